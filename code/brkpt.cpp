@@ -0,0 +1,1095 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Breakpoint Manager Object
+//!
+//! \details
+//!    Each logical breakpoint is converted to one or more masked matches.  An
+//!    address range is split into naturally aligned power-of-two blocks, each
+//!    of which is a single masked match.  The matches are then merged in
+//!    pairs, always choosing the pair that produces the narrowest match,
+//!    until they fit in the four hardware comparators.
+//!
+//!    A merged match is a superset of the matches that it replaced, so the
+//!    comparators can halt the KS10 on a bus cycle that no logical breakpoint
+//!    asked for.  These false hits are filtered in software when the KS10
+//!    halts.  Fetch breakpoints are checked against the PC and data
+//!    breakpoints are checked against the effective address of the
+//!    instruction that was executing.
+//!
+//! \file
+//!    brkpt.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#include <time.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "brkpt.hpp"
+#include "util.hpp"
+
+//
+// Bus flags that the comparators can match.
+//
+
+static const ks10_t::addr_t flagMask = (ks10_t::flagFetch | ks10_t::flagRead |
+                                        ks10_t::flagWrite | ks10_t::flagIO);
+
+//
+// Bits that a match can cover: the flags and the 22-bit IO address.
+//
+
+static const ks10_t::addr_t busMask = flagMask | ks10_t::ioAddrMask;
+
+//
+// A BRAR of zero disables the comparator.  This bit is never set in the
+// mask, so it can be set in the BRAR without changing the match.
+//
+
+static const ks10_t::addr_t fillBit = 0400000000000ULL;
+
+//
+// EBR Enable Pager bit
+//
+
+static const ks10_t::data_t ebrENBPAG = 0020000;
+
+//!
+//! \brief
+//!    Sign extend a 36-bit value
+//!
+
+static int64_t sext36(ks10_t::data_t data) {
+    data &= 0777777777777ULL;
+    return (data & 0400000000000ULL) ? (int64_t)(data | ~0777777777777ULL) : (int64_t)data;
+}
+
+//!
+//! \brief
+//!    Returns the name of a breakpoint type
+//!
+
+const char *brkpt_t::typeName(type_t type) {
+    switch (type) {
+        case typeFETCH: return "fetch";
+        case typeMEMRD: return "memrd";
+        case typeMEMWR: return "memwr";
+        case typeMEM:   return "mem";
+        case typeIORD:  return "iord";
+        case typeIOWR:  return "iowr";
+        case typeIO:    return "io";
+    }
+    return "?";
+}
+
+//!
+//! \brief
+//!    Set the flags of a match for a breakpoint type
+//!
+//! \details
+//!    The comparator matches a cycle if the masked compare succeeds with
+//!    either the write flag or the read flag ignored.  Setting both flags in
+//!    the BRAR therefore matches reads and writes, and setting one of them
+//!    with both in the mask matches only that direction.
+//!
+//! \param type -
+//!    breakpoint type
+//!
+//! \param [out] m -
+//!    match.  The flag bits of the BRAR and BRMR are set.
+//!
+
+void brkpt_t::flags(type_t type, match_t &m) {
+    static const ks10_t::addr_t rdwr = ks10_t::flagRead | ks10_t::flagWrite | ks10_t::flagIO;
+    switch (type) {
+        case typeFETCH:
+            m.brar = ks10_t::flagFetch | ks10_t::flagRead;
+            m.brmr = ks10_t::flagFetch | rdwr;
+            break;
+        case typeMEMRD:
+            m.brar = ks10_t::flagRead;
+            m.brmr = rdwr;
+            break;
+        case typeMEMWR:
+            m.brar = ks10_t::flagWrite;
+            m.brmr = rdwr;
+            break;
+        case typeMEM:
+            m.brar = ks10_t::flagRead | ks10_t::flagWrite;
+            m.brmr = rdwr;
+            break;
+        case typeIORD:
+            m.brar = ks10_t::flagRead | ks10_t::flagIO;
+            m.brmr = rdwr;
+            break;
+        case typeIOWR:
+            m.brar = ks10_t::flagWrite | ks10_t::flagIO;
+            m.brmr = rdwr;
+            break;
+        case typeIO:
+            m.brar = ks10_t::flagRead | ks10_t::flagWrite | ks10_t::flagIO;
+            m.brmr = rdwr;
+            break;
+    }
+}
+
+//!
+//! \brief
+//!    Returns the width of a match
+//!
+//! \details
+//!    The width is the number of bus bits that the match does not care
+//!    about.  A match covers 2**width combinations of address and flags.
+//!
+
+unsigned int brkpt_t::width(const match_t &m) {
+    return __builtin_popcountll(busMask & ~m.brmr);
+}
+
+//!
+//! \brief
+//!    Merge two matches
+//!
+//! \details
+//!    The merged match keeps only the bits that both matches care about and
+//!    that have the same value in both.  It matches every cycle that either
+//!    match does.
+//!
+
+brkpt_t::match_t brkpt_t::merge(const match_t &a, const match_t &b) {
+    match_t m;
+    m.brmr = a.brmr & b.brmr & ~(a.brar ^ b.brar);
+    m.brar = a.brar & m.brmr;
+    return m;
+}
+
+//!
+//! \brief
+//!    Returns true if a match is a combined read-or-write match
+//!
+//! \details
+//!    A combined match has both the read and the write flag set in the BRAR
+//!    and in the BRMR.  It relies on the write half of the comparator.
+//!
+
+bool brkpt_t::rdwr(const match_t &m) {
+    static const ks10_t::addr_t both = ks10_t::flagRead | ks10_t::flagWrite;
+    return (m.brar & m.brmr & both) == both;
+}
+
+//!
+//! \brief
+//!    Convert an address range to masked matches
+//!
+//! \details
+//!    The range is split into naturally aligned power-of-two blocks.  If
+//!    there are more blocks than will fit, the range is converted to a
+//!    single match on the address bits that are common to the whole range.
+//!
+//! \param type -
+//!    breakpoint type
+//!
+//! \param lo -
+//!    first address
+//!
+//! \param hi -
+//!    last address
+//!
+//! \param [out] m -
+//!    matches
+//!
+//! \param max -
+//!    size of m[]
+//!
+//! \returns
+//!    number of matches
+//!
+
+unsigned int brkpt_t::blocks(type_t type, ks10_t::addr_t lo, ks10_t::addr_t hi, match_t *m, unsigned int max) {
+
+    bool io = (type == typeIORD) || (type == typeIOWR) || (type == typeIO);
+    ks10_t::addr_t addrMask = io ? ks10_t::ioAddrMask : ks10_t::memAddrMask;
+
+    match_t f;
+    flags(type, f);
+
+    unsigned int num = 0;
+    ks10_t::addr_t addr = lo;
+    while (addr <= hi) {
+        ks10_t::addr_t size = 1;
+        while (((addr & (size * 2 - 1)) == 0) && (addr + size * 2 - 1 <= hi) && (size * 2 <= addrMask)) {
+            size *= 2;
+        }
+        if (num == max) {
+            ks10_t::addr_t diff = lo ^ hi;
+            while (diff & (diff + 1)) {
+                diff |= diff >> 1;
+            }
+            m[0].brmr = f.brmr | (addrMask & ~diff);
+            m[0].brar = f.brar | (lo & m[0].brmr & addrMask);
+            return 1;
+        }
+        m[num].brmr = f.brmr | (addrMask & ~(size - 1));
+        m[num].brar = f.brar | addr;
+        num += 1;
+        addr += size;
+    }
+    return num;
+}
+
+//!
+//! \brief
+//!    Program the hardware comparators
+//!
+//! \details
+//!    The enabled breakpoints are converted to matches and the matches are
+//!    merged until they fit in the comparators.  The comparators are only
+//!    written if the manager has breakpoints or has written them before so
+//!    that settings made with the "br" command are left alone.
+//!
+//!    Comparator 3 in the FPGA ignores the write flag in both halves of its
+//!    compare (fpga/ks10/breakpoint/breakpoint.sv), so a combined
+//!    read-or-write match there never matches a write.  Combined matches
+//!    are kept out of comparator 3.  If all four matches are combined, the
+//!    matches are merged into three.  A write-only match in comparator 3
+//!    also matches reads, so the comparators are no longer exact.
+//!
+
+void brkpt_t::program(void) {
+
+    match_t m[maxBP];
+    unsigned int num = 0;
+    bool fits = true;
+
+    //
+    // Try to split every range into aligned blocks
+    //
+
+    for (unsigned int i = 0; i < maxBP; i++) {
+        if (bps[i].used && bps[i].enabled) {
+            if (num == maxBP) {
+                fits = false;
+                break;
+            }
+            num += blocks(bps[i].type, bps[i].lo, bps[i].hi, &m[num], maxBP - num);
+        }
+    }
+
+    //
+    // Too many blocks.  Use one match per breakpoint.
+    //
+
+    if (!fits) {
+        num = 0;
+        for (unsigned int i = 0; i < maxBP; i++) {
+            if (bps[i].used && bps[i].enabled) {
+                num += blocks(bps[i].type, bps[i].lo, bps[i].hi, &m[num], 1);
+            }
+        }
+    }
+
+    if ((num == 0) && !owned) {
+        return;
+    }
+
+    exact = fits && (num <= numHW);
+
+    //
+    // Merge the pair of matches that produces the narrowest match until the
+    // matches fit in the hardware comparators.  Then move a match that is
+    // not a combined read-or-write match into comparator 3.
+    //
+
+    unsigned int limit = numHW;
+    for (;;) {
+        while (num > limit) {
+            unsigned int bestI = 0;
+            unsigned int bestJ = 1;
+            unsigned int bestW = ~0U;
+            for (unsigned int i = 0; i < num; i++) {
+                for (unsigned int j = i + 1; j < num; j++) {
+                    unsigned int w = width(merge(m[i], m[j]));
+                    if (w < bestW) {
+                        bestW = w;
+                        bestI = i;
+                        bestJ = j;
+                    }
+                }
+            }
+            m[bestI] = merge(m[bestI], m[bestJ]);
+            m[bestJ] = m[--num];
+            exact = false;
+        }
+        if (num < numHW) {
+            break;
+        }
+        unsigned int i = 0;
+        while ((i < numHW) && rdwr(m[i])) {
+            i++;
+        }
+        if (i < numHW) {
+            match_t t = m[i];
+            m[i] = m[numHW - 1];
+            m[numHW - 1] = t;
+            break;
+        }
+        limit = numHW - 1;
+    }
+
+    //
+    // A write-only match in comparator 3 also matches reads
+    //
+
+    if (num == numHW) {
+        const match_t &m3 = m[numHW - 1];
+        if ((m3.brar & m3.brmr & (ks10_t::flagRead | ks10_t::flagWrite)) == ks10_t::flagWrite) {
+            exact = false;
+        }
+    }
+
+    numMatch = num;
+    for (unsigned int i = 0; i < numHW; i++) {
+        if (i < num) {
+            if (m[i].brmr == 0) {
+                printf("KS10: Breakpoints are too broad to merge into comparator %u.\n", i);
+            }
+            if (m[i].brar == 0) {
+                m[i].brar = fillBit;
+            }
+            hw[i] = m[i];
+        } else {
+            hw[i].brar = 0;
+            hw[i].brmr = 0;
+        }
+    }
+    arm();
+    owned = (num != 0);
+
+    //
+    // The halts that check() continues are not kept in the halt history
+    //
+
+    ks10_t::recordHalts(num == 0);
+}
+
+//!
+//! \brief
+//!    Write the matches to the hardware comparators
+//!
+
+void brkpt_t::arm(void) {
+    for (unsigned int i = 0; i < numHW; i++) {
+        ks10_t::writeBRAR(i, hw[i].brar);
+        ks10_t::writeBRMR(i, hw[i].brmr);
+    }
+}
+
+//!
+//! \brief
+//!    Add a breakpoint
+//!
+//! \param type -
+//!    breakpoint type
+//!
+//! \param lo -
+//!    first address
+//!
+//! \param hi -
+//!    last address
+//!
+//! \param count -
+//!    halt on this hit and on every hit after it
+//!
+//! \param cond -
+//!    condition that must be true to halt
+//!
+//! \param log -
+//!    log the hit and continue instead of halting
+//!
+//! \returns
+//!    breakpoint number or -1 if the table is full
+//!
+
+int brkpt_t::add(type_t type, ks10_t::addr_t lo, ks10_t::addr_t hi, uint64_t count, const cond_t &cond, bool log) {
+    for (unsigned int i = 0; i < maxBP; i++) {
+        if (!bps[i].used) {
+            bps[i].used    = true;
+            bps[i].enabled = true;
+            bps[i].type    = type;
+            bps[i].lo      = lo;
+            bps[i].hi      = hi;
+            bps[i].count   = count ? count : 1;
+            bps[i].hits    = 0;
+            bps[i].cond    = cond;
+            bps[i].log     = log;
+            program();
+            return i;
+        }
+    }
+    return -1;
+}
+
+//!
+//! \brief
+//!    Delete a breakpoint
+//!
+//! \returns
+//!    false if the breakpoint does not exist
+//!
+
+bool brkpt_t::remove(unsigned int id) {
+    if ((id >= maxBP) || !bps[id].used) {
+        return false;
+    }
+    bps[id].used = false;
+    program();
+    return true;
+}
+
+//!
+//! \brief
+//!    Enable or disable a breakpoint
+//!
+//! \returns
+//!    false if the breakpoint does not exist
+//!
+
+bool brkpt_t::enable(unsigned int id, bool enable) {
+    if ((id >= maxBP) || !bps[id].used) {
+        return false;
+    }
+    bps[id].enabled = enable;
+    program();
+    return true;
+}
+
+//!
+//! \brief
+//!    Delete all breakpoints
+//!
+
+void brkpt_t::clear(void) {
+    for (unsigned int i = 0; i < maxBP; i++) {
+        bps[i].used = false;
+    }
+    program();
+    halts = 0;
+    falseHits = 0;
+}
+
+//!
+//! \brief
+//!    Zero the hit counters
+//!
+
+void brkpt_t::reset(void) {
+    for (unsigned int i = 0; i < maxBP; i++) {
+        bps[i].hits = 0;
+    }
+    halts = 0;
+    falseHits = 0;
+    logged = 0;
+    resumed = 0;
+    serviceNsecs = 0;
+    serviceMax = 0;
+    serviceLate = 0;
+}
+
+//!
+//! \brief
+//!    Select the log file
+//!
+//! \param filename -
+//!    file to append the log to.  NULL logs to the console.
+//!
+//! \returns
+//!    false if the file cannot be opened
+//!
+
+bool brkpt_t::logTo(const char *filename) {
+    if (logFile != stdout) {
+        fclose(logFile);
+        logFile = stdout;
+    }
+    if (filename != NULL) {
+        FILE *fp = fopen(filename, "a");
+        if (fp == NULL) {
+            printf("KS10: Unable to open breakpoint log \"%s\": %s\n", filename, strerror(errno));
+            return false;
+        }
+        logFile = fp;
+    }
+    return true;
+}
+
+//!
+//! \brief
+//!    Capture a breakpoint hit for the log
+//!
+//! \details
+//!    The log line has the breakpoint number, the PC, the IR, the data
+//!    address and memory word for memory breakpoints, and the ACs.
+//!
+//!    Only the bus reads are done here, while the KS10 is halted.  The ACs
+//!    are read once for all of the hits of a halt.  The lines are written
+//!    by flush() after the KS10 has been continued, so file IO is not part
+//!    of the halt to continue time.
+//!
+//! \param id -
+//!    breakpoint number
+//!
+//! \param pc -
+//!    PC
+//!
+//! \param ir -
+//!    IR
+//!
+//! \param addr -
+//!    data addresses of the instruction
+//!
+//! \param num -
+//!    number of data addresses
+//!
+//! \param io -
+//!    the data addresses are IO addresses
+//!
+
+void brkpt_t::record(unsigned int id, ks10_t::addr_t pc, ks10_t::data_t ir, const ks10_t::addr_t *addr, unsigned int num, bool io) {
+
+    if (numPending == 0) {
+        ks10_t::snapshot_t snap;
+        ks10_t::snapshot(snap, false);
+        for (unsigned int i = 0; i < 020; i++) {
+            pendingAC[i] = snap.ac[i];
+        }
+    }
+
+    hit_t &hit = pending[numPending++];
+    hit.id  = id;
+    hit.pc  = pc;
+    hit.ir  = ir;
+    hit.mem = false;
+    if (!io && (bps[id].type != typeFETCH)) {
+        for (unsigned int j = 0; j < num; j++) {
+            if ((addr[j] >= bps[id].lo) && (addr[j] <= bps[id].hi)) {
+                hit.mem  = true;
+                hit.addr = addr[j];
+                hit.data = ks10_t::readMem(addr[j]);
+                break;
+            }
+        }
+    }
+}
+
+//!
+//! \brief
+//!    Write the captured hits to the log
+//!
+
+void brkpt_t::flush(void) {
+    for (unsigned int n = 0; n < numPending; n++) {
+        const hit_t &hit = pending[n];
+        fprintf(logFile, "bp%u PC=%06llo IR=%012llo", hit.id, hit.pc, hit.ir);
+        if (hit.mem) {
+            fprintf(logFile, " MEM[%06llo]=%012llo", hit.addr, hit.data);
+        }
+        fprintf(logFile, " AC=");
+        for (unsigned int i = 0; i < 020; i++) {
+            fprintf(logFile, "%s%012llo", i ? "," : "", pendingAC[i]);
+        }
+        fprintf(logFile, "\n");
+        logged += 1;
+    }
+    numPending = 0;
+}
+
+//!
+//! \brief
+//!    Returns true if any breakpoint is enabled
+//!
+
+bool brkpt_t::armed(void) const {
+    for (unsigned int i = 0; i < maxBP; i++) {
+        if (bps[i].used && bps[i].enabled) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//!
+//! \brief
+//!    List the breakpoints and the comparator contents
+//!
+
+void brkpt_t::list(void) {
+
+    static const char *cmpName[] = {"", "==", "!=", "<", ">", "<=", ">=", "&"};
+
+    printf("KS10: Breakpoints:\n"
+           "  ID  Type   First    Last         Count         Hits  Condition\n");
+    for (unsigned int i = 0; i < maxBP; i++) {
+        const bp_t &bp = bps[i];
+        if (!bp.used) {
+            continue;
+        }
+        printf("  %2u%c%c%-6s %08llo %08llo %10llu %12llu  ",
+               i, bp.enabled ? ' ' : '*', bp.log ? 'L' : ' ', typeName(bp.type), bp.lo, bp.hi,
+               (unsigned long long)bp.count, (unsigned long long)bp.hits);
+        if (bp.cond.cmp != cmpNONE) {
+            if (bp.cond.ac) {
+                printf("ac%llo", bp.cond.addr);
+            } else {
+                printf("%llo", bp.cond.addr);
+            }
+            printf("%s%llo", cmpName[bp.cond.cmp], bp.cond.value);
+        }
+        printf("\n");
+    }
+    printf("  (* = disabled, L = logging)\n"
+           "KS10: Breakpoint halts: %llu, false hits: %llu, logged: %llu\n",
+           (unsigned long long)halts, (unsigned long long)falseHits, (unsigned long long)logged);
+    if (resumed != 0) {
+        printf("KS10: Halt to continue: %llu us average, %llu us maximum, %llu over %llu us\n",
+               (unsigned long long)(serviceNsecs / resumed / 1000), (unsigned long long)(serviceMax / 1000),
+               (unsigned long long)serviceLate, (unsigned long long)(serviceBound / 1000));
+    }
+    if (owned) {
+        for (unsigned int i = 0; i < numMatch; i++) {
+            printf("KS10: Comparator %u: BRAR=%012llo BRMR=%012llo\n", i, hw[i].brar, hw[i].brmr);
+        }
+    }
+}
+
+//!
+//! \brief
+//!    Parse a condition
+//!
+//! \details
+//!    A condition is "acN<op>value" or "addr<op>value".  The operator is one
+//!    of ==, !=, <, >, <=, >=, or &.  The numbers are octal and the value may
+//!    be negative.  The relational operators compare signed 36-bit values and
+//!    & is true if any of the bits in the value are set.
+//!
+//! \param s -
+//!    condition string
+//!
+//! \param [out] cond -
+//!    parsed condition
+//!
+//! \returns
+//!    true if the condition is valid
+//!
+
+bool brkpt_t::parseCond(const char *s, cond_t &cond) {
+
+    char *end;
+
+    while (isspace(*s)) {
+        s++;
+    }
+    cond.ac = (tolower(s[0]) == 'a') && (tolower(s[1]) == 'c');
+    if (cond.ac) {
+        s += 2;
+    }
+    if (!isdigit(*s)) {
+        return false;
+    }
+    cond.addr = strtoull(s, &end, 8);
+    if ((cond.ac && cond.addr > 017) || (!cond.ac && cond.addr > ks10_t::memAddrMask)) {
+        return false;
+    }
+    s = end;
+    while (isspace(*s)) {
+        s++;
+    }
+
+    if (s[0] == '=' && s[1] == '=') {
+        cond.cmp = cmpEQ;
+        s += 2;
+    } else if (s[0] == '!' && s[1] == '=') {
+        cond.cmp = cmpNE;
+        s += 2;
+    } else if (s[0] == '<' && s[1] == '=') {
+        cond.cmp = cmpLE;
+        s += 2;
+    } else if (s[0] == '>' && s[1] == '=') {
+        cond.cmp = cmpGE;
+        s += 2;
+    } else if (s[0] == '<') {
+        cond.cmp = cmpLT;
+        s += 1;
+    } else if (s[0] == '>') {
+        cond.cmp = cmpGT;
+        s += 1;
+    } else if (s[0] == '&') {
+        cond.cmp = cmpAND;
+        s += 1;
+    } else {
+        return false;
+    }
+
+    while (isspace(*s)) {
+        s++;
+    }
+    bool neg = (*s == '-');
+    if (neg) {
+        s++;
+    }
+    if (!isdigit(*s)) {
+        return false;
+    }
+    ks10_t::data_t value = strtoull(s, &end, 8);
+    if (*end != 0 || value > 0777777777777ULL) {
+        return false;
+    }
+    cond.value = (neg ? -value : value) & 0777777777777ULL;
+    return true;
+}
+
+//!
+//! \brief
+//!    Evaluate a condition
+//!
+//! \note
+//!    Reading an AC executes a MOVEM to location 100.
+//!
+
+bool brkpt_t::evalCond(const cond_t &cond) {
+
+    if (cond.cmp == cmpNONE) {
+        return true;
+    }
+
+    ks10_t::data_t data = cond.ac ? ks10_t::readAC(cond.addr) : ks10_t::readMem(cond.addr);
+    int64_t a = sext36(data);
+    int64_t b = sext36(cond.value);
+
+    switch (cond.cmp) {
+        case cmpEQ:  return a == b;
+        case cmpNE:  return a != b;
+        case cmpLT:  return a <  b;
+        case cmpGT:  return a >  b;
+        case cmpLE:  return a <= b;
+        case cmpGE:  return a >= b;
+        case cmpAND: return (data & cond.value) != 0;
+        default:     return true;
+    }
+}
+
+//!
+//! \brief
+//!    Compute the effective address of an instruction
+//!
+//! \details
+//!    Indexing and indirection are followed using the current ACs and memory.
+//!    IO instructions index with the full 22-bit AC contents.
+//!
+//! \param insn -
+//!    instruction
+//!
+//! \param io -
+//!    compute an IO address
+//!
+
+ks10_t::addr_t brkpt_t::effAddr(ks10_t::data_t insn, bool io) {
+    ks10_t::addr_t y = insn & 0777777;
+    for (unsigned int depth = 0; depth < 16; depth++) {
+        unsigned int x = (insn >> 18) & 017;
+        unsigned int i = (insn >> 22) & 001;
+        y = insn & 0777777;
+        if (x != 0) {
+            ks10_t::data_t ac = ks10_t::readAC(x);
+            if (io) {
+                return (ac + y) & ks10_t::ioAddrMask;
+            }
+            y = (ac + y) & 0777777;
+        }
+        if (!i) {
+            break;
+        }
+        insn = ks10_t::readMem(y);
+    }
+    return y;
+}
+
+//!
+//! \brief
+//!    Find the data addresses of an instruction
+//!
+//! \details
+//!    Block transfers, extended instructions, and UUOs access addresses that
+//!    cannot be recovered after the instruction completes.
+//!
+//! \param insn -
+//!    instruction
+//!
+//! \param [out] addr -
+//!    data addresses.  There are at most three.
+//!
+//! \param [out] num -
+//!    number of data addresses
+//!
+//! \param [out] io -
+//!    the addresses are IO addresses
+//!
+//! \returns
+//!    false if the addresses cannot be determined
+//!
+
+bool brkpt_t::dataAddr(ks10_t::data_t insn, ks10_t::addr_t *addr, unsigned int &num, bool &io) {
+
+    unsigned int op = (insn >> 27) & 0777;
+    unsigned int ac = (insn >> 23) & 017;
+
+    num = 0;
+    io  = (op >= 0710) && (op <= 0727);
+
+    if ((op <= 0077) || (op == 0104) || (op == 0123) || (op == 0251)) {
+        return false;
+    }
+
+    switch (op) {
+        case 0260:      // PUSHJ
+        case 0261:      // PUSH
+            addr[num++] = ks10_t::readAC(ac) & 0777777;
+            break;
+        case 0262:      // POP
+        case 0263:      // POPJ
+            addr[num++] = (ks10_t::readAC(ac) + 1) & 0777777;
+            break;
+        case 0256:      // XCT
+            addr[num++] = effAddr(insn, false);
+            insn = ks10_t::readMem(addr[0]);
+            op = (insn >> 27) & 0777;
+            if ((op <= 0077) || (op == 0104) || (op == 0123) || (op == 0251) || (op == 0256)) {
+                return false;
+            }
+            addr[num++] = effAddr(insn, false);
+            break;
+        case 0133:      // IBP
+        case 0134:      // ILDB
+        case 0135:      // LDB
+        case 0136:      // IDPB
+        case 0137:      // DPB
+            addr[num++] = effAddr(insn, false);
+            addr[num++] = effAddr(ks10_t::readMem(addr[0]), false);
+            break;
+        default:
+            addr[num++] = effAddr(insn, io);
+            break;
+    }
+    return true;
+}
+
+//!
+//! \brief
+//!    Check a halt against the breakpoints
+//!
+//! \details
+//!    This is called when the KS10 halts while the console is running it.
+//!    If the halt was caused by the comparators, the halt is checked against
+//!    each enabled breakpoint.  Every breakpoint that matches has its hit
+//!    counter incremented.  If no breakpoint has reached its count with its
+//!    condition true, the comparators are re-armed and the KS10 is continued.
+//!    Logging breakpoints that are satisfied are logged and do not stop the
+//!    KS10.
+//!
+//!    The halt to continue path is bounded.  It does a fixed number of bus
+//!    operations: the halt status, EBR, at most three data address reads,
+//!    the ACs and one memory word per logged hit, and the comparators.  It
+//!    does no file IO because the log lines are written after the KS10 is
+//!    continued.  The time is measured and list() reports it with the
+//!    number of continues that took longer than serviceBound.  The console
+//!    is not a real-time process, so scheduling can still exceed the bound.
+//!
+//!    The PC, IR, and Halt Status Word are read together before anything
+//!    else because reading an AC executes an instruction, which reloads
+//!    PCIR.  Data addresses are computed from the ACs after the instruction
+//!    has completed, so an instruction that modifies its own index register
+//!    can be missed.
+//!
+//!    While breakpoints are armed the halt status thread does not record
+//!    halts.  The halts that are not continued are recorded here.
+//!
+//!    The comparators match physical addresses but the PC, the effective
+//!    addresses, and the indirect words are virtual when paging is enabled.
+//!    The page tables are not walked.  Instead, with paging enabled the
+//!    software check is skipped and the comparator match is trusted.  The
+//!    hit is counted only if one breakpoint is enabled and the comparators
+//!    match exactly its range.  Otherwise the KS10 is left halted as an
+//!    unverified breakpoint halt.  Memory conditions always use physical
+//!    addresses.
+//!
+//! \returns
+//!    true if the KS10 was continued
+//!
+
+bool brkpt_t::check(void) {
+
+    if (!armed()) {
+        return false;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    ks10_t::data_t pcir;
+    ks10_t::data_t hsw;
+    ks10_t::data_t hswPC;
+    if (!ks10_t::readHaltStatus(pcir, hsw, hswPC)) {
+        return false;
+    }
+    if (hsw != 2) {
+        ks10_t::recordHalt(true);
+        return false;
+    }
+
+    halts += 1;
+
+    ks10_t::addr_t pc = (pcir >> 36) & 0777777;
+    ks10_t::data_t ir = pcir & 0777777777777ULL;
+    hswPC &= 0777777;
+
+    bool paged = (ks10_t::rdEBR() & ebrENBPAG) != 0;
+    unsigned int enabled = 0;
+    for (unsigned int i = 0; i < maxBP; i++) {
+        if (bps[i].used && bps[i].enabled) {
+            enabled += 1;
+        }
+    }
+
+    ks10_t::addr_t addr[3];
+    unsigned int num = 0;
+    bool io = false;
+    bool known = true;
+    bool haveAddr = false;
+
+    bool matched = false;
+    bool unverified = false;
+    int stop = -1;
+
+    for (unsigned int i = 0; i < maxBP; i++) {
+        bp_t &bp = bps[i];
+        if (!bp.used || !bp.enabled) {
+            continue;
+        }
+
+        bool hit = false;
+        if (paged) {
+            if (!exact || (enabled != 1)) {
+                unverified = true;
+                continue;
+            }
+            hit = true;
+        } else if (bp.type == typeFETCH) {
+            hit = ((pc >= bp.lo) && (pc <= bp.hi)) || ((hswPC >= bp.lo) && (hswPC <= bp.hi));
+        } else {
+            if (!haveAddr) {
+                known = dataAddr(ir, addr, num, io);
+                haveAddr = true;
+            }
+            if (!known) {
+                unverified = true;
+                continue;
+            }
+            bool ioType = (bp.type == typeIORD) || (bp.type == typeIOWR) || (bp.type == typeIO);
+            if (ioType == io) {
+                for (unsigned int j = 0; j < num; j++) {
+                    if ((addr[j] >= bp.lo) && (addr[j] <= bp.hi)) {
+                        hit = true;
+                    }
+                }
+            }
+        }
+
+        if (hit) {
+            matched = true;
+            bp.hits += 1;
+            if ((bp.hits >= bp.count) && evalCond(bp.cond)) {
+                if (bp.log) {
+                    record(i, pc, ir, addr, haveAddr ? num : 0, io);
+                } else if (stop < 0) {
+                    stop = i;
+                }
+            }
+        }
+    }
+
+    if (!matched && !unverified) {
+        falseHits += 1;
+    }
+
+    if (stop >= 0) {
+        flush();
+        printf("KS10: Breakpoint %d (%s %06llo-%06llo) hit %llu times at PC=%06llo.\n",
+               stop, typeName(bps[stop].type), bps[stop].lo, bps[stop].hi,
+               (unsigned long long)bps[stop].hits, pc);
+        ks10_t::recordHalt(true);
+        return false;
+    }
+
+    if (unverified && !matched) {
+        flush();
+        printf("KS10: Breakpoint halt could not be verified at PC=%06llo.\n", pc);
+        ks10_t::recordHalt(true);
+        return false;
+    }
+
+    //
+    // Re-arm the comparators and continue.  Wait for the KS10 to start
+    // running so this halt is not seen again.
+    //
+
+    arm();
+    ks10_t::startCONT();
+
+    struct timespec finish;
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    uint64_t ns = nsecs(start, finish);
+    serviceNsecs += ns;
+    if (ns > serviceMax) {
+        serviceMax = ns;
+    }
+    if (ns > serviceBound) {
+        serviceLate += 1;
+    }
+    resumed += 1;
+
+    flush();
+
+    for (unsigned int i = 0; (i < 100) && ks10_t::halt(); i++) {
+        usleep(1);
+    }
+    return true;
+}
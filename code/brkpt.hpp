@@ -0,0 +1,241 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Breakpoint Manager Object
+//!
+//! \details
+//!    The FPGA has four breakpoint comparators.  Each comparator is a
+//!    Breakpoint Address Register (BRAR) and a Breakpoint Mask Register
+//!    (BRMR) and halts the KS10 when the masked bus address and flags match.
+//!
+//!    This object multiplexes any number of logical breakpoints onto the
+//!    four comparators by merging them into wider masked matches.  When the
+//!    KS10 halts the console checks the halt against the logical
+//!    breakpoints, filters out the false hits that the merged comparators
+//!    allow, updates the hit counters, and evaluates the conditions.  If no
+//!    breakpoint is satisfied the KS10 is continued.
+//!
+//!    A logging breakpoint records the PC, IR, data word, and ACs when it is
+//!    satisfied and continues the KS10 instead of leaving it halted.
+//!
+//!    The comparators match physical bus addresses.  The software check
+//!    uses the PC and the effective addresses of the instruction, which are
+//!    virtual when paging is enabled.  With paging enabled the software
+//!    check is skipped.  See brkpt_t::check().
+//!
+//! \file
+//!    brkpt.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+
+#ifndef __BRKPT_HPP
+#define __BRKPT_HPP
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ks10.hpp"
+
+//!
+//! \brief
+//!    Breakpoint Manager Object
+//!
+
+class brkpt_t {
+
+    public:
+
+        static const unsigned int maxBP = 64;           //!< Logical breakpoints
+        static const unsigned int numHW = 4;            //!< Hardware comparators
+        static const uint64_t serviceBound = 1000000;   //!< Halt to continue bound (ns)
+
+        //!
+        //! \brief
+        //!    Breakpoint types
+        //!
+
+        enum type_t {
+            typeFETCH,                          //!< Instruction fetch
+            typeMEMRD,                          //!< Memory read
+            typeMEMWR,                          //!< Memory write
+            typeMEM,                            //!< Memory read or write
+            typeIORD,                           //!< IO read
+            typeIOWR,                           //!< IO write
+            typeIO,                             //!< IO read or write
+        };
+
+        //!
+        //! \brief
+        //!    Condition comparisons
+        //!
+
+        enum cmp_t {
+            cmpNONE,                            //!< No condition
+            cmpEQ,                              //!< ==
+            cmpNE,                              //!< !=
+            cmpLT,                              //!< <  (signed)
+            cmpGT,                              //!< >  (signed)
+            cmpLE,                              //!< <= (signed)
+            cmpGE,                              //!< >= (signed)
+            cmpAND,                             //!< &  (any bits set)
+        };
+
+        //!
+        //! \brief
+        //!    Condition.  An AC or a memory location compared to a value.
+        //!
+
+        struct cond_t {
+            cmp_t cmp;                          //!< Comparison
+            bool ac;                            //!< Compare an AC instead of memory
+            ks10_t::addr_t addr;                //!< AC number or memory address
+            ks10_t::data_t value;               //!< Value
+        };
+
+        //!
+        //! \brief
+        //!    Logical breakpoint
+        //!
+
+        struct bp_t {
+            bool used;                          //!< Entry is in use
+            bool enabled;                       //!< Breakpoint is enabled
+            type_t type;                        //!< Breakpoint type
+            ks10_t::addr_t lo;                  //!< First address
+            ks10_t::addr_t hi;                  //!< Last address
+            uint64_t count;                     //!< Halt on this hit and after
+            uint64_t hits;                      //!< Verified hits
+            cond_t cond;                        //!< Condition
+            bool log;                           //!< Log and continue instead of halting
+        };
+
+    private:
+
+        //!
+        //! \brief
+        //!    Masked match.  A bus cycle matches if the bits that are set in
+        //!    the mask are the same in the bus address and in the value.
+        //!
+
+        struct match_t {
+            ks10_t::addr_t brar;                //!< Value
+            ks10_t::addr_t brmr;                //!< Mask
+        };
+
+        //!
+        //! \brief
+        //!    Logged hit.  The hit is captured while the KS10 is halted and
+        //!    written after the KS10 is continued.
+        //!
+
+        struct hit_t {
+            unsigned int id;                    //!< Breakpoint number
+            ks10_t::addr_t pc;                  //!< PC
+            ks10_t::data_t ir;                  //!< IR
+            bool mem;                           //!< The memory word is valid
+            ks10_t::addr_t addr;                //!< Memory address
+            ks10_t::data_t data;                //!< Memory word
+        };
+
+        bp_t bps[maxBP];                        //!< Logical breakpoints
+        match_t hw[numHW];                      //!< Comparator contents
+        unsigned int numMatch;                  //!< Comparators in use
+        bool exact;                             //!< Comparators match only the enabled ranges
+        bool owned;                             //!< The manager has programmed the comparators
+        uint64_t halts;                         //!< Breakpoint halts
+        uint64_t falseHits;                     //!< Halts that matched no breakpoint
+        uint64_t logged;                        //!< Hits that were logged
+        uint64_t resumed;                       //!< Halts that were continued
+        uint64_t serviceNsecs;                  //!< Time from halt to continue
+        uint64_t serviceMax;                    //!< Longest time from halt to continue
+        uint64_t serviceLate;                   //!< Continues that exceeded serviceBound
+        hit_t pending[maxBP];                   //!< Hits to be written to the log
+        unsigned int numPending;                //!< Number of pending hits
+        ks10_t::data_t pendingAC[020];          //!< ACs of the pending hits
+        FILE *logFile;                          //!< Log file or stdout
+
+        static void flags(type_t type, match_t &m);
+        static unsigned int width(const match_t &m);
+        static match_t merge(const match_t &a, const match_t &b);
+        static bool rdwr(const match_t &m);
+        static unsigned int blocks(type_t type, ks10_t::addr_t lo, ks10_t::addr_t hi, match_t *m, unsigned int max);
+        static ks10_t::addr_t effAddr(ks10_t::data_t insn, bool io);
+        static bool dataAddr(ks10_t::data_t insn, ks10_t::addr_t *addr, unsigned int &num, bool &io);
+        static bool evalCond(const cond_t &cond);
+        static const char *typeName(type_t type);
+        void program(void);
+        void arm(void);
+        void record(unsigned int id, ks10_t::addr_t pc, ks10_t::data_t ir, const ks10_t::addr_t *addr, unsigned int num, bool io);
+        void flush(void);
+
+    public:
+
+        int add(type_t type, ks10_t::addr_t lo, ks10_t::addr_t hi, uint64_t count, const cond_t &cond, bool log);
+        bool logTo(const char *filename);
+        bool remove(unsigned int id);
+        bool enable(unsigned int id, bool enable);
+        void clear(void);
+        void reset(void);
+        void list(void);
+        bool check(void);
+        bool armed(void) const;
+        static bool parseCond(const char *s, cond_t &cond);
+
+        //!
+        //! \brief
+        //!    Constructor
+        //!
+
+        brkpt_t(void) :
+            numMatch(0),
+            exact(true),
+            owned(false),
+            halts(0),
+            falseHits(0),
+            logged(0),
+            resumed(0),
+            serviceNsecs(0),
+            serviceMax(0),
+            serviceLate(0),
+            numPending(0),
+            logFile(stdout) {
+            for (unsigned int i = 0; i < maxBP; i++) {
+                bps[i].used = false;
+            }
+        }
+
+        //!
+        //! \brief
+        //!    Destructor
+        //!
+
+        ~brkpt_t(void) {
+            logTo(NULL);
+        }
+};
+
+#endif
@@ -36,9 +36,11 @@
 //******************************************************************************
 
 #include <atomic>
+#include <new>
 #include <thread>
 
 #include <ctype.h>
+#include <errno.h>
 #include <getopt.h>
 #include <setjmp.h>
 #include <signal.h>
@@ -46,6 +48,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <termios.h>
 #include <unistd.h>
 #include <inttypes.h>
@@ -54,13 +57,20 @@
 
 #include "mt.hpp"
 #include "rp.hpp"
+#include "ube.hpp"
 #include "dasm.hpp"
 #include "dz11.hpp"
 #include "ks10.hpp"
 #include "lp20.hpp"
+#include "pack.hpp"
+#include "prof.hpp"
+#include "brkpt.hpp"
 #include "rh11.hpp"
 #include "tape.hpp"
+#include "trace.hpp"
+#include "rhpoll.hpp"
 #include "dup11.hpp"
+#include "kmc11.hpp"
 #include "vt100.hpp"
 #include "commands.hpp"
 
@@ -78,6 +88,11 @@ mt_t    mt;             //!< Construct MT (tape) device
 lp20_t  lp;             //!< Construct LP (printer) device
 dz11_t  dz;             //!< Construct DZ (tty) device
 dup11_t dp;             //!< Construct DUP (serial com) device
+kmc11_t km;             //!< Construct KMC (microprocessor) device
+trace_t tr;             //!< Construct instruction trace
+prof_t  prof;           //!< Construct PC sampling profiler
+symtab_t symtab;        //!< Construct symbol table
+brkpt_t bp;             //!< Construct breakpoint manager
 
 //
 // RP configuration
@@ -138,6 +153,27 @@ void sigHandler(int sig) {
     }
 }
 
+//!
+//! \brief
+//!    Deferred signal handler
+//!
+//! \details
+//!    Commands that hold the FPGA mutex or own resources in a long loop
+//!    install this handler instead.  It only sets a flag which the loop
+//!    checks at a point where it is safe to stop.
+//!
+//! \param
+//!    sig - should always be SIGINT
+//!
+
+static volatile sig_atomic_t sigInterrupt;
+
+static void sigDeferHandler(int sig) {
+    if (sig == SIGINT) {
+        sigInterrupt = 1;
+    }
+}
+
 //!
 //! \brief
 //!    Initialize defaults
@@ -306,7 +342,12 @@ bool command_t::consoleOutput(void) {
         //
 
         usleep(100);
-    } while (!ks10_t::halt());
+
+        //
+        // Breakpoint halts that are not satisfied continue the KS10
+        //
+
+    } while (!ks10_t::halt() || bp.check());
 
     //
     // Restore the terminal attributes
@@ -365,43 +406,6 @@ static ks10_t::data_t parseOctal(const char *buf) {
     return num;
 }
 
-//!
-//! \brief
-//!    This function builds a 36-bit data word from the contents of the .SAV
-//!    file.
-//!
-//! \param
-//!    b is a pointer to the input data
-//!
-//! \details
-//!    Data is in the format:
-//!
-//!       Byte 0:   0  B00 B01 B02 B03 B04 B05 B06
-//!       Byte 1:   0  B07 B08 B09 B10 B11 B12 B13
-//!       Byte 2:   0  B14 B15 B16 B17 B18 B19 B20
-//!       Byte 3:   0  B21 B22 B23 B24 B25 B26 B27
-//!       Byte 4:  B35 B28 B29 B30 B31 B32 B33 B34
-//!
-//!       Note the position of B35!
-//!
-//!    See "TOPS-10 Tape Processing Manual" Section 6.4 entitled "ANSI-ASCII
-//!    Mode" for format definition.
-//!
-//!    See also document entitled "Dumper and Backup Tape Formats".
-//!
-//! \returns
-//!    36-bit data word
-//!
-
-ks10_t::data_t rdword(const uint8_t *b) {
-    return ((((ks10_t::data_t)(b[0] & 0x7f)) << 29) |   // Bit  0 - Bit  6
-            (((ks10_t::data_t)(b[1] & 0x7f)) << 22) |   // Bit  7 - Bit 13
-            (((ks10_t::data_t)(b[2] & 0x7f)) << 15) |   // Bit 14 - Bit 20
-            (((ks10_t::data_t)(b[3] & 0x7f)) <<  8) |   // Bit 21 - Bit 27
-            (((ks10_t::data_t)(b[4] & 0x7f)) <<  1) |   // Bit 28 - Bit 34
-            (((ks10_t::data_t)(b[4] & 0x80)) >>  7));   // Bit 35
-}
-
 //!
 //! \brief
 //!    Read the PDP10 .SAV file
@@ -431,7 +435,7 @@ ks10_t::data_t getdata(FILE *fp) {
         printf("KS10: getdata - read() failed.\n");
     }
 
-    return rdword(buffer);
+    return pack_t::packANSI(buffer);
 }
 
 //!
@@ -488,17 +492,75 @@ static bool loadCode(const char * filename) {
         }
 
         //
-        // Read record
+        // Read record.  The record is read, packed, and written to memory
+        // in blocks.  A block does not wrap around the end of memory.
         //
 
-        while ((words & 0400000) != 0) {
-            ks10_t::data_t data36 = getdata(fp);
-            addr  = (addr  + 1) & 0777777;
-            ks10_t::writeMem(addr, data36);
+        static const unsigned int blkWORDS = 512;
+        uint8_t buffer[5 * blkWORDS];
+        ks10_t::data_t block[blkWORDS];
+
+        words = 01000000 - words;
+        addr  = (addr + 1) & 0777777;
+
+        while (words != 0) {
+            unsigned int count = (words < blkWORDS) ? words : blkWORDS;
+            if (addr + count > 01000000) {
+                count = 01000000 - addr;
+            }
+            if (fread(buffer, 5, count, fp) != count) {
+                printf("KS10: loadCode - read() failed.\n");
+                fclose(fp);
+                return false;
+            }
+            pack_t::packANSI(block, buffer, count);
+            ks10_t::writeMemBlock(addr, block, count);
 #if 0
-            printf("%06o\t%s\n", addr, dasm(data36));
+            for (unsigned int i = 0; i < count; i++) {
+                printf("%06o\t%s\n", addr + i, dasm(block[i]));
+            }
 #endif
-            words = (words + 1) & 0777777;
+            addr   = (addr + count) & 0777777;
+            words -= count;
+        }
+    }
+}
+
+//!
+//! \brief
+//!   Print the symbols for a location and its contents
+//!
+//! \details
+//!   Nothing is printed when no symbols are loaded or nothing resolves.
+//!
+//! \param addr
+//!   Address of the location
+//!
+//! \param data
+//!   Contents of the location
+//!
+//! \param ea
+//!   Also print the symbol for the Y field of an instruction
+//!
+
+static void printSymbols(uint64_t addr, uint64_t data, bool ea) {
+
+    if (symtab.size() == 0) {
+        return;
+    }
+
+    char buf[symtab_t::maxName + 16];
+    uint32_t y = data & 0777777;
+    bool haveAddr = (addr <= 0777777) && (symtab.lookup(addr) >= 0);
+    bool haveY    = ea && (symtab.lookup(y) >= 0);
+
+    if (haveAddr || haveY) {
+        printf("\t;");
+        if (haveAddr) {
+            printf(" %s", symtab.format(addr, buf, sizeof(buf)));
+        }
+        if (haveY) {
+            printf(" Y=%s", symtab.format(y, buf, sizeof(buf)));
         }
     }
 }
@@ -515,13 +577,17 @@ static bool loadCode(const char * filename) {
 //!
 
 static void dasmMEM(ks10_t::addr_t addr, unsigned int len) {
+    char buf[dasmLEN];
     printf("KS10: Memory disassembly:\n");
     for (unsigned int i = 0; i < len; i++) {
         ks10_t::data_t data = ks10_t::readMem(addr);
         if (ks10_t::nxmnxd()) {
             printf("  Failed. (NXM)\n");
         } else {
-            printf("%07llo: %s\n", addr & ks10_t::maxMemAddr, dasm(data));
+            dasm(data, buf, sizeof(buf));
+            printf("%07llo: %s", addr & ks10_t::maxMemAddr, buf);
+            printSymbols(addr & ks10_t::maxMemAddr, data, true);
+            printf("\n");
         }
         addr++;
     }
@@ -535,7 +601,11 @@ static void dasmMEM(ks10_t::addr_t addr, unsigned int len) {
 void printPCIR(uint64_t data) {
     unsigned int pc = (data >> 36) &  0777777;
     unsigned long long ir = (data >> 0) & 0777777777777;
-    printf("%06o\t%s\n", pc, dasm(ir));
+    char buf[dasmLEN];
+    dasm(ir, buf, sizeof(buf));
+    printf("%06o\t%s", pc, buf);
+    printSymbols(pc, ir, true);
+    printf("\n");
 }
 
 //!
@@ -613,6 +683,285 @@ bool command_t::cmdBA(int argc, char *argv[]) {
     return true;
 }
 
+//!
+//! \brief
+//!   Parse an address
+//!
+//! \details
+//!    An address is an octal number or the name of a symbol.
+//!
+
+static bool parseAddr(const char *s, ks10_t::addr_t &addr) {
+    if ((*s >= '0') && (*s <= '7')) {
+        char *end;
+        addr = strtoull(s, &end, 8);
+        return *end == 0;
+    }
+    int i = symtab.find(s);
+    if (i < 0) {
+        printf("KS10: Symbol \"%s\" is not defined.\n", s);
+        return false;
+    }
+    addr = symtab[i].value;
+    return true;
+}
+
+//!
+//! \brief
+//!   Parse an address range
+//!
+//! \details
+//!    A range is "addr" or "first:last".
+//!
+
+static bool parseRange(const char *s, ks10_t::addr_t mask, ks10_t::addr_t &lo, ks10_t::addr_t &hi) {
+    char buf[64];
+    strncpy(buf, s, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+    char *colon = strchr(buf, ':');
+    if (colon != NULL) {
+        *colon++ = 0;
+    }
+    if (!parseAddr(buf, lo)) {
+        return false;
+    }
+    hi = lo;
+    if ((colon != NULL) && !parseAddr(colon, hi)) {
+        return false;
+    }
+    if ((lo > hi) || (hi > mask)) {
+        printf("KS10: Invalid address range \"%s\".\n", s);
+        return false;
+    }
+    return true;
+}
+
+//!
+//! \brief
+//!   Breakpoint manager
+//!
+//! \details
+//!    The <b>BP</b> (Breakpoint) command manages any number of logical
+//!    breakpoints that share the four hardware breakpoint comparators.
+//!
+//! \param [in] argc
+//!    Number of arguments.
+//!
+//! \param [in] argv
+//!    Array of pointers to the arguments.
+//!
+//! \returns
+//!    True if the interpreter should print a prompt after completion;
+//!    otherwise false.
+//!
+
+bool command_t::cmdBP(int argc, char *argv[]) {
+
+    static const char *usage =
+        "\n"
+        "The \"bp\" command manages logical breakpoints.  Any number of breakpoints\n"
+        "are merged onto the four hardware breakpoint comparators.  When the KS10\n"
+        "halts on a comparator, the console checks the halt against the breakpoints,\n"
+        "counts the hits, and continues the KS10 unless a breakpoint has reached its\n"
+        "count with its condition true.\n"
+        "\n"
+        "Breakpoint addresses are physical.  When paging is enabled the console\n"
+        "cannot check the halt against the breakpoints.  A halt is counted only\n"
+        "when one breakpoint is enabled and its range fits the comparators\n"
+        "exactly.  Otherwise the KS10 stays halted.\n"
+        "\n"
+        "Usage: bp [--help] <command> [options] [arg]\n"
+        "\n"
+        "The bp commands are:\n"
+        "  add            Add a breakpoint.  One break condition is required.\n"
+        "  del n|all      Delete breakpoint n or all breakpoints.\n"
+        "  enable n       Enable breakpoint n.\n"
+        "  disable n      Disable breakpoint n.\n"
+        "  list           List the breakpoints, hit counts, and comparators.\n"
+        "  reset          Zero the hit counts.\n"
+        "  log [file]     Append breakpoint logs to a file.  Without a file the\n"
+        "                 logs are printed on the console.\n"
+        "\n"
+        "Break conditions are:\n"
+        "  --fetch=range  Break on an instruction fetch.\n"
+        "  --mem=range    Break on a memory read or memory write.\n"
+        "  --memrd=range  Break on a memory read.\n"
+        "  --memwr=range  Break on a memory write.\n"
+        "  --io=range     Break on an IO read or IO write.\n"
+        "  --iord=range   Break on an IO read.\n"
+        "  --iowr=range   Break on an IO write.\n"
+        "\n"
+        "A range is \"addr\" or \"first:last\".  Addresses are octal or symbols.\n"
+        "\n"
+        "Valid options are:\n"
+        "   [--help]                    Print help.\n"
+        "   [--count=n]                 Halt on the nth hit and after.  The default\n"
+        "                               is 1.\n"
+        "   [--if=cond]                 Halt only if the condition is true.  The\n"
+        "                               condition is \"acN<op>value\" or\n"
+        "                               \"addr<op>value\" where <op> is one of ==, !=,\n"
+        "                               <, >, <=, >=, or &.  Numbers are octal and\n"
+        "                               the comparisons are signed.\n"
+        "   [--log]                     Log the hit and continue instead of halting.\n"
+        "                               The log has the PC, IR, memory word, and\n"
+        "                               ACs.\n"
+        "\n"
+        "Notes:\n"
+        "  The breakpoint manager takes over all four comparators.  Settings made with\n"
+        "  the \"br\" command are overwritten while breakpoints are defined.\n"
+        "\n"
+        "  Data breakpoints are checked against the effective address of the\n"
+        "  instruction that halted, which is computed from the ACs after the\n"
+        "  instruction completes.  BLT, EXTEND, and UUOs are not checked.  Reads and\n"
+        "  writes to the same address are not distinguished by the check.\n"
+        "\n"
+        "  Conditions on ACs are read by executing a MOVEM to location 100.\n"
+        "\n"
+        "Examples:\n"
+        "\n"
+        "  bp add --fetch=030000:030077\n"
+        "  bp add --memwr=1234 --count=100\n"
+        "  bp add --fetch=loop --if=ac3==177\n"
+        "  bp log memlog.txt\n"
+        "  bp add --memwr=freelist --log\n"
+        "  bp list\n"
+        "\n";
+
+    static const struct option options[] = {
+        {"help",  no_argument,       0, 0},  // 0
+        {"fetch", required_argument, 0, 0},  // 1
+        {"mem",   required_argument, 0, 0},  // 2
+        {"memrd", required_argument, 0, 0},  // 3
+        {"memwr", required_argument, 0, 0},  // 4
+        {"io",    required_argument, 0, 0},  // 5
+        {"iord",  required_argument, 0, 0},  // 6
+        {"iowr",  required_argument, 0, 0},  // 7
+        {"count", required_argument, 0, 0},  // 8
+        {"if",    required_argument, 0, 0},  // 9
+        {"log",   no_argument,       0, 0},  // 10
+        {0,       0,                 0, 0},  // 11
+    };
+
+    //
+    // Break condition for options 1 through 7
+    //
+
+    static const brkpt_t::type_t types[] = {
+        brkpt_t::typeFETCH,
+        brkpt_t::typeMEM,
+        brkpt_t::typeMEMRD,
+        brkpt_t::typeMEMWR,
+        brkpt_t::typeIO,
+        brkpt_t::typeIORD,
+        brkpt_t::typeIOWR,
+    };
+
+    if ((argc == 1) || (strncasecmp(argv[1], "--help", 4) == 0)) {
+        printf(usage);
+        return true;
+    }
+
+    //
+    // getopt_long() moves the command behind the options
+    //
+
+    const char *cmd = argv[1];
+
+    brkpt_t::type_t type = brkpt_t::typeFETCH;
+    const char *range = NULL;
+    uint64_t count = 1;
+    bool log = false;
+    brkpt_t::cond_t cond;
+    cond.cmp = brkpt_t::cmpNONE;
+
+    opterr = 0;
+    for (;;) {
+        int index = 0;
+        int ret = getopt_long(argc, argv, "", options, &index);
+        if (ret == -1) {
+            break;
+        } else if (ret == '?') {
+            printf("bp: unrecognized option \"%s\"\n\n%s", argv[optind-1], usage);
+            return true;
+        } else {
+            switch (index) {
+                case 0:
+                    printf(usage);
+                    return true;
+                case 1 ... 7:
+                    if (range != NULL) {
+                        printf("bp: only one break condition is allowed\n");
+                        return true;
+                    }
+                    type  = types[index - 1];
+                    range = optarg;
+                    break;
+                case 8:
+                    count = strtoull(optarg, NULL, 10);
+                    break;
+                case 9:
+                    if (!brkpt_t::parseCond(optarg, cond)) {
+                        printf("bp: invalid condition \"%s\"\n", optarg);
+                        return true;
+                    }
+                    break;
+                case 10:
+                    log = true;
+                    break;
+            }
+        }
+    }
+
+    const char *arg = (optind + 1 < argc) ? argv[optind + 1] : NULL;
+
+    if (strncasecmp(cmd, "add", 3) == 0) {
+        if (range == NULL) {
+            printf("bp: missing break condition\n");
+            return true;
+        }
+        bool io = (type == brkpt_t::typeIO) || (type == brkpt_t::typeIORD) || (type == brkpt_t::typeIOWR);
+        ks10_t::addr_t lo;
+        ks10_t::addr_t hi;
+        if (!parseRange(range, io ? ks10_t::ioAddrMask : ks10_t::memAddrMask, lo, hi)) {
+            return true;
+        }
+        int id = bp.add(type, lo, hi, count, cond, log);
+        if (id < 0) {
+            printf("bp: too many breakpoints\n");
+        } else {
+            printf("KS10: Breakpoint %d added.\n", id);
+        }
+    } else if (strncasecmp(cmd, "delete", 3) == 0) {
+        if (arg == NULL) {
+            printf("bp: missing breakpoint number\n");
+        } else if (strncasecmp(arg, "all", 3) == 0) {
+            bp.clear();
+            printf("KS10: All breakpoints deleted.\n");
+        } else if (!bp.remove(strtoul(arg, NULL, 10))) {
+            printf("bp: breakpoint %s does not exist\n", arg);
+        }
+    } else if ((strncasecmp(cmd, "enable", 2) == 0) || (strncasecmp(cmd, "disable", 3) == 0)) {
+        if (arg == NULL) {
+            printf("bp: missing breakpoint number\n");
+        } else if (!bp.enable(strtoul(arg, NULL, 10), toupper(cmd[0]) == 'E')) {
+            printf("bp: breakpoint %s does not exist\n", arg);
+        }
+    } else if (strncasecmp(cmd, "list", 2) == 0) {
+        bp.list();
+    } else if (strncasecmp(cmd, "reset", 3) == 0) {
+        bp.reset();
+        printf("KS10: Breakpoint hit counts zeroed.\n");
+    } else if (strncasecmp(cmd, "log", 3) == 0) {
+        if (bp.logTo(arg)) {
+            printf("KS10: Breakpoints log to %s.\n", arg ? arg : "the console");
+        }
+    } else {
+        printf("bp: unrecognized command\n");
+    }
+
+    return true;
+}
+
 //!
 //! \brief
 //!    Dump BRAR or BRMR
@@ -1385,6 +1734,108 @@ bool command_t::cmdDA(int argc, char *argv[]) {
 
 }
 
+//!
+//! \brief
+//!    Bridge the DUP11 to the host
+//!
+//! \param [in] argc
+//!    Number of arguments.
+//!
+//! \param [in] argv
+//!    Array of pointers to the argument.
+//!
+//! \returns
+//!    True if the interpreter should print a prompt after completion;
+//!    otherwise false.
+//!
+
+static bool cmdDUP_BRIDGE(int argc, char *argv[]) {
+
+    static const char *usage =
+        "\n"
+        "The \"du bridge\" command moves synchronous line data between the DUP11\n"
+        "FIFOs and the host. Each frame that the DUP11 transmits is sent as one\n"
+        "UDP datagram or TAP frame. Frames received from the host are written to\n"
+        "the DUP11 receiver preceded by SYN characters.\n"
+        "\n"
+        "Usage: du bridge [option]\n"
+        "\n"
+        "Valid options are:\n"
+        "   [--help]                    Print help.\n"
+        "   [--loop]                    Loop transmitted frames back to the receiver\n"
+        "                               without a network.\n"
+        "   [--udp=lport:host:rport]    Bridge to a UDP peer.\n"
+        "   [--tap=ifname]              Bridge to a TAP device.\n"
+        "   [--gap=usecs]               Transmitter idle time that ends a frame.\n"
+        "                               The default is 2000 microseconds.\n"
+        "   [--stat[us]]                Print frames/second and FIFO stalls.\n"
+        "   [--stop]                    Stop the bridge.\n"
+        "\n";
+
+    static const struct option options[] = {
+        {"help",   no_argument,       0, 0},  // 0
+        {"loop",   no_argument,       0, 0},  // 1
+        {"udp",    required_argument, 0, 0},  // 2
+        {"tap",    required_argument, 0, 0},  // 3
+        {"gap",    required_argument, 0, 0},  // 4
+        {"stat",   no_argument,       0, 0},  // 5
+        {"status", no_argument,       0, 0},  // 6
+        {"stop",   no_argument,       0, 0},  // 7
+        {0,        0,                 0, 0},  // 8
+    };
+
+    int mode = -1;
+    const char *arg = NULL;
+    unsigned int gap = 2000;
+
+    opterr = 0;
+    for (;;) {
+        int index = 0;
+        int ret = getopt_long(argc, argv, "", options, &index);
+        if (ret == -1) {
+            break;
+        } else if (ret == '?') {
+            printf("du bridge: unrecognized option \"%s\"\n\n%s", argv[optind-1], usage);
+            return true;
+        } else {
+            switch (index) {
+                case 0:
+                    printf(usage);
+                    return true;
+                case 1:
+                    mode = dup11_t::bridgeLOOP;
+                    break;
+                case 2:
+                    mode = dup11_t::bridgeUDP;
+                    arg  = optarg;
+                    break;
+                case 3:
+                    mode = dup11_t::bridgeTAP;
+                    arg  = optarg;
+                    break;
+                case 4:
+                    gap = strtoul(optarg, NULL, 0);
+                    break;
+                case 5:
+                case 6:
+                    dp.bridgeStat();
+                    return true;
+                case 7:
+                    dp.bridgeStop();
+                    return true;
+            }
+        }
+    }
+
+    if (mode < 0) {
+        printf("du bridge: one of --loop, --udp, or --tap is required\n\n%s", usage);
+        return true;
+    }
+
+    dp.bridgeStart(mode, arg, gap);
+    return true;
+}
+
 //!
 //! \brief
 //!    Configure DUP11
@@ -1612,11 +2063,13 @@ bool command_t::cmdDUP(int argc, char *argv[]) {
         "Usage: dup [--help] [<command [<args>]]\n"
         "\n"
         "The dup command are:\n"
+        "  bridge    Bridge the DUP11 to a UDP socket or TAP device\n"
         "  conf[ig]  Configure the DUP11 device\n"
-        "  dump      Dump DUP registers\n"
+        "  dump      Dump DUP registers (--script prints name=value lines)\n"
         "  stat[us]  Dump DUO registers\n"
         "\n"
         "See also:\n"
+        "  du bridge --help\n"
         "  du conf --help\n"
        "\n";
 
@@ -1635,10 +2088,12 @@ bool command_t::cmdDUP(int argc, char *argv[]) {
 
     if (strncasecmp(argv[1], "--help", 4) == 0) {
         printf(usageTop);
+    } else if (strncasecmp(argv[1], "bridge", 4) == 0) {
+        cmdDUP_BRIDGE(argc, argv);
     } else if (strncasecmp(argv[1], "conf", 4) == 0) {
         cmdDUP_CONF(argc, argv);
     } else if (strncasecmp(argv[1], "dump", 4) == 0) {
-        dp.dumpRegs();
+        dp.dumpRegs(argc > 2 && strncasecmp(argv[2], "--script", 4) == 0);
     } else if (strncasecmp(argv[1], "stat", 4) == 0) {
         dp.dumpRegs();
     } else {
@@ -1650,7 +2105,7 @@ bool command_t::cmdDUP(int argc, char *argv[]) {
 
 //!
 //! \brief
-//!    Configure DZ11
+//!    Bridge DZ11 lines to the host
 //!
 //! \param [in] argc
 //!    Number of arguments.
@@ -1663,32 +2118,140 @@ bool command_t::cmdDUP(int argc, char *argv[]) {
 //!    otherwise false.
 //!
 
-static bool cmdDZ_CONF(int argc, char *argv[]) {
-
-    uint32_t dzccr = ks10_t::readDZCCR();
+static bool cmdDZ_BRIDGE(int argc, char *argv[]) {
 
     static const char *usage =
         "\n"
-        "The \"dz config\" command configures and displays the configuration the\n"
-        "DZ11.\n"
+        "The \"dz bridge\" command connects DZ11 lines to host PTYs or to Unix\n"
+        "sockets so that terminals on the DZ11 can be used from the console\n"
+        "processor. The console drives the DZ11 in place of the KS10, so the\n"
+        "KS10 does not see the host PTYs and the bridge only runs while the\n"
+        "KS10 is halted. The bridge stops when the KS10 is started.\n"
         "\n"
-        "Usage: dz config [option]\n"
+        "Usage: dz bridge [option]\n"
         "\n"
         "Valid options are:\n"
         "   [--help]                    Print help.\n"
-        "   [--line=linenum]            Set line number.\n"
-        "   [--co={t[rue]} | {f[alse}]  Set Carrier Sense state for the selected\n"
-        "                               line number.\n"
-        "   [--dtr={t[rue]} | {f[alse}] Set Data Terminal Ready state for the\n"
-        "                               selected line number.\n"
-        "   [--ri={t[rue]} | {f[alse}]  Set Ring Indication state for the\n"
-        "                               selected line number.\n"
+        "   [--lines=mask]              Bit mask of lines to bridge. The default\n"
+        "                               is 0xff (all lines).\n"
+        "   [--baud=rate]               Line speed. The default is 9600.\n"
+        "   [--sock[et]=dir]            Create Unix sockets named dz0-dz7 in dir\n"
+        "                               instead of PTYs.\n"
+        "   [--stat[us]]                Print characters/second for each line.\n"
+        "   [--stop]                    Stop the bridge.\n"
         "\n"
         "Examples:\n"
         "\n"
-        "  dz config (with no options)\n"
+        "  dz bridge --lines=0x03 --baud=19200\n"
         "\n"
-        "    Prints the DZ configuration.\n"
+        "    Bridges lines 0 and 1 to PTYs at 19200 baud.\n"
+        "\n";
+
+    static const struct option options[] = {
+        {"help",   no_argument,       0, 0},  // 0
+        {"lines",  required_argument, 0, 0},  // 1
+        {"baud",   required_argument, 0, 0},  // 2
+        {"sock",   required_argument, 0, 0},  // 3
+        {"socket", required_argument, 0, 0},  // 4
+        {"stat",   no_argument,       0, 0},  // 5
+        {"status", no_argument,       0, 0},  // 6
+        {"stop",   no_argument,       0, 0},  // 7
+        {0,        0,                 0, 0},  // 8
+    };
+
+    unsigned int mask = 0xff;
+    unsigned int baud = 9600;
+    const char *sockdir = NULL;
+
+    opterr = 0;
+    for (;;) {
+        int index = 0;
+        int ret = getopt_long(argc, argv, "", options, &index);
+        if (ret == -1) {
+            break;
+        } else if (ret == '?') {
+            printf("dz bridge: unrecognized option \"%s\"\n\n%s", argv[optind-1], usage);
+            return true;
+        } else {
+            switch (index) {
+                case 0:
+                    printf(usage);
+                    return true;
+                case 1:
+                    mask = strtoul(optarg, NULL, 0);
+                    if ((mask == 0) || (mask > 0xff)) {
+                        printf("dz bridge: parameter out of range \'--%s=%s\'\n", options[index].name, optarg);
+                        return true;
+                    }
+                    break;
+                case 2:
+                    baud = strtoul(optarg, NULL, 0);
+                    break;
+                case 3:
+                case 4:
+                    sockdir = optarg;
+                    break;
+                case 5:
+                case 6:
+                    dz.bridgeStat();
+                    return true;
+                case 7:
+                    dz.bridgeStop();
+                    return true;
+            }
+        }
+    }
+
+    if (!ks10_t::halt()) {
+        printf("KS10: CPU is running. Halt it first.\n");
+        return true;
+    }
+
+    dz.bridgeStart(mask, baud, sockdir);
+    return true;
+}
+
+//!
+//! \brief
+//!    Configure DZ11
+//!
+//! \param [in] argc
+//!    Number of arguments.
+//!
+//! \param [in] argv
+//!    Array of pointers to the argument.
+//!
+//! \returns
+//!    True if the interpreter should print a prompt after completion;
+//!    otherwise false.
+//!
+
+static bool cmdDZ_CONF(int argc, char *argv[]) {
+
+    uint32_t dzccr = ks10_t::readDZCCR();
+
+    static const char *usage =
+        "\n"
+        "The \"dz config\" command configures and displays the configuration the\n"
+        "DZ11.\n"
+        "\n"
+        "Usage: dz config [option]\n"
+        "\n"
+        "Valid options are:\n"
+        "   [--help]                    Print help.\n"
+        "   [--line=linenum]            Set line number.\n"
+        "   [--co={t[rue]} | {f[alse}]  Set Carrier Sense state for the selected\n"
+        "                               line number.\n"
+        "   [--dtr={t[rue]} | {f[alse}] Set Data Terminal Ready state for the\n"
+        "                               selected line number.\n"
+        "   [--ri={t[rue]} | {f[alse}]  Set Ring Indication state for the\n"
+        "                               selected line number.\n"
+        "\n"
+        "Examples:\n"
+        "\n"
+        "  dz config (with no options)\n"
+        "\n"
+        "    Prints the DZ configuration.\n"
         "\n"
         "  dz config --line=0 --ri=true --line=2 --co=false\n"
         "\n"
@@ -1826,6 +2389,15 @@ static bool cmdDZ_TEST(int argc, char *argv[]) {
         "                    characters received on the selected serial port back to the\n"
         "                    associated serial port. Type ^C on the TTY to exit. Valid\n"
         "                    values of port is 0-7.\n"
+        "   [--soak]         Soak test. All selected lines transmit pseudo-random data\n"
+        "                    concurrently with the transmitters looped back to the\n"
+        "                    receivers. Reports throughput, lost characters, overruns\n"
+        "                    and latency. The modem controls are also checked.\n"
+        "   [--baud=rate[,rate...]]\n"
+        "                    Soak test baud rate for each line. The last rate is used\n"
+        "                    for the remaining lines. The default is 9600.\n"
+        "   [--lines=mask]   Soak test line mask. The default is 0xff (all lines).\n"
+        "   [--count=n]      Soak test characters per line. The default is 10000.\n"
         "\n";
 
     static const struct option options[] = {
@@ -1834,9 +2406,18 @@ static bool cmdDZ_TEST(int argc, char *argv[]) {
         {"echo",  required_argument, 0, 0},  // 2
         {"rx",    required_argument, 0, 0},  // 3
         {"tx",    required_argument, 0, 0},  // 4
-        {0,       0,                 0, 0},  // 5
+        {"soak",  no_argument,       0, 0},  // 5
+        {"baud",  required_argument, 0, 0},  // 6
+        {"lines", required_argument, 0, 0},  // 7
+        {"count", required_argument, 0, 0},  // 8
+        {0,       0,                 0, 0},  // 9
     };
 
+    bool soak = false;
+    unsigned int mask = 0xff;
+    unsigned int count = 10000;
+    unsigned int baud[8] = {9600, 9600, 9600, 9600, 9600, 9600, 9600, 9600};
+
     //
     // No argument
     //
@@ -1846,6 +2427,11 @@ static bool cmdDZ_TEST(int argc, char *argv[]) {
         return true;
     }
 
+    if (dz.bridgeActive()) {
+        printf("KS10: DZ11 bridge is running. Stop it first.\n");
+        return true;
+    }
+
     //
     // Process command line
     //
@@ -1886,10 +2472,47 @@ static bool cmdDZ_TEST(int argc, char *argv[]) {
                         printf("dz test tx: port arguments out of range\n");
                     }
                     return true;
+                case 5:
+                    soak = true;
+                    break;
+                case 6:
+                    {
+                        char *s = optarg;
+                        for (unsigned int line = 0; line < 8; line++) {
+                            baud[line] = strtoul(s, &s, 0);
+                            if (*s == ',') {
+                                s++;
+                            } else {
+                                for (unsigned int i = line + 1; i < 8; i++) {
+                                    baud[i] = baud[line];
+                                }
+                                break;
+                            }
+                        }
+                    }
+                    break;
+                case 7:
+                    mask = strtoul(optarg, NULL, 0);
+                    if ((mask == 0) || (mask > 0xff)) {
+                        printf("dz test: parameter out of range \'--%s=%s\'\n", options[index].name, optarg);
+                        return true;
+                    }
+                    break;
+                case 8:
+                    count = strtoul(optarg, NULL, 0);
+                    break;
             }
         }
     }
 
+    if (soak) {
+        if (!ks10_t::halt()) {
+            printf("KS10: CPU is running. Halt it first.\n");
+            return true;
+        }
+        dz.testSOAK(mask, baud, count);
+    }
+
     return true;
 }
 
@@ -1920,12 +2543,14 @@ bool command_t::cmdDZ(int argc, char *argv[]) {
         "Usage: dz [--help] <command> [<args>]\n"
         "\n"
         "The dz command are:\n"
+        "  bridge    Bridge DZ lines to host PTYs or sockets\n"
         "  conf[ig]  Configure the DZ11 device\n"
-        "  dump      Dump DZ registers\n"
+        "  dump      Dump DZ registers (--script prints name=value lines)\n"
         "  test      Test DZ functionality\n"
         "  stat[us]  Dump DZ registers\n"
         "\n"
         "See also:\n"
+        "  dz bridge --help\n"
         "  dz conf --help\n"
         "  dz test --help\n"
        "\n";
@@ -1942,10 +2567,12 @@ bool command_t::cmdDZ(int argc, char *argv[]) {
     if (strncasecmp(argv[1], "--help", 4) == 0) {
         printf(usageTop);
         return true;
+    } else if (strncasecmp(argv[1], "bridge", 4) == 0) {
+        return cmdDZ_BRIDGE(argc, argv);
     } else if (strncasecmp(argv[1], "conf", 4) == 0) {
         return cmdDZ_CONF(argc, argv);
     } else if (strncasecmp(argv[1], "dump", 4) == 0) {
-        dz.dumpRegs();
+        dz.dumpRegs(argc > 2 && strncasecmp(argv[2], "--script", 4) == 0);
     } else if (strncasecmp(argv[1], "stat", 4) == 0) {
         dz.dumpRegs();
     } else if (strncasecmp(argv[1], "test", 4) == 0) {
@@ -1957,6 +2584,82 @@ bool command_t::cmdDZ(int argc, char *argv[]) {
     return true;
 }
 
+//!
+//! \brief
+//!    KMC11 Microprocessor
+//!
+//!    The <b>KM</b> (KMC11) command loads, controls, and samples the KMC11
+//!    microprocessor.
+//!
+//! \param [in] argc
+//!    Number of arguments.
+//!
+//! \param [in] argv
+//!    Array of pointers to the arguments.
+//!
+//! \returns
+//!    True if the interpreter should print a prompt after completion;
+//!    otherwise false.
+//!
+
+bool command_t::cmdKM(int argc, char *argv[]) {
+
+    const char *usageTop =
+        "\n"
+        "The \"km\" command provides an interface to load, control, and sample the\n"
+        "KMC11 microprocessor.\n"
+        "\n"
+        "Usage: km [--help] <command> [<args>]\n"
+        "\n"
+        "The km commands are:\n"
+        "  load file   Load the KMC11 Control RAM with microcode. The file may be\n"
+        "              a binary image of little-endian words or a text file with\n"
+        "              one octal word (or octal address/word) per line.\n"
+        "  start       Master clear and start the KMC11\n"
+        "  stop        Stop the KMC11\n"
+        "  step        Single step the KMC11 microprocessor\n"
+        "  dump        Dump KMC11 registers\n"
+        "  stat[us] [msec]\n"
+        "              Sample the KMC11 for msec milliseconds (default 1000) and\n"
+        "              report the time running and the rate of DMC/DMR port\n"
+        "              handshakes with the KS10.\n"
+        "\n";
+
+    if ((argc == 1) || (strncasecmp(argv[1], "--help", 4) == 0)) {
+        printf(usageTop);
+        return true;
+    }
+
+    if (strncasecmp(argv[1], "load", 4) == 0) {
+        if (argc != 3) {
+            printf("km load: missing filename\n");
+        } else if (!ks10_t::halt()) {
+            printf("KS10: CPU is running. Halt it first.\n");
+        } else {
+            km.loadCRAM(argv[2]);
+        }
+    } else if (strncasecmp(argv[1], "start", 4) == 0) {
+        km.start();
+    } else if (strncasecmp(argv[1], "stop", 4) == 0) {
+        km.stop();
+    } else if (strncasecmp(argv[1], "step", 4) == 0) {
+        km.step();
+    } else if (strncasecmp(argv[1], "dump", 4) == 0) {
+        km.dumpRegs();
+    } else if (strncasecmp(argv[1], "stat", 4) == 0) {
+        unsigned int msec = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1000;
+        if (msec == 0) {
+            printf("km stat: the sample period must be at least 1 msec\n");
+        } else {
+            km.sample(msec);
+        }
+    } else {
+        printf("km: unrecognized command\n");
+    }
+
+    return true;
+}
+
 //!
 //! \brief
 //!    Execute the next instruction
@@ -2436,6 +3139,7 @@ bool command_t::cmdHE(int, char *[]) {
         "\n"
         "   !: bang - escape to sub-shell or execute sub-program\n"
         "   ?: help - print summary of all commands\n"
+        "  bp: breakpoint manager\n"
         "  br: breakpoint\n"
         "  ce: cache enable\n"
         "  cl: clear screen\n"
@@ -2448,18 +3152,22 @@ bool command_t::cmdHE(int, char *[]) {
         "  ha: halt the KS10 processor\n"
         "  he: print summary of all commands\n"
         "  hs: print halt status word\n"
+        "  km: kmc11 (microprocessor) interface\n"
         "  lp: lp20 (line printer) interface\n"
         "  mr: master reset\n"
         "  mt: mt (magtape) interface\n"
+        "  pr: pc sampling profiler\n"
         "  qu: quit the console and exit\n"
         "  rd: read memory, IO, and registers\n"
         "  rp: rp (disk) interface\n"
         "  si: single step instruction(s)\n"
         "  sh: shutdown monitor\n"
         "  st: start program execution at address\n"
+        "  sy: symbol table\n"
         "  te: system timer enable\n"
         "  tp: system traps enable\n"
         "  tr: trace buffer control\n"
+        "  ub: unibus exerciser (bandwidth and interrupt tests)\n"
         "  wr: write to memory and IO\n"
         "  zm: zero memory\n"
         "\n"
@@ -2577,11 +3285,20 @@ bool command_t::cmdHS(int argc, char *argv[]) {
         "\n"
         "The \"hs\" command prints the contents of the \"Halt Status Block\".\n"
         "\n"
-        "usage: hs [--help]\n"
+        "usage: hs [--help] [--history]\n"
+        "\n"
+        "Valid options are:\n"
+        "\n"
+        "  [--help]     Print help.\n"
+        "  [--history]  Print the halt cause, PC, HR, FLG, and VMA of the most\n"
+        "               recent halts, newest first.  The halt status is captured\n"
+        "               every time the KS10 halts.  Breakpoint halts that are\n"
+        "               continued automatically are not kept.\n"
         "\n";
 
     static const struct option options[] = {
         {"help",    no_argument, 0, 0},  // 0
+        {"history", no_argument, 0, 0},  // 1
         {0,         0,           0, 0},  // 2
     };
 
@@ -2601,6 +3318,24 @@ bool command_t::cmdHS(int argc, char *argv[]) {
         } else if (index == 0) {
             printf(usage);
             return true;
+        } else if (index == 1) {
+            ks10_t::hsb_t hsb[ks10_t::numHalts];
+            unsigned int num = ks10_t::haltHistory(hsb, ks10_t::numHalts);
+            if (num == 0) {
+                printf("KS10: No halts have been recorded.\n");
+                return true;
+            }
+            printf("  Time            PC      HR            FLG           VMA           Cause\n");
+            for (unsigned int i = 0; i < num; i++) {
+                struct tm tm;
+                char buf[16];
+                localtime_r(&hsb[i].time.tv_sec, &tm);
+                strftime(buf, sizeof(buf), "%H:%M:%S", &tm);
+                printf("  %s.%03ld  %06llo  %012llo  %012llo  %012llo  %s\n",
+                       buf, hsb[i].time.tv_nsec / 1000000, hsb[i].hswPC,
+                       hsb[i].hr, hsb[i].flg, hsb[i].vma, ks10_t::haltCause(hsb[i].hsw));
+            }
+            return true;
         }
    }
 
@@ -2874,10 +3609,22 @@ bool command_t::cmdLP(int argc, char *argv[]) {
         "\n"
         "The lp commands are:\n"
         "  break          Breakpoint on LP IO accesses\n"
+        "  capture <dir>  Render print jobs to files in <dir> instead of printing\n"
+        "  capture off    Send print jobs to the printer\n"
+        "  capture        Show the capture status and recent jobs\n"
         "  config <args>  Configure the LP\n"
-        "  dump           Dump the LP registers\n"
-        "  print  <args>  Print a file to LP\n"
+        "  dump           Dump the LP registers (--script prints name=value lines)\n"
+        "  print  <args>  Queue one or more files to print on the LP\n"
+        "  queue          List the print queue\n"
+        "  ram    <file>  Load a translation RAM image (binary or octal text)\n"
         "  test           Print test message to LP\n"
+        "  vfu    <file>  Load a DAVFU image (TOPS-10 .VFU format)\n"
+        "\n"
+        "The RAM and DAVFU images are loaded before the next print job and are\n"
+        "kept across jobs.  Only changes are rewritten.\n"
+        "\n"
+        "Print jobs DMA through KS10 memory, so the KS10 must be halted to print.\n"
+        "A job stops if the KS10 is started.  Captured jobs do not use the KS10.\n"
         "\n";
 
     if (argc < 2) {
@@ -2890,20 +3637,43 @@ bool command_t::cmdLP(int argc, char *argv[]) {
         printf(usageTop);
     } else if (strncasecmp(argv[1], "break", 4) == 0) {
         cmdLP_BREAK();
+    } else if (strncasecmp(argv[1], "capture", 3) == 0) {
+        if (argc < 3) {
+            lp.captureStat();
+        } else if (strcasecmp(argv[2], "off") == 0) {
+            lp.captureStop();
+        } else {
+            lp.captureStart(argv[2]);
+        }
     } else if (strncasecmp(argv[1], "stat", 4) == 0) {
         lp.dumpRegs();
     } else if (strncasecmp(argv[1], "conf", 4) == 0) {
         cmdLP_CONFIG(argc, argv);
     } else if (strncasecmp(argv[1], "dump", 4) == 0) {
-        lp.dumpRegs();
+        lp.dumpRegs(argc > 2 && strncasecmp(argv[2], "--script", 4) == 0);
     } else if (strncasecmp(argv[1], "print", 4) == 0) {
         if (argc < 3) {
             printf("lp print: missing argument\n");
-        } if (argc >= 3) {
-            lp.printFile(argv[2]);
+        }
+        for (int i = 2; i < argc; i++) {
+            lp.printFile(argv[i]);
+        }
+    } else if (strncasecmp(argv[1], "queue", 4) == 0) {
+        lp.printQueue();
+    } else if (strncasecmp(argv[1], "ram", 3) == 0) {
+        if (argc != 3) {
+            printf("lp ram: missing argument\n");
+        } else {
+            lp.loadRAM(argv[2]);
         }
     } else if (strncasecmp(argv[1], "test", 3) == 0) {
         lp.testRegs();
+    } else if (strncasecmp(argv[1], "vfu", 3) == 0) {
+        if (argc != 3) {
+            printf("lp vfu: missing argument\n");
+        } else {
+            lp.loadVFU(argv[2]);
+        }
     } else {
         printf("lp: unrecognized argument\n");
     }
@@ -3704,6 +4474,7 @@ bool cmdMT_DUMP(int argc, char *argv[]) {
         "                    support 8 Tape Drives. For now only Unit 0 is implemented.\n"
         "                    Any non-zero argument will generate an error message.\n"
         "                    The default Unit is 0.\n"
+        "   [--script]       Print the registers as name=value lines.\n"
         "\n";
 
     static const struct option options[] = {
@@ -3711,7 +4482,8 @@ bool cmdMT_DUMP(int argc, char *argv[]) {
         {"tcu",     required_argument, 0, 0},  // 1
         {"slave",   required_argument, 0, 0},  // 2
         {"unit",    required_argument, 0, 0},  // 3
-        {0,         0,                 0, 0},  // 4
+        {"script",  no_argument,       0, 0},  // 4
+        {0,         0,                 0, 0},  // 5
     };
 
     //
@@ -3720,6 +4492,7 @@ bool cmdMT_DUMP(int argc, char *argv[]) {
 
     uint32_t tcu =  0;
     uint32_t unit = 0;
+    bool script = false;
     opterr = 0;
 
     for (;;) {
@@ -3745,11 +4518,15 @@ bool cmdMT_DUMP(int argc, char *argv[]) {
                     // unit switch
                     PARSE_UNIT("dump", false);
                     break;
+                case 4:
+                    // script switch
+                    script = true;
+                    break;
             }
         }
     }
 
-    mt.dumpRegs(tcu, mt_cfg.drive[unit].param);
+    mt.dumpRegs(tcu, mt_cfg.drive[unit].param, script);
     return true;
 }
 
@@ -4073,6 +4850,11 @@ bool cmdMT_REWIND(int argc, char *argv[]) {
         "                    support 8 Tape Drives. For now only Unit 0 is implemented.\n"
         "                    Any non-zero argument will generate an error message.\n"
         "                    The default Unit is 0.\n"
+        "   [--nowait]       Return to the console prompt immediately. A message is\n"
+        "                    printed when the rewind completes. Other mt commands\n"
+        "                    are refused until then.\n"
+        "   [--timeout=secs] Set the rewind timeout in seconds. The default is 420\n"
+        "                    seconds (7 minutes).\n"
         "\n";
 
     static const struct option options[] = {
@@ -4080,7 +4862,9 @@ bool cmdMT_REWIND(int argc, char *argv[]) {
         {"tcu",     required_argument, 0, 0},  // 1
         {"slave",   required_argument, 0, 0},  // 2
         {"unit",    required_argument, 0, 0},  // 3
-        {0,         0,           0, 0},  // 1
+        {"nowait",  no_argument, 0, 0},  // 4
+        {"timeout", required_argument, 0, 0},  // 5
+        {0,         0,           0, 0},  // 6
     };
 
     //
@@ -4089,6 +4873,7 @@ bool cmdMT_REWIND(int argc, char *argv[]) {
 
     uint32_t tcu = 0;
     uint32_t unit = 0;
+    bool nowait = false;
     opterr = 0;
 
     for (;;) {
@@ -4114,12 +4899,31 @@ bool cmdMT_REWIND(int argc, char *argv[]) {
                     // unit switch
                     PARSE_UNIT("rewind", false);
                     break;
+                case 4:
+                    // nowait switch
+                    nowait = true;
+                    break;
+                case 5:
+                    // timeout switch
+                    if (isdigit(optarg[0])) {
+                        unsigned int temp = strtoul(optarg, NULL, 0);
+                        if (temp != 0) {
+                            mt.setRewindTimeout(temp * 1000);
+                        } else {
+                            printf("mt rewind: parameter out of range \'--%s=%s\'\n", options[index].name, optarg);
+                            return true;
+                        }
+                    } else {
+                        printf("mt rewind: unrecognized option \'--%s=%s\'\n", options[index].name, optarg);
+                        return true;
+                    }
+                    break;
 
             }
         }
     }
 
-    mt.cmdRewind(tcu, mt_cfg.drive[unit].param);
+    mt.cmdRewind(tcu, mt_cfg.drive[unit].param, nowait);
 
     return true;
 }
@@ -4667,7 +5471,19 @@ bool command_t::cmdMT(int argc, char *argv[]) {
     if (strncasecmp(argv[1], "--help", 4) == 0) {
         printf(usage);
         return true;
-    } else if (strncasecmp(argv[1], "boot", 3) == 0) {
+    }
+
+    //
+    // A rewind that was started with --nowait is polled with the TCU and
+    // slave left selected.  Every other command changes the selection.
+    //
+
+    if (mt.rewindBusy()) {
+        printf("mt: a rewind is in progress. Try again when it completes.\n");
+        return true;
+    }
+
+    if (strncasecmp(argv[1], "boot", 3) == 0) {
         return cmdMT_BOOT(argc, argv);
     } else if (strncasecmp(argv[1], "debug", 3) == 0) {
         return cmdMT_DEBUG(argc, argv);
@@ -4700,60 +5516,81 @@ bool command_t::cmdMT(int argc, char *argv[]) {
 
 //!
 //! \brief
-//!    Quit
-//!
-//! \returns
-//!    True if the interpreter should print a prompt after completion;
-//!    otherwise false.
-//!
-
-bool command_t::cmdQU(int /*argc*/, char */*argv*/[]) {
-
-    struct termios ctrl;
-    tcgetattr(STDIN_FILENO, &ctrl);
-    ctrl.c_lflag |= (ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &ctrl);
-
-    exit(EXIT_SUCCESS);
-}
-
-//!
-//! \brief
-//!    Memory Read
+//!    PC Sampling Profiler
 //!
 //! \details
-//!    This function peforms memory reads.
+//!    The <b>PR</b> command samples the KS10 PC while programs run and
+//!    reports where the time is spent.
 //!
 //! \param [in] argc
 //!    Number of arguments.
 //!
 //! \param [in] argv
-//!    Array of pointers to the argument.
+//!    Array of pointers to the arguments.
 //!
 //! \returns
 //!    True if the interpreter should print a prompt after completion;
 //!    otherwise false.
 //!
 
-bool command_t::cmdRD(int argc, char *argv[]) {
+bool command_t::cmdPR(int argc, char *argv[]) {
 
-    const char *usage =
+    static const char *usage =
         "\n"
-        "The \"rd\" command reads from memory, Unibus IO, APR IO, and ACs.\n"
+        "The \"pr\" command is a statistical profiler.  It samples the KS10 PC at a\n"
+        "fixed rate on a background thread while the KS10 runs and builds\n"
+        "histograms of the samples by PC and by page.  The reports are by symbol\n"
+        "when symbols have been loaded with the \"sy\" command.\n"
         "\n"
-        "Usage: rd [--help] <ac <reg>> | <io addr> | <mem addr <length>> | aprid |\n"
-        "          apr | pi |ubr | ebr | spb | csb | cstm | pur | tim | int | hsb | pc\n"
+        "The sampled PC does not include the user/exec mode, so user and monitor\n"
+        "samples at the same PC are counted together.\n"
+        "\n"
+        "Usage: pr [--help] <command> [options] [file]\n"
+        "\n"
+        "The pr commands are:\n"
+        "  start          Start sampling.  The histograms are kept from any\n"
+        "                 previous run so runs can be combined.\n"
+        "  stop           Stop sampling and print the statistics.\n"
+        "  stat           Print the sample rate and the sampling overhead.\n"
+        "  clear          Clear the histograms.\n"
+        "  report [file]  Print a flat profile, or write it to a file.\n"
+        "  folded file    Write the samples as folded stacks for flame graph\n"
+        "                 tools.  The stacks are \"page;symbol count\".\n"
+        "\n"
+        "Valid options are:\n"
+        "   [--help]                    Print help.\n"
+        "   [--rate=n]                  Samples per second.  The default is 1000.\n"
+        "   [--top=n]                   Number of lines in each table of the flat\n"
+        "                               profile.  The default is 20.\n"
+        "\n"
+        "Examples:\n"
+        "\n"
+        "  pr start --rate=2000\n"
+        "  pr report --top=40\n"
+        "  pr folded tops20.folded\n"
         "\n";
 
     static const struct option options[] = {
-        {"help",  no_argument, 0, 0},  // 0
-        {0,       0,           0, 0},  // 1
+        {"help",  no_argument,       0, 0},  // 0
+        {"rate",  required_argument, 0, 0},  // 1
+        {"top",   required_argument, 0, 0},  // 2
+        {0,       0,                 0, 0},  // 3
     };
 
+    if ((argc == 1) || (strncasecmp(argv[1], "--help", 4) == 0)) {
+        printf(usage);
+        return true;
+    }
+
     //
-    // Process command line
+    // getopt_long() moves the command behind the options
     //
 
+    const char *cmd = argv[1];
+
+    unsigned int rate = 1000;
+    unsigned int top  = 20;
+
     opterr = 0;
     for (;;) {
         int index = 0;
@@ -4761,20 +5598,148 @@ bool command_t::cmdRD(int argc, char *argv[]) {
         if (ret == -1) {
             break;
         } else if (ret == '?') {
-            printf("rd: unrecognized option: %s\n", argv[optind-1]);
-            return true;
-        } else if (index == 0) {
-            printf(usage);
+            printf("pr: unrecognized option \"%s\"\n\n%s", argv[optind-1], usage);
             return true;
+        } else {
+            switch (index) {
+                case 0:
+                    printf(usage);
+                    return true;
+                case 1:
+                    rate = strtoul(optarg, NULL, 0);
+                    break;
+                case 2:
+                    top = strtoul(optarg, NULL, 0);
+                    break;
+            }
         }
     }
 
-    if (!ks10_t::halt()) {
-        printf("KS10: CPU is running. Halt it first.\n");
-        return true;
-    }
+    //
+    // The command is the first argument that is left.  A file name may
+    // follow it.  The commands are compared as whole words because "start",
+    // "stop", and "stat" share their first characters.
+    //
 
-    if (strncasecmp(argv[1], "aprid", 5) == 0) {
+    const char *file = (optind + 1 < argc) ? argv[optind + 1] : NULL;
+
+    if (strcasecmp(cmd, "start") == 0) {
+        prof.start(rate);
+    } else if (strcasecmp(cmd, "stop") == 0) {
+        prof.stop();
+        prof.stat();
+    } else if (strcasecmp(cmd, "stat") == 0) {
+        prof.stat();
+    } else if (strcasecmp(cmd, "clear") == 0) {
+        prof.clear();
+        printf("KS10: Profiler histograms cleared.\n");
+    } else if (strcasecmp(cmd, "report") == 0) {
+        if (file == NULL) {
+            prof.flat(stdout, symtab, top);
+        } else {
+            FILE *fp = fopen(file, "w");
+            if (fp == NULL) {
+                printf("KS10: Unable to open file \"%s\". %s\n", file, strerror(errno));
+                return true;
+            }
+            prof.flat(fp, symtab, top);
+            fclose(fp);
+            printf("KS10: Wrote flat profile to \"%s\".\n", file);
+        }
+    } else if (strcasecmp(cmd, "folded") == 0) {
+        if (file == NULL) {
+            printf("pr: missing file name\n");
+            return true;
+        }
+        prof.folded(file, symtab);
+    } else {
+        printf("pr: unrecognized command\n");
+    }
+
+    return true;
+}
+
+//!
+//! \brief
+//!    Quit
+//!
+//! \returns
+//!    True if the interpreter should print a prompt after completion;
+//!    otherwise false.
+//!
+
+bool command_t::cmdQU(int /*argc*/, char */*argv*/[]) {
+
+    struct termios ctrl;
+    tcgetattr(STDIN_FILENO, &ctrl);
+    ctrl.c_lflag |= (ICANON | ECHO);
+    tcsetattr(STDIN_FILENO, TCSANOW, &ctrl);
+
+    exit(EXIT_SUCCESS);
+}
+
+//!
+//! \brief
+//!    Memory Read
+//!
+//! \details
+//!    This function peforms memory reads.
+//!
+//! \param [in] argc
+//!    Number of arguments.
+//!
+//! \param [in] argv
+//!    Array of pointers to the argument.
+//!
+//! \returns
+//!    True if the interpreter should print a prompt after completion;
+//!    otherwise false.
+//!
+
+bool command_t::cmdRD(int argc, char *argv[]) {
+
+    const char *usage =
+        "\n"
+        "The \"rd\" command reads from memory, Unibus IO, APR IO, and ACs.\n"
+        "\n"
+        "Usage: rd [--help] <ac <reg>> | <io addr> | <mem addr <length>> | aprid |\n"
+        "          apr | pi |ubr | ebr | spb | csb | cstm | pur | tim | int | hsb | pc |\n"
+        "          all\n"
+        "\n"
+        "\"rd all\" reads the PC, IR, ACs, and all of the processor registers in one\n"
+        "sequence.\n"
+        "\n";
+
+    static const struct option options[] = {
+        {"help",  no_argument, 0, 0},  // 0
+        {0,       0,           0, 0},  // 1
+    };
+
+    //
+    // Process command line
+    //
+
+    opterr = 0;
+    for (;;) {
+        int index = 0;
+        int ret = getopt_long(argc, argv, "", options, &index);
+        if (ret == -1) {
+            break;
+        } else if (ret == '?') {
+            printf("rd: unrecognized option: %s\n", argv[optind-1]);
+            return true;
+        } else if (index == 0) {
+            printf(usage);
+            return true;
+        }
+    }
+
+    if (!ks10_t::halt()) {
+        printf("KS10: CPU is running. Halt it first.\n");
+        return true;
+    }
+
+    if (strncasecmp(argv[1], "aprid", 5) == 0) {
         ks10_t::data_t data = ks10_t::rdAPRID();
         printf("KS10: APRID  : %012llo\n"
                "      INHCST : %llo\n"
@@ -4828,10 +5793,29 @@ bool command_t::cmdRD(int argc, char *argv[]) {
         printf("KS10: HSB is %012llo\n", ks10_t::rdHSB());
     } else if (strncasecmp(argv[1], "pc", 2) == 0) {
         printPCIR(ks10_t::readPCIR());
+    } else if (strncasecmp(argv[1], "all", 3) == 0) {
+        ks10_t::snapshot_t snap;
+        ks10_t::snapshot(snap);
+        printPCIR(snap.pcir);
+        printf("KS10: APRID is %012llo     APR  is %012llo\n"
+               "      PI    is %012llo     UBR  is %012llo\n"
+               "      EBR   is %012llo     SPB  is %012llo\n"
+               "      CSB   is %012llo     CSTM is %012llo\n"
+               "      PUR   is %012llo     TIM  is %012llo %012llo\n"
+               "      INT   is %012llo     HSB  is %012llo\n",
+               snap.aprid, snap.apr, snap.pi, snap.ubr, snap.ebr, snap.spb,
+               snap.csb, snap.cstm, snap.pur, snap.tim[0], snap.tim[1],
+               snap.intrvl, snap.hsb);
+        for (unsigned int i = 0; i < 020; i += 4) {
+            printf("%02o: %012llo %012llo %012llo %012llo\n", i,
+                   snap.ac[i], snap.ac[i+1], snap.ac[i+2], snap.ac[i+3]);
+        }
     } else if (strncasecmp(argv[1], "ac", 2) == 0) {
         if (argc == 2) {
+            ks10_t::snapshot_t snap;
+            ks10_t::snapshot(snap, false);
             for (unsigned int i = 0; i < 020; i++) {
-                printf("%02o: %012llo\n", i, ks10_t::readAC(i));
+                printf("%02o: %012llo\n", i, snap.ac[i]);
             }
         } else if (argc == 3) {
             unsigned int regAC = parseOctal(argv[2]);
@@ -4850,7 +5834,9 @@ bool command_t::cmdRD(int argc, char *argv[]) {
             if (ks10_t::nxmnxd()) {
                 printf("rd mem: memory access failed with NXM\n");
             } else {
-                printf("%06llo: %012llo\n", addr, data);
+                printf("%06llo: %012llo", addr, data);
+                printSymbols(addr, data, false);
+                printf("\n");
             }
         } else if (argc == 4) {
             ks10_t::addr_t addr = parseOctal(argv[2]);
@@ -4860,7 +5846,9 @@ bool command_t::cmdRD(int argc, char *argv[]) {
                 if (ks10_t::nxmnxd()) {
                     printf("rd mem: memory access failed with NXM\n");
                 } else {
-                    printf("%06llo: %012llo\n", addr, data);
+                    printf("%06llo: %012llo", addr, data);
+                    printSymbols(addr, data, false);
+                    printf("\n");
                 }
                 addr++;
             }
@@ -4912,6 +5900,13 @@ static bool cmdRP_BOOT(int argc, char *argv[]) {
         "Valid options are:\n"
         "\n"
         "   [--help]          Print help.\n"
+        "   [--cache]         Boot using the boot cache. If the disk serial number and\n"
+        "                     the Home Block are unchanged, the cached Pre-Boot is\n"
+        "                     started without reading the FE File and Pre-Boot pages.\n"
+        "                     Otherwise the disk is booted normally and the cache is\n"
+        "                     updated. Use --flush after rewriting the front-end\n"
+        "                     files. The cache is kept in /var/cache/ks10/rpboot.cache.\n"
+        "   [--flush]         Flush the boot cache and exit. Do not boot.\n"
         "   [--base=addr]     Set the base address of the RH11. The default value of\n"
         "                     0776700 is the only correct base address for the disks.\n"
         "                     Don\'t change this unless you know what you are doing.\n"
@@ -4934,7 +5929,9 @@ static bool cmdRP_BOOT(int argc, char *argv[]) {
         {"diag",        no_argument,       0, 0},  // 5
         {"diagnostic",  no_argument,       0, 0},  // 6
         {"diagnostics", no_argument,       0, 0},  // 7
-        {0,             0,                 0, 0},  // 8
+        {"cache",       no_argument,       0, 0},  // 8
+        {"flush",       no_argument,       0, 0},  // 9
+        {0,             0,                 0, 0},  // 10
     };
 
     if (argc < 2) {
@@ -4946,6 +5943,7 @@ static bool cmdRP_BOOT(int argc, char *argv[]) {
     // Process command line
     //
 
+    bool cache = false;
     ks10_t::addr_t temp = 0;
     opterr = 0;
     for (;;) {
@@ -5003,6 +6001,12 @@ static bool cmdRP_BOOT(int argc, char *argv[]) {
                 case 7:
                     rp_cfg.bootdiag = true;
                     break;
+                case 8:
+                    cache = true;
+                    break;
+                case 9:
+                    rp_t::flushCache();
+                    return true;
             }
         }
     }
@@ -5035,7 +6039,7 @@ static bool cmdRP_BOOT(int argc, char *argv[]) {
     // Boot from disk using the selected boot image
     //
 
-    rp.boot(rp_cfg.unit, rp_cfg.bootdiag);
+    rp.boot(rp_cfg.unit, rp_cfg.bootdiag, cache);
 
     return true;
 }
@@ -5088,6 +6092,9 @@ static bool cmdRP_CONF(int argc, char *argv[]) {
         "                    Disk Drive.\n"
         "   [--unit=unit]    Disk Drive selection. This parameter must be provided.\n"
         "                    See example below.\n"
+        "   [--timeout=ms]   Set the RH11 command completion timeout in milliseconds.\n"
+        "                    This setting applies to all Disk Drives. The default is\n"
+        "                    100 milliseconds.\n"
         "\n"
         "Example:\n"
         "\n"
@@ -5107,7 +6114,8 @@ static bool cmdRP_CONF(int argc, char *argv[]) {
         {"online",  required_argument, 0, 0},   // 5
         {"wrl",     required_argument, 0, 0},   // 6
         {"wprot",   required_argument, 0, 0},   // 7
-        {0,         0,                 0, 0},   // 8
+        {"timeout", required_argument, 0, 0},   // 8
+        {0,         0,                 0, 0},   // 9
     };
 
     //
@@ -5213,6 +6221,19 @@ static bool cmdRP_CONF(int argc, char *argv[]) {
                         return true;
                     }
                     break;
+                case 8:
+                    // conf timeout switch
+                    if (isdigit(optarg[0])) {
+                        unsigned int temp = strtoul(optarg, NULL, 0);
+                        if (temp != 0) {
+                            rp.setTimeout(temp);
+                        } else {
+                            printf("rp: parameter out of range \'--%s=%s\'\n", options[index].name, optarg);
+                        }
+                    } else {
+                        printf("rp: unrecognized option \'--%s=%s\'\n", options[index].name, optarg);
+                    }
+                    break;
             }
         }
     }
@@ -5220,6 +6241,138 @@ static bool cmdRP_CONF(int argc, char *argv[]) {
     return true;
 }
 
+//!
+//! \brief
+//!    Dump, restore, or verify an RP disk image
+//!
+//! \param [in] argc
+//!    Number of arguments.
+//!
+//! \param [in] argv
+//!    Array of pointers to the argument.
+//!
+//! \returns
+//!    True if the interpreter should print a prompt after completion;
+//!    otherwise false.
+//!
+
+static bool cmdRP_IMAGE(int argc, char *argv[]) {
+
+    static const char *usage =
+        "\n"
+        "The \"rp dump\", \"rp restore\", and \"rp verify\" commands copy a disk pack\n"
+        "to or from a SIMH format disk image file on the console file system.\n"
+        "\n"
+        "Usage: rp dump    [--help] <options> filename\n"
+        "       rp restore [--help] <options> filename\n"
+        "       rp verify  [--help] <options> filename\n"
+        "\n"
+        "Valid options are:\n"
+        "\n"
+        "   [--help]          Print help.\n"
+        "   [--start=cyl]     Start at the specified cylinder. This is used to resume\n"
+        "                     a transfer that was interrupted. The default is 0.\n"
+        "   [--unit=unit]     Set the disk unit. The default is the boot unit.\n"
+        "   [--verify]        Write check each block after it is restored.\n"
+        "\n"
+        "Two pages of the console staging area in KS10 memory are used for the disk\n"
+        "buffers. The KS10 must be halted.\n"
+        "\n";
+
+    static const struct option options[] = {
+        {"help",   no_argument,       0, 0},  // 0
+        {"start",  required_argument, 0, 0},  // 1
+        {"unit",   required_argument, 0, 0},  // 2
+        {"verify", no_argument,       0, 0},  // 3
+        {0,        0,                 0, 0},  // 4
+    };
+
+    //
+    // Process command line
+    //
+
+    unsigned int unit  = rp_cfg.unit;
+    unsigned int start = 0;
+    bool verify = false;
+    opterr = 0;
+    for (;;) {
+        int index = 0;
+        int ret = getopt_long(argc, argv, "", options, &index);
+        if (ret == -1) {
+            break;
+        } else if (ret == '?') {
+            printf("rp %s: unrecognized option: %s\n", argv[1], argv[optind-1]);
+            return true;
+        } else {
+            switch (index) {
+                case 0:
+                    // help switch
+                    printf(usage);
+                    return true;
+                case 1:
+                    // start switch
+                    if (isdigit(optarg[0])) {
+                        start = strtoul(optarg, NULL, 0);
+                    } else {
+                        printf("rp %s: unrecognized option \'--%s=%s\'\n", argv[1], options[index].name, optarg);
+                        return true;
+                    }
+                    break;
+                case 2:
+                    // unit switch
+                    if (isdigit(optarg[0])) {
+                        unsigned int temp = strtoul(optarg, NULL, 0);
+                        if (temp <= 7) {
+                            unit = temp;
+                        } else {
+                            printf("rp %s: parameter out of range \'--%s=%s\'\n", argv[1], options[index].name, optarg);
+                            return true;
+                        }
+                    } else {
+                        printf("rp %s: unrecognized option \'--%s=%s\'\n", argv[1], options[index].name, optarg);
+                        return true;
+                    }
+                    break;
+                case 3:
+                    // verify switch
+                    verify = true;
+                    break;
+            }
+        }
+    }
+
+    //
+    // The non-option arguments are the sub-command and the filename
+    //
+
+    if (argc - optind != 2) {
+        if (optind < argc) {
+            printf("rp %s: a single filename is required\n", argv[optind]);
+        } else {
+            printf("rp: a single filename is required\n");
+        }
+        return true;
+    }
+
+    const char *cmd      = argv[optind];
+    const char *filename = argv[optind + 1];
+
+    if (!ks10_t::halt()) {
+        printf("KS10: CPU is running. Halt it first.\n");
+        return true;
+    }
+
+    if (strncasecmp(cmd, "dump", 4) == 0) {
+        rp.dumpImage(unit, filename, start);
+    } else if (strncasecmp(cmd, "rest", 4) == 0) {
+        rp.restoreImage(unit, filename, start, verify);
+    } else {
+        rp.verifyImage(unit, filename, start);
+    }
+
+    return true;
+}
+
 //!
 //! \brief
 //!    Print RP Status
@@ -5247,13 +6400,17 @@ static bool cmdRP_STAT(int argc, char *argv[]) {
         "The rp stat commands are:\n"
         "   [--help]      Print help.\n"
         "   [--sum[mary]] Print summary only.\n"
+        "   [--hist]      Print the RH11 completion latency histogram.\n"
+        "   [--clear]     Clear the RH11 completion latency histogram.\n"
         "\n";
 
     static const struct option options[] = {
         {"help",    no_argument, 0, 0},  // 0
         {"sum",     no_argument, 0, 0},  // 1
         {"summary", no_argument, 0, 0},  // 2
-        {0,         0,           0, 0},  // 3
+        {"hist",    no_argument, 0, 0},  // 3
+        {"clear",   no_argument, 0, 0},  // 4
+        {0,         0,           0, 0},  // 5
     };
 
     //
@@ -5261,6 +6418,8 @@ static bool cmdRP_STAT(int argc, char *argv[]) {
     //
 
     bool summary = false;
+    bool hist    = false;
+    bool clear   = false;
     opterr = 0;
 
     for (;;) {
@@ -5282,10 +6441,28 @@ static bool cmdRP_STAT(int argc, char *argv[]) {
                     // summary
                     summary = true;
                     break;
+                case 3:
+                    // hist
+                    hist = true;
+                    break;
+                case 4:
+                    // clear
+                    clear = true;
+                    break;
             }
         }
     }
 
+    if (hist || clear) {
+        if (hist) {
+            rhpoll_t::printHistogram();
+        }
+        if (clear) {
+            rhpoll_t::clearHistogram();
+        }
+        return true;
+    }
+
     if (summary) {
         uint64_t rpdebug = ks10_t::getRPDEBUG();
         if (rpdebug >> 56 == ks10_t::rpIDLE) {
@@ -5330,6 +6507,11 @@ static bool cmdRP_TEST(int argc, char *argv[]) {
         "\n"
         "The rp test commands are:\n"
         "   [--help]   Print help.\n"
+        "   [--bench]  Measure IOPS, MB/s, and latency. The write test only writes\n"
+        "              to the maintenance cylinders (809-814). The options are:\n"
+        "                [--count=n]     Operations per test. The default is 1000.\n"
+        "                [--csv=file]    Save the results in CSV format.\n"
+        "                [--json=file]   Save the results in JSON format.\n"
         "   [--dump]   Dump registers\n"
         "   [--fifo]   Test RH11 FIFO (aka SILO)\n"
         "   [--init]   Test RH11 and RP initialization\n"
@@ -5340,15 +6522,19 @@ static bool cmdRP_TEST(int argc, char *argv[]) {
         "\n";
 
     static const struct option options[] = {
-        {"help",  no_argument, 0, 0},  // 0
-        {"dump",  no_argument, 0, 0},  // 1
-        {"fifo",  no_argument, 0, 0},  // 2
-        {"init",  no_argument, 0, 0},  // 3
-        {"reset", no_argument, 0, 0},  // 4
-        {"read",  no_argument, 0, 0},  // 5
-        {"write", no_argument, 0, 0},  // 6
-        {"wrchk", no_argument, 0, 0},  // 7
-        {0,       0,           0, 0},  // 8
+        {"help",  no_argument,       0, 0},  // 0
+        {"dump",  no_argument,       0, 0},  // 1
+        {"fifo",  no_argument,       0, 0},  // 2
+        {"init",  no_argument,       0, 0},  // 3
+        {"reset", no_argument,       0, 0},  // 4
+        {"read",  no_argument,       0, 0},  // 5
+        {"write", no_argument,       0, 0},  // 6
+        {"wrchk", no_argument,       0, 0},  // 7
+        {"bench", no_argument,       0, 0},  // 8
+        {"count", required_argument, 0, 0},  // 9
+        {"csv",   required_argument, 0, 0},  // 10
+        {"json",  required_argument, 0, 0},  // 11
+        {0,       0,                 0, 0},  // 12
     };
 
     if (argc == 2) {
@@ -5360,6 +6546,11 @@ static bool cmdRP_TEST(int argc, char *argv[]) {
     // Process command line
     //
 
+    bool bench = false;
+    unsigned int count = 1000;
+    const char *csvfile = NULL;
+    const char *jsonfile = NULL;
+
     opterr = 0;
     for (;;) {
         int index = 0;
@@ -5395,9 +6586,30 @@ static bool cmdRP_TEST(int argc, char *argv[]) {
                 case 7:
                     rp.testWrchk(rp_cfg.unit);
                     break;
+                case 8:
+                    bench = true;
+                    break;
+                case 9:
+                    count = strtoul(optarg, NULL, 0);
+                    break;
+                case 10:
+                    csvfile = optarg;
+                    break;
+                case 11:
+                    jsonfile = optarg;
+                    break;
             }
         }
     }
+
+    if (bench) {
+        if (!ks10_t::halt()) {
+            printf("KS10: CPU is running. Halt it first.\n");
+            return true;
+        }
+        rp.testBench(rp_cfg.unit, count, csvfile, jsonfile);
+    }
+
     return true;
 }
 
@@ -5430,16 +6642,20 @@ bool command_t::cmdRP(int argc, char *argv[]) {
         "Usage: rp [--help] <command> [<args>]\n"
         "\n"
         "The rp commands are:\n"
-        "  boot   Boot from RP devices\n"
-        "  conf   Configure RP devices\n"
-        "  dump   Dump RP related registers\n"
-        "  reset  Reset the RP hardware\n"
-        "  stat   Print RP status\n"
-        "  test   Test RP functionality\n"
+        "  boot     Boot from RP devices\n"
+        "  conf     Configure RP devices\n"
+        "  dump     Dump RP related registers, or dump a disk to a file.\n"
+        "           \"rp dump --script\" prints the registers as name=value lines.\n"
+        "  reset    Reset the RP hardware\n"
+        "  restore  Restore a disk from a file\n"
+        "  stat     Print RP status\n"
+        "  test     Test RP functionality\n"
+        "  verify   Compare a disk to a file\n"
         "\n"
         "See also:\n"
         "  rp boot --help\n"
         "  rp conf --help\n"
+        "  rp dump --help\n"
         "  rp test --help\n"
         "\n";
 
@@ -5460,14 +6676,23 @@ bool command_t::cmdRP(int argc, char *argv[]) {
     } else if (strncasecmp(argv[1], "conf", 4) == 0) {
         return cmdRP_CONF(argc, argv);
     } else if (strncasecmp(argv[1], "dump", 4) == 0) {
-        rp.dumpRegs();
-        printf("RPCCR = 0x%08x\n", ks10_t::readRPCCR());
+        if (argc == 2) {
+            rp.dumpRegs();
+        } else if (argc == 3 && strncasecmp(argv[2], "--script", 4) == 0) {
+            rp.dumpRegs(true);
+        } else {
+            return cmdRP_IMAGE(argc, argv);
+        }
     } else if (strncasecmp(argv[1], "reset", 4) == 0) {
         rp.clear();
+    } else if (strncasecmp(argv[1], "restore", 4) == 0) {
+        return cmdRP_IMAGE(argc, argv);
     } else if (strncasecmp(argv[1], "stat", 4) == 0) {
         cmdRP_STAT(argc, argv);
     } else if (strncasecmp(argv[1], "test", 4) == 0) {
         return cmdRP_TEST(argc, argv);
+    } else if (strncasecmp(argv[1], "verify", 4) == 0) {
+        return cmdRP_IMAGE(argc, argv);
     } else {
         printf("rp: unrecognized option \'%s\'\n", argv[1]);
     }
@@ -5482,6 +6707,10 @@ bool command_t::cmdRP(int argc, char *argv[]) {
 //! \details
 //!    The <b>SI</b> (Step Instruction) single steps the KS10 CPU.
 //!
+//!    Multiple steps are executed in a loop that only reads the PCIR after
+//!    each step.  The PCIRs are saved in a buffer and printed or logged
+//!    after the loop so that the output does not slow down the stepping.
+//!
 //! \sa cmdHA, cmdCO
 //!
 //! \param [in] argc
@@ -5499,14 +6728,62 @@ bool command_t::cmdSI(int argc, char *argv[]) {
         "\n"
         "The command \"si\" single steps the KS10.\n"
         "\n"
-        "Usage: si [--help] [step count]\n"
+        "Usage: si [--help] [options] [step count]\n"
+        "\n"
+        "The step count is octal.  The default is one step.\n"
+        "\n"
+        "Valid options are:\n"
+        "\n"
+        "  [--help]        Print help.\n"
+        "  [--count=n]     Step n instructions.  n is decimal.\n"
+        "  [--quiet]       Do not print the instructions.\n"
+        "  [--log=file]    Write the instructions to a file instead of the console.\n"
+        "  [--acs]         Also record the ACs that each instruction changes.  This\n"
+        "                  reads all of the ACs after every step and is much slower.\n"
+        "  [--pc=range]    Stop after stepping an instruction in the address range.\n"
+        "                  A range is \"addr\" or \"first:last\".\n"
+        "  [--op=op[,op]]  Stop after stepping an instruction with one of the octal\n"
+        "                  opcodes.\n"
+        "\n"
+        "Examples:\n"
+        "\n"
+        "  si --count=100000 --quiet --pc=030000\n"
+        "  si --count=5000 --log=trace.txt --acs --op=254,104\n"
         "\n";
 
     static const struct option options[] = {
-        {"help",    no_argument, 0, 0},  // 0
-        {0,         0,           0, 0},  // 1
+        {"help",  no_argument,       0, 0},  // 0
+        {"count", required_argument, 0, 0},  // 1
+        {"quiet", no_argument,       0, 0},  // 2
+        {"log",   required_argument, 0, 0},  // 3
+        {"acs",   no_argument,       0, 0},  // 4
+        {"pc",    required_argument, 0, 0},  // 5
+        {"op",    required_argument, 0, 0},  // 6
+        {0,       0,                 0, 0},  // 7
     };
 
+    //
+    // AC change record
+    //
+
+    struct acChange_t {
+        unsigned int step;                      // Step number
+        unsigned int ac;                        // AC number
+        ks10_t::data_t data;                    // New contents
+    };
+
+    static const unsigned int maxOps = 8;
+
+    unsigned int num = 0;
+    bool quiet = false;
+    bool acs = false;
+    const char *logName = NULL;
+    bool stopPC = false;
+    ks10_t::addr_t pcLo = 0;
+    ks10_t::addr_t pcHi = 0;
+    unsigned int ops[maxOps];
+    unsigned int numOps = 0;
+
     //
     // Process command line
     //
@@ -5520,28 +6797,225 @@ bool command_t::cmdSI(int argc, char *argv[]) {
         } else if (ret == '?') {
             printf("si: unrecognized option: %s\n", argv[optind-1]);
             return true;
-        } else if (index == 0) {
-            printf(usage);
-            return true;
-        }
-    }
-
-    if (argc == 1) {
-        ks10_t::startSTEP();
-        printPCIR(ks10_t::readPCIR());
-        printf("si: single stepped\n");
-    } else if (argc >= 2) {
-        unsigned int num = parseOctal(argv[1]);
-        for (unsigned int i = 0; i < num; i++) {
-            ks10_t::startSTEP();
-            printPCIR(ks10_t::readPCIR());
+        } else {
+            switch (index) {
+                case 0:
+                    printf(usage);
+                    return true;
+                case 1:
+                    num = strtoul(optarg, NULL, 10);
+                    break;
+                case 2:
+                    quiet = true;
+                    break;
+                case 3:
+                    logName = optarg;
+                    break;
+                case 4:
+                    acs = true;
+                    break;
+                case 5:
+                    if (!parseRange(optarg, ks10_t::maxVirtAddr, pcLo, pcHi)) {
+                        return true;
+                    }
+                    stopPC = true;
+                    break;
+                case 6:
+                    for (const char *p = optarg; *p != 0; ) {
+                        char *end;
+                        unsigned int op = strtoul(p, &end, 8);
+                        if ((end == p) || (op > 0777) || (numOps == maxOps)) {
+                            printf("si: invalid opcode list \"%s\"\n", optarg);
+                            return true;
+                        }
+                        ops[numOps++] = op;
+                        p = (*end == ',') ? end + 1 : end;
+                    }
+                    break;
+            }
         }
-        printf("si: single stepped %d instructions\n", num);
-        if (argc >= 3) {
+    }
+
+    if (optind < argc) {
+        num = parseOctal(argv[optind]);
+        if (optind + 1 < argc) {
             printf("si: additional arguments ignored\n");
         }
     }
 
+    if (!ks10_t::halt()) {
+        printf("KS10: CPU is running. Halt it first.\n");
+        return true;
+    }
+
+    //
+    // Single step with the original output
+    //
+
+    if ((num <= 1) && !quiet && !logName && !acs && !stopPC && (numOps == 0)) {
+        ks10_t::data_t pcir;
+        ks10_t::step(pcir);
+        printPCIR(pcir);
+        printf("si: single stepped\n");
+        return true;
+    }
+
+    if (num == 0) {
+        num = 1;
+    }
+
+    FILE *fp = stdout;
+    if (logName != NULL) {
+        fp = fopen(logName, "w");
+        if (fp == NULL) {
+            printf("si: unable to open \"%s\": %s\n", logName, strerror(errno));
+            return true;
+        }
+    }
+
+    uint64_t *trace = new (std::nothrow) uint64_t[num];
+    if (trace == NULL) {
+        printf("si: unable to allocate a buffer for %u steps\n", num);
+        if (fp != stdout) {
+            fclose(fp);
+        }
+        return true;
+    }
+
+    acChange_t *changes = NULL;
+    unsigned int numChanges = 0;
+    unsigned int maxChanges = 0;
+    ks10_t::snapshot_t prev;
+    if (acs) {
+        ks10_t::snapshot(prev, false);
+    }
+
+    //
+    // Step loop
+    //
+    // Most of the loop time is spent with the FPGA mutex held.  A SIGINT
+    // must not longjmp out of the loop, so ^C only sets a flag that is
+    // checked once per step.
+    //
+
+    const char *reason = NULL;
+    unsigned int steps = 0;
+
+    struct timespec start;
+    struct timespec finish;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    sigInterrupt = 0;
+    sa.sa_handler = sigDeferHandler;
+    sigaction(SIGINT, &sa, NULL);
+
+    while (steps < num) {
+        if (sigInterrupt) {
+            reason = "it was interrupted";
+            break;
+        }
+        ks10_t::data_t pcir;
+        if (!ks10_t::step(pcir)) {
+            reason = "the KS10 did not halt after a step";
+            break;
+        }
+        trace[steps++] = pcir;
+
+        if (acs) {
+            ks10_t::snapshot_t snap;
+            ks10_t::snapshot(snap, false);
+            for (unsigned int i = 0; i < 020; i++) {
+                if (snap.ac[i] != prev.ac[i]) {
+                    if (numChanges == maxChanges) {
+                        unsigned int newMax = maxChanges ? maxChanges * 2 : 1024;
+                        acChange_t *temp = new (std::nothrow) acChange_t[newMax];
+                        if (temp == NULL) {
+                            reason = "the AC change buffer could not be grown";
+                            break;
+                        }
+                        for (unsigned int j = 0; j < numChanges; j++) {
+                            temp[j] = changes[j];
+                        }
+                        delete[] changes;
+                        changes = temp;
+                        maxChanges = newMax;
+                    }
+                    changes[numChanges].step = steps - 1;
+                    changes[numChanges].ac   = i;
+                    changes[numChanges].data = snap.ac[i];
+                    numChanges += 1;
+                }
+            }
+            prev = snap;
+            if (reason != NULL) {
+                break;
+            }
+        }
+
+        unsigned int pc = (pcir >> 36) & 0777777;
+        unsigned int op = (pcir >> 27) & 0777;
+        if (stopPC && (pc >= pcLo) && (pc <= pcHi)) {
+            reason = "PC matched";
+            break;
+        }
+        for (unsigned int i = 0; i < numOps; i++) {
+            if (op == ops[i]) {
+                reason = "opcode matched";
+                break;
+            }
+        }
+        if (reason != NULL) {
+            break;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    double secs = (finish.tv_sec - start.tv_sec) + (finish.tv_nsec - start.tv_nsec) / 1e9;
+
+    //
+    // Print or log the trace.  ^C stops the output but still frees the
+    // buffers and closes the log.
+    //
+
+    sigInterrupt = 0;
+    if (!quiet || (fp != stdout)) {
+        unsigned int change = 0;
+        for (unsigned int i = 0; (i < steps) && !sigInterrupt; i++) {
+            if (fp == stdout) {
+                printPCIR(trace[i]);
+            } else {
+                char buf[dasmLEN];
+                char sym[symtab_t::maxName + 16];
+                unsigned int pc = (trace[i] >> 36) & 0777777;
+                dasm(trace[i] & 0777777777777ULL, buf, sizeof(buf));
+                fprintf(fp, "%06o\t%s", pc, buf);
+                if (symtab.lookup(pc) >= 0) {
+                    fprintf(fp, "\t; %s", symtab.format(pc, sym, sizeof(sym)));
+                }
+                fprintf(fp, "\n");
+            }
+            while ((change < numChanges) && (changes[change].step == i)) {
+                fprintf(fp, "\t\tAC%02o=%012llo\n", changes[change].ac, changes[change].data);
+                change += 1;
+            }
+        }
+    }
+
+    if (fp != stdout) {
+        fclose(fp);
+    }
+    delete[] changes;
+    delete[] trace;
+
+    sa.sa_handler = sigHandler;
+    sigaction(SIGINT, &sa, NULL);
+
+    printf("si: stepped %u instructions in %.3f seconds (%.0f steps/sec)\n",
+           steps, secs, secs > 0 ? steps / secs : 0.0);
+    if (reason != NULL) {
+        printf("si: stopped because %s\n", reason);
+    }
+
     return true;
 }
 
@@ -5679,6 +7153,160 @@ bool command_t::cmdST(int argc, char *argv[]) {
     return true;
 }
 
+//!
+//! \brief
+//!    Symbol table
+//!
+//! \details
+//!    The <b>SY</b> command loads the symbols that are used by the "da",
+//!    "tr", "rd", and "pr" commands.
+//!
+//! \param [in] argc
+//!    Number of arguments.
+//!
+//! \param [in] argv
+//!    Array of pointers to the arguments.
+//!
+//! \returns
+//!    True if the interpreter should print a prompt after completion;
+//!    otherwise false.
+//!
+
+bool command_t::cmdSY(int argc, char *argv[]) {
+
+    static const char *usage =
+        "\n"
+        "The \"sy\" command loads a symbol table.  When symbols are loaded, the\n"
+        "\"da\", \"tr\", \"rd mem\", and \"rd pc\" commands print addresses as\n"
+        "symbol+offset and the \"pr\" profiler reports by symbol.\n"
+        "\n"
+        "Usage: sy [--help] <command> [options] [arg]\n"
+        "\n"
+        "The sy commands are:\n"
+        "  load file      Load the symbols from a file.  The format is selected\n"
+        "                 by the extension:\n"
+        "                   .SAV, .EXE  DDT symbol table (.JBSYM) of a program\n"
+        "                   .REL        Symbol blocks of a relocatable file\n"
+        "                   other       LINK map or MACRO listing symbol table,\n"
+        "                               or any file of \"name value\" lines\n"
+        "  clear          Discard all of the symbols.\n"
+        "  stat           Print the number of symbols.\n"
+        "  addr addr      Print an address as symbol+offset.\n"
+        "  value name     Print the value of a symbol.\n"
+        "\n"
+        "Valid options are:\n"
+        "   [--help]                    Print help.\n"
+        "   [--reloc=addr]              Add addr to relocatable symbols in .REL\n"
+        "                               files and listings.  The default is 0.\n"
+        "   [--cordmp]                  Binary files use the Core Dump packing.\n"
+        "                               The default is the ANSI packing of the\n"
+        "                               .SAV files that \"go\" loads.\n"
+        "   [--clear]                   Discard the symbols before loading.\n"
+        "\n"
+        "Examples:\n"
+        "\n"
+        "  sy load --clear diag/smddt.sav\n"
+        "  sy load tops10.map\n"
+        "  sy addr 1234\n"
+        "\n";
+
+    static const struct option options[] = {
+        {"help",   no_argument,       0, 0},  // 0
+        {"reloc",  required_argument, 0, 0},  // 1
+        {"cordmp", no_argument,       0, 0},  // 2
+        {"clear",  no_argument,       0, 0},  // 3
+        {0,        0,                 0, 0},  // 4
+    };
+
+    if ((argc == 1) || (strncasecmp(argv[1], "--help", 4) == 0)) {
+        printf(usage);
+        return true;
+    }
+
+    //
+    // getopt_long() moves the command behind the options
+    //
+
+    const char *cmd = argv[1];
+
+    uint32_t reloc = 0;
+    bool cordmp = false;
+    bool clear = false;
+
+    opterr = 0;
+    for (;;) {
+        int index = 0;
+        int ret = getopt_long(argc, argv, "", options, &index);
+        if (ret == -1) {
+            break;
+        } else if (ret == '?') {
+            printf("sy: unrecognized option \"%s\"\n\n%s", argv[optind-1], usage);
+            return true;
+        } else {
+            switch (index) {
+                case 0:
+                    printf(usage);
+                    return true;
+                case 1:
+                    reloc = strtoul(optarg, NULL, 8) & 0777777;
+                    break;
+                case 2:
+                    cordmp = true;
+                    break;
+                case 3:
+                    clear = true;
+                    break;
+            }
+        }
+    }
+
+    const char *arg = (optind + 1 < argc) ? argv[optind + 1] : NULL;
+
+    if (strncasecmp(cmd, "load", 3) == 0) {
+        if (arg == NULL) {
+            printf("sy: missing file name\n");
+            return true;
+        }
+        if (clear) {
+            symtab.clear();
+        }
+        symtab.load(arg, reloc, cordmp);
+    } else if (strncasecmp(cmd, "clear", 3) == 0) {
+        symtab.clear();
+        printf("KS10: Symbol table cleared.\n");
+    } else if (strncasecmp(cmd, "stat", 3) == 0) {
+        if (symtab.size() == 0) {
+            printf("KS10: No symbols are loaded.\n");
+        } else {
+            printf("KS10: %u symbols from %06o to %06o.\n", symtab.size(),
+                   symtab[0].value, symtab[symtab.size() - 1].value);
+        }
+    } else if (strncasecmp(cmd, "addr", 3) == 0) {
+        if (arg == NULL) {
+            printf("sy: missing address\n");
+            return true;
+        }
+        char buf[symtab_t::maxName + 16];
+        uint32_t addr = parseOctal(arg) & 0777777;
+        printf("%06o = %s\n", addr, symtab.format(addr, buf, sizeof(buf)));
+    } else if (strncasecmp(cmd, "value", 3) == 0) {
+        if (arg == NULL) {
+            printf("sy: missing symbol name\n");
+            return true;
+        }
+        int i = symtab.find(arg);
+        if (i < 0) {
+            printf("sy: symbol \"%s\" is not defined\n", arg);
+        } else {
+            printf("%s = %06o%s\n", symtab[i].name, symtab[i].value, symtab[i].global ? "" : " (local)");
+        }
+    } else {
+        printf("sy: unrecognized command\n");
+    }
+
+    return true;
+}
+
 //!
 //! \brief
 //!    Timer Enable
@@ -5893,6 +7521,26 @@ bool command_t::cmdTR(int argc, char *argv[]) {
         "  --size         Prints the trace buffer size. The trace buffer size is fixed\n"
         "                 when the FPGA is built. The maximum buffer size is only\n"
         "                 limited by the amount of memory available in the FPGA.\n"
+        "  --save=file    Drain the entire trace buffer to a binary file. Each entry\n"
+        "                 is 8 bytes (PC and IR). The entries are in execution order\n"
+        "                 only if the KS10 is halted. Use the \"trdump\" tool to\n"
+        "                 disassemble, filter, and histogram the file.\n"
+        "  --stream=dir   Continuously drain the trace buffer while the KS10 runs.\n"
+        "                 The trace is written to a ring of files named\n"
+        "                 dir/trace00.bin, dir/trace01.bin, ...\n"
+        "                 The trace buffer is a LIFO that the KS10 keeps pushing\n"
+        "                 while it is drained, so streamed entries are not in\n"
+        "                 execution order and the gap markers are only roughly\n"
+        "                 placed. A streamed trace is only useful for histograms.\n"
+        "  --files=n      Number of files in the stream ring. The default is 8.\n"
+        "  --entries=n    Number of entries in each stream file. The default is\n"
+        "                 1048576 (8 MB).\n"
+        "  --stop         Stop the trace stream and print the statistics.\n"
+        "  --stat         Print the trace stream statistics: the sustained entries\n"
+        "                 per second, the overflows, and the estimated fraction of\n"
+        "                 the instructions that were not captured. Entries that\n"
+        "                 are pushed while the console pops are dropped without\n"
+        "                 being counted, so the fraction is a lower bound.\n"
         "\n"
         "If the length is not provided, the default length is 32. If the length is\n"
         "provided the length can be given in decimal, octal, or hex. If the length is\n"
@@ -5902,18 +7550,27 @@ bool command_t::cmdTR(int argc, char *argv[]) {
         "tr               Prints the last 32 samples of trace buffer.\n"
         "tr 1024          Prints the last 1024 samples of the trace buffer is at least\n"
         "                 1024 entries in length.\n"
+        "tr --save=tr.bin Saves the trace buffer to \"tr.bin\".\n"
+        "tr --stream=/tmp/trace --files=4\n"
+        "                 Streams the trace to four files in /tmp/trace.\n"
         "\n"
         "I never remember the proper command to clear the trace buffer - so I added\n"
         "them all.\n";
 
     static const struct option options[] = {
-        {"help",  no_argument, 0, 0},  // 0
-        {"clr",   no_argument, 0, 1},  // 1
-        {"clear", no_argument, 0, 2},  // 2
-        {"reset", no_argument, 0, 3},  // 3
-        {"rst",   no_argument, 0, 4},  // 4
-        {"size",  no_argument, 0, 5},  // 5
-        {0,       0,           0, 6},  // 6
+        {"help",    no_argument,       0, 0},   // 0
+        {"clr",     no_argument,       0, 1},   // 1
+        {"clear",   no_argument,       0, 2},   // 2
+        {"reset",   no_argument,       0, 3},   // 3
+        {"rst",     no_argument,       0, 4},   // 4
+        {"size",    no_argument,       0, 5},   // 5
+        {"save",    required_argument, 0, 6},   // 6
+        {"stream",  required_argument, 0, 7},   // 7
+        {"files",   required_argument, 0, 8},   // 8
+        {"entries", required_argument, 0, 9},   // 9
+        {"stop",    no_argument,       0, 10},  // 10
+        {"stat",    no_argument,       0, 11},  // 11
+        {0,         0,                 0, 12},  // 12
     };
 
     static const char *header =
@@ -5921,14 +7578,14 @@ bool command_t::cmdTR(int argc, char *argv[]) {
         " Entry     PC      HI     LO    OPC AC I XR   EA  \n"
         "-------  ------  ------ ------  --- -- - -- ------\n";
 
-    static const uint64_t itrCLR   = 0x8000000000000000;
-//  static const uint64_t itrFULL  = 0x4000000000000000;
-    static const uint64_t itrEMPTY = 0x2000000000000000;
-
     //
     // Process command line
     //
 
+    const char *streamDir = NULL;
+    unsigned int streamFiles = 8;
+    uint64_t streamEntries = 1048576;
+
     opterr = 0;
     for (;;) {
         int index = 0;
@@ -5939,6 +7596,10 @@ bool command_t::cmdTR(int argc, char *argv[]) {
             printf("tr: unrecognized option: %s\n", argv[optind-1]);
             return true;
         } else {
+            if ((index >= 1) && (index <= 6) && tr.streaming()) {
+                printf("tr: the trace is being streamed. Use \"tr --stop\" first.\n");
+                return true;
+            }
             switch(index) {
                 case 0:
                     printf(usage);
@@ -5947,17 +7608,46 @@ bool command_t::cmdTR(int argc, char *argv[]) {
                 case 2:
                 case 3:
                 case 4:
-                    ks10_t::writeITR(itrCLR);
+                    ks10_t::writeITR(ks10_t::itrCLR);
                     printf("tr: trace buffer cleared\n");
                     return true;
                 case 5:
                     printf("tr: the trace buffer size is %d entries\n",
                            1 << (int)((ks10_t::readITR() >> 56) & 0x1f));
                     return true;
+                case 6:
+                    tr.save(optarg);
+                    return true;
+                case 7:
+                    streamDir = optarg;
+                    break;
+                case 8:
+                    streamFiles = strtoul(optarg, NULL, 0);
+                    break;
+                case 9:
+                    streamEntries = strtoull(optarg, NULL, 0);
+                    break;
+                case 10:
+                    tr.streamStop();
+                    tr.streamStat();
+                    return true;
+                case 11:
+                    tr.streamStat();
+                    return true;
             }
         }
     }
 
+    if (streamDir != NULL) {
+        tr.streamStart(streamDir, streamFiles, streamEntries);
+        return true;
+    }
+
+    if (tr.streaming()) {
+        printf("tr: the trace is being streamed. Use \"tr --stop\" first.\n");
+        return true;
+    }
+
     int num = 32;
     if (argc == 2) {
         num = strtoul(argv[1], NULL, 0);
@@ -5968,7 +7658,7 @@ bool command_t::cmdTR(int argc, char *argv[]) {
         uint64_t itr = ks10_t::readITR();
 //      printf("0x%016llx\n", itr);
         if (first) {
-            if (itr & itrEMPTY) {
+            if (itr & ks10_t::itrEMPTY) {
                 printf("tr: trace buffer is empty\n");
                 return true;
             } else {
@@ -5977,7 +7667,7 @@ bool command_t::cmdTR(int argc, char *argv[]) {
         } else {
             printf("%7d  ", -i);
             printPCIR(itr);
-            if ((itr & itrEMPTY) != 0) {
+            if ((itr & ks10_t::itrEMPTY) != 0) {
                 printf("tr: trace buffer is empty\n");
                 return true;
             }
@@ -5990,6 +7680,178 @@ bool command_t::cmdTR(int argc, char *argv[]) {
     return true;
 }
 
+//!
+//! \brief
+//!    Unibus Exerciser
+//!
+//! \details
+//!    The <b>UBE</b> command drives the Unibus Exercisers to measure DMA
+//!    bandwidth, interrupt request latency, and Unibus error rates.
+//!
+//! \param [in] argc
+//!    Number of arguments.
+//!
+//! \param [in] argv
+//!    Array of pointers to the arguments.
+//!
+//! \returns
+//!    True if the interpreter should print a prompt after completion;
+//!    otherwise false.
+//!
+
+bool command_t::cmdUBE(int argc, char *argv[]) {
+
+    static const char *usage =
+        "\n"
+        "The \"ube\" command drives the Unibus Exercisers (UBE) to measure Unibus\n"
+        "DMA bandwidth, interrupt request latency, and the UBA error (TMO and NXD)\n"
+        "rates.  The KS10 must be halted.\n"
+        "\n"
+        "Usage: ube [--help] <command> [option]\n"
+        "\n"
+        "The ube commands are:\n"
+        "  probe          List the exercisers that are present\n"
+        "  dump           Dump the exerciser registers\n"
+        "  read           NPR In (DMA read of KS10 memory) bandwidth test\n"
+        "  write          NPR Out (DMA write of KS10 memory) bandwidth test\n"
+        "  intr           Interrupt request test\n"
+        "\n"
+        "Valid options are:\n"
+        "   [--help]                    Print help.\n"
+        "   [--uba=n]                   IO Bridge with the exercisers.  The default\n"
+        "                               is 4.\n"
+        "   [--units=mask]              Bit mask of exercisers to use.  Bit 0 is\n"
+        "                               UBE1.  The default is all that are present.\n"
+        "   [--words=n]                 Words per exerciser per DMA.  The default is\n"
+        "                               1024.  All exercisers combined are limited\n"
+        "                               to 8192 words.\n"
+        "   [--count=n]                 Number of DMAs or interrupts per exerciser.\n"
+        "                               The default is 100.\n"
+        "   [--level=n]                 BR level (4-7) for the interrupt test.  The\n"
+        "                               default is 4.\n"
+        "   [--addr=addr]               KS10 memory used by the DMA tests.  It is\n"
+        "                               overwritten.  The default is a buffer in\n"
+        "                               the console staging area.\n"
+        "\n"
+        "Examples:\n"
+        "\n"
+        "  ube write --units=0x3 --words=4096 --count=1000\n"
+        "\n"
+        "    Runs UBE1 and UBE2 together writing 4096 words each, 1000 times.\n"
+        "\n";
+
+    static const struct option options[] = {
+        {"help",  no_argument,       0, 0},  // 0
+        {"uba",   required_argument, 0, 0},  // 1
+        {"units", required_argument, 0, 0},  // 2
+        {"words", required_argument, 0, 0},  // 3
+        {"count", required_argument, 0, 0},  // 4
+        {"level", required_argument, 0, 0},  // 5
+        {"addr",  required_argument, 0, 0},  // 6
+        {0,       0,                 0, 0},  // 7
+    };
+
+    if ((argc == 1) || (strncasecmp(argv[1], "--help", 4) == 0)) {
+        printf(usage);
+        return true;
+    }
+
+    //
+    // getopt_long() moves the command behind the options
+    //
+
+    const char *cmd = argv[1];
+
+    unsigned int ubaNUM = 4;
+    unsigned int units  = 0;
+    unsigned int words  = 1024;
+    unsigned int count  = 100;
+    unsigned int level  = 4;
+    ks10_t::addr_t addr = 0;
+
+    opterr = 0;
+    for (;;) {
+        int index = 0;
+        int ret = getopt_long(argc, argv, "", options, &index);
+        if (ret == -1) {
+            break;
+        } else if (ret == '?') {
+            printf("ube: unrecognized option \"%s\"\n\n%s", argv[optind-1], usage);
+            return true;
+        } else {
+            switch (index) {
+                case 0:
+                    printf(usage);
+                    return true;
+                case 1:
+                    ubaNUM = strtoul(optarg, NULL, 0);
+                    if ((ubaNUM < 1) || (ubaNUM > 4)) {
+                        printf("ube: parameter out of range \'--%s=%s\'\n", options[index].name, optarg);
+                        return true;
+                    }
+                    break;
+                case 2:
+                    units = strtoul(optarg, NULL, 0);
+                    break;
+                case 3:
+                    words = strtoul(optarg, NULL, 0);
+                    break;
+                case 4:
+                    count = strtoul(optarg, NULL, 0);
+                    break;
+                case 5:
+                    level = strtoul(optarg, NULL, 0);
+                    break;
+                case 6:
+                    addr = strtoul(optarg, NULL, 8);
+                    break;
+            }
+        }
+    }
+
+    if (!ks10_t::halt()) {
+        printf("KS10: CPU is running. Halt it first.\n");
+        return true;
+    }
+
+    ube_t ube((ubaNUM << 18) | (ube_t::baseADDR1 & 0777777));
+
+    unsigned int present = ube.probe();
+    if (units == 0) {
+        units = present;
+    }
+    if ((units & ~present) != 0) {
+        printf("ube: exerciser mask 0x%03x includes exercisers that are not present (0x%03x).\n", units, present);
+        return true;
+    }
+    if (units == 0) {
+        printf("KS10: No exercisers found on UBA%d.\n", ubaNUM);
+        return true;
+    }
+
+    if (strncasecmp(cmd, "probe", 4) == 0) {
+        printf("KS10: UBA%d exercisers:", ubaNUM);
+        for (unsigned int i = 0; i < ube_t::maxUBE; i++) {
+            if (present & (1 << i)) {
+                printf(" UBE%d", i + 1);
+            }
+        }
+        printf("\n");
+    } else if (strncasecmp(cmd, "dump", 4) == 0) {
+        ube.dumpRegs(units);
+    } else if (strncasecmp(cmd, "read", 4) == 0) {
+        ube.testDMA(units, false, words, count, addr);
+    } else if (strncasecmp(cmd, "write", 4) == 0) {
+        ube.testDMA(units, true, words, count, addr);
+    } else if (strncasecmp(cmd, "intr", 4) == 0) {
+        ube.testINTR(units, level, count);
+    } else {
+        printf("ube: unrecognized command\n");
+    }
+
+    return true;
+}
+
 //!
 //! \brief
 //!    Memory Write
@@ -6316,6 +8178,7 @@ bool command_t::execute(char * buf) {
     static const cmdList_t cmdList[] = {
         {"!",  &command_t::cmdBA},          // Bang
         {"?",  &command_t::cmdHE},          // Help
+        {"BP", &command_t::cmdBP},          // Breakpoint manager
         {"BR", &command_t::cmdBR},          // Breakpoint
         {"CE", &command_t::cmdCE},          // Cache enable
         {"CO", &command_t::cmdCO},          // Continue
@@ -6329,18 +8192,22 @@ bool command_t::execute(char * buf) {
         {"HA", &command_t::cmdHA},          // Halt
         {"HE", &command_t::cmdHE},          // Help
         {"HS", &command_t::cmdHS},          // Halt status
+        {"KM", &command_t::cmdKM},          // KMC11
         {"LP", &command_t::cmdLP},          // LPxx configuration
         {"MR", &command_t::cmdMR},
         {"MT", &command_t::cmdMT},          // Magtape boot
+        {"PR", &command_t::cmdPR},          // Profiler
         {"QU", &command_t::cmdQU},          // Quit
         {"RD", &command_t::cmdRD},          // Simple memory read
         {"RP", &command_t::cmdRP},          // RPxx Configuration
         {"SH", &command_t::cmdSH},           // Escape to shell
         {"SI", &command_t::cmdSI},          // Step instruction
         {"ST", &command_t::cmdST},          // Start
+        {"SY", &command_t::cmdSY},          // Symbols
         {"TE", &command_t::cmdTE},          // Timer enable
         {"TP", &command_t::cmdTP},          // Trap enable
         {"TR", &command_t::cmdTR},          // Trace
+        {"UB", &command_t::cmdUBE},         // Unibus Exerciser
         {"WR", &command_t::cmdWR},          // Simple memory write
         {"ZM", &command_t::cmdZM},          // Zero memory
         {"ZZ", &command_t::cmdZZ},          // Testing
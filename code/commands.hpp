@@ -48,6 +48,7 @@ class command_t {
         void initialize(void);
 
         bool cmdBA(int argc, char *argv[]);
+        bool cmdBP(int argc, char *argv[]);
         bool cmdBR(int argc, char *argv[]);
         bool cmdCE(int argc, char *argv[]);
         bool cmdCO(int argc, char *argv[]);
@@ -61,18 +62,22 @@ class command_t {
         bool cmdHA(int argc, char *argv[]);
         bool cmdHE(int argc, char *argv[]);
         bool cmdHS(int argc, char *argv[]);
+        bool cmdKM(int argc, char *argv[]);
         bool cmdLP(int argc, char *argv[]);
         bool cmdMR(int argc, char *argv[]);
         bool cmdMT(int argc, char *argv[]);
+        bool cmdPR(int argc, char *argv[]);
         bool cmdQU(int argc, char *argv[]);
         bool cmdRD(int argc, char *argv[]);
         bool cmdRP(int argc, char *argv[]);
         bool cmdSH(int argc, char *argv[]);
         bool cmdSI(int argc, char *argv[]);
         bool cmdST(int argc, char *argv[]);
+        bool cmdSY(int argc, char *argv[]);
         bool cmdTE(int argc, char *argv[]);
         bool cmdTP(int argc, char *argv[]);
         bool cmdTR(int argc, char *argv[]);
+        bool cmdUBE(int argc, char *argv[]);
         bool cmdWR(int argc, char *argv[]);
         bool cmdZM(int argc, char *argv[]);
         bool cmdZZ(int argc, char *argv[]);
@@ -5,6 +5,10 @@
 //! \brief
 //!    Simple PDP10 Disassembler
 //!
+//! \details
+//!    The disassembler is reentrant and does not allocate memory.  The
+//!    octal fields are copied from a table of precomputed three digit octal
+//!    strings instead of being formatted by sprintf().
 //!
 //! \file
 //!    dasm.cpp
@@ -33,8 +37,170 @@
 //
 //******************************************************************************
 
+#include <string.h>
+
 #include "dasm.hpp"
-#include "stdio.h"
+
+//
+// Three digit octal strings
+//
+
+static const char octal[01000][4] = {
+    "000", "001", "002", "003", "004", "005", "006", "007",
+    "010", "011", "012", "013", "014", "015", "016", "017",
+    "020", "021", "022", "023", "024", "025", "026", "027",
+    "030", "031", "032", "033", "034", "035", "036", "037",
+    "040", "041", "042", "043", "044", "045", "046", "047",
+    "050", "051", "052", "053", "054", "055", "056", "057",
+    "060", "061", "062", "063", "064", "065", "066", "067",
+    "070", "071", "072", "073", "074", "075", "076", "077",
+    "100", "101", "102", "103", "104", "105", "106", "107",
+    "110", "111", "112", "113", "114", "115", "116", "117",
+    "120", "121", "122", "123", "124", "125", "126", "127",
+    "130", "131", "132", "133", "134", "135", "136", "137",
+    "140", "141", "142", "143", "144", "145", "146", "147",
+    "150", "151", "152", "153", "154", "155", "156", "157",
+    "160", "161", "162", "163", "164", "165", "166", "167",
+    "170", "171", "172", "173", "174", "175", "176", "177",
+    "200", "201", "202", "203", "204", "205", "206", "207",
+    "210", "211", "212", "213", "214", "215", "216", "217",
+    "220", "221", "222", "223", "224", "225", "226", "227",
+    "230", "231", "232", "233", "234", "235", "236", "237",
+    "240", "241", "242", "243", "244", "245", "246", "247",
+    "250", "251", "252", "253", "254", "255", "256", "257",
+    "260", "261", "262", "263", "264", "265", "266", "267",
+    "270", "271", "272", "273", "274", "275", "276", "277",
+    "300", "301", "302", "303", "304", "305", "306", "307",
+    "310", "311", "312", "313", "314", "315", "316", "317",
+    "320", "321", "322", "323", "324", "325", "326", "327",
+    "330", "331", "332", "333", "334", "335", "336", "337",
+    "340", "341", "342", "343", "344", "345", "346", "347",
+    "350", "351", "352", "353", "354", "355", "356", "357",
+    "360", "361", "362", "363", "364", "365", "366", "367",
+    "370", "371", "372", "373", "374", "375", "376", "377",
+    "400", "401", "402", "403", "404", "405", "406", "407",
+    "410", "411", "412", "413", "414", "415", "416", "417",
+    "420", "421", "422", "423", "424", "425", "426", "427",
+    "430", "431", "432", "433", "434", "435", "436", "437",
+    "440", "441", "442", "443", "444", "445", "446", "447",
+    "450", "451", "452", "453", "454", "455", "456", "457",
+    "460", "461", "462", "463", "464", "465", "466", "467",
+    "470", "471", "472", "473", "474", "475", "476", "477",
+    "500", "501", "502", "503", "504", "505", "506", "507",
+    "510", "511", "512", "513", "514", "515", "516", "517",
+    "520", "521", "522", "523", "524", "525", "526", "527",
+    "530", "531", "532", "533", "534", "535", "536", "537",
+    "540", "541", "542", "543", "544", "545", "546", "547",
+    "550", "551", "552", "553", "554", "555", "556", "557",
+    "560", "561", "562", "563", "564", "565", "566", "567",
+    "570", "571", "572", "573", "574", "575", "576", "577",
+    "600", "601", "602", "603", "604", "605", "606", "607",
+    "610", "611", "612", "613", "614", "615", "616", "617",
+    "620", "621", "622", "623", "624", "625", "626", "627",
+    "630", "631", "632", "633", "634", "635", "636", "637",
+    "640", "641", "642", "643", "644", "645", "646", "647",
+    "650", "651", "652", "653", "654", "655", "656", "657",
+    "660", "661", "662", "663", "664", "665", "666", "667",
+    "670", "671", "672", "673", "674", "675", "676", "677",
+    "700", "701", "702", "703", "704", "705", "706", "707",
+    "710", "711", "712", "713", "714", "715", "716", "717",
+    "720", "721", "722", "723", "724", "725", "726", "727",
+    "730", "731", "732", "733", "734", "735", "736", "737",
+    "740", "741", "742", "743", "744", "745", "746", "747",
+    "750", "751", "752", "753", "754", "755", "756", "757",
+    "760", "761", "762", "763", "764", "765", "766", "767",
+    "770", "771", "772", "773", "774", "775", "776", "777",
+};
+
+//!
+//! \brief
+//!    Copy a string
+//!
+//! \returns
+//!    pointer to the end of the string in the buffer
+//!
+
+static inline char *putStr(char *ptr, const char *s) {
+    while (*s) {
+        *ptr++ = *s++;
+    }
+    return ptr;
+}
+
+//!
+//! \brief
+//!    Print a number in octal with a fixed number of digits (1 to 6)
+//!
+//! \returns
+//!    pointer to the end of the number in the buffer
+//!
+
+static inline char *putOctal(char *ptr, unsigned int val, unsigned int digits) {
+    if (digits > 3) {
+        const char *s = &octal[(val >> 9) & 0777][6 - digits];
+        while (*s) {
+            *ptr++ = *s++;
+        }
+        digits = 3;
+    }
+    const char *s = &octal[val & 0777][3 - digits];
+    while (*s) {
+        *ptr++ = *s++;
+    }
+    return ptr;
+}
+
+//!
+//! \brief
+//!    Print an 18-bit number in octal without leading zeros
+//!
+//! \returns
+//!    pointer to the end of the number in the buffer
+//!
+
+static inline char *putOctal(char *ptr, unsigned int val) {
+    unsigned int digits = 1;
+    for (unsigned int v = val >> 3; v != 0; v >>= 3) {
+        digits++;
+    }
+    return putOctal(ptr, val, digits);
+}
+
+//!
+//! \brief
+//!    Print the instruction in octal followed by the instruction fields.
+//!    This is "%06o %06o\t%03o %02o %01o %02o %06o\t".
+//!
+//! \returns
+//!    pointer to the end of the fields in the buffer
+//!
+
+static char *putFields(char *ptr, unsigned long long insn) {
+
+    unsigned int op = (insn >> 27) &    0777;
+    unsigned int ac = (insn >> 23) &     017;
+    unsigned int in = (insn >> 22) &       1;
+    unsigned int xr = (insn >> 18) &     017;
+    unsigned int ea = (insn >>  0) & 0777777;
+    unsigned int lh = (insn >> 18) & 0777777;
+    unsigned int rh = (insn >>  0) & 0777777;
+
+    ptr = putOctal(ptr, lh, 6);
+    *ptr++ = ' ';
+    ptr = putOctal(ptr, rh, 6);
+    *ptr++ = '\t';
+    ptr = putOctal(ptr, op, 3);
+    *ptr++ = ' ';
+    ptr = putOctal(ptr, ac, 2);
+    *ptr++ = ' ';
+    *ptr++ = '0' + in;
+    *ptr++ = ' ';
+    ptr = putOctal(ptr, xr, 2);
+    *ptr++ = ' ';
+    ptr = putOctal(ptr, ea, 6);
+    *ptr++ = '\t';
+    return ptr;
+}
 
 //!
 //! \brief
@@ -43,48 +209,43 @@
 //! \param [in] opcode
 //!    pointer to string with opcode
 //!
-//! \param [in] buf
-//!    pointer to buffer.   Must be long enough to store the disassembled
-//!    instruction.
+//! \param [in] ptr
+//!    pointer to buffer.   Must be at least dasmLEN characters.
 //
 //! \param [in] insn
 //!    36-bit instruction to disassemble
 //!
 //! \returns
-//!    pointer to buffer with disassembled instruction
+//!    pointer to the end of the disassembled instruction
 //!
 
-static const char* opSTD(const char *opcode, char *buf, unsigned long long insn) {
-
-    char *ptr = buf;
-    unsigned int len = 0;
+static char *opSTD(const char *opcode, char *ptr, unsigned long long insn) {
 
-    unsigned int op = (insn >> 27) &    0777;
     unsigned int ac = (insn >> 23) &     017;
     unsigned int in = (insn >> 22) &       1;
     unsigned int xr = (insn >> 18) &     017;
     unsigned int ea = (insn >>  0) & 0777777;
-    unsigned int lh = (insn >> 18) & 0777777;
-    unsigned int rh = (insn >>  0) & 0777777;
 
     //
     // Print instruction
     //
 
-    len += sprintf(&ptr[len], "%06o %06o\t%03o %02o %01o %02o %06o\t", lh, rh, op, ac, in, xr, ea);
+    ptr = putFields(ptr, insn);
 
     //
     // Print opcode
     //
 
-    len += sprintf(&ptr[len], "%s\t", opcode);
+    ptr = putStr(ptr, opcode);
+    *ptr++ = '\t';
 
     //
     // Optionally print AC
     //
 
     if (ac != 0) {
-        len += sprintf(&ptr[len], "%o,", ac);
+        ptr = putOctal(ptr, ac);
+        *ptr++ = ',';
     }
 
     //
@@ -92,7 +253,7 @@ static const char* opSTD(const char *opcode, char *buf, unsigned long long insn)
     //
 
     if (in != 0) {
-        len += sprintf(&ptr[len], "@");
+        *ptr++ = '@';
     }
 
     //
@@ -102,9 +263,10 @@ static const char* opSTD(const char *opcode, char *buf, unsigned long long insn)
     if (ac != 0 || in != 0 || xr != 0 || ea != 0) {
 
         if (ea & 0400000) {
-            len += sprintf(&ptr[len], "-%o", (~ea + 1) & 0377777);
+            *ptr++ = '-';
+            ptr = putOctal(ptr, (~ea + 1) & 0377777);
         } else {
-            len += sprintf(&ptr[len], "%o", ea);
+            ptr = putOctal(ptr, ea);
         }
     }
 
@@ -113,10 +275,62 @@ static const char* opSTD(const char *opcode, char *buf, unsigned long long insn)
     //
 
     if (xr != 0) {
-        len += sprintf(&ptr[len], "(%o)", xr);
+        *ptr++ = '(';
+        ptr = putOctal(ptr, xr);
+        *ptr++ = ')';
     }
 
-    return buf;
+    return ptr;
+}
+
+//!
+//! \brief
+//!    This function prints the operand of the IOT and JRST instructions.
+//!    These instructions use the AC field as part of the opcode.
+//!
+//! \param [in] ptr
+//!    pointer to buffer.
+//
+//! \param [in] insn
+//!    36-bit instruction to disassemble
+//!
+//! \returns
+//!    pointer to the end of the disassembled instruction
+//!
+
+static char *putOperand(char *ptr, unsigned long long insn) {
+
+    unsigned int in = (insn >> 22) &       1;
+    unsigned int xr = (insn >> 18) &     017;
+    unsigned int ea = (insn >>  0) & 0777777;
+
+    //
+    // Optionally print indirect
+    //
+
+    if (in != 0) {
+        *ptr++ = '@';
+    }
+
+    //
+    // Optionally print EA
+    //
+
+    if (in != 0 || xr != 0 || ea != 0) {
+        ptr = putOctal(ptr, ea);
+    }
+
+    //
+    // Optionally print XR
+    //
+
+    if (xr != 0) {
+        *ptr++ = '(';
+        ptr = putOctal(ptr, xr);
+        *ptr++ = ')';
+    }
+
+    return ptr;
 }
 
 //!
@@ -124,18 +338,17 @@ static const char* opSTD(const char *opcode, char *buf, unsigned long long insn)
 //!    This function disassembles an IOT instruction.  These are
 //!    instructions 700, 701, and 702.
 //!
-//! \param [in] buf
-//!    pointer to buffer.   Must be long enough to store the disassembled
-//!    instruction.
+//! \param [in] ptr
+//!    pointer to buffer.   Must be at least dasmLEN characters.
 //
 //! \param [in] insn
 //!    36-bit instruction to disassemble
 //!
 //! \returns
-//!    pointer to buffer with disassembled instruction
+//!    pointer to the end of the disassembled instruction
 //!
 
-static const char* opIOT(const char *, char *buf, unsigned long long insn) {
+static char *opIOT(const char *, char *ptr, unsigned long long insn) {
 
     static const char* table[] = {
         "APRID",        // 70000
@@ -188,74 +401,39 @@ static const char* opIOT(const char *, char *buf, unsigned long long insn) {
         "70274",        // 70274
     };
 
-    char *ptr = buf;
-    unsigned int len = 0;
-
-    unsigned int op = (insn >> 27) &    0777;
-    unsigned int ac = (insn >> 23) &     017;
-    unsigned int in = (insn >> 22) &       1;
-    unsigned int xr = (insn >> 18) &     017;
-    unsigned int ea = (insn >>  0) & 0777777;
     unsigned int f  = (insn >> 23) &     077;
-    unsigned int lh = (insn >> 18) & 0777777;
-    unsigned int rh = (insn >>  0) & 0777777;
 
     //
     // Print instruction
     //
 
-    len += sprintf(&ptr[len], "%06o %06o\t%03o %02o %01o %02o %06o\t", lh, rh, op, ac, in, xr, ea);
+    ptr = putFields(ptr, insn);
 
     //
     // Print opcode
     //
 
-    len += sprintf(&ptr[len], "%s\t", table[f]);
-
-    //
-    // Optionally print indirect
-    //
-
-    if (in != 0) {
-        len += sprintf(&ptr[len], "@");
-    }
-
-    //
-    // Optionally print EA
-    //
-
-    if (in != 0 || xr != 0 || ea != 0) {
-        len += sprintf(&ptr[len], "%o", ea);
-    }
-
-    //
-    // Optionally print XR
-    //
-
-    if (xr != 0) {
-        len += sprintf(&ptr[len], "(%o)", xr);
-    }
-
-    return buf;
+    ptr = putStr(ptr, table[f]);
+    *ptr++ = '\t';
 
+    return putOperand(ptr, insn);
 }
 
 //!
 //! \brief
 //!    This function disassembles a JRST instruction.
 //!
-//! \param [in] buf
-//!    pointer to buffer.   Must be long enough to store the disassembled
-//!    instruction.
+//! \param [in] ptr
+//!    pointer to buffer.   Must be at least dasmLEN characters.
 //
 //! \param [in] insn
 //!    36-bit instruction to disassemble
 //!
 //! \returns
-//!    pointer to buffer with disassembled instruction
+//!    pointer to the end of the disassembled instruction
 //!
 
-static const char* opJRST(const char *, char *buf, unsigned long long insn) {
+static char *opJRST(const char *, char *ptr, unsigned long long insn) {
 
     static const char* table[] = {
         "JRST",         // 00
@@ -276,73 +454,50 @@ static const char* opJRST(const char *, char *buf, unsigned long long insn) {
         "UUO",          // 17
     };
 
-    char *ptr = buf;
-    unsigned int len = 0;
-
-    unsigned int op = (insn >> 27) &    0777;
     unsigned int ac = (insn >> 23) &     017;
-    unsigned int in = (insn >> 22) &       1;
-    unsigned int xr = (insn >> 18) &     017;
-    unsigned int ea = (insn >>  0) & 0777777;
-    unsigned int lh = (insn >> 18) & 0777777;
-    unsigned int rh = (insn >>  0) & 0777777;
 
     //
     // Print instruction
     //
 
-    len += sprintf(&ptr[len], "%06o %06o\t%03o %02o %01o %02o %06o\t", lh, rh, op, ac, in, xr, ea);
+    ptr = putFields(ptr, insn);
 
     //
     // Print opcode
     //
 
-    len += sprintf(&ptr[len], "%s\t", table[ac]);
-
-    //
-    // Optionally print indirect
-    //
-
-    if (in != 0) {
-        len += sprintf(&ptr[len], "@");
-    }
+    ptr = putStr(ptr, table[ac]);
+    *ptr++ = '\t';
 
-    //
-    // Optionally print EA
-    //
-
-    if (in != 0 || xr != 0 || ea != 0) {
-        len += sprintf(&ptr[len], "%o", ea);
-    }
-    //
-    // Optionally print XR
-    //
-
-    if (xr != 0) {
-        len += sprintf(&ptr[len], "(%o)", xr);
-    }
-
-    return buf;
+    return putOperand(ptr, insn);
 }
 
 //!
 //! \brief
 //!    This function disassembles an instruction.
 //!
+//! \details
+//!    This function is reentrant.  The output is truncated to fit the
+//!    buffer.
+//!
 //! \param [in] insn
 //!    36-bit instruction to disassemble
 //!
+//! \param [out] out
+//!    buffer for the disassembled instruction
+//!
+//! \param [in] size
+//!    size of the buffer
+//!
 //! \returns
-//!    pointer to buffer with disassembled instruction
+//!    length of the disassembled instruction in the buffer
 //!
 
-const char* dasm(unsigned long long insn) {
-
-    static char buffer[80];
+size_t dasm(unsigned long long insn, char *out, size_t size) {
 
     static const struct {
         const char *opcode;
-        const char *(*fun)(const char* name, char *buf, unsigned long long arg);
+        char *(*fun)(const char* name, char *buf, unsigned long long arg);
     } table[01000] = {
 
         {"UUO",    opSTD},         // 000
@@ -922,7 +1077,64 @@ const char* dasm(unsigned long long insn) {
         {"UUO777", opSTD},         // 777
     };
 
+    if (size == 0) {
+        return 0;
+    }
+
+    char line[dasmLEN];
+    char *buf = (size >= dasmLEN) ? out : line;
+
     unsigned int op = (insn >> 27) & 0777;
-    return (table[op].fun)(table[op].opcode, buffer, insn);
+    size_t len = (table[op].fun)(table[op].opcode, buf, insn) - buf;
+
+    if (buf == line) {
+        if (len >= size) {
+            len = size - 1;
+        }
+        memcpy(out, line, len);
+    }
+    out[len] = 0;
+    return len;
+}
 
+//!
+//! \brief
+//!    This function disassembles an array of instructions.
+//!
+//! \param [in] insn
+//!    array of 36-bit instructions to disassemble
+//!
+//! \param [in] num
+//!    number of instructions
+//!
+//! \param [out] out
+//!    array of num lines for the disassembled instructions
+//!
+
+void dasm(const unsigned long long *insn, unsigned int num, char (*out)[dasmLEN]) {
+    for (unsigned int i = 0; i < num; i++) {
+        dasm(insn[i], out[i], dasmLEN);
+    }
+}
+
+//!
+//! \brief
+//!    This function disassembles an instruction.
+//!
+//! \details
+//!    Each thread has its own buffer so this function can be called from
+//!    more than one thread.  The buffer is overwritten by the next call
+//!    from the same thread.
+//!
+//! \param [in] insn
+//!    36-bit instruction to disassemble
+//!
+//! \returns
+//!    pointer to buffer with disassembled instruction
+//!
+
+const char* dasm(unsigned long long insn) {
+    static thread_local char buffer[dasmLEN];
+    dasm(insn, buffer, sizeof(buffer));
+    return buffer;
 }
@@ -36,6 +36,16 @@
 #ifndef __DASM_HPP
 #define __DASM_HPP
 
+#include <stddef.h>
+
+//
+// Longest disassembled instruction including the terminating NUL
+//
+
+const size_t dasmLEN = 80;
+
+size_t dasm(unsigned long long insn, char *out, size_t size);
+void dasm(const unsigned long long *insn, unsigned int num, char (*out)[dasmLEN]);
 const char* dasm(unsigned long long insn);
 
 #endif
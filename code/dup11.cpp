@@ -38,25 +38,441 @@
 //
 
 #include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/if_tun.h>
 
 #include "uba.hpp"
 #include "dup11.hpp"
+#include "regs.hpp"
+
+//
+// DUP11 Register Descriptions
+//
+
+static const regs_t::field_t fieldsRXCSR[] = {
+    {"DSCA",   15, 1, NULL},
+    {"RING",   14, 1, NULL},
+    {"CTS",    13, 1, NULL},
+    {"DCD",    12, 1, NULL},
+    {"RXACT",  11, 1, NULL},
+    {"SECRX",  10, 1, NULL},
+    {"DSR",     9, 1, NULL},
+    {"STRSYN",  8, 1, NULL},
+    {"RXDONE",  7, 1, NULL},
+    {"RXIE",    6, 1, NULL},
+    {"DSCIE",   5, 1, NULL},
+    {"RXEN",    4, 1, NULL},
+    {"SECTX",   3, 1, NULL},
+    {"RTS",     2, 1, NULL},
+    {"DTR",     1, 1, NULL},
+    {"DSCB",    0, 1, NULL},
+    {NULL,      0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsTXCSR[] = {
+    {"TXDLE",  15, 1, NULL},
+    {"MDO",    14, 1, NULL},
+    {"MCO",    13, 1, NULL},
+    {"MSEL",   11, 2, NULL},
+    {"MDI",    10, 1, NULL},
+    {"TXACT",   9, 1, NULL},
+    {"INIT",    8, 1, NULL},
+    {"TXDONE",  7, 1, NULL},
+    {"TXIE",    6, 1, NULL},
+    {"SEND",    4, 1, NULL},
+    {"HDX",     3, 1, NULL},
+    {NULL,      0, 0, NULL},
+};
+
+//
+// RXDBUF is not included because reading it clears RXDONE
+//
+
+static const regs_t::reg_t regsDUP[] = {
+    regs_t::regUBAS,
+    {"RXCSR", 00, false, fieldsRXCSR},
+    {"TXCSR", 04, false, fieldsTXCSR},
+};
 
 //!
 //! \brief
 //!    Dump DUP11 registers
 //!
+//! \param script -
+//!    Print the registers as "name=value" assignments
+//!
+
+void dup11_t::dumpRegs(bool script) {
+    regs_t::dump("du", addrRXCSR, regsDUP, sizeof(regsDUP) / sizeof(regsDUP[0]), script);
+    regs_t::printCCR("du", "DUPCCR", ks10_t::readDUPCCR(), script);
+}
+
+
+//!
+//! \brief
+//!    Return the time in microseconds
+//!
+
+static uint64_t usecs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//!
+//! \brief
+//!    Read the DUPCCR
+//!
+//! \details
+//!    Reading the DUPCCR pops the TX FIFO.  Therefore every read of the
+//!    DUPCCR by the bridge must go through this function so that transmit
+//!    data is never lost.  Leading SYN characters are stripped from the
+//!    frame.
+//!
+//! \returns
+//!    Contents of the DUPCCR
+//!
+
+uint32_t dup11_t::readCCR(void) {
+
+    uint32_t ccr = ks10_t::readDUPCCR();
+
+    if ((ccr & ks10_t::dupTXE) == 0) {
+        uint8_t ch = (ccr & ks10_t::dupTXFIFO) >> 16;
+        if ((txFrame.len != 0) || (ch != SYN)) {
+            if (txFrame.len < maxFRAME) {
+                txFrame.data[txFrame.len++] = ch;
+            } else {
+                local.overflows++;
+            }
+        }
+        txLast = usecs();
+    }
+
+    return ccr;
+}
+
+//!
+//! \brief
+//!    Send the frame that was drained from the TX FIFO
+//!
+//! \details
+//!    In loopback mode the frame is queued for the RX FIFO.
+//!
 
-void dup11_t::dumpRegs(void) {
+void dup11_t::sendFrame(void) {
 
-    printf("KS10: Register Dump\n"
-           "      UBAS  : %012llo\n"
-           "      RXCSR : %06o\n"
-           "      TXCSR : %06o\n"
-           "      DUPCCR: 0x%08x\n",
-           uba.readCSR(),
-           ks10_t::readIO16(addrRXCSR),
-           ks10_t::readIO16(addrTXCSR),
-           ks10_t::readDZCCR());
+    if (bridgeMode == bridgeLOOP) {
+        if (rxCount < numFRAME) {
+            frame_t &f = rxQueue[(rxHead + rxCount) % numFRAME];
+            f.len = txFrame.len;
+            memcpy(f.data, txFrame.data, txFrame.len);
+            rxCount++;
+        } else {
+            local.drops++;
+        }
+    } else {
+        if (write(bridgeFd, txFrame.data, txFrame.len) < 0) {
+            local.drops++;
+        }
+    }
+
+    local.txFrames++;
+    local.txBytes += txFrame.len;
+    txFrame.len = 0;
 }
 
+//!
+//! \brief
+//!    Receive frames from the host
+//!
+//! \returns
+//!    Number of frames received
+//!
+
+unsigned int dup11_t::bridgeHost(void) {
+
+    unsigned int count = 0;
+
+    if (bridgeMode == bridgeLOOP) {
+        return 0;
+    }
+
+    while (rxCount < numFRAME) {
+        frame_t &f = rxQueue[(rxHead + rxCount) % numFRAME];
+        ssize_t n = read(bridgeFd, f.data, maxFRAME);
+        if (n <= 0) {
+            break;
+        }
+        f.len = n;
+        rxCount++;
+        count++;
+    }
+
+    return count;
+}
+
+//!
+//! \brief
+//!    Feed queued frames to the RX FIFO
+//!
+//! \details
+//!    Each frame is preceded by SYN characters so that the DUP11 receiver
+//!    can synchronize.  A full RX FIFO stalls the feed until the KS10 has
+//!    read some characters.
+//!
+//! \returns
+//!    Number of bytes written to the RX FIFO
+//!
+
+unsigned int dup11_t::bridgeFeed(void) {
+
+    unsigned int count = 0;
+
+    while ((rxCount != 0) && (count < maxSCAN)) {
+
+        if (readCCR() & ks10_t::dupRXF) {
+            if (!stalled) {
+                stalled = true;
+                local.stalls++;
+            }
+            break;
+        }
+        stalled = false;
+
+        frame_t &f = rxQueue[rxHead];
+        uint8_t ch = (rxPos < numSYN) ? SYN : f.data[rxPos - numSYN];
+        ks10_t::writeDUPCCR(bridgeCtl | ch);
+        count++;
+
+        if (++rxPos == numSYN + f.len) {
+            local.rxFrames++;
+            local.rxBytes += f.len;
+            rxHead = (rxHead + 1) % numFRAME;
+            rxCount--;
+            rxPos = 0;
+        }
+    }
+
+    return count;
+}
+
+//!
+//! \brief
+//!    Bridge loop
+//!
+//! \details
+//!    The TX FIFO is drained in batches.  A frame ends when the TX FIFO has
+//!    been idle for the gap time.  The statistics are published after every
+//!    scan, including idle and stalled scans, so that the lock is only held
+//!    for a copy.
+//!
+
+void dup11_t::bridgeLoop(void) {
+
+    while (bridgeRun) {
+
+        unsigned int count = 0;
+        for (; count < maxSCAN; count++) {
+            if (readCCR() & ks10_t::dupTXE) {
+                break;
+            }
+        }
+
+        if ((txFrame.len != 0) && (usecs() - txLast > bridgeGap)) {
+            sendFrame();
+            count++;
+        }
+
+        count += bridgeHost();
+        count += bridgeFeed();
+
+        {
+            std::lock_guard<std::mutex> lock(bridgeMutex);
+            stats = local;
+        }
+
+        if (count == 0) {
+            usleep(100);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &bridgeEnd);
+}
+
+//!
+//! \brief
+//!    Start the bridge
+//!
+//! \param mode -
+//!    bridgeLOOP, bridgeUDP, or bridgeTAP
+//!
+//! \param arg -
+//!    For bridgeUDP, "lport:host:rport".  For bridgeTAP, the interface name.
+//!
+//! \param gap -
+//!    TX FIFO idle time that ends a frame in microseconds
+//!
+//! \returns
+//!    True if the bridge was started.
+//!
+
+bool dup11_t::bridgeStart(int mode, const char *arg, unsigned int gap) {
+
+    if (bridgeRun) {
+        printf("KS10: DUP11 bridge is already running.\n");
+        return false;
+    }
+
+    bridgeStop();
+
+    if (mode == bridgeUDP) {
+
+        unsigned int lport;
+        unsigned int rport;
+        char host[64];
+        if (sscanf(arg, "%u:%63[^:]:%u", &lport, host, &rport) != 3) {
+            printf("KS10: DUP11 UDP argument \"%s\" is not lport:host:rport.\n", arg);
+            return false;
+        }
+
+        struct addrinfo hints;
+        struct addrinfo *res;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family   = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        if (getaddrinfo(host, NULL, &hints, &res) != 0) {
+            printf("KS10: DUP11 unable to resolve \"%s\".\n", host);
+            return false;
+        }
+        struct sockaddr_in raddr = *(struct sockaddr_in *)res->ai_addr;
+        raddr.sin_port = htons(rport);
+        freeaddrinfo(res);
+
+        struct sockaddr_in laddr;
+        memset(&laddr, 0, sizeof(laddr));
+        laddr.sin_family      = AF_INET;
+        laddr.sin_addr.s_addr = htonl(INADDR_ANY);
+        laddr.sin_port        = htons(lport);
+
+        bridgeFd = socket(AF_INET, SOCK_DGRAM, 0);
+        if ((bridgeFd < 0) ||
+            (bind(bridgeFd, (struct sockaddr *)&laddr, sizeof(laddr)) != 0) ||
+            (connect(bridgeFd, (struct sockaddr *)&raddr, sizeof(raddr)) != 0)) {
+            printf("KS10: DUP11 unable to open UDP socket. %s\n", strerror(errno));
+            bridgeStop();
+            return false;
+        }
+
+    } else if (mode == bridgeTAP) {
+
+        struct ifreq ifr;
+        memset(&ifr, 0, sizeof(ifr));
+        ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+        strncpy(ifr.ifr_name, arg, IFNAMSIZ - 1);
+
+        bridgeFd = open("/dev/net/tun", O_RDWR);
+        if ((bridgeFd < 0) || (ioctl(bridgeFd, TUNSETIFF, &ifr) != 0)) {
+            printf("KS10: DUP11 unable to open TAP device \"%s\". %s\n", arg, strerror(errno));
+            bridgeStop();
+            return false;
+        }
+
+    }
+
+    if (bridgeFd >= 0) {
+        fcntl(bridgeFd, F_SETFL, fcntl(bridgeFd, F_GETFL) | O_NONBLOCK);
+    }
+
+    //
+    // Keep the modem and jumper configuration when writing the RX FIFO.
+    // This read may pop a TX byte so the frame state is initialized first.
+    //
+
+    memset(&local, 0, sizeof(local));
+    memset(&stats, 0, sizeof(stats));
+    txFrame.len = 0;
+    txLast      = usecs();
+    rxHead      = 0;
+    rxCount     = 0;
+    rxPos       = 0;
+    stalled     = false;
+    bridgeMode  = mode;
+    bridgeGap   = gap;
+    bridgeCtl   = readCCR() & (ks10_t::dupRI   | ks10_t::dupCTS | ks10_t::dupDSR | ks10_t::dupDCD |
+                               ks10_t::dupH325 | ks10_t::dupW3  | ks10_t::dupW5  | ks10_t::dupW6);
+
+    clock_gettime(CLOCK_MONOTONIC, &bridgeTime);
+    bridgeRun = true;
+    bridgeThread = std::thread(&dup11_t::bridgeLoop, this);
+
+    return true;
+}
+
+//!
+//! \brief
+//!    Stop the bridge
+//!
+
+void dup11_t::bridgeStop(void) {
+
+    bridgeRun = false;
+    if (bridgeThread.joinable()) {
+        bridgeThread.join();
+    }
+
+    if (bridgeFd >= 0) {
+        close(bridgeFd);
+        bridgeFd = -1;
+    }
+}
+
+//!
+//! \brief
+//!    Print bridge statistics
+//!
+
+void dup11_t::bridgeStat(void) {
+
+    if (bridgeMode < 0) {
+        printf("KS10: DUP11 bridge has not been started.\n");
+        return;
+    }
+
+    stats_t copy;
+    {
+        std::lock_guard<std::mutex> lock(bridgeMutex);
+        copy = stats;
+    }
+
+    struct timespec now;
+    if (bridgeRun) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } else {
+        now = bridgeEnd;
+    }
+
+    double secs = (now.tv_sec - bridgeTime.tv_sec) + (now.tv_nsec - bridgeTime.tv_nsec) / 1e9;
+    if (secs <= 0) {
+        secs = 1e-9;
+    }
+
+    printf("KS10: DUP11 bridge is %s (%.1f seconds).\n"
+           "      TX frames     : %llu (%.1f frames/sec, %llu bytes)\n"
+           "      RX frames     : %llu (%.1f frames/sec, %llu bytes)\n"
+           "      RX FIFO stalls: %u\n"
+           "      TX overflows  : %u\n"
+           "      Dropped       : %u\n",
+           bridgeRun ? "running" : "stopped", secs,
+           (unsigned long long)copy.txFrames, copy.txFrames / secs, (unsigned long long)copy.txBytes,
+           (unsigned long long)copy.rxFrames, copy.rxFrames / secs, (unsigned long long)copy.rxBytes,
+           copy.stalls, copy.overflows, copy.drops);
+}
@@ -8,6 +8,9 @@
 //! \details
 //!    This object allows the console to interact with the DUP11
 //!
+//!    The bridge moves synchronous line data between the DUP11 FIFOs and a
+//!    host UDP socket or TAP device.
+//!
 //! \file
 //!    dup11.hpp
 //!
@@ -38,6 +41,12 @@
 #ifndef __DUP11_HPP
 #define __DUP11_HPP
 
+#include <mutex>
+#include <thread>
+
+#include <time.h>
+#include <stdint.h>
+
 #include "uba.hpp"
 #include "ks10.hpp"
 
@@ -75,8 +84,80 @@ class dup11_t {
 
         uba_t uba;
 
+        //
+        // Bridge
+        //
+
+        static const unsigned int maxFRAME = 2048;      //!< Largest frame
+        static const unsigned int maxSCAN  = 64;        //!< FIFO accesses per scan
+        static const unsigned int numFRAME = 8;         //!< RX frame queue depth
+        static const unsigned int numSYN   = 4;         //!< SYN bytes before each RX frame
+        static const uint8_t      SYN      = 0226;      //!< DDCMP SYN character
+
+        //!
+        //! \brief
+        //!    Bridge statistics
+        //!
+
+        struct stats_t {
+            uint64_t txFrames;                  //!< Frames sent to the host
+            uint64_t txBytes;                   //!< Bytes sent to the host
+            uint64_t rxFrames;                  //!< Frames received from the host
+            uint64_t rxBytes;                   //!< Bytes received from the host
+            unsigned int stalls;                //!< RX FIFO full stalls
+            unsigned int overflows;             //!< TX frames that were truncated
+            unsigned int drops;                 //!< Loopback frames dropped
+        };
+
+        //!
+        //! \brief
+        //!    Frame buffer
+        //!
+
+        struct frame_t {
+            unsigned int len;                   //!< Frame length
+            uint8_t data[maxFRAME];             //!< Frame data
+        };
+
+        int bridgeMode;                         //!< Bridge mode
+        int bridgeFd;                           //!< Host socket or TAP
+        unsigned int bridgeGap;                 //!< End of frame idle time (us)
+        uint32_t bridgeCtl;                     //!< DUPCCR control bits
+        volatile bool bridgeRun;                //!< Bridge thread is running
+        std::thread bridgeThread;               //!< Bridge thread
+        std::mutex bridgeMutex;                 //!< Protects stats
+        stats_t stats;                          //!< Statistics
+        stats_t local;                          //!< Bridge thread statistics
+        struct timespec bridgeTime;             //!< Start time
+        struct timespec bridgeEnd;              //!< Stop time
+
+        frame_t txFrame;                        //!< Frame being drained from the TX FIFO
+        uint64_t txLast;                        //!< Time of last TX byte (us)
+        frame_t rxQueue[numFRAME];              //!< Frames for the RX FIFO
+        unsigned int rxHead;                    //!< Next frame for the RX FIFO
+        unsigned int rxCount;                   //!< Frames in rxQueue
+        unsigned int rxPos;                     //!< Position in rxQueue[rxHead]
+        bool stalled;                           //!< RX FIFO is full
+
+        uint32_t readCCR(void);
+        void sendFrame(void);
+        unsigned int bridgeHost(void);
+        unsigned int bridgeFeed(void);
+        void bridgeLoop(void);
+
     public:
 
+        //!
+        //! \brief
+        //!    Bridge modes
+        //!
+
+        enum {
+            bridgeLOOP,                         //!< Software loopback
+            bridgeUDP,                          //!< UDP socket
+            bridgeTAP,                          //!< TAP device
+        };
+
         //
         // DUP11 Base Addresses
         //
@@ -88,7 +169,10 @@ class dup11_t {
         // Public Functions
         //
 
-        void dumpRegs(void);
+        void dumpRegs(bool script = false);
+        bool bridgeStart(int mode, const char *arg, unsigned int gap);
+        void bridgeStop(void);
+        void bridgeStat(void);
 
         //!
         //! \brief
@@ -101,9 +185,21 @@ class dup11_t {
             addrPARCSR((baseADDR & 07777770) + offsetPARCSR),
             addrTXCSR ((baseADDR & 07777770) + offsetTXCSR ),
             addrTXDBUF((baseADDR & 07777770) + offsetTXDBUF),
-            uba(baseADDR) {
+            uba(baseADDR),
+            bridgeMode(-1),
+            bridgeFd(-1),
+            bridgeRun(false) {
             ;
         }
+
+        //!
+        //! \brief
+        //!    Destructor.  Stop the bridge.
+        //!
+
+        ~dup11_t(void) {
+            bridgeStop();
+        }
 };
 
 #endif
@@ -9,6 +9,13 @@
 //!    This object allows the console to interact with the DZ11 Terminal
 //!    Multiplexer. This is mostly for testing the DZ11 from the console.
 //!
+//!    The line bridge services all of the bridged lines from a single scan
+//!    loop.  Characters are buffered per line and are passed to and from
+//!    the host in batches.  Characters received by the DZ11 go to the host
+//!    and characters from the host are transmitted by the DZ11.  The console
+//!    plays the part of the KS10 driver, so the bridge only runs while the
+//!    KS10 is halted.
+//!
 //! \file
 //!    dz11.cpp
 //!
@@ -38,28 +45,71 @@
 //
 
 #include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/un.h>
+#include <sys/socket.h>
 
 #include "uba.hpp"
 #include "dz11.hpp"
+#include "regs.hpp"
+
+//
+// DZ11 Register Descriptions
+//
+
+static const regs_t::field_t fieldsCSR[] = {
+    {"TRDY",  15, 1, NULL},
+    {"TIE",   14, 1, NULL},
+    {"SA",    13, 1, NULL},
+    {"SAE",   12, 1, NULL},
+    {"TLINE",  8, 3, NULL},
+    {"RDONE",  7, 1, NULL},
+    {"RIE",    6, 1, NULL},
+    {"MSE",    5, 1, NULL},
+    {"CLR",    4, 1, NULL},
+    {"MAINT",  3, 1, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsTCR[] = {
+    {"DTR",    8, 8, NULL},
+    {"LIN",    0, 8, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsMSR[] = {
+    {"CO",     8, 8, NULL},
+    {"RI",     0, 8, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+//
+// RBUF is not included because reading it pops the receiver silo
+//
+
+static const regs_t::reg_t regsDZ[] = {
+    regs_t::regUBAS,
+    {"CSR", 00, false, fieldsCSR},
+    {"TCR", 04, false, fieldsTCR},
+    {"MSR", 06, false, fieldsMSR},
+};
 
 //!
 //! \brief
 //!    Dump DZ11 registers
 //!
+//! \param script -
+//!    Print the registers as "name=value" assignments
+//!
 
-void dz11_t::dumpRegs(void) {
-
-    printf("KS10: dz register dump\n"
-           "      UBAS : %012llo\n"
-           "      CSR  : %06o\n"
-           "      TCR  : %06o\n"
-           "      MSR  : %06o\n"
-           "      DZCCR: 0x%08x\n",
-           uba.readCSR(),
-           ks10_t::readIO16(addrCSR),
-           ks10_t::readIO16(addrTCR),
-           ks10_t::readIO16(addrMSR),
-           ks10_t::readDZCCR());
+void dz11_t::dumpRegs(bool script) {
+    regs_t::dump("dz", addrCSR, regsDZ, sizeof(regsDZ) / sizeof(regsDZ[0]), script);
+    regs_t::printCCR("dz", "DZCCR", ks10_t::readDZCCR(), script);
 }
 
 //!
@@ -269,3 +319,765 @@ void dz11_t::testECHO(int line) {
         }
     }
 }
+
+//!
+//! \brief
+//!    Soak test the DZ11
+//!
+//! \details
+//!    All of the selected lines are run concurrently with the transmitters
+//!    looped back to the receivers by CSR[MAINT].  Each line sends a
+//!    pseudo-random payload which is regenerated by the receiver for
+//!    comparison.  Transmit times are kept per character so the latency
+//!    of each character can be measured.
+//!
+//!    Characters that are lost (for example by a silo overrun) are detected
+//!    by resynchronizing on the transmit history.
+//!
+//!    Before the data test, the modem controls are looped back by setting
+//!    Carrier Sense and Ring Indication in the DZCCR and checking them in
+//!    the MSR.  The DZCCR is restored afterwards.
+//!
+//! \param mask -
+//!    Bit mask of lines to test
+//!
+//! \param baud -
+//!    Baud rate for each line
+//!
+//! \param count -
+//!    Number of characters to send on each line
+//!
+//! \returns
+//!    True if the test passed.
+//!
+
+bool dz11_t::testSOAK(unsigned int mask, const unsigned int baud[8], unsigned int count) {
+
+    static const unsigned int histSIZE = 16;
+    static const unsigned int ringSIZE = 256;
+
+    struct soak_t {
+        uint32_t seed;                          //!< Transmit PRNG state
+        uint8_t ringChar[ringSIZE];             //!< Transmit history
+        uint32_t ringTime[ringSIZE];            //!< Transmit times (us)
+        unsigned int txIndex;                   //!< Characters sent
+        unsigned int rxIndex;                   //!< Characters matched
+        unsigned int received;                  //!< Characters received
+        unsigned int errors;                    //!< Unmatched characters
+        unsigned int lost;                      //!< Characters skipped
+        unsigned int overruns;                  //!< RBUF overrun errors
+        uint32_t latMin;                        //!< Minimum latency (us)
+        uint32_t latMax;                        //!< Maximum latency (us)
+        uint64_t latSum;                        //!< Total latency (us)
+        uint32_t lastTime;                      //!< Time of last character (us)
+    } soak[numLINES];
+
+    unsigned int histogram[histSIZE] = {};
+
+    mask &= 0xff;
+    for (unsigned int line = 0; line < numLINES; line++) {
+        if ((mask & (1 << line)) && (baudCode(baud[line]) < 0)) {
+            printf("KS10: DZ11 baud rate of %d is not supported.\n", baud[line]);
+            return false;
+        }
+    }
+
+    //
+    // Modem control loopback
+    //
+
+    bool pass = true;
+    uint32_t dzccr = ks10_t::readDZCCR();
+
+    ks10_t::writeDZCCR(mask << 8);
+    uint16_t msrCO = ks10_t::readIO16(addrMSR);
+    ks10_t::writeDZCCR(mask);
+    uint16_t msrRI = ks10_t::readIO16(addrMSR);
+    ks10_t::writeDZCCR(dzccr);
+
+    if ((((msrCO >> 8) & mask) != mask) || ((msrCO & mask) != 0) ||
+        (((msrRI >> 8) & mask) != 0)    || ((msrRI & mask) != mask)) {
+        printf("KS10: DZ11 modem control loopback failed. MSR was %06o (CO) and %06o (RI).\n", msrCO, msrRI);
+        pass = false;
+    }
+
+    //
+    // Device clear, configure the lines, and enable maintenance loopback
+    //
+
+    ks10_t::writeIO(addrCSR, DZCSR_CLR);
+    while (ks10_t::readIO(addrCSR) & DZCSR_CLR) {
+        ;
+    }
+
+    for (unsigned int line = 0; line < numLINES; line++) {
+        memset(&soak[line], 0, sizeof(soak[line]));
+        soak[line].seed   = 0x2545f491 * (line + 1);
+        soak[line].latMin = 0xffffffff;
+        if (mask & (1 << line)) {
+            ks10_t::writeIO(addrLPR, DZLPR_RXEN | (baudCode(baud[line]) << 8) | DZLPR_8N1 | line);
+        }
+    }
+
+    ks10_t::writeIO(addrCSR, DZCSR_MSE | DZCSR_MAINT);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    //
+    // The test ends when everything has been received or when no line
+    // makes progress for a second.
+    //
+
+    uint32_t now = 0;
+    uint32_t progress = 0;
+    uint16_t tcr = 0;
+
+    for (;;) {
+
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        now = (ts.tv_sec - start.tv_sec) * 1000000 + (ts.tv_nsec - start.tv_nsec) / 1000;
+
+        //
+        // Receive
+        //
+
+        for (;;) {
+            uint16_t rbuf = ks10_t::readIO16(addrRBUF);
+            if ((rbuf & DZRBUF_VALID) == 0) {
+                break;
+            }
+            progress = now;
+            soak_t &s = soak[(rbuf >> 8) & 7];
+            uint8_t ch = rbuf & 0xff;
+            s.received++;
+            s.lastTime = now;
+            if (rbuf & DZRBUF_OVRE) {
+                s.overruns++;
+            }
+
+            unsigned int i = s.rxIndex;
+            while ((i < s.txIndex) && (s.ringChar[i % ringSIZE] != ch)) {
+                i++;
+            }
+
+            if (i == s.txIndex) {
+                s.errors++;
+                continue;
+            }
+
+            uint32_t latency = now - s.ringTime[i % ringSIZE];
+            s.lost   += i - s.rxIndex;
+            s.rxIndex = i + 1;
+            s.latSum += latency;
+            if (latency < s.latMin) {
+                s.latMin = latency;
+            }
+            if (latency > s.latMax) {
+                s.latMax = latency;
+            }
+            unsigned int bucket = 0;
+            while ((bucket < histSIZE - 1) && (latency >> (bucket + 1))) {
+                bucket++;
+            }
+            histogram[bucket]++;
+        }
+
+        //
+        // Transmit.  Limit the characters in flight to the history size.
+        //
+
+        uint16_t enable = 0;
+        bool done = true;
+        for (unsigned int line = 0; line < numLINES; line++) {
+            soak_t &s = soak[line];
+            if (mask & (1 << line)) {
+                if ((s.txIndex < count) && (s.txIndex - s.rxIndex < ringSIZE)) {
+                    enable |= 1 << line;
+                }
+                if (s.rxIndex < s.txIndex || s.txIndex < count) {
+                    done = false;
+                }
+            }
+        }
+
+        if (done || (now - progress > 1000000)) {
+            break;
+        }
+
+        if (enable != tcr) {
+            tcr = enable;
+            ks10_t::writeIO16(addrTCR, tcr);
+        }
+
+        uint16_t csr = ks10_t::readIO16(addrCSR);
+        if ((csr & DZCSR_TRDY) && tcr) {
+            unsigned int line = (csr >> 8) & 7;
+            if (tcr & (1 << line)) {
+                soak_t &s = soak[line];
+                s.seed ^= s.seed << 13;
+                s.seed ^= s.seed >> 17;
+                s.seed ^= s.seed << 5;
+                uint8_t ch = s.seed & 0xff;
+                s.ringChar[s.txIndex % ringSIZE] = ch;
+                s.ringTime[s.txIndex % ringSIZE] = now;
+                s.txIndex++;
+                ks10_t::writeIO16(addrTDR, ch);
+                progress = now;
+            } else {
+                tcr &= ~(1 << line);
+                ks10_t::writeIO16(addrTCR, tcr);
+            }
+        }
+    }
+
+    ks10_t::writeIO16(addrTCR, 0);
+    ks10_t::writeIO(addrCSR, DZCSR_CLR);
+
+    //
+    // Report
+    //
+
+    printf("KS10: DZ11 soak test results:\n"
+           "      Line   Baud     Sent Received     cps  Lost Errors Overruns   Latency min/avg/max (us)\n");
+
+    for (unsigned int line = 0; line < numLINES; line++) {
+        if ((mask & (1 << line)) == 0) {
+            continue;
+        }
+        soak_t &s = soak[line];
+        unsigned int matched = s.rxIndex - s.lost;
+        s.lost += s.txIndex - s.rxIndex;
+        double secs = s.lastTime / 1e6;
+        printf("      %4d %6d %8d %8d %7.1f %5d %6d %8d   %7u %7u %7u\n",
+               line, baud[line], s.txIndex, s.received, secs > 0 ? s.received / secs : 0.0,
+               s.lost, s.errors, s.overruns,
+               matched ? s.latMin : 0, matched ? (unsigned int)(s.latSum / matched) : 0, s.latMax);
+        if ((s.txIndex != count) || s.lost || s.errors || s.overruns) {
+            pass = false;
+        }
+    }
+
+    printf("\n"
+           "      Latency (us)           Count\n"
+           "      ------------------------ ----------\n");
+
+    for (unsigned int i = 0; i < histSIZE; i++) {
+        if (histogram[i] != 0) {
+            printf("      %10u - %10u %10u\n",
+                   i == 0 ? 0 : 1u << i, (i == histSIZE - 1) ? 0xffffffffu : (2u << i) - 1, histogram[i]);
+        }
+    }
+
+    printf("KS10: DZ11 soak test %s.\n", pass ? "passed" : "failed");
+    return pass;
+}
+
+//!
+//! \brief
+//!    Convert a baud rate to a Line Parameter Register speed code
+//!
+//! \param baud -
+//!    Baud rate
+//!
+//! \returns
+//!    Speed code (0-15) or -1 if the baud rate is not supported.
+//!
+
+int dz11_t::baudCode(unsigned int baud) {
+    static const unsigned int rates[16] = {
+        50, 75, 110, 134, 150, 300, 600, 1200,
+        1800, 2000, 2400, 3600, 4800, 7200, 9600, 19200,
+    };
+    for (int i = 0; i < 16; i++) {
+        if (rates[i] == baud) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//!
+//! \brief
+//!    Open the host side of a bridged line
+//!
+//! \details
+//!    The line is connected to a new PTY or, if a socket directory is
+//!    provided, to a Unix socket named "dz<line>" in that directory.
+//!
+//! \param line -
+//!    Line number (0-7)
+//!
+//! \param sockdir -
+//!    Socket directory or NULL for a PTY
+//!
+//! \returns
+//!    True if successful.
+//!
+
+bool dz11_t::bridgeOpen(unsigned int line, const char *sockdir) {
+
+    line_t &l = lines[line];
+    memset(&l, 0, sizeof(l));
+    l.fd  = -1;
+    l.lfd = -1;
+
+    if (sockdir == NULL) {
+
+        l.fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if ((l.fd < 0) || (grantpt(l.fd) != 0) || (unlockpt(l.fd) != 0)) {
+            printf("KS10: DZ11 line %d: Unable to open PTY. %s\n", line, strerror(errno));
+            bridgeClose(line);
+            return false;
+        }
+        strncpy(l.name, ptsname(l.fd), sizeof(l.name) - 1);
+
+        //
+        // Make the PTY raw.  The terminal does its own echo and editing.
+        //
+
+        int sfd = open(l.name, O_RDWR | O_NOCTTY);
+        if (sfd >= 0) {
+            struct termios tio;
+            if (tcgetattr(sfd, &tio) == 0) {
+                cfmakeraw(&tio);
+                tcsetattr(sfd, TCSANOW, &tio);
+            }
+            close(sfd);
+        }
+        fcntl(l.fd, F_SETFL, fcntl(l.fd, F_GETFL) | O_NONBLOCK);
+
+    } else {
+
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/dz%d", sockdir, line);
+        strncpy(l.name, addr.sun_path, sizeof(l.name) - 1);
+        unlink(addr.sun_path);
+
+        l.lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if ((l.lfd < 0) ||
+            (bind(l.lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+            (listen(l.lfd, 1) != 0)) {
+            printf("KS10: DZ11 line %d: Unable to open socket \"%s\". %s\n", line, l.name, strerror(errno));
+            bridgeClose(line);
+            return false;
+        }
+        fcntl(l.lfd, F_SETFL, fcntl(l.lfd, F_GETFL) | O_NONBLOCK);
+    }
+
+    return true;
+}
+
+//!
+//! \brief
+//!    Close the host side of a bridged line
+//!
+//! \param line -
+//!    Line number (0-7)
+//!
+
+void dz11_t::bridgeClose(unsigned int line) {
+
+    line_t &l = lines[line];
+
+    if (l.fd >= 0) {
+        close(l.fd);
+        l.fd = -1;
+    }
+
+    if (l.lfd >= 0) {
+        close(l.lfd);
+        unlink(l.name);
+        l.lfd = -1;
+    }
+}
+
+//!
+//! \brief
+//!    Move received characters from the DZ11 to the host
+//!
+//! \details
+//!    The receiver silo is emptied by reading RBUF until the Data Valid bit
+//!    is clear.  This avoids a CSR read per character.   The characters
+//!    are then written to the host with one write per line.
+//!
+//!    If the host is not keeping up, XOFF is sent to the terminal when the
+//!    line buffer is 3/4 full and XON is sent when it has drained to 1/4.
+//!
+//! \returns
+//!    Number of characters that were moved
+//!
+
+unsigned int dz11_t::bridgeRX(void) {
+
+    unsigned int count = 0;
+
+    while (count < maxSCAN) {
+        uint16_t rbuf = ks10_t::readIO16(addrRBUF);
+        if ((rbuf & DZRBUF_VALID) == 0) {
+            break;
+        }
+        count++;
+        unsigned int line = (rbuf >> 8) & 7;
+        line_t &l = lines[line];
+        if (rbuf & DZRBUF_OVRE) {
+            l.overruns++;
+        }
+        if (bridgeMask & (1 << line)) {
+            if (l.rxCount < bufSIZE) {
+                l.rxBuf[l.rxCount++] = rbuf & 0xff;
+            } else {
+                l.overruns++;
+            }
+            l.rxChars++;
+        }
+    }
+
+    for (unsigned int line = 0; line < numLINES; line++) {
+        line_t &l = lines[line];
+        if (l.rxCount == 0) {
+            continue;
+        }
+
+        //
+        // Characters are discarded when no client is connected
+        //
+
+        if (l.fd < 0) {
+            l.rxCount = 0;
+            continue;
+        }
+
+        ssize_t n = write(l.fd, l.rxBuf, l.rxCount);
+        if (n > 0) {
+            l.rxCount -= n;
+            memmove(l.rxBuf, &l.rxBuf[n], l.rxCount);
+        }
+
+        //
+        // Flow control
+        //
+
+        if (!l.stopped && (l.rxCount > 3 * bufSIZE / 4)) {
+            l.flowChar = 023;
+            l.stopped  = true;
+        } else if (l.stopped && (l.rxCount < bufSIZE / 4)) {
+            l.flowChar = 021;
+            l.stopped  = false;
+        }
+    }
+
+    return count;
+}
+
+//!
+//! \brief
+//!    Read characters from the host
+//!
+//! \details
+//!    The host is only read when there is room in the line buffer.  This
+//!    throttles the host to the line speed.
+//!
+//! \returns
+//!    Number of characters that were read
+//!
+
+unsigned int dz11_t::bridgeHost(void) {
+
+    unsigned int count = 0;
+
+    for (unsigned int line = 0; line < numLINES; line++) {
+        if ((bridgeMask & (1 << line)) == 0) {
+            continue;
+        }
+        line_t &l = lines[line];
+
+        //
+        // Accept a socket connection
+        //
+
+        if ((l.fd < 0) && (l.lfd >= 0)) {
+            l.fd = accept(l.lfd, NULL, NULL);
+            if (l.fd < 0) {
+                continue;
+            }
+            fcntl(l.fd, F_SETFL, fcntl(l.fd, F_GETFL) | O_NONBLOCK);
+        }
+
+        if (l.fd < 0) {
+            continue;
+        }
+
+        if (l.txHead != 0) {
+            memmove(l.txBuf, &l.txBuf[l.txHead], l.txCount);
+            l.txHead = 0;
+        }
+
+        if (l.txCount == bufSIZE) {
+            continue;
+        }
+
+        //
+        // A PTY returns EIO when the slave is not open.  A socket returns
+        // zero when the client disconnects.
+        //
+
+        ssize_t n = read(l.fd, &l.txBuf[l.txCount], bufSIZE - l.txCount);
+        if (n > 0) {
+            l.txCount += n;
+            count += n;
+        } else if ((n == 0) && (l.lfd >= 0)) {
+            close(l.fd);
+            l.fd = -1;
+        }
+    }
+
+    return count;
+}
+
+//!
+//! \brief
+//!    Transmit characters from the line buffers
+//!
+//! \details
+//!    The transmit enable in TCR is set for each line that has characters
+//!    to send.  The DZ11 scanner reports the next ready line in CSR[TLINE].
+//!
+//! \returns
+//!    Number of characters that were transmitted
+//!
+
+unsigned int dz11_t::bridgeTX(void) {
+
+    unsigned int count = 0;
+
+    //
+    // Enable the lines that have something to send.  Keep DTR asserted.
+    //
+
+    uint16_t tcr = bridgeMask << 8;
+    for (unsigned int line = 0; line < numLINES; line++) {
+        if (lines[line].txCount || lines[line].flowChar) {
+            tcr |= 1 << line;
+        }
+    }
+
+    if (tcr != bridgeTCR) {
+        bridgeTCR = tcr;
+        ks10_t::writeIO16(addrTCR, tcr);
+    }
+
+    while ((count < maxSCAN) && (bridgeTCR & 0xff)) {
+        uint16_t csr = ks10_t::readIO16(addrCSR);
+        if ((csr & DZCSR_TRDY) == 0) {
+            break;
+        }
+        unsigned int line = (csr >> 8) & 7;
+        line_t &l = lines[line];
+        if (l.flowChar) {
+            ks10_t::writeIO16(addrTDR, l.flowChar);
+            l.flowChar = 0;
+        } else if (l.txCount) {
+            ks10_t::writeIO16(addrTDR, l.txBuf[l.txHead++]);
+            l.txCount--;
+            l.txChars++;
+            count++;
+        }
+
+        //
+        // Disable the line when it has nothing left to send
+        //
+
+        if ((l.txCount == 0) && (l.flowChar == 0) && (bridgeTCR & (1 << line))) {
+            bridgeTCR &= ~(1 << line);
+            ks10_t::writeIO16(addrTCR, bridgeTCR);
+        }
+    }
+
+    return count;
+}
+
+//!
+//! \brief
+//!    Line bridge scan loop
+//!
+//! \details
+//!    The loop sleeps for a millisecond when there is no work.  At 19200
+//!    baud a line receives about two characters per millisecond so the
+//!    receiver silo will not overflow.
+//!
+//!    The loop exits if the KS10 is started because the operating system
+//!    then owns the DZ11 registers.  The console can not share them with
+//!    the KS10 and the FPGA has no other path to the line data.
+//!
+
+void dz11_t::bridgeLoop(void) {
+
+    while (bridgeRun) {
+        unsigned int count = bridgeRX() + bridgeHost() + bridgeTX();
+        if (count == 0) {
+            if (!ks10_t::halt()) {
+                printf("KS10: DZ11 bridge stopped because the CPU is running.\n");
+                break;
+            }
+            usleep(1000);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &bridgeEnd);
+    bridgeRun = false;
+}
+
+//!
+//! \brief
+//!    Start the line bridge
+//!
+//! \param mask -
+//!    Bit mask of lines to bridge
+//!
+//! \param baud -
+//!    Baud rate
+//!
+//! \param sockdir -
+//!    Directory for Unix sockets or NULL to use PTYs
+//!
+//! \returns
+//!    True if the bridge was started.
+//!
+
+bool dz11_t::bridgeStart(unsigned int mask, unsigned int baud, const char *sockdir) {
+
+    if (bridgeRun) {
+        printf("KS10: DZ11 bridge is already running.\n");
+        return false;
+    }
+
+    int code = baudCode(baud);
+    if (code < 0) {
+        printf("KS10: DZ11 baud rate of %d is not supported.\n", baud);
+        return false;
+    }
+
+    //
+    // Clean up after a previous bridge
+    //
+
+    bridgeStop();
+
+    mask &= 0xff;
+    for (unsigned int line = 0; line < numLINES; line++) {
+        lines[line].fd  = -1;
+        lines[line].lfd = -1;
+        if ((mask & (1 << line)) && !bridgeOpen(line, sockdir)) {
+            for (unsigned int i = 0; i < line; i++) {
+                bridgeClose(i);
+            }
+            return false;
+        }
+    }
+
+    //
+    // Device clear, configure the lines, assert DTR, and start scanning.
+    //
+
+    ks10_t::writeIO(addrCSR, DZCSR_CLR);
+    while (ks10_t::readIO(addrCSR) & DZCSR_CLR) {
+        ;
+    }
+
+    for (unsigned int line = 0; line < numLINES; line++) {
+        if (mask & (1 << line)) {
+            ks10_t::writeIO(addrLPR, DZLPR_RXEN | (code << 8) | DZLPR_8N1 | line);
+        }
+    }
+
+    bridgeMask = mask;
+    bridgeTCR  = mask << 8;
+    ks10_t::writeIO(addrTCR, bridgeTCR);
+    ks10_t::writeIO(addrCSR, DZCSR_MSE);
+
+    for (unsigned int line = 0; line < numLINES; line++) {
+        if (mask & (1 << line)) {
+            printf("KS10: DZ11 line %d is bridged to %s\n", line, lines[line].name);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &bridgeTime);
+    bridgeRun = true;
+    bridgeThread = std::thread(&dz11_t::bridgeLoop, this);
+
+    return true;
+}
+
+//!
+//! \brief
+//!    Stop the line bridge
+//!
+
+void dz11_t::bridgeStop(void) {
+
+    bridgeRun = false;
+    if (bridgeThread.joinable()) {
+        bridgeThread.join();
+    }
+
+    for (unsigned int line = 0; line < numLINES; line++) {
+        if (bridgeMask & (1 << line)) {
+            bridgeClose(line);
+        }
+    }
+}
+
+//!
+//! \brief
+//!    Print line bridge statistics
+//!
+
+void dz11_t::bridgeStat(void) {
+
+    if (bridgeMask == 0) {
+        printf("KS10: DZ11 bridge has not been started.\n");
+        return;
+    }
+
+    struct timespec now;
+    if (bridgeRun) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } else {
+        now = bridgeEnd;
+    }
+
+    double secs = (now.tv_sec - bridgeTime.tv_sec) + (now.tv_nsec - bridgeTime.tv_nsec) / 1e9;
+    if (secs <= 0) {
+        secs = 1e-9;
+    }
+
+    printf("KS10: DZ11 bridge is %s (%.1f seconds).\n"
+           "      Line     RX chars   RX cps     TX chars   TX cps  Overruns  Device\n",
+           bridgeRun ? "running" : "stopped", secs);
+
+    uint64_t rxTotal = 0;
+    uint64_t txTotal = 0;
+    unsigned int ovTotal = 0;
+
+    for (unsigned int line = 0; line < numLINES; line++) {
+        if ((bridgeMask & (1 << line)) == 0) {
+            continue;
+        }
+        const line_t &l = lines[line];
+        printf("      %4d %12llu %8.1f %12llu %8.1f %9u  %s%s\n", line,
+               (unsigned long long)l.rxChars, l.rxChars / secs,
+               (unsigned long long)l.txChars, l.txChars / secs,
+               l.overruns, l.name, l.stopped ? " (XOFF)" : "");
+        rxTotal += l.rxChars;
+        txTotal += l.txChars;
+        ovTotal += l.overruns;
+    }
+
+    printf("      All  %12llu %8.1f %12llu %8.1f %9u\n",
+           (unsigned long long)rxTotal, rxTotal / secs,
+           (unsigned long long)txTotal, txTotal / secs, ovTotal);
+}
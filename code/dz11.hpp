@@ -9,6 +9,13 @@
 //!    This object allows the console to interact with the DZ11 Terminal
 //!    Multiplexer.   This is mostly for testing the DZ11 from the console.
 //!
+//!    The line bridge connects DZ11 lines to host PTYs or Unix sockets.  The
+//!    console drives the DZ11 registers itself, so a terminal that is wired
+//!    to a DZ11 port becomes a host terminal on the console processor.  The
+//!    KS10 does not see the host PTY.  The FPGA has no path from the console
+//!    to the DZ11 line data, so the bridge can not present a host PTY to the
+//!    KS10 as a DZ11 terminal, and it only runs while the KS10 is halted.
+//!
 //! \file
 //!    dz11.hpp
 //!
@@ -39,6 +46,11 @@
 #ifndef __DZ11_HPP
 #define __DZ11_HPP
 
+#include <thread>
+
+#include <time.h>
+#include <stdint.h>
+
 #include "uba.hpp"
 #include "ks10.hpp"
 
@@ -80,6 +92,50 @@ class dz11_t {
 
         void setup(unsigned int line);
 
+        //
+        // Line bridge
+        //
+
+        static const unsigned int numLINES = 8;         //!< Lines per DZ11
+        static const unsigned int bufSIZE  = 256;       //!< Line buffer size
+        static const unsigned int maxSCAN  = 64;        //!< Characters per scan
+
+        //!
+        //! \brief
+        //!    Bridged line state
+        //!
+
+        struct line_t {
+            int fd;                             //!< PTY master or connected socket
+            int lfd;                            //!< Listening socket (socket mode)
+            char name[108];                     //!< PTY slave or socket path
+            uint8_t rxBuf[bufSIZE];             //!< DZ11 to host characters
+            unsigned int rxCount;               //!< Characters in rxBuf
+            uint8_t txBuf[bufSIZE];             //!< Host to DZ11 characters
+            unsigned int txHead;                //!< Next character in txBuf
+            unsigned int txCount;               //!< Characters in txBuf
+            uint8_t flowChar;                   //!< XOFF or XON to send
+            bool stopped;                       //!< XOFF sent to terminal
+            uint64_t rxChars;                   //!< Characters received
+            uint64_t txChars;                   //!< Characters transmitted
+            unsigned int overruns;              //!< RBUF overrun errors
+        };
+
+        line_t lines[numLINES];
+        unsigned int bridgeMask;
+        uint16_t bridgeTCR;
+        volatile bool bridgeRun;
+        std::thread bridgeThread;
+        struct timespec bridgeTime;
+        struct timespec bridgeEnd;
+
+        bool bridgeOpen(unsigned int line, const char *sockdir);
+        void bridgeClose(unsigned int line);
+        unsigned int bridgeRX(void);
+        unsigned int bridgeHost(void);
+        unsigned int bridgeTX(void);
+        void bridgeLoop(void);
+
     public:
 
         uint16_t readTCR(void) {
@@ -107,6 +163,23 @@ class dz11_t {
         static const ks10_t::data_t DZCSR_RDONE = 0x0080;         //!< Receiver Done
         static const ks10_t::data_t DZCSR_MSE   = 0x0020;         //!< Master Scan Enable
         static const ks10_t::data_t DZCSR_CLR   = 0x0010;         //!< Clear
+        static const ks10_t::data_t DZCSR_MAINT = 0x0008;         //!< Maintenance Loopback
+
+        //
+        //! Receiver Buffer (RBUF) definitions
+        //
+
+        static const ks10_t::data_t DZRBUF_VALID = 0x8000;        //!< Data Valid
+        static const ks10_t::data_t DZRBUF_OVRE  = 0x4000;        //!< Overrun Error
+        static const ks10_t::data_t DZRBUF_FRME  = 0x2000;        //!< Framing Error
+        static const ks10_t::data_t DZRBUF_PARE  = 0x1000;        //!< Parity Error
+
+        //
+        //! Line Parameter Register (LPR) definitions
+        //
+
+        static const ks10_t::data_t DZLPR_RXEN  = 0x1000;         //!< Receiver Enable
+        static const ks10_t::data_t DZLPR_8N1   = 0x0018;         //!< 8 bits, no parity, 1 stop
 
         //
         // Public Functions
@@ -115,7 +188,21 @@ class dz11_t {
         void testTX(int line);
         void testRX(int line);
         void testECHO(int line);
-        void dumpRegs(void);
+        bool testSOAK(unsigned int mask, const unsigned int baud[8], unsigned int count);
+        void dumpRegs(bool script = false);
+        bool bridgeStart(unsigned int mask, unsigned int baud, const char *sockdir);
+        void bridgeStop(void);
+        void bridgeStat(void);
+        static int baudCode(unsigned int baud);
+
+        //!
+        //! \brief
+        //!    Returns true if the line bridge is running
+        //!
+
+        bool bridgeActive(void) {
+            return bridgeRun;
+        }
 
         //!
         //! \brief
@@ -129,9 +216,21 @@ class dz11_t {
             addrTCR ((baseADDR & 07777770) + offsetTCR ),
             addrMSR ((baseADDR & 07777770) + offsetMSR ),
             addrTDR ((baseADDR & 07777770) + offsetTDR ),
-            uba(baseADDR) {
+            uba(baseADDR),
+            bridgeMask(0),
+            bridgeTCR(0),
+            bridgeRun(false) {
                 ;
         }
+
+        //!
+        //! \brief
+        //!    Destructor.  Stop the line bridge.
+        //!
+
+        ~dz11_t(void) {
+            bridgeStop();
+        }
 };
 
 #endif
@@ -0,0 +1,327 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    KMC11 Interface Object
+//!
+//! \details
+//!    This object allows the console to interact with the KMC11 General
+//!    Purpose Microprocessor.
+//!
+//! \file
+//!    kmc11.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#include <stdio.h>
+#include <ctype.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "uba.hpp"
+#include "kmc11.hpp"
+
+//!
+//! \brief
+//!    Write the maintenance bits (BSEL1)
+//!
+//! \details
+//!    The low byte of SEL0 (BSEL0) is preserved.
+//!
+//! \param maint -
+//!    Maintenance bits
+//!
+
+void kmc11_t::writeMAINT(uint16_t maint) {
+    uint16_t sel0 = ks10_t::readIO16(addrSEL0);
+    ks10_t::writeIO16(addrSEL0, (sel0 & ~KMCSEL0_MAINT) | (maint & KMCSEL0_MAINT));
+}
+
+//!
+//! \brief
+//!    Dump KMC11 registers
+//!
+
+void kmc11_t::dumpRegs(void) {
+
+    uint16_t sel0 = ks10_t::readIO16(addrSEL0);
+
+    printf("KS10: kmc register dump\n"
+           "      UBAS : %012llo\n"
+           "      SEL0 : %06o\n"
+           "      SEL2 : %06o\n"
+           "      SEL4 : %06o\n"
+           "      SEL6 : %06o\n"
+           "      State: %s%s%s\n",
+           uba.readCSR(),
+           sel0,
+           ks10_t::readIO16(addrSEL2),
+           ks10_t::readIO16(addrSEL4),
+           ks10_t::readIO16(addrSEL6),
+           (sel0 & KMCSEL0_RUN)    ? "Running" : "Stopped",
+           (sel0 & KMCSEL0_LULOOP) ? ", Line Unit Loopback" : "",
+           (sel0 & KMCSEL0_CRAMOUT) ? ", CRAM Out" : "");
+}
+
+//!
+//! \brief
+//!    Load the KMC11 Control RAM
+//!
+//! \details
+//!    The file is either a binary image of little-endian 16-bit words
+//!    starting at CRAM address 0, or a text file.  Each line of a text file
+//!    contains an octal word, or an octal address and an octal word
+//!    separated by a slash or colon.  Text following a semicolon or '#' is
+//!    ignored.
+//!
+//!    The image is parsed before the KMC11 is touched.  The KMC11 is then
+//!    stopped and each word is written using the maintenance registers:
+//!    SEL4 is loaded with the address, SEL6 with the microinstruction, and
+//!    CRAM WR is pulsed while CRAM OUT is asserted.
+//!
+//! \param filename -
+//!    Microcode file
+//!
+//! \returns
+//!    True if successful.
+//!
+
+bool kmc11_t::loadCRAM(const char *filename) {
+
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        printf("KS10: Unable to open \"%s\". %s\n", filename, strerror(errno));
+        return false;
+    }
+
+    static uint8_t buf[4 * sizeCRAM * 8];
+    size_t len = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+
+    //
+    // It is a text file if every character is printable or white space
+    //
+
+    bool text = true;
+    for (size_t i = 0; i < len; i++) {
+        if (!isprint(buf[i]) && !isspace(buf[i])) {
+            text = false;
+            break;
+        }
+    }
+
+    static uint16_t cram[sizeCRAM];
+    bool valid[sizeCRAM] = {};
+    unsigned int words = 0;
+    unsigned int high  = 0;
+
+    if (text) {
+        char *line = reinterpret_cast<char *>(buf);
+        buf[len < sizeof(buf) ? len : sizeof(buf) - 1] = 0;
+        unsigned int addr = 0;
+        unsigned int lineNum = 0;
+        while (line && *line) {
+            char *next = strchr(line, '\n');
+            if (next) {
+                *next++ = 0;
+            }
+            lineNum++;
+            char *comment = strpbrk(line, ";#");
+            if (comment) {
+                *comment = 0;
+            }
+            unsigned int a;
+            unsigned int d;
+            if (sscanf(line, "%o%*[/:]%o", &a, &d) == 2) {
+                addr = a;
+            } else if (sscanf(line, "%o", &d) != 1) {
+                line = next;
+                continue;
+            }
+            if ((addr >= sizeCRAM) || (d > 0177777)) {
+                printf("KS10: \"%s\" line %d: address or data out of range.\n", filename, lineNum);
+                return false;
+            }
+            cram[addr]  = d;
+            valid[addr] = true;
+            if (addr >= high) {
+                high = addr + 1;
+            }
+            addr++;
+            line = next;
+        }
+    } else {
+        if ((len & 1) || (len > 2 * sizeCRAM)) {
+            printf("KS10: \"%s\" is not a KMC11 microcode image.\n", filename);
+            return false;
+        }
+        for (unsigned int addr = 0; addr < len / 2; addr++) {
+            cram[addr]  = buf[2 * addr] | (buf[2 * addr + 1] << 8);
+            valid[addr] = true;
+        }
+        high = len / 2;
+    }
+
+    //
+    // Stop the microprocessor and load the CRAM
+    //
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    writeMAINT(KMCSEL0_MCLR);
+    writeMAINT(KMCSEL0_CRAMOUT);
+
+    for (unsigned int addr = 0; addr < high; addr++) {
+        if (valid[addr]) {
+            ks10_t::writeIO16(addrSEL4, addr);
+            ks10_t::writeIO16(addrSEL6, cram[addr]);
+            writeMAINT(KMCSEL0_CRAMOUT | KMCSEL0_CRAMWR);
+            words++;
+        }
+    }
+
+    writeMAINT(0);
+
+    struct timespec finish;
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    double msec = (finish.tv_sec - start.tv_sec) * 1e3 + (finish.tv_nsec - start.tv_nsec) / 1e6;
+
+    printf("KS10: Loaded %d words of KMC11 microcode from \"%s\" in %.1f ms.\n", words, filename, msec);
+    return true;
+}
+
+//!
+//! \brief
+//!    Master clear and start the KMC11
+//!
+
+void kmc11_t::start(void) {
+    writeMAINT(KMCSEL0_MCLR);
+    writeMAINT(KMCSEL0_RUN);
+}
+
+//!
+//! \brief
+//!    Stop the KMC11
+//!
+
+void kmc11_t::stop(void) {
+    writeMAINT(0);
+}
+
+//!
+//! \brief
+//!    Single step the KMC11 microprocessor
+//!
+
+void kmc11_t::step(void) {
+    writeMAINT(KMCSEL0_STEP);
+    writeMAINT(0);
+}
+
+//!
+//! \brief
+//!    Sample the KMC11
+//!
+//! \details
+//!    The SEL registers are sampled as fast as possible for the sample
+//!    period.  The fraction of samples with RUN asserted is the execution
+//!    duty.  A DMC11 or DMR11 transfers each buffer by DMA and then performs
+//!    one port handshake with the KS10 (RDYI or RDYO).  The handshake rate
+//!    is therefore the rate of DMA buffer transfers, and the rate at which
+//!    the KS10 is interrupted.
+//!
+//!    Register changes are counted as a rough measure of microprocessor
+//!    activity.
+//!
+//! \param msec -
+//!    Sample period in milliseconds
+//!
+
+void kmc11_t::sample(unsigned int msec) {
+
+    unsigned int samples = 0;
+    unsigned int running = 0;
+    unsigned int rdyi    = 0;
+    unsigned int rdyo    = 0;
+    unsigned int changes = 0;
+
+    uint16_t last0 = ks10_t::readIO16(addrSEL0);
+    uint16_t last2 = ks10_t::readIO16(addrSEL2);
+    uint16_t last4 = ks10_t::readIO16(addrSEL4);
+    uint16_t last6 = ks10_t::readIO16(addrSEL6);
+
+    struct timespec start;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    double elapsed = 0;
+    while (elapsed < msec) {
+
+        uint16_t sel0 = ks10_t::readIO16(addrSEL0);
+        uint16_t sel2 = ks10_t::readIO16(addrSEL2);
+        uint16_t sel4 = ks10_t::readIO16(addrSEL4);
+        uint16_t sel6 = ks10_t::readIO16(addrSEL6);
+
+        samples++;
+        if (sel0 & KMCSEL0_RUN) {
+            running++;
+        }
+        if ((sel0 & KMCSEL0_RDYI) && !(last0 & KMCSEL0_RDYI)) {
+            rdyi++;
+        }
+        if ((sel2 & KMCSEL2_RDYO) && !(last2 & KMCSEL2_RDYO)) {
+            rdyo++;
+        }
+        if ((sel0 != last0) || (sel2 != last2) || (sel4 != last4) || (sel6 != last6)) {
+            changes++;
+        }
+
+        last0 = sel0;
+        last2 = sel2;
+        last4 = sel4;
+        last6 = sel6;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed = (now.tv_sec - start.tv_sec) * 1e3 + (now.tv_nsec - start.tv_nsec) / 1e6;
+    }
+
+    double secs = elapsed / 1e3;
+
+    printf("KS10: KMC11 sampled %d times in %.3f seconds.\n"
+           "      Running          : %5.1f%%\n"
+           "      Register changes : %8d (%.1f/sec)\n"
+           "      RDYI handshakes  : %8d (%.1f/sec)\n"
+           "      RDYO handshakes  : %8d (%.1f/sec)\n",
+           samples, secs,
+           samples ? 100.0 * running / samples : 0.0,
+           changes, changes / secs,
+           rdyi, rdyi / secs,
+           rdyo, rdyo / secs);
+}
@@ -0,0 +1,156 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    KMC11 Interface Object
+//!
+//! \details
+//!    This object allows the console to interact with the KMC11 General
+//!    Purpose Microprocessor.  The console can load the KMC11 Control RAM
+//!    (CRAM) with microcode (for example the DMC11 or DMR11 images), start
+//!    and stop the microprocessor, and sample its state.
+//!
+//!    The KMC11 has no hardware performance counters.  The statistics are
+//!    collected by sampling the SEL registers.
+//!
+//! \file
+//!    kmc11.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+
+#ifndef __KMC11_HPP
+#define __KMC11_HPP
+
+#include <stdint.h>
+
+#include "uba.hpp"
+#include "ks10.hpp"
+
+//!
+//! \brief
+//!    KMC11 Interface Object
+//!
+
+class kmc11_t {
+    private:
+
+        //
+        // Register offsets
+        //
+
+        const ks10_t::addr_t offsetSEL0 = 00;
+        const ks10_t::addr_t offsetSEL2 = 02;
+        const ks10_t::addr_t offsetSEL4 = 04;
+        const ks10_t::addr_t offsetSEL6 = 06;
+
+        //
+        // Register Addresses
+        //
+
+        const ks10_t::addr_t addrSEL0;
+        const ks10_t::addr_t addrSEL2;
+        const ks10_t::addr_t addrSEL4;
+        const ks10_t::addr_t addrSEL6;
+
+        //
+        // UBA object
+        //
+
+        uba_t uba;
+
+        void writeMAINT(uint16_t maint);
+
+    public:
+
+        //
+        // KMC11 Base Address
+        //
+
+        static const uint32_t baseADDR1 = 03760540;      //!< base address #1
+
+        //
+        // CRAM size in words
+        //
+
+        static const unsigned int sizeCRAM = 1024;
+
+        //
+        //! SEL0 Maintenance Register (BSEL1) definitions
+        //
+
+        static const uint16_t KMCSEL0_RUN     = 0x8000;    //!< Run
+        static const uint16_t KMCSEL0_MCLR    = 0x4000;    //!< Master Clear
+        static const uint16_t KMCSEL0_CRAMWR  = 0x2000;    //!< CRAM Write
+        static const uint16_t KMCSEL0_LUSTEP  = 0x1000;    //!< Line Unit Step
+        static const uint16_t KMCSEL0_LULOOP  = 0x0800;    //!< Line Unit Loopback
+        static const uint16_t KMCSEL0_CRAMOUT = 0x0400;    //!< CRAM Out
+        static const uint16_t KMCSEL0_CRAMIN  = 0x0200;    //!< CRAM In
+        static const uint16_t KMCSEL0_STEP    = 0x0100;    //!< Step Microprocessor
+        static const uint16_t KMCSEL0_MAINT   = 0xff00;    //!< Maintenance Bits
+
+        //
+        //! DMC11/DMR11 port handshake definitions
+        //
+
+        static const uint16_t KMCSEL0_RDYI    = 0x0080;    //!< Ready In (SEL0)
+        static const uint16_t KMCSEL2_RDYO    = 0x0080;    //!< Ready Out (SEL2)
+
+        //
+        // Public Functions
+        //
+
+        bool loadCRAM(const char *filename);
+        void start(void);
+        void stop(void);
+        void step(void);
+        void dumpRegs(void);
+        void sample(unsigned int msec);
+
+        //!
+        //! \brief
+        //!    Returns true if the KMC11 is running
+        //!
+
+        bool isRunning(void) {
+            return ks10_t::readIO16(addrSEL0) & KMCSEL0_RUN;
+        }
+
+        //!
+        //! \brief
+        //!    Constructor. Setup register addresses.
+        //!
+
+        kmc11_t(uint32_t baseADDR = baseADDR1) :
+            addrSEL0((baseADDR & 07777770) + offsetSEL0),
+            addrSEL2((baseADDR & 07777770) + offsetSEL2),
+            addrSEL4((baseADDR & 07777770) + offsetSEL4),
+            addrSEL6((baseADDR & 07777770) + offsetSEL6),
+            uba(baseADDR) {
+            ;
+        }
+};
+
+#endif
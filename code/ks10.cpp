@@ -52,6 +52,12 @@
 int ks10_t::fd;                                         //!< /dev/mem file descriptor
 bool ks10_t::debug;                                     //!< Debug mode
 std::mutex ks10_t::fpga_mutex;                          //!< FPGA access mutex
+unsigned int ks10_t::epoch;                             //!< CPU start/reset count
+std::mutex ks10_t::halt_mutex;                          //!< Halt ring mutex
+ks10_t::hsb_t ks10_t::halts[numHalts];                  //!< Ring of recent halts
+unsigned int ks10_t::haltCount;                         //!< Halts recorded
+volatile bool ks10_t::haltRecord = true;                //!< Halt thread records halts
+ks10_t::addr_t ks10_t::hsbAddress = hsbDefault;         //!< Last Halt Status Block address
 char *ks10_t::fpgaAddrVirt;                             //!< FPGA Base Virtual Address
 
 volatile ks10_t::addr_t *ks10_t::regAddr;               //!< Console Address Register
@@ -877,6 +883,99 @@ ks10_t::data_t ks10_t::readAC(ks10_t::data_t regAC) {
     return executeInstructionAndGetData(insnMOVEM, tempAddr);
 }
 
+//!
+//! \brief
+//!    Read the ACs and processor registers
+//!
+//! \details
+//!    The rdXXX() and readAC() functions each save the temporary location,
+//!    execute one instruction, read the result, and restore the temporary
+//!    location under their own lock.  This function executes the whole set
+//!    of instructions under one lock and saves and restores the temporary
+//!    location once.
+//!
+//!    Each result is read before the next instruction is loaded into the
+//!    CIR, the same as the single instruction functions.
+//!
+//! \param [out] snap -
+//!    CPU state
+//!
+//! \param regs -
+//!    Read the processor registers.  If false, only the PC, IR, and ACs are
+//!    read.
+//!
+//! \note
+//!    The KS10 must be halted.
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+void ks10_t::snapshot(snapshot_t &snap, bool regs) {
+
+    const addr_t tempAddr = 0100;
+
+    static const struct {
+        data_t opcode;
+        data_t snapshot_t::*reg;
+    } regList[] = {
+        {opAPRID,  &snapshot_t::aprid },
+        {opRDAPR,  &snapshot_t::apr   },
+        {opRDPI,   &snapshot_t::pi    },
+        {opRDUBR,  &snapshot_t::ubr   },
+        {opRDEBR,  &snapshot_t::ebr   },
+        {opRDSPB,  &snapshot_t::spb   },
+        {opRDCSB,  &snapshot_t::csb   },
+        {opRDCSTM, &snapshot_t::cstm  },
+        {opRDPUR,  &snapshot_t::pur   },
+        {opRDINT,  &snapshot_t::intrvl},
+        {opRDHSB,  &snapshot_t::hsb   },
+    };
+
+    lockMutex();
+    snap.pcir = *regPCIR;
+    const data_t tempData0 = __readMem(tempAddr + 0);
+    for (data_t regAC = 0; regAC < 020; regAC++) {
+        __executeInstruction((opMOVEM << 18) | (regAC << 23) | tempAddr);
+        snap.ac[regAC] = __readMem(tempAddr);
+    }
+    if (regs) {
+        for (unsigned int i = 0; i < sizeof(regList) / sizeof(regList[0]); i++) {
+            __executeInstruction((regList[i].opcode << 18) | tempAddr);
+            snap.*regList[i].reg = __readMem(tempAddr);
+        }
+        const data_t tempData1 = __readMem(tempAddr + 1);
+        __executeInstruction((opRDTIM << 18) | tempAddr);
+        snap.tim[0] = __readMem(tempAddr + 0);
+        snap.tim[1] = __readMem(tempAddr + 1);
+        __writeMem(tempAddr + 1, tempData1);
+    }
+    __writeMem(tempAddr + 0, tempData0);
+    unlockMutex();
+}
+
+//!
+//! \brief
+//!    Return the name of a halt cause
+//!
+//! \param hsw -
+//!    Halt Status Word (contents of location 0)
+//!
+
+const char *ks10_t::haltCause(data_t hsw) {
+    switch (hsw) {
+        case 00000: return "Microcode Startup.";
+        case 00001: return "Halt Instruction.";
+        case 00002: return "Console Halt.";
+        case 00100: return "IO Page Failure.";
+        case 00101: return "Illegal Interrupt Instruction.";
+        case 00102: return "Pointer to Unibus Vector is zero.";
+        case 01000: return "Illegal Microcode Dispatch.";
+        case 01005: return "Microcode Startup Check Failed.";
+        default:    return "Unknown.";
+    }
+}
+
 //!
 //! \brief
 //!    Print Halt Status Word
@@ -892,30 +991,33 @@ void ks10_t::printHaltStatusWord(void) {
     lockMutex();
     data_t hswStatus = __readMem(0);
     data_t hswPC     = __readMem(1);
-
-    printf("KS10: Halt Cause: %s (PC=%06llo)\n",
-           (hswStatus== 00000 ? "Microcode Startup."                     :
-            (hswStatus== 00001 ? "Halt Instruction."                     :
-             (hswStatus== 00002 ? "Console Halt."                        :
-              (hswStatus== 00100 ? "IO Page Failure."                    :
-               (hswStatus== 00101 ? "Illegal Interrupt Instruction."     :
-                (hswStatus== 00102 ? "Pointer to Unibus Vector is zero." :
-                 (hswStatus== 01000 ? "Illegal Microcode Dispatch."      :
-                  (hswStatus== 01005 ? "Microcode Startup Check Failed." :
-                   "Unknown.")))))))),
-           hswPC);
     unlockMutex();
+    printf("KS10: Halt Cause: %s (PC=%06llo)\n", haltCause(hswStatus), hswPC);
 }
 
 //!
 //! \brief
-//!    Print Halt Status Block
+//!    Read the Halt Status Word and Halt Status Block
 //!
 //! \details
-//!    This function prints the Halt Status Word and the Halt Status Block.
+//!    The Halt Status Word, the RDHSB instruction, and the 17 words of the
+//!    Halt Status Block are read in one locked sequence.  The CPU is checked
+//!    inside the lock so that the RDHSB instruction is never executed while
+//!    another thread has continued the CPU.
 //!
-//!    The code executes a RDHSB instruction in the Console Instruction
-//!    Register to get the address of the Halt Status Block from the CPU.
+//!    Executing RDHSB reloads PCIR and pushes an entry into the trace
+//!    buffer.  When exec is false no instruction is executed and the block
+//!    is read from the address that the last RDHSB returned.  Until then
+//!    that is the address that the microcode uses at power-up.
+//!
+//! \param [out] hsb -
+//!    Halt status
+//!
+//! \param [in] exec -
+//!    Execute RDHSB to find the Halt Status Block
+//!
+//! \returns
+//!    false if the CPU is running
 //!
 //! \note
 //!    The KS10 Technical Manual shows that the Halt Status Block include the
@@ -925,54 +1027,95 @@ void ks10_t::printHaltStatusWord(void) {
 //!    This function is thread safe.
 //!
 
-void ks10_t::printHaltStatusBlock(void) {
-
-    lockMutex();
-    data_t hswStatus = __readMem(0);
-    data_t hswPC     = __readMem(1);
+bool ks10_t::readHSB(hsb_t &hsb, bool exec) {
 
-    printf("KS10: Halt Cause: %s (PC=%06llo)\n",
-           (hswStatus== 00000 ? "Microcode Startup."                     :
-            (hswStatus== 00001 ? "Halt Instruction."                     :
-             (hswStatus== 00002 ? "Console Halt."                        :
-              (hswStatus== 00100 ? "IO Page Failure."                    :
-               (hswStatus== 00101 ? "Illegal Interrupt Instruction."     :
-                (hswStatus== 00102 ? "Pointer to Unibus Vector is zero." :
-                 (hswStatus== 01000 ? "Illegal Microcode Dispatch."      :
-                  (hswStatus== 01005 ? "Microcode Startup Check Failed." :
-                   "Unknown.")))))))),
-           hswPC);
+    static data_t hsb_t::*const regList[] = {
+        &hsb_t::mag, &hsb_t::pc,  &hsb_t::hr,  &hsb_t::ar,  &hsb_t::arx,
+        &hsb_t::br,  &hsb_t::brx, &hsb_t::one, &hsb_t::ebr, &hsb_t::ubr,
+        &hsb_t::msk, &hsb_t::flg, &hsb_t::pi,  &hsb_t::x1,  &hsb_t::t0,
+        &hsb_t::t1,  &hsb_t::vma,
+    };
 
-#if 1
+    const addr_t tempAddr  = 0100;
+    const data_t insnRDHSB = opRDHSB << 18 | tempAddr;
 
-    //
-    // Check CPU status
-    //
+    clock_gettime(CLOCK_REALTIME, &hsb.time);
 
-    if (!ks10_t::__halt()) {
-        printf("KS10: CPU is running. Halt it first.\n");
-        return;
+    lockMutex();
+    if (!__halt()) {
+        unlockMutex();
+        return false;
+    }
+    hsb.hsw     = __readMem(0);
+    hsb.hswPC   = __readMem(1);
+    hsb.hsbAddr = 0;
+    for (unsigned int i = 0; i < sizeof(regList) / sizeof(regList[0]); i++) {
+        hsb.*regList[i] = 0;
     }
 
     //
-    // Read the address of the Halt Status Block
+    // The microcode has not written a Halt Status Block yet at startup
     //
 
-    const addr_t tempAddr  = 0100;
-    const data_t insnRDHSB = opRDHSB << 18 | tempAddr;
-    ks10_t::addr_t hsbAddr = __executeInstructionAndGetData(insnRDHSB, tempAddr);
-
-#else
+    if (hsb.hsw != 00000) {
+        if (exec) {
+            hsbAddress = __executeInstructionAndGetData(insnRDHSB, tempAddr) & memAddrMask;
+        }
+        hsb.hsbAddr = hsbAddress;
+        for (unsigned int i = 0; i < sizeof(regList) / sizeof(regList[0]); i++) {
+            hsb.*regList[i] = __readMem(hsb.hsbAddr + i);
+        }
+    }
+    unlockMutex();
+    return true;
+}
 
-    ks10_t::addr_t hsbAddr = 0376000ULL;
+//!
+//! \brief
+//!    Read the PC, IR, and Halt Status Word
+//!
+//! \details
+//!    PCIR and the Halt Status Word are read together in one locked
+//!    sequence so that no console instruction can reload PCIR between
+//!    them.
+//!
+//! \param [out] pcir -
+//!    PC and IR of the last instruction
+//!
+//! \param [out] hsw -
+//!    Halt Status Word (halt cause)
+//!
+//! \param [out] hswPC -
+//!    Halt Status PC
+//!
+//! \returns
+//!    false if the CPU is running
+//!
+//! \note
+//!    This function is thread safe.
+//!
 
-#endif
+bool ks10_t::readHaltStatus(data_t &pcir, data_t &hsw, data_t &hswPC) {
+    lockMutex();
+    bool halted = __halt();
+    pcir  = *regPCIR;
+    hsw   = __readMem(0);
+    hswPC = __readMem(1);
+    unlockMutex();
+    return halted;
+}
 
-    //
-    // Print the Halt Status Block
-    //
+//!
+//! \brief
+//!    Print a Halt Status Word and Halt Status Block
+//!
+//! \param hsb -
+//!    Halt status
+//!
 
-    printf("      Halt Status Block Address is %06llo\n"
+void ks10_t::printHSB(const hsb_t &hsb) {
+    printf("KS10: Halt Cause: %s (PC=%06llo)\n"
+           "      Halt Status Block Address is %06llo\n"
            "      PC  is %012llo     HR  is %012llo\n"
            "      MAG is %012llo     ONE is %012llo\n"
            "      AR  is %012llo     ARX is %012llo\n"
@@ -982,25 +1125,123 @@ void ks10_t::printHaltStatusBlock(void) {
            "      PI  is %012llo     X1  is %012llo\n"
            "      TO  is %012llo     T1  is %012llo \n"
            "      VMA is %012llo\n",
-           hsbAddr,
-           __readMem(hsbAddr +  1),     // PC
-           __readMem(hsbAddr +  2),     // HR
-           __readMem(hsbAddr +  0),     // MAG
-           __readMem(hsbAddr +  7),     // ONE
-           __readMem(hsbAddr +  3),     // AR
-           __readMem(hsbAddr +  4),     // ARX
-           __readMem(hsbAddr +  5),     // BR
-           __readMem(hsbAddr +  6),     // BRX
-           __readMem(hsbAddr +  8),     // EBR
-           __readMem(hsbAddr +  9),     // UBR
-           __readMem(hsbAddr + 10),     // MASK
-           __readMem(hsbAddr + 11),     // FLG
-           __readMem(hsbAddr + 12),     // PI
-           __readMem(hsbAddr + 13),     // X1
-           __readMem(hsbAddr + 14),     // T0
-           __readMem(hsbAddr + 15),     // T1
-           __readMem(hsbAddr + 16));    // VMA
-    unlockMutex();
+           haltCause(hsb.hsw), hsb.hswPC,
+           hsb.hsbAddr,
+           hsb.pc,  hsb.hr,
+           hsb.mag, hsb.one,
+           hsb.ar,  hsb.arx,
+           hsb.br,  hsb.brx,
+           hsb.ebr, hsb.ubr,
+           hsb.msk, hsb.flg,
+           hsb.pi,  hsb.x1,
+           hsb.t0,  hsb.t1,
+           hsb.vma);
+}
+
+//!
+//! \brief
+//!    Print Halt Status Block
+//!
+//! \details
+//!    This function prints the Halt Status Word, the Halt Status Block, and
+//!    the ACs.
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+void ks10_t::printHaltStatusBlock(void) {
+
+    hsb_t hsb;
+    if (!readHSB(hsb)) {
+        printHaltStatusWord();
+        printf("KS10: CPU is running. Halt it first.\n");
+        return;
+    }
+    printHSB(hsb);
+
+    snapshot_t snap;
+    snapshot(snap, false);
+    for (unsigned int i = 0; i < 020; i += 4) {
+        printf("      AC%02o is %012llo %012llo %012llo %012llo\n", i,
+               snap.ac[i], snap.ac[i+1], snap.ac[i+2], snap.ac[i+3]);
+    }
+}
+
+//!
+//! \brief
+//!    Record a halt
+//!
+//! \details
+//!    The halt status is read and saved in a ring of the most recent halts.
+//!    This is called by the halt status thread on every halt.
+//!
+//!    No instruction is executed, so recording a halt does not disturb PCIR
+//!    or the trace buffer.
+//!
+//! \param [in] force -
+//!    Record the halt even if recording has been disabled by recordHalts()
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+void ks10_t::recordHalt(bool force) {
+    if (!force && !haltRecord) {
+        return;
+    }
+    hsb_t hsb;
+    if (readHSB(hsb, false)) {
+        std::lock_guard<std::mutex> lock(halt_mutex);
+        halts[haltCount % numHalts] = hsb;
+        haltCount += 1;
+    }
+}
+
+//!
+//! \brief
+//!    Enable or disable halt recording by the halt status thread
+//!
+//! \details
+//!    The breakpoint manager disables recording while breakpoints are
+//!    armed so that the halts that it continues do not fill the ring.  It
+//!    records the halts that it does not continue itself.
+//!
+//! \param [in] enable -
+//!    true to record halts
+//!
+
+void ks10_t::recordHalts(bool enable) {
+    haltRecord = enable;
+}
+
+//!
+//! \brief
+//!    Return the most recent halts
+//!
+//! \param [out] hsb -
+//!    Halts, most recent first
+//!
+//! \param max -
+//!    Size of hsb[]
+//!
+//! \returns
+//!    Number of halts returned
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+unsigned int ks10_t::haltHistory(hsb_t *hsb, unsigned int max) {
+    std::lock_guard<std::mutex> lock(halt_mutex);
+    unsigned int num = haltCount < numHalts ? haltCount : numHalts;
+    if (num > max) {
+        num = max;
+    }
+    for (unsigned int i = 0; i < num; i++) {
+        hsb[i] = halts[(haltCount - 1 - i) % numHalts];
+    }
+    return num;
 }
 
 /* ks10_cpu_api */ //! \}
@@ -41,6 +41,7 @@
 
 #include <mutex>
 
+#include <time.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -273,6 +274,68 @@ class ks10_t {
             brmrIOWR    = (flagWrite | flagIO  ),       //!< IO write flags
         };
 
+        //!
+        //! \brief
+        //!    CPU state snapshot
+        //!
+        //! \details
+        //!    The ACs and the processor registers that the console reads by
+        //!    executing instructions.  See snapshot().
+        //!
+
+        struct snapshot_t {
+            data_t pcir;                                //!< PC and IR
+            data_t ac[020];                             //!< ACs
+            data_t aprid;                               //!< APRID
+            data_t apr;                                 //!< RDAPR
+            data_t pi;                                  //!< RDPI
+            data_t ubr;                                 //!< RDUBR
+            data_t ebr;                                 //!< RDEBR
+            data_t spb;                                 //!< RDSPB
+            data_t csb;                                 //!< RDCSB
+            data_t cstm;                                //!< RDCSTM
+            data_t pur;                                 //!< RDPUR
+            data_t tim[2];                              //!< RDTIM (double word)
+            data_t intrvl;                              //!< RDINT
+            data_t hsb;                                 //!< RDHSB
+        };
+
+        //!
+        //! \brief
+        //!    Halt Status Word and Halt Status Block
+        //!
+        //! \details
+        //!    The HSB registers are in the order that the microcode stores
+        //!    them in memory.
+        //!
+
+        struct hsb_t {
+            struct timespec time;                       //!< When the halt was captured
+            data_t hsw;                                 //!< Halt status (halt cause)
+            data_t hswPC;                               //!< Halt status PC
+            addr_t hsbAddr;                             //!< Halt Status Block address
+            data_t mag;                                 //!< MAG
+            data_t pc;                                  //!< PC
+            data_t hr;                                  //!< HR
+            data_t ar;                                  //!< AR
+            data_t arx;                                 //!< ARX
+            data_t br;                                  //!< BR
+            data_t brx;                                 //!< BRX
+            data_t one;                                 //!< ONE
+            data_t ebr;                                 //!< EBR
+            data_t ubr;                                 //!< UBR
+            data_t msk;                                 //!< MASK
+            data_t flg;                                 //!< FLG
+            data_t pi;                                  //!< PI
+            data_t x1;                                  //!< X1
+            data_t t0;                                  //!< T0
+            data_t t1;                                  //!< T1
+            data_t vma;                                 //!< VMA
+        };
+
+        static const unsigned int numHalts = 32;        //!< Halts kept for post-mortem analysis
+        static const addr_t hsbDefault = 0376000;       //!< Microcode Halt Status Block address
+
         //!
         //! \brief
         //!    RP Controller State
@@ -329,6 +392,19 @@ class ks10_t {
             lpONLINE      = 0x00000001,                    //!<
         };
 
+        //!
+        //! \brief
+        //!    ITR Register Bit Definitions
+        //!
+
+        enum itr_bits_t : uint64_t {
+            itrCLR   = 0x8000000000000000ULL,           //!< Clear the trace buffer
+            itrFULL  = 0x4000000000000000ULL,           //!< Trace buffer is full
+            itrEMPTY = 0x2000000000000000ULL,           //!< Trace buffer is empty
+            itrSIZE  = 0x1f00000000000000ULL,           //!< Log2 of the trace buffer size
+            itrPCIR  = 0x003fffffffffffffULL,           //!< PC (bits 53:36) and IR (bits 35:0)
+        };
+
         //!
         //! \brief
         //!    MTDIR Register Bit Definitions
@@ -367,9 +443,12 @@ class ks10_t {
         static void writeRegCIR(data_t data);
         static data_t readMem(addr_t addr);
         static void writeMem(addr_t addr, data_t data);
+        static void readMemBlock(addr_t addr, data_t *buf, unsigned int len);
+        static void writeMemBlock(addr_t addr, const data_t *buf, unsigned int len);
         static data_t readIO(addr_t addr);
         static void writeIO(addr_t addr, data_t data);
         static uint16_t readIO16(addr_t addr);
+        static void readIOBlock(const addr_t *addr, const bool *wide, data_t *buf, unsigned int len);
         static void writeIO16(addr_t addr, uint16_t data);
         static uint8_t readIO8(addr_t addr);
         static void writeIO8(addr_t addr, uint8_t data);
@@ -390,6 +469,7 @@ class ks10_t {
         static data_t readBRMR(int unit);
         static void writeBRMR(int unit, data_t data);
         static data_t readITR(void);
+        static unsigned int readITRBlock(uint64_t *buf, unsigned int len);
         static void writeITR(data_t data);
         static data_t readPCIR(void);
         static uint64_t getMTDEBUG(void);
@@ -412,6 +492,7 @@ class ks10_t {
         static bool nxmnxd(void);
         static void startRUN(void);
         static void startSTEP(void);
+        static bool step(data_t &pcir);
         static void startEXEC(void);
         static void startCONT(void);
         static void testRegs(void);
@@ -438,14 +519,29 @@ class ks10_t {
         static data_t rdINT(void);
         static data_t rdHSB(void);
         static data_t readAC(data_t regAC);
+        static void snapshot(snapshot_t &snap, bool regs = true);
+        static bool readHSB(hsb_t &hsb, bool exec = true);
+        static bool readHaltStatus(data_t &pcir, data_t &hsw, data_t &hswPC);
+        static void printHSB(const hsb_t &hsb);
+        static const char *haltCause(data_t hsw);
+        static void recordHalt(bool force = false);
+        static void recordHalts(bool enable);
+        static unsigned int haltHistory(hsb_t *hsb, unsigned int max);
         static void lockMutex(void);
         static void unlockMutex(void);
+        static unsigned int cpuEpoch(void);
 
     private:
 
         static int fd;                                          //!< /dev/mem file descriptor
         static bool debug;                                      //!< debug mode
         static std::mutex fpga_mutex;                           //!< FPGA access mutex
+        static unsigned int epoch;                              //!< CPU start/reset count
+        static std::mutex halt_mutex;                           //!< Halt ring mutex
+        static hsb_t halts[numHalts];                           //!< Ring of recent halts
+        static unsigned int haltCount;                          //!< Halts recorded
+        static volatile bool haltRecord;                        //!< Halt thread records halts
+        static addr_t hsbAddress;                               //!< Last Halt Status Block address
 
         //
         // Misc constants
@@ -827,6 +923,11 @@ inline uint32_t ks10_t::__readRegStat(void) {
 //! \brief
 //!    This function writes to <b>Console Status Register</b>
 //!
+//! \details
+//!    A run, continue, step, or reset advances the CPU epoch.  An EXEC
+//!    without RUN (CONT | EXEC) only executes the instruction in the CIR for
+//!    the console (readAC, RDHSB, and friends) and does not.
+//!
 //! \param data -
 //!    data to be written to the <b>Console Status Register</b>.
 //!
@@ -835,9 +936,33 @@ inline uint32_t ks10_t::__readRegStat(void) {
 //!
 
 inline void ks10_t::__writeRegStat(uint32_t data) {
+    if ((data & (statRUN | statRESET)) || ((data & (statCONT | statEXEC)) == statCONT)) {
+        epoch++;
+    }
     *regStat = data;
 }
 
+//!
+//! \brief
+//!    This function returns the CPU epoch
+//!
+//! \details
+//!    The epoch is incremented every time the KS10 is started, stepped,
+//!    continued, or reset.  Console EXEC cycles do not count.  Objects that
+//!    cache KS10 state (for example the UBA page map shadow) compare epochs
+//!    to detect that the KS10 may have modified that state.
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+inline unsigned int ks10_t::cpuEpoch(void) {
+    lockMutex();
+    unsigned int ret = epoch;
+    unlockMutex();
+    return ret;
+}
+
 //!
 //! \brief
 //!    This function reads a 32-bit value from the DZCCR
@@ -1129,6 +1254,46 @@ inline uint64_t ks10_t::readITR(void) {
     return ret;
 }
 
+//!
+//! \brief
+//!    This function drains the Instruction Trace Register.
+//!
+//! \details
+//!    The ITR is read until a read has the itrEMPTY bit set or the buffer
+//!    is full.  Like readITR(), this is a direct register access and does
+//!    not take the FPGA mutex, so a long drain does not stall the other
+//!    console threads.
+//!
+//!    The entries are stored exactly as read, newest first.  A read with
+//!    itrEMPTY set does not contain an entry and is not stored.
+//!
+//! \param [out] buf -
+//!    Buffer to receive the ITR contents
+//!
+//! \param [in] len -
+//!    Size of the buffer in entries
+//!
+//! \returns
+//!    Number of entries that were read
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+inline unsigned int ks10_t::readITRBlock(uint64_t *buf, unsigned int len) {
+    unsigned int i = 0;
+    LOCK();
+    while (i < len) {
+        buf[i] = *regITR;
+        if (buf[i] & itrEMPTY) {
+            break;
+        }
+        i++;
+    }
+    UNLOCK();
+    return i;
+}
+
 //!
 //! \brief
 //!    This function writess a 36-bit value to the Instruction Trace Register.
@@ -1379,6 +1544,41 @@ inline void ks10_t::startSTEP(void) {
     unlockMutex();
 }
 
+//!
+//! \brief
+//!    Execute a single instruction and wait for it to complete
+//!
+//! \details
+//!    The step, the wait for the CPU to halt again, and the read of the PCIR
+//!    are done under one lock so that a step costs one status write, a few
+//!    status reads, and one PCIR read.
+//!
+//! \param [out] pcir -
+//!    PC and IR of the instruction that was executed
+//!
+//! \returns
+//!    false if the CPU did not halt after the step
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+inline bool ks10_t::step(data_t &pcir) {
+    lockMutex();
+    __startSTEP();
+    bool halted = false;
+    for (unsigned int i = 0; i < 100000; i++) {
+        uint32_t stat = __readRegStat();
+        if ((stat & statHALT) && !(stat & statCONT)) {
+            halted = true;
+            break;
+        }
+    }
+    pcir = *regPCIR;
+    unlockMutex();
+    return halted;
+}
+
 //!
 //! \brief
 //!    Continue execution at the current PC.
@@ -2013,6 +2213,65 @@ inline void ks10_t::writeMem(addr_t addr, data_t data) {
     unlockMutex();
 }
 
+//!
+//! \brief
+//!    This function reads a block of 36-bit words from KS10 memory.
+//!
+//! \details
+//!    The FPGA mutex is held for the entire block instead of being taken
+//!    and released for each word.  This is used by the disk and printer
+//!    code to move DMA buffers between the console and KS10 memory.
+//!
+//! \param [in] addr -
+//!    Memory address of the first word
+//!
+//! \param [out] buf -
+//!    Buffer to receive the data
+//!
+//! \param [in] len -
+//!    Number of words to read
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+inline void ks10_t::readMemBlock(addr_t addr, data_t *buf, unsigned int len) {
+    lockMutex();
+    for (unsigned int i = 0; i < len; i++) {
+        buf[i] = __readMem(addr + i);
+    }
+    unlockMutex();
+}
+
+//!
+//! \brief
+//!    This function writes a block of 36-bit words to KS10 memory.
+//!
+//! \details
+//!    The FPGA mutex is held for the entire block instead of being taken
+//!    and released for each word.
+//!
+//! \param [in] addr -
+//!    Memory address of the first word
+//!
+//! \param [in] buf -
+//!    Buffer containing the data
+//!
+//! \param [in] len -
+//!    Number of words to write
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+inline void ks10_t::writeMemBlock(addr_t addr, const data_t *buf, unsigned int len) {
+    lockMutex();
+    for (unsigned int i = 0; i < len; i++) {
+        __writeMem(addr + i, buf[i]);
+    }
+    unlockMutex();
+}
+
 /* ks10_mem_api */ //! \}
 //! \addtogroup ks10_io_api
 //! \{
@@ -2177,6 +2436,39 @@ inline uint16_t ks10_t::readIO16(addr_t addr) {
     return ret;
 }
 
+//!
+//! \brief
+//!    This function reads a list of KS10 IO registers.
+//!
+//! \details
+//!    The FPGA mutex is held for the entire list so that the registers are
+//!    sampled together and the other threads are only locked out once.
+//!    This is used by the device register dumps.
+//!
+//! \param [in] addr -
+//!    IO address of each register
+//!
+//! \param [in] wide -
+//!    True for a 36-bit read, false for a 16-bit Unibus read
+//!
+//! \param [out] buf -
+//!    Buffer to receive the register contents
+//!
+//! \param [in] len -
+//!    Number of registers to read
+//!
+//! \note
+//!    This function is thread safe.
+//!
+
+inline void ks10_t::readIOBlock(const addr_t *addr, const bool *wide, data_t *buf, unsigned int len) {
+    lockMutex();
+    for (unsigned int i = 0; i < len; i++) {
+        buf[i] = wide[i] ? __readIO(addr[i]) : __readIO16(addr[i]);
+    }
+    unlockMutex();
+}
+
 //!
 //! \brief
 //!    This function writes 16-word to KS10 Unibus IO.
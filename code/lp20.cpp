@@ -37,18 +37,26 @@
 //******************************************************************************
 //
 
+#include <thread>
+
+#include <time.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "uba.hpp"
 #include "lp20.hpp"
+#include "pack.hpp"
+#include "regs.hpp"
 
 //!
 //! \brief
 //!   DAVFU Data
 //!
 //! \note
-//!   The DAVFU is 12-bits wide
+//!   The DAVFU is 12-bits wide.  This 66 line, 6 LPI form is loaded unless
+//!   a VFU file has been loaded with "lp vfu".
 //!
 
 static const uint16_t davfu_data[] = {
@@ -145,12 +153,16 @@ void lp20_t::initialize(void) {
 
 void packBytes(ks10_t::addr_t addr, const char *s, unsigned int size) {
 
-    for (unsigned int i = 0; i < size; i += 4) {
-        ks10_t::data_t data = (((ks10_t::data_t)s[i+0] << 18) |
-                               ((ks10_t::data_t)s[i+1] << 26) |
-                               ((ks10_t::data_t)s[i+2] <<  0) |
-                               ((ks10_t::data_t)s[i+3] <<  8));
-        ks10_t::writeMem(addr++, data);
+    ks10_t::data_t data[256];
+    const uint8_t *src = reinterpret_cast<const uint8_t *>(s);
+
+    while (size > 0) {
+        unsigned int bytes = (size > 4 * 256) ? 4 * 256 : size;
+        unsigned int words = pack_t::packUNIBUS(data, src, bytes);
+        ks10_t::writeMemBlock(addr, data, words);
+        addr += words;
+        src  += bytes;
+        size -= bytes;
     }
 }
 
@@ -164,9 +176,6 @@ void lp20_t::testRegs(void) {
         "Hello! Test.\r\n"
         "One.  Two.  Three.  Four.  Five.\r\n";
 
-    const ks10_t::addr_t vaddr = 004000;        // Virtual address (in UBA address space)
-    const ks10_t::addr_t paddr = 070000;        // Physical address (in KS10 memory)
-
     //
     // Is printer online?
     //
@@ -178,29 +187,28 @@ void lp20_t::testRegs(void) {
     }
 
     //
-    // Clear tranlation RAM
+    // Load translation RAM
     //
 
-    for (int i = 0; i < 256; i++) {
-        ks10_t::writeIO(addrCBUF, i);
-        ks10_t::writeIO(addrRAMD, 0);
-    }
+    initRAM();
 
     //
-    // Stuff message in KS10 memory for DMA
+    // Set Unibus mapping
+    //  This will page the destination to a staging buffer
     //
 
-    packBytes(paddr, test_msg, sizeof(test_msg));
+    ks10_t::addr_t paddr;                                   // Physical address (in KS10 memory)
+    const ks10_t::addr_t vaddr = uba.allocPAG(4, &paddr);   // Virtual address (in UBA address space)
+    if (vaddr == 0) {
+        return;
+    }
+    uba.mapPAG(vaddr, paddr, 4, uba_t::PAG_VLD);
 
     //
-    // Set Unibus mapping
-    //  This will page the destination to 070000
+    // Stuff message in KS10 memory for DMA
     //
 
-    uba.writePAG(1, uba_t::PAG_VLD | (0 + uba_t::addr2page(paddr)));
-    uba.writePAG(2, uba_t::PAG_VLD | (1 + uba_t::addr2page(paddr)));
-    uba.writePAG(3, uba_t::PAG_VLD | (2 + uba_t::addr2page(paddr)));
-    uba.writePAG(4, uba_t::PAG_VLD | (3 + uba_t::addr2page(paddr)));
+    packBytes(paddr, test_msg, sizeof(test_msg));
 
     //
     // Initialize
@@ -217,7 +225,7 @@ void lp20_t::testRegs(void) {
 
     while (msg_size > 0) {
 
-        const unsigned int bytes_per_dma = 4092;
+        const unsigned int bytes_per_dma = bytesPerDMA;
         unsigned int bytes_to_send = msg_size;
 
         //
@@ -262,138 +270,1188 @@ void lp20_t::testRegs(void) {
 
     }
 
+    uba.freePAG(vaddr, 4, paddr);
 }
 
+//!
+//! \brief
+//!    Decode the LP20 CSRA MODE field
+//!
+
+static const char *printMODE(uint16_t mode) {
+    static const char *name[] = {"PRINT", "TEST", "DAVFU", "RAM"};
+    return name[mode & 3];
+}
+
+//
+// LP20 Register Descriptions
+//
+
+static const regs_t::field_t fieldsCSRA[] = {
+    {"ERR",   15, 1, NULL},
+    {"PCZ",   14, 1, NULL},
+    {"UNDC",  13, 1, NULL},
+    {"VFUR",  12, 1, NULL},
+    {"ONLN",  11, 1, NULL},
+    {"DHLD",  10, 1, NULL},
+    {"ECLR",   9, 1, NULL},
+    {"INIT",   8, 1, NULL},
+    {"DONE",   7, 1, NULL},
+    {"IE",     6, 1, NULL},
+    {"ADDR",   4, 2, NULL},
+    {"MODE",   2, 2, printMODE},
+    {"PAR",    1, 1, NULL},
+    {"GO",     0, 1, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsCSRB[] = {
+    {"VAL",   15, 1, NULL},
+    {"LA180", 14, 1, NULL},
+    {"NRDY",  13, 1, NULL},
+    {"DPAR",  12, 1, NULL},
+    {"OVFU",  11, 1, NULL},
+    {"TEST",   8, 3, NULL},
+    {"OFFL",   7, 1, NULL},
+    {"DVOF",   6, 1, NULL},
+    {"LPE",    5, 1, NULL},
+    {"MPE",    4, 1, NULL},
+    {"RPE",    3, 1, NULL},
+    {"MTE",    2, 1, NULL},
+    {"DTE",    1, 1, NULL},
+    {"GOE",    0, 1, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsCBUF[] = {
+    {"CCTR",   8, 8, NULL},
+    {"CBUF",   0, 8, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsPDAT[] = {
+    {"CKSM",   8, 8, NULL},
+    {"PDAT",   0, 8, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::reg_t regsLP[] = {
+    regs_t::regUBAS,
+    {"CSRA", 000, false, fieldsCSRA},
+    {"CSRB", 002, false, fieldsCSRB},
+    {"BAR",  004, false, NULL},
+    {"BCTR", 006, false, NULL},
+    {"PCTR", 010, false, NULL},
+    {"RAMD", 012, false, NULL},
+    {"CBUF", 014, false, fieldsCBUF},
+    {"PDAT", 016, false, fieldsPDAT},
+};
+
 //!
 //! \brief
 //!    Dump LP20 registers
 //!
+//! \param script -
+//!    Print the registers as "name=value" assignments
+//!
 
-void lp20_t::dumpRegs(void) {
-
-    printf("KS10: Register Dump\n"
-           "      UBAS: %012llo\n"
-           "      CSRA: %06o\n"
-           "      CSRB: %06o\n"
-           "      BAR : %06o\n"
-           "      BCTR: %06o\n"
-           "      PCTR: %06o\n"
-           "      RAMD: %06o\n"
-           "      CCTR: %06o\n"
-           "      CBUF: %06o\n"
-           "      CKSM: %06o\n"
-           "      PDAT: %06o\n"
-           "      LPCCR: 0x%08x\n",
-           uba.readCSR(),
-           ks10_t::readIO16(addrCSRA),
-           ks10_t::readIO16(addrCSRB),
-           ks10_t::readIO16(addrBAR),
-           ks10_t::readIO16(addrBCTR),
-           ks10_t::readIO16(addrPCTR),
-           ks10_t::readIO16(addrRAMD),
-           (ks10_t::readIO16(addrCBUF) >> 8) & 0377,
-           (ks10_t::readIO16(addrCBUF) >> 0) & 0377,
-           (ks10_t::readIO16(addrPDAT) >> 8) & 0377,
-           (ks10_t::readIO16(addrPDAT) >> 0) & 0377,
-           ks10_t::readLPCCR());
+void lp20_t::dumpRegs(bool script) {
+    regs_t::dump("lp", addrCSRA, regsLP, sizeof(regsLP) / sizeof(regsLP[0]), script);
+    regs_t::printCCR("lp", "LPCCR", ks10_t::readLPCCR(), script);
 }
 
 //!
 //! \brief
-//!    Read a file from the SD card an print it.
+//!    Load the translation RAM or the DAVFU by DMA
+//!
+//! \details
+//!    The LP20 CSRA MODE field redirects a DMA from the printer to the
+//!    translation RAM (two bytes per entry) or to the DAVFU.  This replaces
+//!    hundreds of individual IO writes with one block write to KS10 memory
+//!    and one DMA.
+//!
+//!    The buffer is staged in a page of the UBA staging area through a one
+//!    page UBA window.  The LP20 is left initialized (print mode) when the
+//!    DMA completes.
+//!
+//! \param [in] mode -
+//!    LPCSRA_LDRM or LPCSRA_LDVF
+//!
+//! \param [in] buf -
+//!    Bytes to load
+//!
+//! \param [in] bytes -
+//!    Number of bytes to load.  This must not be more than 512.
+//!
+//! \returns
+//!    True if the DMA completed, false otherwise.
 //!
 
-void lp20_t::printFile(const char *filename) {
+bool lp20_t::loadDMA(ks10_t::data_t mode, const uint8_t *buf, unsigned int bytes) {
 
-    const ks10_t::addr_t vaddr = 004000;        // Virtual address (in UBA address space)
-    const ks10_t::addr_t paddr = 070000;        // Physical address (in KS10 memory)
+    ks10_t::data_t data[(2 * sizeRAM + 3) / 4];
 
-    FILE *fp = fopen(filename, "r");
+    if ((bytes == 0) || (bytes > 2 * sizeRAM)) {
+        return false;
+    }
+
+    ks10_t::addr_t paddr;                                   // Physical address (in KS10 memory)
+    const ks10_t::addr_t vaddr = uba.allocPAG(1, &paddr);   // Virtual address (in UBA address space)
+    if (vaddr == 0) {
+        return false;
+    }
+    uba.mapPAG(vaddr, paddr, 1, uba_t::PAG_VLD);
+
+    ks10_t::writeMemBlock(paddr, data, pack_t::packUNIBUS(data, buf, bytes));
+
+    //
+    // BAR[17:16] are written through CSRA
+    //
+
+    ks10_t::writeIO(addrCSRA, LPCSRA_INIT);
+    ks10_t::writeIO(addrBCTR, -bytes);
+    ks10_t::writeIO(addrBAR,  vaddr);
+    ks10_t::writeIO(addrCSRA, mode | ((vaddr >> 12) & 0x0030) | LPCSRA_GO);
+
+    //
+    // The RAM loads immediately.  The DAVFU is loaded through the printer
+    // interface so allow some time.
+    //
+
+    bool success = false;
+    for (unsigned int i = 0; i < 5000; i++) {
+        if ((ks10_t::readIO(addrCSRA) & LPCSRA_GO) == 0) {
+            success = true;
+            break;
+        }
+        usleep(1000);
+    }
+
+    ks10_t::writeIO(addrCSRA, LPCSRA_INIT);
+    uba.freePAG(vaddr, 1, paddr);
+
+    if (!success) {
+        printf("KS10: LP20 %s load timed out.\n", mode == LPCSRA_LDRM ? "RAM" : "DAVFU");
+    }
+    return success;
+}
+
+//!
+//! \brief
+//!    Load the translation RAM
+//!
+//! \details
+//!    The RAM image is compared with the shadow of what was last loaded and
+//!    only the entries that differ are written.  A few entries are written
+//!    with IO writes; anything more is loaded with a single DMA.  Nothing is
+//!    written if the RAM is unchanged.
+//!
+//!    The shadow is discarded if the KS10 has been started since the RAM
+//!    was loaded because the KS10 software (LPTSPL) loads its own
+//!    translation RAM.
+//!
+//!    The default image is all zeros so that every character is printed
+//!    without translation.
+//!
+
+void lp20_t::initRAM(void) {
+
+    uint16_t image[sizeRAM];
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        memcpy(image, ramImage, sizeof(image));
+    }
+
+    std::lock_guard<std::mutex> lock(loadMutex);
+
+    unsigned int epoch = ks10_t::cpuEpoch();
+    if (!ramValid || (ramEpoch != epoch)) {
+        ramValid = false;
+    }
+
+    unsigned int changed = 0;
+    for (unsigned int i = 0; i < sizeRAM; i++) {
+        if (!ramValid || (ramShadow[i] != image[i])) {
+            changed++;
+        }
+    }
+
+    if (changed == 0) {
+        return;
+    }
+
+    if (changed <= maxRAMIO) {
+        for (unsigned int i = 0; i < sizeRAM; i++) {
+            if (ramShadow[i] != image[i]) {
+                ks10_t::writeIO(addrCBUF, i);
+                ks10_t::writeIO(addrRAMD, image[i]);
+            }
+        }
+    } else {
+        uint8_t buf[2 * sizeRAM];
+        for (unsigned int i = 0; i < sizeRAM; i++) {
+            buf[2 * i + 0] = (image[i] >> 0) & 0377;
+            buf[2 * i + 1] = (image[i] >> 8) & 0377;
+        }
+        if (!loadDMA(LPCSRA_LDRM, buf, sizeof(buf))) {
+            ramValid = false;
+            return;
+        }
+    }
+
+    memcpy(ramShadow, image, sizeof(ramShadow));
+    ramValid = true;
+    ramEpoch = epoch;
+}
+
+//!
+//! \brief
+//!    Build the default DAVFU program
+//!
+//! \details
+//!    The default is the 66 line, 6 LPI form in davfu_data[].  Each line is
+//!    sent as two bytes: channels 1-6 then channels 7-12.
+//!
+//! \param [out] buf -
+//!    DAVFU program
+//!
+//! \returns
+//!    Length of the DAVFU program in bytes
+//!
+
+static unsigned int defaultVFU(uint8_t *buf) {
+    unsigned int len = 0;
+    buf[len++] = 0354;
+    for (unsigned int i = 0; i < sizeof(davfu_data) / sizeof(davfu_data[0]); i++) {
+        buf[len++] = (davfu_data[i] >> 0) & 077;
+        buf[len++] = (davfu_data[i] >> 6) & 077;
+    }
+    buf[len++] = 0357;
+    return len;
+}
+
+//!
+//! \brief
+//!    Load the DAVFU
+//!
+//! \details
+//!    The DAVFU is loaded if the DAVFU program has changed, if the KS10 has
+//!    been started since the DAVFU was loaded, or if the printer reports
+//!    that the DAVFU is not ready (for example after the printer was power
+//!    cycled).
+//!
+//!    Printers with an optical VFU are not loaded.
+//!
+
+void lp20_t::initVFU(void) {
+
+    if (ks10_t::readLPCCR() & ks10_t::lpOVFU) {
+        return;
+    }
+
+    uint8_t image[maxVFU];
+    unsigned int len;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        len = vfuLen;
+        memcpy(image, vfuImage, len);
+    }
+
+    if (len == 0) {
+        len = defaultVFU(image);
+    }
+
+    std::lock_guard<std::mutex> lock(loadMutex);
+
+    unsigned int epoch = ks10_t::cpuEpoch();
+    if (vfuValid && (vfuEpoch == epoch) && (vfuShadowLen == len) &&
+        (memcmp(vfuShadow, image, len) == 0) &&
+        (ks10_t::readIO(addrCSRA) & LPCSRA_VFUR)) {
+        return;
+    }
+
+    vfuValid = false;
+    if (!loadDMA(LPCSRA_LDVF, image, len)) {
+        return;
+    }
+
+    memcpy(vfuShadow, image, len);
+    vfuShadowLen = len;
+    vfuValid = true;
+    vfuEpoch = epoch;
+}
+
+//!
+//! \brief
+//!    Read a translation RAM image file
+//!
+//! \details
+//!    Two formats are accepted:
+//!
+//!    - A binary image of exactly 512 bytes.  This is 256 little-endian
+//!      16-bit entries, which is also the layout the LP20 RAM load DMA
+//!      uses.
+//!    - An octal text file.  Each line is either "char/value" or just
+//!      "value" (which applies to the next character).  Text after a ';'
+//!      is a comment.  Characters that are not listed are cleared.
+//!
+//!    Only the low 12 bits of each entry are used.  The image is loaded by
+//!    the print spooler before the next job.
+//!
+//! \param [in] filename -
+//!    Name of the RAM image file
+//!
+//! \returns
+//!    True if the file was read, false otherwise.
+//!
+
+bool lp20_t::loadRAM(const char *filename) {
+
+    FILE *fp = fopen(filename, "rb");
     if (fp == NULL) {
         printf("KS10: fopen(%s) failed.\n", filename);
-        return;
+        return false;
     }
 
+    uint8_t raw[2 * sizeRAM + 1];
+    size_t numbytes = fread(raw, 1, sizeof(raw), fp);
+
     //
-    // Is printer online?
+    // A text file of exactly 512 bytes has no control characters other than
+    // white space.  A binary image always does.
     //
 
-    ks10_t::data_t temp = ks10_t::readIO(addrCSRA);
-    if ((temp & LPCSRA_ONLN) == 0) {
-        printf("KS10: Printer is offline.\n");
-        return;
+    uint16_t image[sizeRAM] = {};
+    bool binary = false;
+    if (numbytes == 2 * sizeRAM) {
+        for (size_t i = 0; i < numbytes; i++) {
+            if ((raw[i] < ' ') && (raw[i] != '\t') && (raw[i] != '\r') && (raw[i] != '\n') && (raw[i] != '\f')) {
+                binary = true;
+                break;
+            }
+        }
+    }
+
+    if (binary) {
+        for (unsigned int i = 0; i < sizeRAM; i++) {
+            image[i] = (raw[2 * i + 0] | (raw[2 * i + 1] << 8)) & 07777;
+        }
+    } else {
+        rewind(fp);
+        char line[256];
+        unsigned int lineno = 0;
+        unsigned int next = 0;
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            lineno++;
+            char *comment = strchr(line, ';');
+            if (comment != NULL) {
+                *comment = 0;
+            }
+            unsigned int chr;
+            unsigned int val;
+            char extra;
+            if (sscanf(line, " %o / %o %c", &chr, &val, &extra) == 2) {
+                ;
+            } else if (sscanf(line, " %o %c", &val, &extra) == 1) {
+                chr = next;
+            } else if (sscanf(line, " %c", &extra) != 1) {
+                continue;
+            } else {
+                printf("KS10: %s:%d: Unrecognized line.\n", filename, lineno);
+                fclose(fp);
+                return false;
+            }
+            if ((chr >= sizeRAM) || (val > 07777)) {
+                printf("KS10: %s:%d: Value out of range.\n", filename, lineno);
+                fclose(fp);
+                return false;
+            }
+            image[chr] = val;
+            next = chr + 1;
+        }
+    }
+    fclose(fp);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    memcpy(ramImage, image, sizeof(ramImage));
+    return true;
+}
+
+//!
+//! \brief
+//!    Read a DAVFU image file
+//!
+//! \details
+//!    The file is a TOPS-10 .VFU file: a start code, two bytes per line
+//!    (channels 1-6 then channels 7-12), and a stop code.  The start code is
+//!    0354 (6 LPI), 0355 (8 LPI), or 0356 (use the printer setting) and the
+//!    stop code is 0357.  The LP26 only looks at the low seven bits, so
+//!    0154-0157 are also accepted.  Anything after the stop code (padding)
+//!    is ignored.
+//!
+//!    The image is loaded by the print spooler before the next job.
+//!
+//! \param [in] filename -
+//!    Name of the VFU file
+//!
+//! \returns
+//!    True if the file was read, false otherwise.
+//!
+
+bool lp20_t::loadVFU(const char *filename) {
+
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        printf("KS10: fopen(%s) failed.\n", filename);
+        return false;
+    }
+
+    uint8_t image[maxVFU + 1];
+    size_t numbytes = fread(image, 1, sizeof(image), fp);
+    fclose(fp);
+
+    unsigned int start = (numbytes > 0) ? (image[0] & 0177) : 0;
+    if ((start < 0154) || (start > 0156)) {
+        printf("KS10: %s: Missing DAVFU start code.\n", filename);
+        return false;
+    }
+
+    unsigned int len = 0;
+    for (unsigned int i = 1; i < numbytes; i += 2) {
+        if ((image[i] & 0177) == 0157) {
+            len = i + 1;
+            break;
+        }
+        if ((i + 1 < numbytes) && ((image[i] | image[i + 1]) & 0100)) {
+            break;
+        }
+    }
+
+    if (len == 0) {
+        printf("KS10: %s: Missing DAVFU stop code.\n", filename);
+        return false;
+    }
+
+    if (len > maxVFU) {
+        printf("KS10: %s: DAVFU is longer than %d lines.\n", filename, maxLines);
+        return false;
+    }
+
+    if (ks10_t::readLPCCR() & ks10_t::lpOVFU) {
+        printf("KS10: Printer is configured with an Optical VFU.  The DAVFU will not be loaded.\n");
+    }
+
+    printf("KS10: DAVFU is %d lines.\n", (len - 2) / 2);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    memcpy(vfuImage, image, len);
+    vfuLen = len;
+    return true;
+}
+
+//!
+//! \brief
+//!    Wait for a print DMA to complete
+//!
+//! \details
+//!    The printer is slow compared to the console so the wait sleeps
+//!    between polls.
+//!
+//! \returns
+//!    True if the DMA completed, false if the printer went off-line.
+//!
+
+bool lp20_t::waitDMA(void) {
+    for (;;) {
+        ks10_t::data_t csra = ks10_t::readIO(addrCSRA);
+        if ((csra & LPCSRA_GO) == 0) {
+            return true;
+        }
+        if ((csra & LPCSRA_ONLN) == 0) {
+            return false;
+        }
+        usleep(1000);
+    }
+}
+
+//!
+//! \brief
+//!    Print one file
+//!
+//! \details
+//!    The file is printed using two DMA buffers.  While the LP20 is printing
+//!    from one buffer, the next part of the file is read, packed, and
+//!    written to the other buffer.
+//!
+//!    Each DMA is limited to 4092 bytes because BCTR is 12 bits.  Each
+//!    buffer is therefore two UBA pages.
+//!
+//!    The buffers are in the console staging area of KS10 memory and the
+//!    LP20 is reset before the job starts.  Both belong to the monitor
+//!    while the KS10 runs, so the job is refused unless the KS10 is halted
+//!    and is stopped if the KS10 is started while it prints.
+//!
+//! \param [in] filename -
+//!    Name of file to print
+//!
+//! \returns
+//!    True if the file was printed, false otherwise.
+//!
+
+bool lp20_t::printJob(const char *filename) {
+
+    const unsigned int pagesPerBuf = 2;
+
+    static char buffer[bytesPerDMA];
+    static ks10_t::data_t data[bytesPerDMA / 4];
+
+    //
+    // Capture the job to a file instead of printing it
+    //
+
+    bool captured;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        captured = capture;
+    }
+    if (captured) {
+        return captureJob(filename);
+    }
+
+    if (!ks10_t::halt()) {
+        printf("KS10: Not printing %s.  The KS10 must be halted.\n", filename);
+        return false;
+    }
+
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        printf("KS10: fopen(%s) failed.\n", filename);
+        return false;
     }
 
     //
-    // Clear tranlation RAM
+    // Is printer online?
     //
 
-    for (int i = 0; i < 256; i++) {
-        ks10_t::writeIO(addrCBUF, i);
-        ks10_t::writeIO(addrRAMD, 0);
+    if ((ks10_t::readIO(addrCSRA) & LPCSRA_ONLN) == 0) {
+        printf("KS10: Printer is offline.\n");
+        fclose(fp);
+        return false;
     }
 
     //
-    // Create buffer
+    // Load the translation RAM and DAVFU if they have changed
     //
 
-    char buffer[128];
+    initRAM();
+    initVFU();
 
     //
     // Set Unibus mapping
-    //  This will page the destination to 070000
+    //  Both buffers are in the staging area.  The second buffer follows
+    //  the first.
     //
 
-    uba.writePAG(1, uba_t::PAG_VLD | (0 + uba_t::addr2page(paddr)));
-    uba.writePAG(2, uba_t::PAG_VLD | (1 + uba_t::addr2page(paddr)));
-    uba.writePAG(3, uba_t::PAG_VLD | (2 + uba_t::addr2page(paddr)));
-    uba.writePAG(4, uba_t::PAG_VLD | (3 + uba_t::addr2page(paddr)));
+    ks10_t::addr_t paddr[2];                                    // Physical address (in KS10 memory)
+    ks10_t::addr_t vaddr[2];                                    // Virtual address (in UBA address space)
+    vaddr[0] = uba.allocPAG(2 * pagesPerBuf, &paddr[0]);
+    if (vaddr[0] == 0) {
+        fclose(fp);
+        return false;
+    }
+    vaddr[1] = vaddr[0] + pagesPerBuf * 04000;
+    paddr[1] = paddr[0] + pagesPerBuf * 01000;
+    uba.mapPAG(vaddr[0], paddr[0], 2 * pagesPerBuf, uba_t::PAG_VLD);
 
     //
-    // Read file from SD Card into buffer
+    // Reset LP20
     //
 
-    while (!feof(fp)) {
+    ks10_t::writeIO(addrCSRA, LPCSRA_INIT);
 
-        size_t numbytes = fread(buffer, 1, sizeof(buffer), fp);
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
 
-        //
-        // Stuff message in KS10 memory for DMA
-        //
+    unsigned int bytes  = 0;
+    unsigned int pages  = 0;
+    bool         dirty  = false;
+    bool         busy   = false;
+    bool         online = true;
+    bool         halted = true;
 
-        packBytes(paddr, buffer, numbytes);
+    for (unsigned int buf = 0; ; buf ^= 1) {
 
         //
-        // Reset LP20
+        // Stop if the KS10 has been started
         //
 
-        ks10_t::writeIO(addrCSRA, LPCSRA_INIT);
+        if (!ks10_t::halt()) {
+            halted = false;
+            break;
+        }
 
         //
-        // Set byte counter
+        // Read and pack the next chunk while the previous chunk prints
         //
 
-        ks10_t::writeIO(addrBCTR, -numbytes);
+        size_t numbytes = fread(buffer, 1, sizeof(buffer), fp);
+        for (size_t i = 0; i < numbytes; i++) {
+            if (buffer[i] == '\f') {
+                pages++;
+                dirty = false;
+            } else {
+                dirty = true;
+            }
+        }
+        ks10_t::writeMemBlock(paddr[buf], data, pack_t::packUNIBUS(data, reinterpret_cast<const uint8_t *>(buffer), numbytes));
 
         //
-        // Set destination address
+        // Wait for the previous chunk to finish
         //
 
-        ks10_t::writeIO(addrBAR, vaddr);
+        if (busy && !waitDMA()) {
+            online = false;
+            break;
+        }
+        busy = false;
+
+        if (numbytes == 0) {
+            break;
+        }
 
         //
         // Start DMA
         //
 
+        ks10_t::writeIO(addrBCTR, -numbytes);
+        ks10_t::writeIO(addrBAR, vaddr[buf]);
         ks10_t::writeIO(addrCSRA, LPCSRA_GO);
 
-        //
-        // Wait for DMA to complete
-        //
+        busy   = true;
+        bytes += numbytes;
+    }
 
-        while ((ks10_t::readIO(addrCSRA) & LPCSRA_GO) != 0) {
+    //
+    // Abort a DMA that is still in flight before the buffers are released
+    //
+
+    if (busy) {
+        ks10_t::writeIO(addrCSRA, LPCSRA_INIT);
+    }
+
+    uba.freePAG(vaddr[0], 2 * pagesPerBuf, paddr[0]);
+    fclose(fp);
+
+    if (!halted) {
+        printf("KS10: Stopped printing %s because the KS10 was started.\n", filename);
+        return false;
+    }
+
+    if (!online) {
+        printf("KS10: Printer went off-line while printing %s.\n", filename);
+        return false;
+    }
+
+    if (dirty) {
+        pages++;
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double secs = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    printf("KS10: Printed %s: %d bytes, %d pages in %.1f seconds (%.1f pages/minute).\n",
+           filename, bytes, pages, secs, secs > 0 ? pages * 60.0 / secs : 0.0);
+
+    return true;
+}
+
+//!
+//! \brief
+//!    Print spooler thread
+//!
+//! \details
+//!    The thread sleeps until a job is queued and then prints the jobs in
+//!    the order that they were queued.
+//!
+
+void lp20_t::spoolThread(void) {
+
+    char filename[maxName];
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (numJobs == 0) {
+                cv.wait(lock);
+            }
+            strcpy(filename, jobs[headJob]);
+        }
+
+        printJob(filename);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            headJob = (headJob + 1) % maxJobs;
+            numJobs--;
+        }
+    }
+}
+
+//!
+//! \brief
+//!    Queue a file to be printed.
+//!
+//! \details
+//!    The spooler thread is started when the first job is queued.  The
+//!    console is not blocked while the file prints.
+//!
+//! \param [in] filename -
+//!    Name of file to print
+//!
+
+void lp20_t::printFile(const char *filename) {
+
+    if (strlen(filename) >= maxName) {
+        printf("KS10: Filename is too long.\n");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!capture && !ks10_t::halt()) {
+        printf("KS10: The KS10 must be halted to print.\n");
+        return;
+    }
+
+    if (numJobs == maxJobs) {
+        printf("KS10: Print queue is full.\n");
+        return;
+    }
+
+    if (!running) {
+        std::thread(&lp20_t::spoolThread, this).detach();
+        running = true;
+    }
+
+    strcpy(jobs[(headJob + numJobs) % maxJobs], filename);
+    numJobs++;
+    cv.notify_one();
+}
+
+//!
+//! \brief
+//!    Print the print queue
+//!
+//! \details
+//!    The first entry is the job that is currently printing.
+//!
+
+void lp20_t::printQueue(void) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (numJobs == 0) {
+        printf("KS10: Print queue is empty.\n");
+        return;
+    }
+
+    for (unsigned int i = 0; i < numJobs; i++) {
+        printf("KS10: %2d: %s%s\n", i, jobs[(headJob + i) % maxJobs], i == 0 ? " (printing)" : "");
+    }
+}
+
+//!
+//! \brief
+//!    LP26 renderer
+//!
+//! \details
+//!    This renders the LP20 print stream to a text file the way that the
+//!    LP20 and LP26 would print it:
+//!
+//!    - Each character is looked up in the translation RAM and is printed,
+//!      translated, sent to the DAVFU, or counted as an undefined character
+//!      using the LP20 Table 4-5 rules (including Delimiter Hold).
+//!    - Tabs are expanded and lines wrap at 132 columns.
+//!    - Control characters other than CR, LF, VT, and FF print as spaces.
+//!    - DAVFU channel and slew commands and vertical tabs move the paper
+//!      using the DAVFU program.  Reaching the top of form starts a new
+//!      page.
+//!
+//!    A carriage return that is not followed by paper motion is written so
+//!    that overprinting is preserved.  Pages are separated by form feeds.
+//!
+
+class lp26_t {
+    private:
+
+        static const unsigned int maxCols = 132;
+
+        FILE *fp;
+        const uint16_t *vfu;
+        unsigned int vfuLen;
+        unsigned int lctr;
+        unsigned int col;
+        bool cr;
+        bool dhld;
+        bool dirty;
+
+        void step(void) {
+            if (++lctr >= vfuLen) {
+                lctr = 0;
+                fputc('\f', fp);
+                pages++;
+                dirty = false;
+            } else {
+                fputc('\n', fp);
+            }
+            lines++;
+            col = 0;
+            cr  = false;
+        }
+
+        void formFeed(void) {
+            fputc('\f', fp);
+            pages++;
+            lctr  = 0;
+            col   = 0;
+            cr    = false;
+            dirty = false;
+        }
+
+        void channel(unsigned int chan, bool first) {
+            if (chan >= 12) {
+                return;
+            }
+            unsigned int count = 0;
+            if (first) {
+                step();
+                count++;
+            }
+            while (((vfu[lctr] & (1 << chan)) == 0) && (count < vfuLen)) {
+                step();
+                count++;
+            }
+        }
+
+        void printable(uint8_t ch) {
+            if (col == maxCols) {
+                step();
+            }
+            if (cr) {
+                fputc('\r', fp);
+                cr = false;
+            }
+            fputc(ch, fp);
+            col++;
+            dirty = true;
+        }
+
+        void printChar(uint8_t ch) {
+            switch (ch) {
+                case 0:
+                    break;
+                case '\r':
+                    col = 0;
+                    cr  = true;
+                    break;
+                case '\n':
+                    step();
+                    break;
+                case '\f':
+                    formFeed();
+                    break;
+                case '\v':
+                    channel(1, false);
+                    break;
+                case '\t':
+                    do {
+                        printable(' ');
+                    } while (col % 8);
+                    break;
+                default:
+                    printable(((ch < ' ') || (ch == 0177)) ? ' ' : ch);
+                    break;
+            }
+        }
+
+        void paper(uint8_t data) {
+            if (data & 0x10) {
+                for (unsigned int i = 0; i <= (data & 0x0f); i++) {
+                    step();
+                }
+            } else {
+                channel(data & 0x0f, true);
+            }
+        }
+
+    public:
+
+        unsigned int pages;                             //!< Pages printed
+        unsigned int lines;                             //!< Lines printed
+        unsigned int undc;                              //!< Undefined characters
+
+        //!
+        //! \brief
+        //!    Render one byte
+        //!
+        //! \param ch -
+        //!    Character from the print buffer
+        //!
+        //! \param ramd -
+        //!    Translation RAM entry for the character
+        //!
+
+        void put(uint8_t ch, uint16_t ramd) {
+
+            enum {printCBUF, printRAMD, printDVFU, raiseINTR};
+
+            static const uint8_t table[32] = {
+                printCBUF, printRAMD, printCBUF, printDVFU,
+                printRAMD, printRAMD, printDVFU, printDVFU,
+                printRAMD, printRAMD, printDVFU, printDVFU,
+                printRAMD, printRAMD, printDVFU, printDVFU,
+                raiseINTR, raiseINTR, raiseINTR, raiseINTR,
+                printRAMD, raiseINTR, printDVFU, raiseINTR,
+                raiseINTR, raiseINTR, raiseINTR, raiseINTR,
+                raiseINTR, raiseINTR, raiseINTR, raiseINTR,
+            };
+
+            switch (table[((ramd >> 7) & 036) | dhld]) {
+                case printCBUF:
+                    printChar(ch);
+                    break;
+                case printRAMD:
+                    printChar(ramd & 0377);
+                    break;
+                case printDVFU:
+                    paper(ramd & 0377);
+                    break;
+                case raiseINTR:
+                    undc++;
+                    break;
+            }
+            dhld = (ramd & 02000) != 0;
+        }
+
+        //!
+        //! \brief
+        //!    Finish the job
+        //!
+
+        void finish(void) {
+            if (dirty) {
+                fputc('\n', fp);
+                pages++;
+            }
+        }
+
+        //!
+        //! \brief
+        //!    Constructor
+        //!
+
+        lp26_t(FILE *fp, const uint16_t *vfu, unsigned int vfuLen) :
+            fp(fp),
+            vfu(vfu),
+            vfuLen(vfuLen ? vfuLen : 1),
+            lctr(0),
+            col(0),
+            cr(false),
+            dhld(false),
+            dirty(false),
+            pages(0),
+            lines(0),
+            undc(0) {
             ;
         }
+};
+
+//!
+//! \brief
+//!    Render one job to a capture file
+//!
+//! \details
+//!    The job is rendered with the translation RAM and DAVFU images that
+//!    would have been loaded for the printer.  The output file is the next
+//!    unused "lptNNNN.txt" in the capture directory.  A record of the job is
+//!    appended to "lpt.log" in the capture directory.
+//!
+//! \param [in] filename -
+//!    Name of file to print
+//!
+//! \returns
+//!    True if the file was captured, false otherwise.
+//!
+
+bool lp20_t::captureJob(const char *filename) {
+
+    uint16_t ram[sizeRAM];
+    uint8_t vfuData[maxVFU];
+    unsigned int len;
+    char dir[maxName];
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        memcpy(ram, ramImage, sizeof(ram));
+        len = vfuLen;
+        memcpy(vfuData, vfuImage, len);
+        strcpy(dir, captureDir);
+    }
+
+    if (len == 0) {
+        len = defaultVFU(vfuData);
+    }
+
+    //
+    // Unpack the DAVFU program to one 12-bit entry per line
+    //
+
+    uint16_t vfu[maxLines];
+    unsigned int vfuLines = (len - 2) / 2;
+    for (unsigned int i = 0; i < vfuLines; i++) {
+        vfu[i] = (vfuData[2 * i + 1] & 077) | ((vfuData[2 * i + 2] & 077) << 6);
+    }
+
+    FILE *in = fopen(filename, "rb");
+    if (in == NULL) {
+        printf("KS10: fopen(%s) failed.\n", filename);
+        return false;
+    }
+
+    record_t rec;
+    FILE *out = NULL;
+    for (unsigned int seq = 1; seq < 10000; seq++) {
+        snprintf(rec.name, sizeof(rec.name), "%s/lpt%04d.txt", dir, seq);
+        if (access(rec.name, F_OK) != 0) {
+            out = fopen(rec.name, "w");
+            break;
+        }
+    }
+    if (out == NULL) {
+        printf("KS10: Unable to create capture file in %s.\n", dir);
+        fclose(in);
+        return false;
+    }
+
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    lp26_t lp26(out, vfu, vfuLines);
+
+    static uint8_t buffer[bytesPerDMA];
+    size_t numbytes;
+    rec.bytes = 0;
+    while ((numbytes = fread(buffer, 1, sizeof(buffer), in)) != 0) {
+        for (size_t i = 0; i < numbytes; i++) {
+            lp26.put(buffer[i], ram[buffer[i]]);
+        }
+        rec.bytes += numbytes;
+    }
+    lp26.finish();
+
+    fclose(in);
+    fclose(out);
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    rec.pages = lp26.pages;
+    rec.lines = lp26.lines;
+    rec.undc  = lp26.undc;
+    rec.secs  = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    char logname[maxName + 16];
+    snprintf(logname, sizeof(logname), "%s/lpt.log", dir);
+    FILE *log = fopen(logname, "a");
+    if (log != NULL) {
+        fprintf(log, "%s %s bytes=%d pages=%d lines=%d undc=%d\n",
+                rec.name, filename, rec.bytes, rec.pages, rec.lines, rec.undc);
+        fclose(log);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        captureRecs[captureJobs % maxRecs] = rec;
+        captureJobs++;
+    }
+
+    printf("KS10: Captured %s to %s: %d bytes, %d pages, %d lines in %.3f seconds.\n",
+           filename, rec.name, rec.bytes, rec.pages, rec.lines, rec.secs);
+
+    return true;
+}
+
+//!
+//! \brief
+//!    Start capturing print jobs to files
+//!
+//! \param [in] dir -
+//!    Directory for the capture files
+//!
+//! \returns
+//!    True if capture was started, false otherwise.
+//!
+
+bool lp20_t::captureStart(const char *dir) {
+
+    struct stat st;
+    if ((stat(dir, &st) != 0) || !S_ISDIR(st.st_mode)) {
+        printf("KS10: %s is not a directory.\n", dir);
+        return false;
+    }
+
+    if (strlen(dir) >= maxName - 16) {
+        printf("KS10: Directory name is too long.\n");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    strcpy(captureDir, dir);
+    capture = true;
+    printf("KS10: Capturing print jobs to %s.\n", dir);
+    return true;
+}
+
+//!
+//! \brief
+//!    Stop capturing print jobs
+//!
+//! \details
+//!    Jobs that are queued after this are sent to the printer.
+//!
+
+void lp20_t::captureStop(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capture = false;
+}
+
+//!
+//! \brief
+//!    Print the capture status and the most recent jobs
+//!
+
+void lp20_t::captureStat(void) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (capture) {
+        printf("KS10: Capturing print jobs to %s.\n", captureDir);
+    } else {
+        printf("KS10: Print jobs are sent to the printer.\n");
+    }
+
+    if (captureJobs == 0) {
+        return;
+    }
 
+    printf("      File                          Bytes   Pages   Lines   UNDC  MB/sec\n");
+    unsigned int first = (captureJobs > maxRecs) ? captureJobs - maxRecs : 0;
+    for (unsigned int i = first; i < captureJobs; i++) {
+        const record_t &rec = captureRecs[i % maxRecs];
+        const char *name = strrchr(rec.name, '/');
+        printf("      %-28s %7d %7d %7d %6d %7.1f\n",
+               name ? name + 1 : rec.name, rec.bytes, rec.pages, rec.lines, rec.undc,
+               rec.secs > 0 ? rec.bytes / rec.secs / 1e6 : 0.0);
     }
 }
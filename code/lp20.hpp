@@ -39,7 +39,11 @@
 #ifndef __LP20_HPP
 #define __LP20_HPP
 
+#include <mutex>
+#include <condition_variable>
+
 #include "ks10.hpp"
+#include "uba.hpp"
 
 //!
 //! \brief
@@ -79,10 +83,13 @@ class lp20_t {
         //! Control and Status Register A (CSRA) definitions
         //!
 
+        static const ks10_t::data_t LPCSRA_VFUR = 0x1000;         //!< DAVFU Ready
         static const ks10_t::data_t LPCSRA_ONLN = 0x0800;         //!< Online
         static const ks10_t::data_t LPCSRA_INIT = 0x0100;         //!< Clear
         static const ks10_t::data_t LPCSRA_DONE = 0x0080;         //!< DMA Done
         static const ks10_t::data_t LPCSRA_IE   = 0x0040;         //!< Interrupt enable
+        static const ks10_t::data_t LPCSRA_LDVF = 0x0008;         //!< Mode: DMA into DAVFU
+        static const ks10_t::data_t LPCSRA_LDRM = 0x000c;         //!< Mode: DMA into RAM
         static const ks10_t::data_t LPCSRA_GO   = 0x0001;         //!< Go
 
         //
@@ -91,6 +98,87 @@ class lp20_t {
 
         uba_t uba;
 
+        //
+        // DMA is limited to 4K bytes (BCTR is 12-bits)
+        //
+
+        static const unsigned int bytesPerDMA = 4092;
+
+        //
+        // Print queue
+        //
+
+        static const unsigned int maxJobs = 16;         //!< Queue depth
+        static const unsigned int maxName = 256;        //!< Filename length
+
+        std::mutex mutex;                               //!< Protects the queue
+        std::condition_variable cv;                     //!< Signals new jobs
+        bool running;                                   //!< Spooler thread started
+        char jobs[maxJobs][maxName];                    //!< Queued filenames
+        unsigned int headJob;                           //!< Current job
+        unsigned int numJobs;                           //!< Number of queued jobs
+
+        //
+        // Translation RAM and DAVFU state
+        //
+        //  The image is what the next job should use.  The shadow is what
+        //  was last loaded into the LP20.  The shadow is discarded when the
+        //  KS10 has been started because the KS10 may have reloaded the LP20.
+        //
+        //  The images are protected by mutex.  The shadows are used by the
+        //  console thread (lp test) and by the spooler thread, so they are
+        //  protected by loadMutex which is held for the whole load.
+        //
+
+        static const unsigned int sizeRAM  = 256;       //!< Translation RAM entries
+        static const unsigned int maxLines = 255;       //!< DAVFU length (lines)
+        static const unsigned int maxVFU   = 2 * maxLines + 2;  //!< DAVFU program (bytes)
+        static const unsigned int maxRAMIO = 16;        //!< RAM updates without DMA
+
+        std::mutex loadMutex;                           //!< Protects the shadows
+        uint16_t ramImage[sizeRAM];                     //!< RAM for the next job
+        uint16_t ramShadow[sizeRAM];                    //!< RAM as last loaded
+        bool ramValid;                                  //!< RAM shadow is valid
+        unsigned int ramEpoch;                          //!< CPU epoch of RAM load
+
+        uint8_t vfuImage[maxVFU];                       //!< DAVFU program for the next job
+        unsigned int vfuLen;                            //!< Length of vfuImage
+        uint8_t vfuShadow[maxVFU];                      //!< DAVFU program as last loaded
+        unsigned int vfuShadowLen;                      //!< Length of vfuShadow
+        bool vfuValid;                                  //!< DAVFU shadow is valid
+        unsigned int vfuEpoch;                          //!< CPU epoch of DAVFU load
+
+        //
+        // Capture to host files
+        //
+        //  Spooled jobs are rendered to files instead of the printer.  Each
+        //  job gets a new file and a record in the capture log.
+        //
+
+        static const unsigned int maxRecs = 16;         //!< Job records kept
+
+        struct record_t {
+            char name[maxName];                         //!< Capture file
+            unsigned int bytes;                         //!< Bytes rendered
+            unsigned int pages;                         //!< Pages
+            unsigned int lines;                         //!< Lines
+            unsigned int undc;                          //!< Undefined characters
+            double secs;                                //!< Render time
+        };
+
+        bool capture;                                   //!< Capture enabled
+        char captureDir[maxName];                       //!< Capture directory
+        record_t captureRecs[maxRecs];                  //!< Recent jobs
+        unsigned int captureJobs;                       //!< Jobs captured
+
+        bool captureJob(const char *filename);
+        bool loadDMA(ks10_t::data_t mode, const uint8_t *buf, unsigned int bytes);
+        void initRAM(void);
+        void initVFU(void);
+        bool waitDMA(void);
+        bool printJob(const char *filename);
+        void spoolThread(void);
+
     public:
 
         //
@@ -106,8 +194,14 @@ class lp20_t {
 
         void initialize(void);
         void testRegs(void);
-        void dumpRegs(void);
+        void dumpRegs(bool script = false);
         void printFile(const char *filename);
+        void printQueue(void);
+        bool loadRAM(const char *filename);
+        bool loadVFU(const char *filename);
+        bool captureStart(const char *dir);
+        void captureStop(void);
+        void captureStat(void);
 
         //!
         //! \brief
@@ -123,7 +217,18 @@ class lp20_t {
             addrRAMD((baseADDR & 07777760) + offsetRAMD),
             addrCBUF((baseADDR & 07777760) + offsetCBUF),
             addrPDAT((baseADDR & 07777760) + offsetPDAT),
-            uba(baseADDR) {
+            uba(baseADDR),
+            running(false),
+            headJob(0),
+            numJobs(0),
+            ramImage(),
+            ramValid(false),
+            ramEpoch(0),
+            vfuLen(0),
+            vfuValid(false),
+            vfuEpoch(0),
+            capture(false),
+            captureJobs(0) {
             ;
         }
 };
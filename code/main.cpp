@@ -78,6 +78,7 @@ void __noreturn haltThread(void) {
     for (;;) {
         bool halt = ks10_t::halt();
         if (halt && !halted) {
+            ks10_t::recordHalt();
             printf("KS10: %sHalted.%s\n", vt100fg_red, vt100at_rst);
             print_hsb = true;
         } else if (halted && !halt) {
@@ -42,6 +42,7 @@
 #include "uba.hpp"
 #include "dasm.hpp"
 #include "rh11.hpp"
+#include "rhpoll.hpp"
 #include "vt100.hpp"
 #include "commands.hpp"
 
@@ -166,27 +167,150 @@ const char *mt_t::printMOP(uint16_t mop) {
     }
 }
 
+//!
+//! \brief
+//!    Print a register in decimal
+//!
+
+static const char *printDec(uint16_t value) {
+    static char buf[8];
+    snprintf(buf, sizeof(buf), "%u", value);
+    return buf;
+}
+
+//!
+//! \brief
+//!    Print a two's complement count (MTWC and MTFC) in decimal
+//!
+
+static const char *printCount(uint16_t value) {
+    static char buf[8];
+    snprintf(buf, sizeof(buf), "%u", 65536 - value);
+    return buf;
+}
+
+//
+// MT Register Descriptions
+//
+
+static const regs_t::field_t fieldsMTCS1[] = {
+    {"SC",      15, 1, NULL},
+    {"TRE",     14, 1, NULL},
+    {"CPE",     13, 1, NULL},
+    {"DVA",     11, 1, NULL},
+    {"A17",      9, 1, NULL},
+    {"A16",      8, 1, NULL},
+    {"RDY",      7, 1, NULL},
+    {"IE",       6, 1, NULL},
+    {"GO",       0, 1, NULL},
+    {"FUN",      1, 5, mt_t::printFUN},
+    {NULL,       0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsMTWC[] = {
+    {"CNT",      0, 16, printCount},
+    {NULL,       0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsMTFC[] = {
+    {"FC",       0, 16, printDec},
+    {"CNT",      0, 16, printCount},
+    {NULL,       0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsMTDS[] = {
+    {"ATA",     15, 1, NULL},
+    {"ERR",     14, 1, NULL},
+    {"PIP",     13, 1, NULL},
+    {"MOL",     12, 1, NULL},
+    {"WRL",     11, 1, NULL},
+    {"EOT",     10, 1, NULL},
+    {"DPR",      8, 1, NULL},
+    {"DRY",      7, 1, NULL},
+    {"SSC",      6, 1, NULL},
+    {"PES",      5, 1, NULL},
+    {"SDWN",     4, 1, NULL},
+    {"IDB",      3, 1, NULL},
+    {"TM",       2, 1, NULL},
+    {"BOT",      1, 1, NULL},
+    {"SLA",      0, 1, NULL},
+    {NULL,       0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsMTER[] = {
+    {"COR/CRC", 15, 1, NULL},
+    {"UNS",     14, 1, NULL},
+    {"OPI",     13, 1, NULL},
+    {"DTE",     12, 1, NULL},
+    {"NEF",     11, 1, NULL},
+    {"CS/ITM",  10, 1, NULL},
+    {"FCE",      9, 1, NULL},
+    {"NSG",      8, 1, NULL},
+    {"PEF/LRC",  7, 1, NULL},
+    {"INC/VPE",  6, 1, NULL},
+    {"DPAR",     5, 1, NULL},
+    {"FMTE",     4, 1, NULL},
+    {"PAR",      3, 1, NULL},
+    {"RMR",      2, 1, NULL},
+    {"ILR",      1, 1, NULL},
+    {"ILF",      0, 1, NULL},
+    {NULL,       0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsMTMR[] = {
+    {"MDF",      7, 9, NULL},
+    {"SWC2",     6, 1, NULL},
+    {"MC",       5, 1, NULL},
+    {"MM",       0, 1, NULL},
+    {"MOP",      1, 4, mt_t::printMOP},
+    {NULL,       0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsMTTC[] = {
+    {"ACCL",    15, 1, NULL},
+    {"FCS",     14, 1, NULL},
+    {"SAC",     13, 1, NULL},
+    {"EAO/DTE", 12, 1, NULL},
+    {"PAR",      3, 1, NULL},
+    {"DEN",      8, 3, mt_t::printDEN},
+    {"FMT",      4, 4, mt_t::printFMT},
+    {"SS",       0, 3, NULL},
+    {NULL,       0, 0, NULL},
+};
+
+//
+// Index of each register in regsMT[]
+//
+
+enum {
+    regMTCS1, regMTWC, regMTBA, regMTFC, regMTCS2, regMTDS, regMTER, regMTAS,
+    regMTCC, regMTDB, regMTMR, regMTDT, regMTSN, regMTTC,
+};
+
+static const regs_t::reg_t regsMT[] = {
+    {"MTCS1", 000, false, fieldsMTCS1},
+    {"MTWC",  002, false, fieldsMTWC},
+    {"MTBA",  004, false, NULL},
+    {"MTFC",  006, false, fieldsMTFC},
+    {"MTCS2", 010, false, rh11_t::fieldsCS2},
+    {"MTDS",  012, false, fieldsMTDS},
+    {"MTER",  014, false, fieldsMTER},
+    {"MTAS",  016, false, NULL},
+    {"MTCC",  020, false, NULL},
+    {"MTDB",  022, false, NULL},
+    {"MTMR",  024, false, fieldsMTMR},
+    {"MTDT",  026, false, NULL},
+    {"MTSN",  030, false, NULL},
+    {"MTTC",  032, false, fieldsMTTC},
+};
+
 //!
 //! \brief
 //!    Print MTCS1
 //!
 
 void mt_t::dumpMTCS1(ks10_t::addr_t addr) {
-    uint16_t mtcs1 = ks10_t::readIO16(addr);
-    printf("      MTCS1 = %06o %s%s%s%s%s%s%s%s%s%sFUN=%s%s\n",
-           mtcs1,
-           mtcs1 != 0     ? "("    : "",
-           mtcs1 & 0x8000 ? "SC "  : "",
-           mtcs1 & 0x4000 ? "TRE " : "",
-           mtcs1 & 0x2000 ? "CPE " : "",
-           mtcs1 & 0x0800 ? "DVA " : "",
-           mtcs1 & 0x0200 ? "A17 " : "",
-           mtcs1 & 0x0100 ? "A16 " : "",
-           mtcs1 & 0x0080 ? "RDY " : "",
-           mtcs1 & 0x0040 ? "IE "  : "",
-           mtcs1 & 0x0001 ? "GO "  : "",
-           printFUN((mtcs1 & 0x003e) >> 1),
-           mtcs1 != 0     ? ")"     : "");
+    regs_t::printReg(regsMT[regMTCS1], ks10_t::readIO16(addr));
 }
 
 //!
@@ -195,25 +319,7 @@ void mt_t::dumpMTCS1(ks10_t::addr_t addr) {
 //!
 
 void mt_t::dumpMTCS2(ks10_t::addr_t addr) {
-    uint16_t mtcs2 = ks10_t::readIO16(addr);
-    printf("      MTCS2 = %06o %s%s%s%s%s%s%s%s%s%s%s%s%s%sUNIT=%d%s\n",
-           mtcs2,
-           mtcs2 != 0     ? "("     : "",
-           mtcs2 & 0x8000 ? "DLT "  : "",
-           mtcs2 & 0x4000 ? "WCE "  : "",
-           mtcs2 & 0x2000 ? "UPE "  : "",
-           mtcs2 & 0x1000 ? "NED "  : "",
-           mtcs2 & 0x0800 ? "NEM "  : "",
-           mtcs2 & 0x0400 ? "PGE "  : "",
-           mtcs2 & 0x0200 ? "MXF "  : "",
-           mtcs2 & 0x0100 ? "MDPE " : "",
-           mtcs2 & 0x0080 ? "OR "   : "",
-           mtcs2 & 0x0040 ? "IR "   : "",
-           mtcs2 & 0x0020 ? "CLR "  : "",
-           mtcs2 & 0x0010 ? "PAT "  : "",
-           mtcs2 & 0x0008 ? "BAI "  : "",
-           (mtcs2 & 0x0007),
-           mtcs2 != 0     ? ")"     : "");
+    regs_t::printReg(regsMT[regMTCS2], ks10_t::readIO16(addr));
 }
 
 //!
@@ -222,26 +328,7 @@ void mt_t::dumpMTCS2(ks10_t::addr_t addr) {
 //!
 
 void mt_t::dumpMTDS(ks10_t::addr_t addr) {
-    uint16_t mtds = ks10_t::readIO16(addr);
-    printf("      MTDS  = %06o %s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s\n",
-           mtds,
-           mtds != 0     ? "("     : "",
-           mtds & 0x8000 ? "ATA "  : "",
-           mtds & 0x4000 ? "ERR "  : "",
-           mtds & 0x2000 ? "PIP "  : "",
-           mtds & 0x1000 ? "MOL "  : "",
-           mtds & 0x0800 ? "WRL "  : "",
-           mtds & 0x0400 ? "EOT "  : "",
-           mtds & 0x0100 ? "DPR "  : "",
-           mtds & 0x0080 ? "DRY "  : "",
-           mtds & 0x0040 ? "SSC "  : "",
-           mtds & 0x0020 ? "PES "  : "",
-           mtds & 0x0010 ? "SDWN " : "",
-           mtds & 0x0008 ? "IDB "  : "",
-           mtds & 0x0004 ? "TM "   : "",
-           mtds & 0x0002 ? "BOT "  : "",
-           mtds & 0x0001 ? "SLA "  : "",
-           mtds != 0     ? ")"     : "");
+    regs_t::printReg(regsMT[regMTDS], ks10_t::readIO16(addr));
 }
 
 //!
@@ -250,27 +337,7 @@ void mt_t::dumpMTDS(ks10_t::addr_t addr) {
 //!
 
 void mt_t::dumpMTER(ks10_t::addr_t addr) {
-    uint16_t mter = ks10_t::readIO16(addr);
-    printf("      MTER  = %06o %s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s\n",
-           mter,
-           mter != 0     ? "("        : "",
-           mter & 0x8000 ? "COR/CRC " : "",
-           mter & 0x4000 ? "UNS "     : "",
-           mter & 0x2000 ? "OPI "     : "",
-           mter & 0x1000 ? "DTE "     : "",
-           mter & 0x0800 ? "NEF "     : "",
-           mter & 0x0400 ? "CS/ITM "  : "",
-           mter & 0x0200 ? "FCE "     : "",
-           mter & 0x0100 ? "NSG "     : "",
-           mter & 0x0080 ? "PEF/LRC " : "",
-           mter & 0x0040 ? "INC/VPE " : "",
-           mter & 0x0020 ? "DPAR "    : "",
-           mter & 0x0010 ? "FMTE "    : "",
-           mter & 0x0008 ? "PAR "     : "",
-           mter & 0x0004 ? "RMR "     : "",
-           mter & 0x0002 ? "ILR "     : "",
-           mter & 0x0001 ? "ILF "     : "",
-           mter != 0     ? ")"        : "");
+    regs_t::printReg(regsMT[regMTER], ks10_t::readIO16(addr));
 }
 
 //!
@@ -279,14 +346,7 @@ void mt_t::dumpMTER(ks10_t::addr_t addr) {
 //!
 
 void mt_t::dumpMTMR(ks10_t::addr_t addr) {
-    uint16_t mtmr = ks10_t::readIO16(addr);
-    printf("      MTMR  = %06o (%03o %s%s%s %s)\n",
-           mtmr,
-           (mtmr & 0xff80) >> 7,
-           (mtmr & 0x0040) ? "SWC2 " : "",
-           (mtmr & 0x0020) ? "MC "   : "",
-           printMOP((mtmr & 0x001e) >> 1),
-           (mtmr & 0x0001) ? "MM "   : "");
+    regs_t::printReg(regsMT[regMTMR], ks10_t::readIO16(addr));
 }
 
 //!
@@ -295,8 +355,7 @@ void mt_t::dumpMTMR(ks10_t::addr_t addr) {
 //!
 
 void mt_t::dumpMTWC(ks10_t::addr_t addr) {
-    uint16_t mtwc = ks10_t::readIO16(addr);
-    printf("      MTWC  = %06o (%u)\n", mtwc, 65536-mtwc);
+    regs_t::printReg(regsMT[regMTWC], ks10_t::readIO16(addr));
 }
 
 //!
@@ -305,8 +364,7 @@ void mt_t::dumpMTWC(ks10_t::addr_t addr) {
 //!
 
 void mt_t::dumpMTFC(ks10_t::addr_t addr) {
-    uint16_t mtfc = ks10_t::readIO16(addr);
-    printf("      MTFC  = %06o (%u, %u)\n", mtfc, mtfc, 65536-mtfc);
+    regs_t::printReg(regsMT[regMTFC], ks10_t::readIO16(addr));
 }
 
 //!
@@ -315,63 +373,42 @@ void mt_t::dumpMTFC(ks10_t::addr_t addr) {
 //!
 
 void mt_t::dumpMTTC(ks10_t::addr_t addr) {
-    uint16_t mttc = ks10_t::readIO16(addr);
-    printf("      MTTC  = %06o (%s%s%s%s%sDEN=\"%s\" FMT=\"%s\" Slave=%d)\n",
-           mttc,
-           mttc & 0x8000 ? "ACCL "    : "",
-           mttc & 0x4000 ? "FCS "     : "",
-           mttc & 0x2000 ? "SAC "     : "",
-           mttc & 0x1000 ? "EAO/DTE " : "",
-           mttc & 0x0010 ? "PAR "     : "",
-           printDEN((mttc >> 8) & 0x07),
-           printFMT((mttc >> 4) & 0x0f),
-           ((mttc >> 0) & 0x07));
+    regs_t::printReg(regsMT[regMTTC], ks10_t::readIO16(addr));
 }
 
 //!
 //! \brief
 //!   Dump MT registers
 //!
+//! \details
+//!   All of the registers are read in one locked pass.
+//!
+//! \param script -
+//!   Print the registers as "name=value" assignments
+//!
 //! \todo
 //!   This doesn't select the drive correctly
 //!
 
-void mt_t::dumpRegs(uint16_t tcu, uint16_t param) {
+void mt_t::dumpRegs(uint16_t tcu, uint16_t param, bool script) {
 
     (void) tcu;
     (void) param;
 
-    dumpMTCS1(addrCS1);
-    dumpMTCS2(addrCS2);
-    dumpMTDS(addrDS);
-    dumpMTER(addrER);
-    dumpMTWC(addrWC);
-    dumpMTFC(addrFC);
-    dumpMTTC(addrTC);
-    printf("      MTBA  = %06o\n"
-           "      MTAS  = %06o\n"
-           "      MTCC  = %06o\n"
-           "      MTDB  = %06o\n"
-           "      MTMR  = %06o\n"
-           "      MTDT  = %06o\n"
-           "      MTSN  = %06o\n"
-           "      MTCCR = 0x%08x\n",
-           ks10_t::readIO16(addrBA),
-           ks10_t::readIO16(addrAS),
-           ks10_t::readIO16(addrCC),
-           ks10_t::readIO16(addrDB),
-           ks10_t::readIO16(addrMR),
-           ks10_t::readIO16(addrDT),
-           ks10_t::readIO16(addrSN),
-           ks10_t::readMTCCR());
+    regs_t::dump("mt", addrCS1, regsMT, sizeof(regsMT) / sizeof(regsMT[0]), script);
+    regs_t::printCCR("mt", "MTCCR", ks10_t::readMTCCR(), script);
 }
 
 //!
 //! \brief
-//!   executeCommand()
+//!   startCommand()
+//!
+//! \details
+//!   Configure the tape controller and issue the command without waiting for
+//!   it to complete.
 //!
 
-void mt_t::executeCommand(uint16_t tcu, uint16_t param, uint16_t cmd, uint16_t wordCnt, uint16_t frameCnt, ks10_t::addr_t vaddr) {
+void mt_t::startCommand(uint16_t tcu, uint16_t param, uint16_t cmd, uint16_t wordCnt, uint16_t frameCnt, ks10_t::addr_t vaddr) {
 
 #if 1
 
@@ -453,6 +490,16 @@ void mt_t::executeCommand(uint16_t tcu, uint16_t param, uint16_t cmd, uint16_t w
     //
 
     ks10_t::writeIO(addrCS1, (ks10_t::readIO16(addrCS1) & 0xffc0) | cmd);
+}
+
+//!
+//! \brief
+//!   executeCommand()
+//!
+
+void mt_t::executeCommand(uint16_t tcu, uint16_t param, uint16_t cmd, uint16_t wordCnt, uint16_t frameCnt, ks10_t::addr_t vaddr) {
+
+    startCommand(tcu, param, cmd, wordCnt, frameCnt, vaddr);
 
     //
     // Check status after the command
@@ -463,27 +510,19 @@ void mt_t::executeCommand(uint16_t tcu, uint16_t param, uint16_t cmd, uint16_t w
         //
         // Rewind-like commands may not show busy depending on tape position.
         //
+        // Time out after twenty seconds
+        //
 
-        for (int i = 0; i < 20000; i++) {
-            if (ks10_t::readIO16(addrDS) & MTDS_DRY) {
-                ks10_t::writeIO(addrAS, 1 << tcu);
-                break;
-            }
-            usleep(1000);
+        if (rhpoll_t::wait(addrDS, MTDS_DRY, 20000)) {
+            ks10_t::writeIO(addrAS, 1 << tcu);
         }
 
         //
         // Wait for BOT to assert again to indicate that the rewind is complete
         //
-        // Time out after 7 minutes
-        //
 
-        for (int i = 0; i < 420000; i++) {
-            if (ks10_t::readIO16(addrDS) & MTDS_BOT) {
-                ks10_t::writeIO(addrAS, 1 << tcu);
-                break;
-            }
-            usleep(1000);
+        if (rhpoll_t::wait(addrDS, MTDS_BOT, rewindTimeout)) {
+            ks10_t::writeIO(addrAS, 1 << tcu);
         }
 
     } else {
@@ -503,14 +542,8 @@ void mt_t::executeCommand(uint16_t tcu, uint16_t param, uint16_t cmd, uint16_t w
         // Time out after twenty seconds
         //
 
-        for (int i = 0;; i++) {
-            if (ks10_t::readIO16(addrDS) & MTDS_DRY) {
-                break;
-            } else if (i > 20000) {
-                printf("KS10: Drive timedout\n");
-                break;
-            }
-            usleep(1000);
+        if (!rhpoll_t::wait(addrDS, MTDS_DRY, 20000)) {
+            printf("KS10: Drive timedout\n");
         }
     }
 
@@ -529,8 +562,72 @@ void mt_t::executeCommand(uint16_t tcu, uint16_t param, uint16_t cmd, uint16_t w
 //!    Rewind the selected tape transport
 //!
 
-void mt_t::cmdRewind(uint16_t tcu, uint16_t param) {
-    executeCommand(tcu, param, MTCS1_FUN_REWIND);
+void mt_t::cmdRewind(uint16_t tcu, uint16_t param, bool nowait) {
+
+    if (!nowait) {
+        executeCommand(tcu, param, MTCS1_FUN_REWIND);
+        return;
+    }
+
+    rewind_t &req = rewindReq[tcu & 7];
+    if (req.busy) {
+        printf("KS10: TCU %d: Rewind already in progress.\n", tcu);
+        return;
+    }
+
+    req.mt   = this;
+    req.tcu  = tcu & 7;
+    req.unit = param & MTTC_SS;
+    req.bot  = false;
+    req.busy = true;
+
+    startCommand(tcu, param, MTCS1_FUN_REWIND);
+
+    if (!rhpoll_t::submit(addrDS, MTDS_DRY, 20000, rewindDone, &req)) {
+        req.busy = false;
+    }
+}
+
+//!
+//! \brief
+//!    Rewind completion callback
+//!
+//! \details
+//!    This function is called from the RH11 poller thread.  The first call
+//!    is made when the drive becomes ready and queues a wait for BOT.  The
+//!    second call is made when the tape reaches BOT.
+//!
+//! \param [in] arg -
+//!    Pointer to the rewind request
+//!
+//! \param [in] success -
+//!    False if the wait timed out.
+//!
+//! \param [in] usec -
+//!    Time to complete the wait in microseconds
+//!
+
+void mt_t::rewindDone(void *arg, bool success, unsigned int usec) {
+
+    rewind_t &req = *static_cast<rewind_t *>(arg);
+    mt_t &mt = *req.mt;
+
+    if (success) {
+        ks10_t::writeIO(mt.addrAS, 1 << req.tcu);
+    }
+
+    if (!req.bot) {
+        req.bot = true;
+        if (rhpoll_t::submit(mt.addrDS, MTDS_BOT, mt.rewindTimeout, rewindDone, arg)) {
+            return;
+        }
+    } else if (success) {
+        printf("KS10: Unit %d: Rewind complete (%u ms).\n", req.unit, usec / 1000);
+    } else {
+        printf("KS10: Unit %d: Rewind timed out.\n", req.unit);
+    }
+
+    req.busy = false;
 }
 
 //!
@@ -697,8 +794,6 @@ void mt_t::testRead(uint16_t tcu, uint16_t param) {
 
     bool pass = true;
     const int words              = 128;
-    const ks10_t::addr_t vaddr   = 004000;
-    const ks10_t::addr_t paddr   = 070000;
     const ks10_t::data_t pattern = 0525252525252;
 
     //
@@ -718,22 +813,37 @@ void mt_t::testRead(uint16_t tcu, uint16_t param) {
 
     //
     // Set Unibus mapping
-    //  This will page the destination address to 070000
+    //  This will page the destination to a staging buffer
     //
 
-    uba.writePAG(1, uba_t::PAG_FTM | uba_t::PAG_VLD | uba_t::addr2page(paddr));
+    ks10_t::addr_t paddr;
+    const ks10_t::addr_t vaddr = uba.allocPAG(1, &paddr);
+    if (vaddr == 0) {
+        return;
+    }
+    uba.mapPAG(vaddr, paddr, 1, uba_t::PAG_FTM | uba_t::PAG_VLD);
+
+    //
+    // The buffer starts one word into the page so that the words around
+    // it are also in the staging buffer.
+    //
+
+    const ks10_t::addr_t vbuf = vaddr + 4;
+    const ks10_t::addr_t pbuf = paddr + 1;
 
     //
     // Fill destination with data
     //
 
     for (int i = -1; i < words + 1; i++) {
-        ks10_t::writeMem(paddr + i, pattern);
+        ks10_t::writeMem(pbuf + i, pattern);
     }
 
-    executeCommand(MTCS1_FUN_RDFWD, param, words, 0, vaddr);
+    executeCommand(MTCS1_FUN_RDFWD, param, words, 0, vbuf);
 
     printf("KS10: Tape read test %s.\n", pass ? "passed" : "failed");
+
+    uba.freePAG(vaddr, 1, paddr);
 }
 
 //!
@@ -748,8 +858,6 @@ void mt_t::testWrite(uint16_t tcu, uint16_t param) {
 
     bool pass = true;
     const unsigned int words     = 128;
-    const ks10_t::addr_t vaddr   = 004000;
-    const ks10_t::addr_t paddr   = 070000;
     const ks10_t::data_t pattern = 0123456654321;
 
 #if 1
@@ -779,6 +887,18 @@ void mt_t::testWrite(uint16_t tcu, uint16_t param) {
         return;
     }
 
+    //
+    // Set Unibus mapping
+    //  This will page the destination to a staging buffer
+    //
+
+    ks10_t::addr_t paddr;
+    const ks10_t::addr_t vaddr = uba.allocPAG(1, &paddr);
+    if (vaddr == 0) {
+        return;
+    }
+    uba.mapPAG(vaddr, paddr, 1, uba_t::PAG_FTM | uba_t::PAG_VLD);
+
     //
     // Create data pattern
     //
@@ -793,13 +913,6 @@ void mt_t::testWrite(uint16_t tcu, uint16_t param) {
 
     ks10_t::writeIO(addrWC, -words*2);
 
-    //
-    // Set Unibus mapping
-    //  This will page the destination to 070000
-    //
-
-    uba.writePAG(1, uba_t::PAG_FTM | uba_t::PAG_VLD | uba_t::addr2page(paddr));
-
     //
     // Set destination address
     //
@@ -809,6 +922,7 @@ void mt_t::testWrite(uint16_t tcu, uint16_t param) {
     printf("KS10: Tape write test %s.\n", pass ? "passed" : "failed");
     printf("Not implemented.\n");
 
+    uba.freePAG(vaddr, 1, paddr);
 }
 
 //!
@@ -823,12 +937,9 @@ void mt_t::testWrchk(uint16_t tcu, uint16_t param) {
 
     bool pass = true;
     const unsigned int words     = 128;
-    const unsigned int vaddr     = 004000;
-    const unsigned int paddr     = 070000;
     const ks10_t::data_t pattern = 0123456654321;
 
 #if 1
-    (void)vaddr;
     (void)param;
 #endif
 
@@ -855,6 +966,18 @@ void mt_t::testWrchk(uint16_t tcu, uint16_t param) {
         return;
     }
 
+    //
+    // Set Unibus mapping
+    //  This will page the destination to a staging buffer
+    //
+
+    ks10_t::addr_t paddr;
+    const ks10_t::addr_t vaddr = uba.allocPAG(1, &paddr);
+    if (vaddr == 0) {
+        return;
+    }
+    uba.mapPAG(vaddr, paddr, 1, uba_t::PAG_FTM | uba_t::PAG_VLD);
+
     //
     // Create data pattern
     //
@@ -869,13 +992,6 @@ void mt_t::testWrchk(uint16_t tcu, uint16_t param) {
 
     ks10_t::writeIO(addrWC, -words*2);
 
-    //
-    // Set Unibus mapping
-    //  This will page the destination to 070000
-    //
-
-    uba.writePAG(1, uba_t::PAG_FTM | uba_t::PAG_VLD | uba_t::addr2page(paddr));
-
     //
     // Set destination address
     //
@@ -883,6 +999,7 @@ void mt_t::testWrchk(uint16_t tcu, uint16_t param) {
     printf("KS10: Tape write check test %s.\n", pass ? "passed" : "failed");
     printf("Not implemented.\n");
 
+    uba.freePAG(vaddr, 1, paddr);
 }
 
 //!
@@ -120,7 +120,28 @@ class mt_t : public rh11_t {
         // Private Functions
         //
 
+        void startCommand(uint16_t tcu, uint16_t param, uint16_t cmd, uint16_t wordCnt = 0, uint16_t frameCnt = 0, ks10_t::addr_t = 0);
         void executeCommand(uint16_t tcu, uint16_t param, uint16_t cmd, uint16_t wordCnt = 0, uint16_t frameCnt = 0, ks10_t::addr_t = 0);
+        static void rewindDone(void *arg, bool success, unsigned int usec);
+
+        //!
+        //! \brief
+        //!    Outstanding rewind request (one per TCU)
+        //!
+
+        struct rewind_t {
+            mt_t *mt;                   //!< Tape object
+            uint16_t tcu;               //!< Tape control unit
+            uint16_t unit;              //!< Slave unit
+            bool bot;                   //!< Waiting for BOT
+            volatile bool busy;         //!< Rewind in progress
+        } rewindReq[8];
+
+        //
+        // Rewind timeout in milliseconds.  Default is 7 minutes.
+        //
+
+        unsigned int rewindTimeout;
 
     public:
 
@@ -300,9 +321,9 @@ class mt_t : public rh11_t {
         static void dumpMTFC(ks10_t::addr_t addr);
         static void dumpMTTC(ks10_t::addr_t addr);
 
-        void dumpRegs(uint16_t tcu, uint16_t param);
+        void dumpRegs(uint16_t tcu, uint16_t param, bool script = false);
         void cmdErase(uint16_t tcu, uint16_t param);
-        void cmdRewind(uint16_t tcu, uint16_t param);
+        void cmdRewind(uint16_t tcu, uint16_t param, bool nowait = false);
         void cmdUnload(uint16_t tcu, uint16_t param);
         void cmdPreset(uint16_t tcu, uint16_t param);
         void cmdSpaceFwd(uint16_t tcu, uint16_t param, uint16_t frameCount);
@@ -313,12 +334,46 @@ class mt_t : public rh11_t {
         void testWrchk(uint16_t tcu, uint16_t param);
         void boot(uint16_t tcu, uint16_t param, bool diagmode = false);
 
+        //!
+        //! \brief
+        //!    Set the rewind timeout
+        //!
+        //! \param ms -
+        //!    Timeout in milliseconds
+        //!
+
+        void setRewindTimeout(unsigned int ms) {
+            rewindTimeout = ms;
+        }
+
+        //!
+        //! \brief
+        //!    Returns true if a rewind is in progress
+        //!
+        //! \details
+        //!    The RH11 poller reads MTDS and writes MTAS of the TCU and slave
+        //!    that were selected when the rewind was started.  No other MT
+        //!    command may change the selection until the rewind completes.
+        //!
+
+        bool rewindBusy(void) const {
+            for (unsigned int i = 0; i < 8; i++) {
+                if (rewindReq[i].busy) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
         //!
         //! \brief
         //!    Constructor. Setup register addresses.
         //!
 
-        mt_t(int32_t baseADDR = baseADDR_MT) : rh11_t(baseADDR) {
+        mt_t(int32_t baseADDR = baseADDR_MT) :
+            rh11_t(baseADDR),
+            rewindReq(),
+            rewindTimeout(420000) {
             ;
         }
 };
@@ -0,0 +1,285 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    PDP-10 Byte Packing
+//!
+//! \details
+//!    This file implements the bulk byte packing functions.
+//!
+//!    The UNIBUS and COMPAT layouts use four bytes per word and are converted
+//!    four words at a time with NEON (ARM) or SSE2 (x86) when available.  The
+//!    remaining words, and the five byte layouts (CORDMP and ANSI) which do
+//!    not map onto vector lanes, use the scalar functions in pack.hpp.
+//!
+//!    The vector code assumes a little-endian host.
+//!
+//!    The round-trip tests and benchmarks are in tools/packtest.
+//!
+//! \file
+//!    pack.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "pack.hpp"
+
+//!
+//! \brief
+//!    Pack Unibus bytes into words
+//!
+//! \details
+//!    Each 32-bit little-endian lane x holds bytes 0-3 of a word.  The word
+//!    is ((x & 0xffff) << 18) | (x >> 16).
+//!
+//! \param [out] dst -
+//!    Destination words.  Must hold (bytes + 3) / 4 words.
+//!
+//! \param [in] src -
+//!    Source bytes
+//!
+//! \param [in] bytes -
+//!    Number of bytes.  A partial last word is padded with zeros.
+//!
+//! \returns
+//!    Number of words that were packed
+//!
+
+unsigned int pack_t::packUNIBUS(ks10_t::data_t *dst, const uint8_t *src, unsigned int bytes) {
+
+    unsigned int words = bytes / 4;
+    unsigned int i = 0;
+
+#if defined(__ARM_NEON)
+    const uint64x2_t mask = vdupq_n_u64(0xffff);
+    for (; i + 4 <= words; i += 4) {
+        uint32x4_t x  = vreinterpretq_u32_u8(vld1q_u8(&src[i * 4]));
+        uint64x2_t lo = vmovl_u32(vget_low_u32(x));
+        uint64x2_t hi = vmovl_u32(vget_high_u32(x));
+        lo = vorrq_u64(vshlq_n_u64(vandq_u64(lo, mask), 18), vshrq_n_u64(lo, 16));
+        hi = vorrq_u64(vshlq_n_u64(vandq_u64(hi, mask), 18), vshrq_n_u64(hi, 16));
+        vst1q_u64(&dst[i + 0], lo);
+        vst1q_u64(&dst[i + 2], hi);
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi64x(0xffff);
+    for (; i + 4 <= words; i += 4) {
+        __m128i x  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&src[i * 4]));
+        __m128i lo = _mm_unpacklo_epi32(x, zero);
+        __m128i hi = _mm_unpackhi_epi32(x, zero);
+        lo = _mm_or_si128(_mm_slli_epi64(_mm_and_si128(lo, mask), 18), _mm_srli_epi64(lo, 16));
+        hi = _mm_or_si128(_mm_slli_epi64(_mm_and_si128(hi, mask), 18), _mm_srli_epi64(hi, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[i + 0]), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[i + 2]), hi);
+    }
+#endif
+
+    for (; i < words; i++) {
+        dst[i] = packUNIBUS(&src[i * 4]);
+    }
+
+    if (bytes & 3) {
+        uint8_t tail[4] = {0, 0, 0, 0};
+        for (unsigned int j = 0; j < (bytes & 3); j++) {
+            tail[j] = src[words * 4 + j];
+        }
+        dst[words++] = packUNIBUS(tail);
+    }
+
+    return words;
+}
+
+//!
+//! \brief
+//!    Unpack words into Unibus bytes
+//!
+//! \param [out] dst -
+//!    Destination bytes.  Must hold 4 * words bytes.
+//!
+//! \param [in] src -
+//!    Source words
+//!
+//! \param [in] words -
+//!    Number of words
+//!
+
+void pack_t::unpackUNIBUS(uint8_t *dst, const ks10_t::data_t *src, unsigned int words) {
+    for (unsigned int i = 0; i < words; i++) {
+        unpackUNIBUS(src[i], &dst[i * 4]);
+    }
+}
+
+//!
+//! \brief
+//!    Pack Core Dump bytes into words
+//!
+//! \param [out] dst -
+//!    Destination words
+//!
+//! \param [in] src -
+//!    Source bytes.  Must hold 5 * words bytes.
+//!
+//! \param [in] words -
+//!    Number of words
+//!
+
+void pack_t::packCORDMP(ks10_t::data_t *dst, const uint8_t *src, unsigned int words) {
+    for (unsigned int i = 0; i < words; i++) {
+        dst[i] = packCORDMP(&src[i * 5]);
+    }
+}
+
+//!
+//! \brief
+//!    Unpack words into Core Dump bytes
+//!
+//! \param [out] dst -
+//!    Destination bytes.  Must hold 5 * words bytes.
+//!
+//! \param [in] src -
+//!    Source words
+//!
+//! \param [in] words -
+//!    Number of words
+//!
+
+void pack_t::unpackCORDMP(uint8_t *dst, const ks10_t::data_t *src, unsigned int words) {
+    for (unsigned int i = 0; i < words; i++) {
+        unpackCORDMP(src[i], &dst[i * 5]);
+    }
+}
+
+//!
+//! \brief
+//!    Pack Compatible bytes into words
+//!
+//! \details
+//!    Each word is the big-endian 32-bit value of its four bytes shifted
+//!    left four bits.
+//!
+//! \param [out] dst -
+//!    Destination words
+//!
+//! \param [in] src -
+//!    Source bytes.  Must hold 4 * words bytes.
+//!
+//! \param [in] words -
+//!    Number of words
+//!
+
+void pack_t::packCOMPAT(ks10_t::data_t *dst, const uint8_t *src, unsigned int words) {
+
+    unsigned int i = 0;
+
+#if defined(__ARM_NEON)
+    for (; i + 4 <= words; i += 4) {
+        uint32x4_t x  = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(&src[i * 4])));
+        vst1q_u64(&dst[i + 0], vshlq_n_u64(vmovl_u32(vget_low_u32(x)),  4));
+        vst1q_u64(&dst[i + 2], vshlq_n_u64(vmovl_u32(vget_high_u32(x)), 4));
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= words; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&src[i * 4]));
+        x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+        x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[i + 0]), _mm_slli_epi64(_mm_unpacklo_epi32(x, zero), 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[i + 2]), _mm_slli_epi64(_mm_unpackhi_epi32(x, zero), 4));
+    }
+#endif
+
+    for (; i < words; i++) {
+        dst[i] = packCOMPAT(&src[i * 4]);
+    }
+}
+
+//!
+//! \brief
+//!    Unpack words into Compatible bytes
+//!
+//! \param [out] dst -
+//!    Destination bytes.  Must hold 4 * words bytes.
+//!
+//! \param [in] src -
+//!    Source words
+//!
+//! \param [in] words -
+//!    Number of words
+//!
+
+void pack_t::unpackCOMPAT(uint8_t *dst, const ks10_t::data_t *src, unsigned int words) {
+    for (unsigned int i = 0; i < words; i++) {
+        unpackCOMPAT(src[i], &dst[i * 4]);
+    }
+}
+
+//!
+//! \brief
+//!    Pack ANSI-ASCII bytes into words
+//!
+//! \param [out] dst -
+//!    Destination words
+//!
+//! \param [in] src -
+//!    Source bytes.  Must hold 5 * words bytes.
+//!
+//! \param [in] words -
+//!    Number of words
+//!
+
+void pack_t::packANSI(ks10_t::data_t *dst, const uint8_t *src, unsigned int words) {
+    for (unsigned int i = 0; i < words; i++) {
+        dst[i] = packANSI(&src[i * 5]);
+    }
+}
+
+//!
+//! \brief
+//!    Unpack words into ANSI-ASCII bytes
+//!
+//! \param [out] dst -
+//!    Destination bytes.  Must hold 5 * words bytes.
+//!
+//! \param [in] src -
+//!    Source words
+//!
+//! \param [in] words -
+//!    Number of words
+//!
+
+void pack_t::unpackANSI(uint8_t *dst, const ks10_t::data_t *src, unsigned int words) {
+    for (unsigned int i = 0; i < words; i++) {
+        unpackANSI(src[i], &dst[i * 5]);
+    }
+}
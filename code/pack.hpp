@@ -0,0 +1,269 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    PDP-10 Byte Packing
+//!
+//! \details
+//!    This object converts between host byte streams and 36-bit PDP-10 words
+//!    for the byte layouts used by the console:
+//!
+//!    - UNIBUS: Four 8-bit bytes per word as seen by Unibus DMA devices (LP20)
+//!    - CORDMP: Five bytes per word (tape Core Dump format)
+//!    - COMPAT: Four bytes per word (tape Compatible format)
+//!    - ANSI:   Five 7-bit bytes per word (ANSI-ASCII .SAV files)
+//!
+//!    "Pack" converts bytes to words.  "Unpack" converts words to bytes.
+//!
+//!    The single word functions are inline.  The bulk functions convert an
+//!    entire buffer and use NEON or SSE2 when the compiler supports it.
+//!
+//! \file
+//!    pack.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#ifndef __PACK_HPP
+#define __PACK_HPP
+
+#include <stdint.h>
+
+#include "ks10.hpp"
+
+//!
+//! \brief
+//!    PDP-10 Byte Packing Object
+//!
+
+class pack_t {
+
+    public:
+
+        //!
+        //! \brief
+        //!    Pack four Unibus bytes into a word
+        //!
+        //! \details
+        //!    Unibus DMA data is packed four 8-bit bytes to the KS10 word.
+        //!    Bits 16, 17, 34, and 35 are not used.
+        //!
+        //!    Byte 0: B10 B11 B12 B13 B14 B15 B16 B17
+        //!    Byte 1: B02 B03 B04 B05 B06 B07 B08 B09
+        //!    Byte 2: B28 B29 B30 B31 B32 B33 B34 B35
+        //!    Byte 3: B20 B21 B22 B23 B24 B25 B26 B27
+        //!
+        //! \param b -
+        //!    Pointer to four bytes
+        //!
+        //! \returns
+        //!    36-bit data word
+        //!
+
+        static ks10_t::data_t packUNIBUS(const uint8_t *b) {
+            return (((ks10_t::data_t)b[0] << 18) |
+                    ((ks10_t::data_t)b[1] << 26) |
+                    ((ks10_t::data_t)b[2] <<  0) |
+                    ((ks10_t::data_t)b[3] <<  8));
+        }
+
+        //!
+        //! \brief
+        //!    Unpack a word into four Unibus bytes
+        //!
+        //! \param data -
+        //!    36-bit data word
+        //!
+        //! \param b -
+        //!    Pointer to four bytes
+        //!
+
+        static void unpackUNIBUS(ks10_t::data_t data, uint8_t *b) {
+            b[0] = (data >> 18) & 0xff;
+            b[1] = (data >> 26) & 0xff;
+            b[2] = (data >>  0) & 0xff;
+            b[3] = (data >>  8) & 0xff;
+        }
+
+        //!
+        //! \brief
+        //!    Pack five Core Dump bytes into a word
+        //!
+        //! \details
+        //!    Core Dump Data (Format 0) is stored as follows:
+        //!
+        //!    Byte 0: B00 B01 B02 B03 B04 B05 B06 B07
+        //!    Byte 1: B08 B09 B10 B11 B12 B13 B14 B15
+        //!    Byte 2: B16 B17 B18 B19 B20 B21 B22 B23
+        //!    Byte 3: B24 B25 B26 B27 B28 B29 B30 B31
+        //!    Byte 4:  0   0   0   0  B32 B33 B34 B35
+        //!
+        //! \param b -
+        //!    Pointer to five bytes
+        //!
+        //! \returns
+        //!    36-bit data word
+        //!
+
+        static ks10_t::data_t packCORDMP(const uint8_t *b) {
+            return (((ks10_t::data_t)b[0] << 28) |
+                    ((ks10_t::data_t)b[1] << 20) |
+                    ((ks10_t::data_t)b[2] << 12) |
+                    ((ks10_t::data_t)b[3] <<  4) |
+                    ((ks10_t::data_t)b[4] & 0x0f));
+        }
+
+        //!
+        //! \brief
+        //!    Unpack a word into five Core Dump bytes
+        //!
+        //! \param data -
+        //!    36-bit data word
+        //!
+        //! \param b -
+        //!    Pointer to five bytes
+        //!
+
+        static void unpackCORDMP(ks10_t::data_t data, uint8_t *b) {
+            b[0] = (data >> 28) & 0xff;
+            b[1] = (data >> 20) & 0xff;
+            b[2] = (data >> 12) & 0xff;
+            b[3] = (data >>  4) & 0xff;
+            b[4] = (data >>  0) & 0x0f;
+        }
+
+        //!
+        //! \brief
+        //!    Pack four Compatible bytes into a word
+        //!
+        //! \details
+        //!    Compat Data (Format 3) is stored as follows:
+        //!
+        //!    Byte 0: B00 B01 B02 B03 B04 B05 B06 B07
+        //!    Byte 1: B08 B09 B10 B11 B12 B13 B14 B15
+        //!    Byte 2: B16 B17 B18 B19 B20 B21 B22 B23
+        //!    Byte 3: B24 B25 B26 B27 B28 B29 B30 B31
+        //!
+        //!    Bits 32-35 are not stored.
+        //!
+        //! \param b -
+        //!    Pointer to four bytes
+        //!
+        //! \returns
+        //!    36-bit data word
+        //!
+
+        static ks10_t::data_t packCOMPAT(const uint8_t *b) {
+            return (((ks10_t::data_t)b[0] << 28) |
+                    ((ks10_t::data_t)b[1] << 20) |
+                    ((ks10_t::data_t)b[2] << 12) |
+                    ((ks10_t::data_t)b[3] <<  4));
+        }
+
+        //!
+        //! \brief
+        //!    Unpack a word into four Compatible bytes
+        //!
+        //! \param data -
+        //!    36-bit data word
+        //!
+        //! \param b -
+        //!    Pointer to four bytes
+        //!
+
+        static void unpackCOMPAT(ks10_t::data_t data, uint8_t *b) {
+            b[0] = (data >> 28) & 0xff;
+            b[1] = (data >> 20) & 0xff;
+            b[2] = (data >> 12) & 0xff;
+            b[3] = (data >>  4) & 0xff;
+        }
+
+        //!
+        //! \brief
+        //!    Pack five ANSI-ASCII bytes into a word
+        //!
+        //! \details
+        //!    Data is in the format:
+        //!
+        //!       Byte 0:   0  B00 B01 B02 B03 B04 B05 B06
+        //!       Byte 1:   0  B07 B08 B09 B10 B11 B12 B13
+        //!       Byte 2:   0  B14 B15 B16 B17 B18 B19 B20
+        //!       Byte 3:   0  B21 B22 B23 B24 B25 B26 B27
+        //!       Byte 4:  B35 B28 B29 B30 B31 B32 B33 B34
+        //!
+        //!       Note the position of B35!
+        //!
+        //!    See "TOPS-10 Tape Processing Manual" Section 6.4 entitled
+        //!    "ANSI-ASCII Mode" for format definition.
+        //!
+        //!    See also document entitled "Dumper and Backup Tape Formats".
+        //!
+        //! \param b -
+        //!    Pointer to five bytes
+        //!
+        //! \returns
+        //!    36-bit data word
+        //!
+
+        static ks10_t::data_t packANSI(const uint8_t *b) {
+            return ((((ks10_t::data_t)(b[0] & 0x7f)) << 29) |   // Bit  0 - Bit  6
+                    (((ks10_t::data_t)(b[1] & 0x7f)) << 22) |   // Bit  7 - Bit 13
+                    (((ks10_t::data_t)(b[2] & 0x7f)) << 15) |   // Bit 14 - Bit 20
+                    (((ks10_t::data_t)(b[3] & 0x7f)) <<  8) |   // Bit 21 - Bit 27
+                    (((ks10_t::data_t)(b[4] & 0x7f)) <<  1) |   // Bit 28 - Bit 34
+                    (((ks10_t::data_t)(b[4] & 0x80)) >>  7));   // Bit 35
+        }
+
+        //!
+        //! \brief
+        //!    Unpack a word into five ANSI-ASCII bytes
+        //!
+        //! \param data -
+        //!    36-bit data word
+        //!
+        //! \param b -
+        //!    Pointer to five bytes
+        //!
+
+        static void unpackANSI(ks10_t::data_t data, uint8_t *b) {
+            b[0] = (data >> 29) & 0x7f;
+            b[1] = (data >> 22) & 0x7f;
+            b[2] = (data >> 15) & 0x7f;
+            b[3] = (data >>  8) & 0x7f;
+            b[4] = ((data >> 1) & 0x7f) | ((data & 1) << 7);
+        }
+
+        static unsigned int packUNIBUS(ks10_t::data_t *dst, const uint8_t *src, unsigned int bytes);
+        static void unpackUNIBUS(uint8_t *dst, const ks10_t::data_t *src, unsigned int words);
+        static void packCORDMP(ks10_t::data_t *dst, const uint8_t *src, unsigned int words);
+        static void unpackCORDMP(uint8_t *dst, const ks10_t::data_t *src, unsigned int words);
+        static void packCOMPAT(ks10_t::data_t *dst, const uint8_t *src, unsigned int words);
+        static void unpackCOMPAT(uint8_t *dst, const ks10_t::data_t *src, unsigned int words);
+        static void packANSI(ks10_t::data_t *dst, const uint8_t *src, unsigned int words);
+        static void unpackANSI(uint8_t *dst, const ks10_t::data_t *src, unsigned int words);
+};
+
+#endif
@@ -0,0 +1,422 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    PC Sampling Profiler Object
+//!
+//! \details
+//!    The sampler thread wakes on an absolute schedule so the sample rate
+//!    does not drift with the time spent taking each sample.  If the thread
+//!    falls behind, the missed periods are skipped and counted instead of
+//!    being taken in a burst.
+//!
+//!    The KS10 has no call stack that the console can see, so the folded
+//!    stacks are two levels deep: the page and the symbol (or the PC when no
+//!    symbols are loaded).
+//!
+//!    The samples are taken from PCIR, which holds the PC and IR but no
+//!    user/exec mode bit.  User and monitor samples at the same PC are
+//!    therefore merged into one histogram entry.
+//!
+//! \file
+//!    prof.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prof.hpp"
+#include "util.hpp"
+
+//!
+//! \brief
+//!    Advance a timespec by a number of nanoseconds
+//!
+
+static void advance(struct timespec &ts, uint64_t ns) {
+    ns += ts.tv_nsec;
+    ts.tv_sec  += ns / 1000000000ULL;
+    ts.tv_nsec  = ns % 1000000000ULL;
+}
+
+//!
+//! \brief
+//!    Sampler thread
+//!
+
+void prof_t::sampleLoop(void) {
+
+    uint64_t period = 1000000000ULL / rate;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (profRun) {
+
+        advance(next, period);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        struct timespec t0;
+        struct timespec t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        bool halted = ks10_t::halt();
+        uint64_t pcir = halted ? 0 : ks10_t::readPCIR();
+
+        std::lock_guard<std::mutex> lock(profMutex);
+        stats.samples++;
+        if (halted) {
+            stats.halted++;
+        } else {
+            unsigned int pc = (pcir >> 36) & 0777777;
+            pcHits[pc]++;
+            pageHits[pc >> 9]++;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        stats.sampleNsecs += nsecs(t0, t1);
+
+        //
+        // Skip the periods that were missed
+        //
+
+        uint64_t late = nsecs(next, t1);
+        if ((int64_t)late > (int64_t)period) {
+            uint64_t missed = late / period;
+            stats.missed += missed;
+            advance(next, missed * period);
+        }
+    }
+}
+
+//!
+//! \brief
+//!    Return the total sampling time in nanoseconds
+//!
+
+uint64_t prof_t::elapsed(void) {
+    uint64_t ret = elapsedNsecs;
+    if (profThread.joinable()) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        ret += nsecs(startTime, now);
+    }
+    return ret;
+}
+
+//!
+//! \brief
+//!    Start sampling
+//!
+//! \details
+//!    The histograms are not cleared so that several runs can be combined.
+//!
+//! \param [in] rate -
+//!    Samples per second
+//!
+//! \returns
+//!    True if the sampler was started
+//!
+
+bool prof_t::start(unsigned int rate) {
+
+    if (profRun) {
+        printf("KS10: Profiler is already running.\n");
+        return false;
+    }
+
+    if ((rate == 0) || (rate > 100000)) {
+        printf("KS10: Sample rate must be between 1 and 100000 samples per second.\n");
+        return false;
+    }
+
+    stop();
+
+    if (pcHits == NULL) {
+        pcHits = new uint32_t[numPC];
+        clear();
+    }
+
+    this->rate = rate;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    profRun = true;
+    profThread = std::thread(&prof_t::sampleLoop, this);
+
+    printf("KS10: Profiler started at %u samples per second.\n", rate);
+    return true;
+}
+
+//!
+//! \brief
+//!    Stop sampling
+//!
+
+void prof_t::stop(void) {
+    profRun = false;
+    if (profThread.joinable()) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        profThread.join();
+        elapsedNsecs += nsecs(startTime, now);
+    }
+}
+
+//!
+//! \brief
+//!    Clear the histograms and the statistics
+//!
+
+void prof_t::clear(void) {
+    std::lock_guard<std::mutex> lock(profMutex);
+    if (pcHits) {
+        memset(pcHits, 0, numPC * sizeof(pcHits[0]));
+    }
+    memset(pageHits, 0, sizeof(pageHits));
+    memset(&stats, 0, sizeof(stats));
+    elapsedNsecs = 0;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+}
+
+//!
+//! \brief
+//!    Print the sampler statistics
+//!
+//! \details
+//!    The overhead is the fraction of one console CPU that is spent taking
+//!    samples.  Sleeping between samples is not included.
+//!
+
+void prof_t::stat(void) {
+
+    stats_t copy;
+    {
+        std::lock_guard<std::mutex> lock(profMutex);
+        copy = stats;
+    }
+
+    double secs = elapsed() / 1.0e9;
+
+    printf("KS10: Profiler is %s.\n"
+           "      Rate      : %u samples/sec requested, %.0f samples/sec achieved\n"
+           "      Time      : %.1f seconds\n"
+           "      Samples   : %llu (%llu while halted)\n"
+           "      Missed    : %llu sample periods\n"
+           "      Cost      : %.0f ns per sample (%.3f%% of one CPU)\n",
+           profRun ? "running" : "stopped",
+           rate, secs > 0 ? copy.samples / secs : 0.0,
+           secs,
+           copy.samples, copy.halted,
+           copy.missed,
+           copy.samples ? (double)copy.sampleNsecs / copy.samples : 0.0,
+           secs > 0 ? 100.0 * copy.sampleNsecs / 1.0e9 / secs : 0.0);
+}
+
+//!
+//! \brief
+//!    Print a flat profile
+//!
+//! \details
+//!    With a symbol table the samples are summed by symbol.  Samples that do
+//!    not resolve to a symbol are summed by page.  Without a symbol table
+//!    the samples are listed by PC.  The busiest pages are listed last.
+//!
+//! \param [in] fp -
+//!    Output file
+//!
+//! \param [in] sym -
+//!    Symbol table
+//!
+//! \param [in] top -
+//!    Number of lines in each table
+//!
+
+void prof_t::flat(FILE *fp, const symtab_t &sym, unsigned int top) {
+
+    if (pcHits == NULL) {
+        fprintf(fp, "KS10: Profiler has not been started.\n");
+        return;
+    }
+
+    uint32_t *pc = new uint32_t[numPC];
+    uint32_t page[numPage];
+    stats_t copy;
+    {
+        std::lock_guard<std::mutex> lock(profMutex);
+        memcpy(pc, pcHits, numPC * sizeof(pc[0]));
+        memcpy(page, pageHits, sizeof(page));
+        copy = stats;
+    }
+
+    uint64_t total = copy.samples - copy.halted;
+    fprintf(fp, "KS10: Flat profile of %llu samples (%llu more while halted).\n", total, copy.halted);
+    if (total == 0) {
+        delete[] pc;
+        return;
+    }
+
+    fprintf(fp, "\n"
+                "  Count     Pct     Cum    Location\n"
+                "---------  ------  ------  --------\n");
+
+    double cum = 0;
+    if (sym.size()) {
+        unsigned int num = sym.size() + numPage;
+        uint32_t *hits = new uint32_t[num];
+        memset(hits, 0, num * sizeof(hits[0]));
+        for (unsigned int i = 0; i < numPC; i++) {
+            if (pc[i]) {
+                int s = sym.lookup(i);
+                hits[s < 0 ? sym.size() + (i >> 9) : (unsigned int)s] += pc[i];
+            }
+        }
+        unsigned int *index = sortIndex(hits, num);
+        for (unsigned int i = 0; (i < top) && (i < num) && (hits[index[i]] != 0); i++) {
+            double pct = 100.0 * hits[index[i]] / total;
+            cum += pct;
+            if (index[i] < sym.size()) {
+                fprintf(fp, "%9u  %5.2f%%  %5.1f%%  %s\n", hits[index[i]], pct, cum, sym[index[i]].name);
+            } else {
+                fprintf(fp, "%9u  %5.2f%%  %5.1f%%  page %03o\n", hits[index[i]], pct, cum, index[i] - sym.size());
+            }
+        }
+        delete[] index;
+        delete[] hits;
+    } else {
+        unsigned int *index = sortIndex(pc, numPC);
+        for (unsigned int i = 0; (i < top) && (pc[index[i]] != 0); i++) {
+            double pct = 100.0 * pc[index[i]] / total;
+            cum += pct;
+            fprintf(fp, "%9u  %5.2f%%  %5.1f%%  %06o\n", pc[index[i]], pct, cum, index[i]);
+        }
+        delete[] index;
+    }
+
+    fprintf(fp, "\n"
+                "  Count     Pct     Cum    Page  Addresses\n"
+                "---------  ------  ------  ----  -------------\n");
+
+    cum = 0;
+    unsigned int *index = sortIndex(page, numPage);
+    for (unsigned int i = 0; (i < top) && (i < numPage) && (page[index[i]] != 0); i++) {
+        double pct = 100.0 * page[index[i]] / total;
+        cum += pct;
+        fprintf(fp, "%9u  %5.2f%%  %5.1f%%  %03o   %06o-%06o\n", page[index[i]], pct, cum,
+                index[i], index[i] << 9, (index[i] << 9) | 0777);
+    }
+    delete[] index;
+    delete[] pc;
+}
+
+//!
+//! \brief
+//!    Write the samples as folded stacks
+//!
+//! \details
+//!    Each line is "page;location count" which is the input format of the
+//!    usual flame graph tools.  The location is the symbol when a symbol
+//!    table is loaded or the PC otherwise.  Samples taken while the KS10 was
+//!    halted are written as "HALTED count".
+//!
+//! \param [in] filename -
+//!    Name of the file to create
+//!
+//! \param [in] sym -
+//!    Symbol table
+//!
+//! \returns
+//!    True if the file was written
+//!
+
+bool prof_t::folded(const char *filename, const symtab_t &sym) {
+
+    if (pcHits == NULL) {
+        printf("KS10: Profiler has not been started.\n");
+        return false;
+    }
+
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        printf("KS10: Unable to open file \"%s\". %s\n", filename, strerror(errno));
+        return false;
+    }
+
+    uint32_t *pc = new uint32_t[numPC];
+    stats_t copy;
+    {
+        std::lock_guard<std::mutex> lock(profMutex);
+        memcpy(pc, pcHits, numPC * sizeof(pc[0]));
+        copy = stats;
+    }
+
+    //
+    // The PCs are visited in order and symbols are sorted by value, so the
+    // samples for each page and symbol are adjacent and can be summed as
+    // they are found.
+    //
+
+    unsigned int lines = 0;
+    uint64_t sum = 0;
+    int lastSym = -1;
+    unsigned int lastPC = 0;
+    for (unsigned int i = 0; i <= numPC; i++) {
+        int s = -1;
+        if (i < numPC) {
+            if (pc[i] == 0) {
+                continue;
+            }
+            s = sym.lookup(i);
+        }
+        bool same = (sum != 0) && (i < numPC) && ((i >> 9) == (lastPC >> 9)) && (s == lastSym) && (s >= 0);
+        if (!same && (sum != 0)) {
+            if (lastSym >= 0) {
+                fprintf(fp, "page_%03o;%s %llu\n", lastPC >> 9, sym[lastSym].name, sum);
+            } else {
+                fprintf(fp, "page_%03o;%06o %llu\n", lastPC >> 9, lastPC, sum);
+            }
+            lines++;
+            sum = 0;
+        }
+        if (i < numPC) {
+            sum += pc[i];
+            lastSym = s;
+            lastPC = i;
+        }
+    }
+
+    if (copy.halted) {
+        fprintf(fp, "HALTED %llu\n", copy.halted);
+        lines++;
+    }
+
+    delete[] pc;
+    if (fclose(fp) != 0) {
+        printf("KS10: Error writing file \"%s\". %s\n", filename, strerror(errno));
+        return false;
+    }
+
+    printf("KS10: Wrote %u folded stacks to \"%s\".\n", lines, filename);
+    return true;
+}
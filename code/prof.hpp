@@ -0,0 +1,135 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    PC Sampling Profiler Object
+//!
+//! \details
+//!    This object samples the KS10 PC at a fixed rate on a background thread
+//!    and builds histograms of the samples by PC and by page.  The reports
+//!    resolve the PCs to symbols when a symbol table has been loaded.
+//!
+//!    Each sample is a read of the PCIR register and the halt status, so the
+//!    profiler does not disturb the KS10 and can be left running.
+//!
+//! \file
+//!    prof.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+
+#ifndef __PROF_HPP
+#define __PROF_HPP
+
+#include <mutex>
+#include <thread>
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ks10.hpp"
+#include "symtab.hpp"
+
+//!
+//! \brief
+//!    PC Sampling Profiler Object
+//!
+
+class prof_t {
+
+    private:
+
+        static const unsigned int numPC   = 01000000;   //!< 18-bit PC
+        static const unsigned int numPage = 01000;      //!< 512 word pages
+
+        //!
+        //! \brief
+        //!    Sampler statistics
+        //!
+
+        struct stats_t {
+            uint64_t samples;                   //!< Samples taken
+            uint64_t halted;                    //!< Samples taken while halted
+            uint64_t missed;                    //!< Sample periods that were skipped
+            uint64_t sampleNsecs;               //!< Time spent taking samples
+        };
+
+        uint32_t *pcHits;                       //!< Samples by PC
+        uint32_t pageHits[numPage];             //!< Samples by page
+        unsigned int rate;                      //!< Samples per second
+        volatile bool profRun;                  //!< Sampler thread is running
+        std::thread profThread;                 //!< Sampler thread
+        std::mutex profMutex;                   //!< Protects the histograms and stats
+        stats_t stats;                          //!< Statistics
+        uint64_t elapsedNsecs;                  //!< Sampling time of previous runs
+        struct timespec startTime;              //!< Start of the current run
+
+        void sampleLoop(void);
+        uint64_t elapsed(void);
+
+    public:
+
+        bool start(unsigned int rate);
+        void stop(void);
+        void clear(void);
+        void stat(void);
+        void flat(FILE *fp, const symtab_t &sym, unsigned int top);
+        bool folded(const char *filename, const symtab_t &sym);
+
+        //!
+        //! \brief
+        //!    Returns true if the profiler is sampling
+        //!
+
+        bool running(void) {
+            return profRun;
+        }
+
+        //!
+        //! \brief
+        //!    Constructor
+        //!
+
+        prof_t(void) :
+            pcHits(NULL),
+            rate(0),
+            profRun(false),
+            elapsedNsecs(0) {
+            clear();
+        }
+
+        //!
+        //! \brief
+        //!    Destructor
+        //!
+
+        ~prof_t(void) {
+            stop();
+            delete[] pcHits;
+        }
+};
+
+#endif
@@ -0,0 +1,251 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Device Register Descriptions
+//!
+//! \details
+//!    This file implements the table driven register snapshots and the
+//!    generic field decoder used by the device register dumps.
+//!
+//! \file
+//!    regs.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "regs.hpp"
+
+//
+// UBA Status Register fields
+//
+
+static const regs_t::field_t fieldsUBAS[] = {
+    {"TMO",  17, 1, NULL},
+    {"BMD",  16, 1, NULL},
+    {"BPE",  15, 1, NULL},
+    {"NXD",  14, 1, NULL},
+    {"HI",   11, 1, NULL},
+    {"LO",   10, 1, NULL},
+    {"PWR",   9, 1, NULL},
+    {"DXF",   7, 1, NULL},
+    {"INI",   6, 1, NULL},
+    {"PIH",   3, 3, NULL},
+    {"PIL",   0, 3, NULL},
+    {NULL,    0, 0, NULL},
+};
+
+const regs_t::reg_t regs_t::regUBAS = {"UBAS", 0763100, true, fieldsUBAS};
+
+//!
+//! \brief
+//!    Read all of the registers in a table
+//!
+//! \details
+//!    The registers are read in one pass with the FPGA mutex held so the
+//!    values are a consistent snapshot of the device.
+//!
+//! \param [in] base -
+//!    Base address of the device
+//!
+//! \param [in] regs -
+//!    Register table
+//!
+//! \param [in] num -
+//!    Number of entries in the register table
+//!
+//! \param [out] vals -
+//!    Register contents.  Must hold num entries.
+//!
+
+void regs_t::snapshot(ks10_t::addr_t base, const reg_t *regs, unsigned int num, ks10_t::data_t *vals) {
+
+    ks10_t::addr_t addr[maxRegs];
+    bool wide[maxRegs];
+
+    if (num > maxRegs) {
+        num = maxRegs;
+    }
+
+    for (unsigned int i = 0; i < num; i++) {
+        if (regs[i].uba) {
+            addr[i] = (base & 07000000) + regs[i].offset;
+        } else {
+            addr[i] = base + regs[i].offset;
+        }
+        wide[i] = regs[i].uba;
+    }
+
+    ks10_t::readIOBlock(addr, wide, vals, num);
+}
+
+//!
+//! \brief
+//!    Print a register and decode its fields
+//!
+//! \param [in] reg -
+//!    Register description
+//!
+//! \param [in] val -
+//!    Register contents
+//!
+//! \param [in] width -
+//!    Width of the register name column
+//!
+
+void regs_t::printReg(const reg_t &reg, ks10_t::data_t val, unsigned int width) {
+
+    if (reg.uba) {
+        printf("      %-*s = %012llo", width, reg.name, val);
+    } else {
+        printf("      %-*s = %06o", width, reg.name, (unsigned int)val);
+    }
+
+    bool open = false;
+    for (const field_t *f = reg.fields; f && f->name; f++) {
+        unsigned int v = (val >> f->lsb) & ((1u << f->width) - 1);
+        if ((f->width == 1) && (f->decode == NULL) && (v == 0)) {
+            continue;
+        }
+        printf("%s", open ? " " : " (");
+        open = true;
+        if (f->decode) {
+            printf("%s=%s", f->name, f->decode(v));
+        } else if (f->width == 1) {
+            printf("%s", f->name);
+        } else {
+            printf("%s=%o", f->name, v);
+        }
+    }
+
+    printf("%s\n", open ? ")" : "");
+}
+
+//!
+//! \brief
+//!    Print a register snapshot
+//!
+//! \details
+//!    The script format prints every register as "dev.REG=value" and every
+//!    field as "dev.REG.FIELD=value" with the values in octal.
+//!
+//! \param [in] dev -
+//!    Device name
+//!
+//! \param [in] regs -
+//!    Register table
+//!
+//! \param [in] num -
+//!    Number of entries in the register table
+//!
+//! \param [in] vals -
+//!    Register contents from snapshot()
+//!
+//! \param [in] script -
+//!    Print in the script format
+//!
+
+void regs_t::print(const char *dev, const reg_t *regs, unsigned int num, const ks10_t::data_t *vals, bool script) {
+
+    if (script) {
+        for (unsigned int i = 0; i < num; i++) {
+            printf("%s.%s=%0*llo\n", dev, regs[i].name, regs[i].uba ? 12 : 6, vals[i]);
+            for (const field_t *f = regs[i].fields; f && f->name; f++) {
+                printf("%s.%s.%s=%llo\n", dev, regs[i].name, f->name, (vals[i] >> f->lsb) & ((1u << f->width) - 1));
+            }
+        }
+        return;
+    }
+
+    unsigned int width = 0;
+    for (unsigned int i = 0; i < num; i++) {
+        if (strlen(regs[i].name) > width) {
+            width = strlen(regs[i].name);
+        }
+    }
+
+    printf("KS10: %s register dump\n", dev);
+    for (unsigned int i = 0; i < num; i++) {
+        printReg(regs[i], vals[i], width);
+    }
+}
+
+//!
+//! \brief
+//!    Print a console control register
+//!
+//! \param [in] dev -
+//!    Device name
+//!
+//! \param [in] name -
+//!    Register name
+//!
+//! \param [in] val -
+//!    Register contents
+//!
+//! \param [in] script -
+//!    Print in the script format
+//!
+
+void regs_t::printCCR(const char *dev, const char *name, uint32_t val, bool script) {
+    if (script) {
+        printf("%s.%s=0x%08x\n", dev, name, val);
+    } else {
+        printf("      %s = 0x%08x\n", name, val);
+    }
+}
+
+//!
+//! \brief
+//!    Snapshot and print the device registers
+//!
+//! \param [in] dev -
+//!    Device name
+//!
+//! \param [in] base -
+//!    Base address of the device
+//!
+//! \param [in] regs -
+//!    Register table
+//!
+//! \param [in] num -
+//!    Number of entries in the register table
+//!
+//! \param [in] script -
+//!    Print in the script format
+//!
+
+void regs_t::dump(const char *dev, ks10_t::addr_t base, const reg_t *regs, unsigned int num, bool script) {
+    ks10_t::data_t vals[maxRegs];
+    if (num > maxRegs) {
+        num = maxRegs;
+    }
+    snapshot(base, regs, num, vals);
+    print(dev, regs, num, vals, script);
+}
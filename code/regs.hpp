@@ -0,0 +1,110 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Device Register Descriptions
+//!
+//! \details
+//!    This object provides a table driven description of the Unibus device
+//!    registers.  Each device describes its registers (name, offset, and
+//!    bit fields) in a static table.  The register dumps read every register
+//!    in the table in one locked pass through the FPGA and then decode the
+//!    fields from the table.
+//!
+//!    The dumps can be printed in a human readable format or in a script
+//!    format that has one "name=value" assignment per line.
+//!
+//! \file
+//!    regs.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+
+#ifndef __REGS_HPP
+#define __REGS_HPP
+
+#include <stdint.h>
+
+#include "ks10.hpp"
+
+//!
+//! \brief
+//!    Device Register Description Object
+//!
+
+class regs_t {
+
+    public:
+
+        //!
+        //! \brief
+        //!    Register bit field
+        //!
+        //! \details
+        //!    A one bit field without a decoder is a flag and is printed by
+        //!    name when it is set.  Other fields are always printed as
+        //!    "NAME=value" in octal, or as "NAME=text" when there is a
+        //!    decoder.  Field tables end with an entry with a NULL name.
+        //!
+
+        struct field_t {
+            const char *name;                           //!< Field name
+            uint8_t lsb;                                //!< Least significant bit
+            uint8_t width;                              //!< Width in bits
+            const char *(*decode)(uint16_t value);      //!< Decoder or NULL
+        };
+
+        //!
+        //! \brief
+        //!    Register description
+        //!
+
+        struct reg_t {
+            const char *name;                           //!< Register name
+            ks10_t::addr_t offset;                      //!< Offset from the base address
+            bool uba;                                   //!< 36-bit UBA register.  Offset is from the UBA.
+            const field_t *fields;                      //!< Bit fields or NULL
+        };
+
+        //
+        // Largest register table
+        //
+
+        static const unsigned int maxRegs = 32;
+
+        //
+        // UBA Status Register
+        //
+
+        static const reg_t regUBAS;
+
+        static void snapshot(ks10_t::addr_t base, const reg_t *regs, unsigned int num, ks10_t::data_t *vals);
+        static void printReg(const reg_t &reg, ks10_t::data_t val, unsigned int width = 5);
+        static void print(const char *dev, const reg_t *regs, unsigned int num, const ks10_t::data_t *vals, bool script);
+        static void printCCR(const char *dev, const char *name, uint32_t val, bool script);
+        static void dump(const char *dev, ks10_t::addr_t base, const reg_t *regs, unsigned int num, bool script);
+};
+
+#endif
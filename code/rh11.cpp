@@ -41,9 +41,32 @@
 #include "rp.hpp"
 #include "uba.hpp"
 #include "rh11.hpp"
+#include "rhpoll.hpp"
 #include "vt100.hpp"
 #include "commands.hpp"
 
+//
+// RH11 Control and Status Register #2 (RHCS2) fields
+//
+
+const regs_t::field_t rh11_t::fieldsCS2[] = {
+    {"DLT",   15, 1, NULL},
+    {"WCE",   14, 1, NULL},
+    {"UPE",   13, 1, NULL},
+    {"NED",   12, 1, NULL},
+    {"NEM",   11, 1, NULL},
+    {"PGE",   10, 1, NULL},
+    {"MXF",    9, 1, NULL},
+    {"MDPE",   8, 1, NULL},
+    {"OR",     7, 1, NULL},
+    {"IR",     6, 1, NULL},
+    {"CLR",    5, 1, NULL},
+    {"PAT",    4, 1, NULL},
+    {"BAI",    3, 1, NULL},
+    {"UNIT",   0, 3, NULL},
+    {NULL,     0, 0, NULL},
+};
+
 #undef RH11_VERBOSE
 
 //
@@ -85,12 +108,7 @@ bool rh11_t::wait(bool verbose) {
     // Wait for disk or tape operation to complete
     //
 
-    for (int i = 0; i < 1000; i++) {
-        if (ks10_t::readIO16(addrCS1) & RHCS1_RDY) {
-            break;
-        }
-        usleep(100);
-    }
+    rhpoll_t::wait(addrCS1, RHCS1_RDY, timeout);
 
     //
     // Check ready status
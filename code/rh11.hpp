@@ -45,6 +45,7 @@
 
 #include "uba.hpp"
 #include "ks10.hpp"
+#include "regs.hpp"
 
 //!
 //! \brief
@@ -53,10 +54,11 @@
 
 class rh11_t {
 
-    private:
+    protected:
 
         //
-        // Register offsets
+        // Register offsets.  Some offsets are shared by disk and tape
+        // registers.  The TM03 Check Character register is at offsetLA.
         //
 
         const ks10_t::addr_t offsetCS1 = 000;
@@ -69,7 +71,7 @@ class rh11_t {
         const ks10_t::addr_t offsetER  = 014;
         const ks10_t::addr_t offsetAS  = 016;
         const ks10_t::addr_t offsetLA  = 020;
-        const ks10_t::addr_t offsetCC  = 020;
+        const ks10_t::addr_t offsetCC  = 036;
         const ks10_t::addr_t offsetDB  = 022;
         const ks10_t::addr_t offsetMR  = 024;
         const ks10_t::addr_t offsetDT  = 026;
@@ -78,8 +80,6 @@ class rh11_t {
         const ks10_t::addr_t offsetTC  = 032;
         const ks10_t::addr_t offsetDC  = 034;
 
-    protected:
-
         //
         // Register Addresses
         //
@@ -132,6 +132,12 @@ class rh11_t {
 
         uba_t uba;
 
+        //
+        // Command completion timeout in milliseconds
+        //
+
+        unsigned int timeout;
+
         //
         // Protected functions
         //
@@ -140,6 +146,12 @@ class rh11_t {
 
     public:
 
+        //
+        // RH11 register fields shared by the disk and tape dumps
+        //
+
+        static const regs_t::field_t fieldsCS2[];
+
         //
         // Public functions
         //
@@ -149,6 +161,18 @@ class rh11_t {
         void testInit(uint16_t unit);
         void boot(uint16_t unit, bool diagmode = false);
 
+        //!
+        //! \brief
+        //!    Set the command completion timeout
+        //!
+        //! \param ms -
+        //!    Timeout in milliseconds
+        //!
+
+        void setTimeout(unsigned int ms) {
+            timeout = ms;
+        }
+
         //!
         //! \brief
         //!    Constructor
@@ -176,7 +200,8 @@ class rh11_t {
             addrOF ((baseADDR & 07777740) + offsetOF ),
             addrTC ((baseADDR & 07777740) + offsetTC ),
             addrDC ((baseADDR & 07777740) + offsetDC ),
-            uba(baseADDR) {
+            uba(baseADDR),
+            timeout(100) {
             ;
         }
 };
@@ -0,0 +1,402 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    RH11 Completion Poller
+//!
+//! \details
+//!    This object provides a single shared thread that polls device registers
+//!    for completion of RH11 (disk and tape) operations.
+//!
+//! \file
+//!    rhpoll.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#include <chrono>
+#include <thread>
+
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "ks10.hpp"
+#include "rhpoll.hpp"
+
+//
+// Static members
+//
+
+std::mutex rhpoll_t::mutex;
+std::condition_variable rhpoll_t::cv;
+bool rhpoll_t::running = false;
+rhpoll_t::request_t rhpoll_t::requests[rhpoll_t::maxRequests];
+unsigned int rhpoll_t::histogram[rhpoll_t::numBuckets];
+unsigned int rhpoll_t::timeouts;
+
+//!
+//! \brief
+//!    Record the latency of a completed request in the histogram
+//!
+//! \param [in] usec -
+//!    Latency in microseconds
+//!
+//! \param [in] success -
+//!    False if the request timed out.
+//!
+//! \note
+//!    The request list mutex must be held.
+//!
+
+void rhpoll_t::record(unsigned int usec, bool success) {
+    if (!success) {
+        timeouts++;
+        return;
+    }
+    unsigned int bucket = 0;
+    while ((usec >>= 1) != 0) {
+        bucket++;
+    }
+    histogram[bucket < numBuckets ? bucket : numBuckets - 1]++;
+}
+
+//!
+//! \brief
+//!    Poller thread
+//!
+//! \details
+//!    The thread sleeps until a request is submitted.  While requests are
+//!    outstanding, each request register is read every poll interval.
+//!    Callbacks are executed after the request list mutex is released so
+//!    that a callback can submit another request.
+//!
+
+void rhpoll_t::pollThread(void) {
+
+    struct done_t {
+        callback_t callback;
+        void *arg;
+        bool success;
+        unsigned int usec;
+    } done[maxRequests];
+
+    for (;;) {
+
+        unsigned int numDone = 0;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (__pending() == 0) {
+                cv.wait(lock);
+            }
+
+            for (unsigned int i = 0; i < maxRequests; i++) {
+                request_t &req = requests[i];
+                if (!req.active) {
+                    continue;
+                }
+
+                uint16_t reg = ks10_t::readIO16(req.addr);
+
+                struct timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                uint64_t usec = (now.tv_sec - req.start.tv_sec) * 1000000ULL +
+                                (now.tv_nsec - req.start.tv_nsec) / 1000;
+
+                bool success = reg & req.mask;
+                if (success || (usec > req.timeout * 1000ULL)) {
+                    req.active = false;
+                    record(usec, success);
+                    done[numDone].callback = req.callback;
+                    done[numDone].arg      = req.arg;
+                    done[numDone].success  = success;
+                    done[numDone].usec     = usec;
+                    numDone++;
+                }
+            }
+        }
+
+        for (unsigned int i = 0; i < numDone; i++) {
+            if (done[i].callback) {
+                done[i].callback(done[i].arg, done[i].success, done[i].usec);
+            }
+        }
+
+        usleep(pollInterval);
+    }
+}
+
+//!
+//! \brief
+//!    Submit a request to the poller
+//!
+//! \details
+//!    The poller thread is started when the first request is submitted.
+//!
+//! \param [in] addr -
+//!    Address of the 16-bit IO register to poll
+//!
+//! \param [in] mask -
+//!    The request completes when any of these bits are set in the register.
+//!
+//! \param [in] timeout -
+//!    Timeout in milliseconds
+//!
+//! \param [in] callback -
+//!    Function to call when the request completes or times out.  This
+//!    function is called from the poller thread.
+//!
+//! \param [in] arg -
+//!    Argument to pass to the callback
+//!
+//! \returns
+//!    True if the request was queued, false if too many requests are
+//!    outstanding.
+//!
+
+bool rhpoll_t::submit(ks10_t::addr_t addr, uint16_t mask, unsigned int timeout, callback_t callback, void *arg) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!running) {
+        std::thread(pollThread).detach();
+        running = true;
+    }
+
+    for (unsigned int i = 0; i < maxRequests; i++) {
+        request_t &req = requests[i];
+        if (!req.active) {
+            req.addr     = addr;
+            req.mask     = mask;
+            req.timeout  = timeout;
+            req.callback = callback;
+            req.arg      = arg;
+            clock_gettime(CLOCK_MONOTONIC, &req.start);
+            req.active   = true;
+            cv.notify_one();
+            return true;
+        }
+    }
+
+    printf("KS10: Too many outstanding RH11 requests.\n");
+    return false;
+}
+
+//!
+//! \brief
+//!    State shared between wait() and its callback
+//!
+//! \details
+//!    If wait() is interrupted the waiter is abandoned and the callback
+//!    deletes it when the request completes or times out.
+//!
+
+struct waiter_t {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done;
+    bool success;
+    bool abandoned;
+};
+
+//!
+//! \brief
+//!    Callback used by wait()
+//!
+
+static void waitCallback(void *arg, bool success, unsigned int /*usec*/) {
+    waiter_t *waiter = static_cast<waiter_t *>(arg);
+    {
+        std::lock_guard<std::mutex> lock(waiter->mutex);
+        if (!waiter->abandoned) {
+            waiter->success = success;
+            waiter->done    = true;
+            waiter->cv.notify_one();
+            return;
+        }
+    }
+    delete waiter;
+}
+
+//!
+//! \brief
+//!    Deferred signal handler used by wait()
+//!
+//! \details
+//!    The console SIGINT handler longjmps to the command prompt, which must
+//!    not happen while a thread is blocked on a condition variable.  While
+//!    wait() is blocked this handler only sets a flag which is checked
+//!    between timed waits.
+//!
+
+static volatile sig_atomic_t waitInterrupt;
+
+static void waitSigHandler(int sig) {
+    if (sig == SIGINT) {
+        waitInterrupt = 1;
+    }
+}
+
+//!
+//! \brief
+//!    Wait for a request to complete
+//!
+//! \details
+//!    The calling thread blocks until the poller reports that the request
+//!    has completed or timed out, or until SIGINT is received.
+//!
+//! \param [in] addr -
+//!    Address of the 16-bit IO register to poll
+//!
+//! \param [in] mask -
+//!    The request completes when any of these bits are set in the register.
+//!
+//! \param [in] timeout -
+//!    Timeout in milliseconds
+//!
+//! \returns
+//!    True if the request completed, false if it timed out or was
+//!    interrupted.
+//!
+
+bool rhpoll_t::wait(ks10_t::addr_t addr, uint16_t mask, unsigned int timeout) {
+
+    //
+    // The waiter is allocated on the heap so that it can outlive an
+    // interrupted wait.  The callback deletes an abandoned waiter.
+    //
+
+    waiter_t *waiter = new waiter_t;
+    waiter->done      = false;
+    waiter->success   = false;
+    waiter->abandoned = false;
+
+    if (!submit(addr, mask, timeout, waitCallback, waiter)) {
+        delete waiter;
+        return false;
+    }
+
+    struct sigaction sa;
+    struct sigaction saved;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = waitSigHandler;
+    sigemptyset(&sa.sa_mask);
+    waitInterrupt = 0;
+    sigaction(SIGINT, &sa, &saved);
+
+    bool success = false;
+    bool done;
+    {
+        std::unique_lock<std::mutex> lock(waiter->mutex);
+        while (!waiter->done && !waitInterrupt) {
+            waiter->cv.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        done = waiter->done;
+        if (done) {
+            success = waiter->success;
+        } else {
+            waiter->abandoned = true;
+        }
+    }
+
+    sigaction(SIGINT, &saved, NULL);
+
+    if (done) {
+        delete waiter;
+    } else {
+        printf("KS10: Wait for RH11 completion was interrupted.\n");
+    }
+
+    return success;
+}
+
+//!
+//! \brief
+//!    Number of outstanding requests
+//!
+//! \note
+//!    The request list mutex must be held.
+//!
+
+unsigned int rhpoll_t::__pending(void) {
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < maxRequests; i++) {
+        if (requests[i].active) {
+            count++;
+        }
+    }
+    return count;
+}
+
+//!
+//! \brief
+//!    Number of outstanding requests
+//!
+
+unsigned int rhpoll_t::pending(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return __pending();
+}
+
+//!
+//! \brief
+//!    Print the completion latency histogram
+//!
+
+void rhpoll_t::printHistogram(void) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    printf("KS10: RH11 completion latency histogram:\n"
+           "        Latency (us)           Count\n"
+           "      ------------------------ ----------\n");
+
+    for (unsigned int i = 0; i < numBuckets; i++) {
+        if (histogram[i] != 0) {
+            printf("      %10u - %10u %10u\n",
+                   i == 0 ? 0 : 1u << i, (i == numBuckets - 1) ? 0xffffffffu : (2u << i) - 1, histogram[i]);
+        }
+    }
+
+    printf("      Timeouts                 %10u\n"
+           "      Outstanding requests     %10u\n",
+           timeouts, __pending());
+}
+
+//!
+//! \brief
+//!    Clear the completion latency histogram
+//!
+
+void rhpoll_t::clearHistogram(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (unsigned int i = 0; i < numBuckets; i++) {
+        histogram[i] = 0;
+    }
+    timeouts = 0;
+}
@@ -0,0 +1,138 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    RH11 Completion Poller
+//!
+//! \details
+//!    This object provides a single shared thread that polls device registers
+//!    for completion of RH11 (disk and tape) operations.
+//!
+//!    A request names a 16-bit IO register and a bit mask.  The request
+//!    completes when any of the bits in the mask are set or when the timeout
+//!    expires.  The caller can either block in wait() or can provide a
+//!    callback to submit() and continue with other work.  Callbacks are
+//!    executed on the poller thread.
+//!
+//!    The poller also keeps a histogram of completion latencies.
+//!
+//! \file
+//!    rhpoll.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#ifndef __RHPOLL_HPP
+#define __RHPOLL_HPP
+
+#include <mutex>
+#include <condition_variable>
+
+#include <time.h>
+#include <stdint.h>
+
+#include "ks10.hpp"
+
+//!
+//! \brief
+//!    RH11 Completion Poller Object
+//!
+
+class rhpoll_t {
+
+    public:
+
+        //!
+        //! \brief
+        //!    Completion callback
+        //!
+        //! \param arg -
+        //!    Argument that was provided to submit()
+        //!
+        //! \param success -
+        //!    True if the operation completed, false if it timed out.
+        //!
+        //! \param usec -
+        //!    Time from submit() to completion in microseconds
+        //!
+
+        typedef void (*callback_t)(void *arg, bool success, unsigned int usec);
+
+        static bool submit(ks10_t::addr_t addr, uint16_t mask, unsigned int timeout, callback_t callback, void *arg);
+        static bool wait(ks10_t::addr_t addr, uint16_t mask, unsigned int timeout);
+        static unsigned int pending(void);
+        static void printHistogram(void);
+        static void clearHistogram(void);
+
+    private:
+
+        //
+        // Poll interval in microseconds
+        //
+
+        static const unsigned int pollInterval = 100;
+
+        //
+        // Maximum number of outstanding requests
+        //
+
+        static const unsigned int maxRequests = 16;
+
+        //
+        // Number of histogram buckets.  Bucket n counts latencies from 2^n
+        // to 2^(n+1)-1 microseconds.  Timeouts are counted separately.
+        //
+
+        static const unsigned int numBuckets = 32;
+
+        //!
+        //! \brief
+        //!    Outstanding request
+        //!
+
+        struct request_t {
+            bool active;                        //!< Request is outstanding
+            ks10_t::addr_t addr;                //!< Register address
+            uint16_t mask;                      //!< Completion bits
+            unsigned int timeout;               //!< Timeout (milliseconds)
+            struct timespec start;              //!< Time of submit()
+            callback_t callback;                //!< Completion callback
+            void *arg;                          //!< Callback argument
+        };
+
+        static std::mutex mutex;                //!< Protects the request list
+        static std::condition_variable cv;      //!< Signals new requests
+        static bool running;                    //!< Poller thread started
+        static request_t requests[maxRequests]; //!< Request list
+        static unsigned int histogram[numBuckets];
+        static unsigned int timeouts;
+
+        static void pollThread(void);
+        static void record(unsigned int usec, bool success);
+        static unsigned int __pending(void);
+};
+
+#endif
@@ -38,6 +38,10 @@
 //
 
 #include "stdio.h"
+#include "time.h"
+#include "string.h"
+#include "stdlib.h"
+#include "sys/stat.h"
 #include "rp.hpp"
 #include "uba.hpp"
 #include "rh11.hpp"
@@ -46,46 +50,116 @@
 
 #undef RP_VERBOSE
 
+//
+// RP Register Descriptions
+//
+
+static const regs_t::field_t fieldsRPCS1[] = {
+    {"SC",    15, 1, NULL},
+    {"TRE",   14, 1, NULL},
+    {"CPE",   13, 1, NULL},
+    {"DVA",   11, 1, NULL},
+    {"A17",    9, 1, NULL},
+    {"A16",    8, 1, NULL},
+    {"RDY",    7, 1, NULL},
+    {"IE",     6, 1, NULL},
+    {"FUN",    1, 5, NULL},
+    {"GO",     0, 1, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsRPDA[] = {
+    {"TA",     8, 6, NULL},
+    {"SA",     0, 6, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsRPDS[] = {
+    {"ATA",   15, 1, NULL},
+    {"ERR",   14, 1, NULL},
+    {"PIP",   13, 1, NULL},
+    {"MOL",   12, 1, NULL},
+    {"WRL",   11, 1, NULL},
+    {"LST",   10, 1, NULL},
+    {"PGM",    9, 1, NULL},
+    {"DPR",    8, 1, NULL},
+    {"DRY",    7, 1, NULL},
+    {"VV",     6, 1, NULL},
+    {"OM",     0, 1, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsRPER[] = {
+    {"DCK",   15, 1, NULL},
+    {"UNS",   14, 1, NULL},
+    {"OPI",   13, 1, NULL},
+    {"DTE",   12, 1, NULL},
+    {"WLE",   11, 1, NULL},
+    {"IAE",   10, 1, NULL},
+    {"AOE",    9, 1, NULL},
+    {"HCRC",   8, 1, NULL},
+    {"HCE",    7, 1, NULL},
+    {"ECH",    6, 1, NULL},
+    {"WCF",    5, 1, NULL},
+    {"FER",    4, 1, NULL},
+    {"PAR",    3, 1, NULL},
+    {"RMR",    2, 1, NULL},
+    {"ILR",    1, 1, NULL},
+    {"ILF",    0, 1, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsRPMR[] = {
+    {"DWRD",   5, 1, NULL},
+    {"DRDD",   4, 1, NULL},
+    {"DSCK",   3, 1, NULL},
+    {"DIND",   2, 1, NULL},
+    {"DCLK",   1, 1, NULL},
+    {"DMD",    0, 1, NULL},
+    {NULL,     0, 0, NULL},
+};
+
+static const regs_t::field_t fieldsRPOF[] = {
+    {"FMT22", 12, 1, NULL},
+    {"ECI",   11, 1, NULL},
+    {"HCI",   10, 1, NULL},
+    {"OFD",    7, 1, NULL},
+    {"OFS",    0, 7, NULL},
+    {NULL,     0, 0, NULL},
+};
+
 //!
 //! \brief
 //!   Dump RP registers
 //!
+//! \param script -
+//!   Print the registers as "name=value" assignments
+//!
+
+void rp_t::dumpRegs(bool script) {
+
+    const regs_t::reg_t regsRP[] = {
+        regs_t::regUBAS,
+        {"RPCS1", offsetCS1, false, fieldsRPCS1},
+        {"RPWC",  offsetWC,  false, NULL},
+        {"RPBA",  offsetBA,  false, NULL},
+        {"RPDA",  offsetDA,  false, fieldsRPDA},
+        {"RPCS2", offsetCS2, false, fieldsCS2},
+        {"RPDS",  offsetDS,  false, fieldsRPDS},
+        {"RPER",  offsetER,  false, fieldsRPER},
+        {"RPAS",  offsetAS,  false, NULL},
+        {"RPLA",  offsetLA,  false, NULL},
+        {"RPDB",  offsetDB,  false, NULL},
+        {"RPMR",  offsetMR,  false, fieldsRPMR},
+        {"RPDT",  offsetDT,  false, NULL},
+        {"RPSN",  offsetSN,  false, NULL},
+        {"RPOF",  offsetOF,  false, fieldsRPOF},
+        {"RPDC",  offsetDC,  false, NULL},
+        {"RPCC",  offsetCC,  false, NULL},
+    };
 
-void rp_t::dumpRegs(void) {
-    printf("KS10: RPCS1 = %06o\n"
-           "      RPWC  = %06o\n"
-           "      RPBA  = %06o\n"
-           "      RPDA  = %06o\n"
-           "      RPCS2 = %06o\n"
-           "      RPDS  = %06o\n"
-           "      RPER  = %06o\n"
-           "      RPAS  = %06o\n"
-           "      RPLA  = %06o\n"
-           "      RPDB  = %06o\n"
-           "      RPMR  = %06o\n"
-           "      RPDT  = %06o\n"
-           "      RPSN  = %06o\n"
-           "      RPOF  = %06o\n"
-           "      RPDC  = %06o\n"
-           "      RPCC  = %06o\n"
-           "      RPCCR = 0x%08x\n",
-           ks10_t::readIO16(addrCS1),
-           ks10_t::readIO16(addrWC),
-           ks10_t::readIO16(addrBA),
-           ks10_t::readIO16(addrDA),
-           ks10_t::readIO16(addrCS2),
-           ks10_t::readIO16(addrDS),
-           ks10_t::readIO16(addrER),
-           ks10_t::readIO16(addrAS),
-           ks10_t::readIO16(addrLA),
-           ks10_t::readIO16(addrDB),
-           ks10_t::readIO16(addrMR),
-           ks10_t::readIO16(addrDT),
-           ks10_t::readIO16(addrSN),
-           ks10_t::readIO16(addrOF),
-           ks10_t::readIO16(addrDC),
-           ks10_t::readIO16(addrCC),
-           ks10_t::readRPCCR());
+    regs_t::dump("rp", addrCS1, regsRP, sizeof(regsRP) / sizeof(regsRP[0]), script);
+    regs_t::printCCR("rp", "RPCCR", ks10_t::readRPCCR(), script);
 }
 
 //!
@@ -193,6 +267,9 @@ bool rp_t::readBlock(ks10_t::addr_t vaddr, ks10_t::data_t daddr) {
 //! \param [in] offset -
 //!    Offset in HOM block
 //!
+//! \param [in] cache -
+//!    Save the Pre-Boot page in the boot cache before booting.
+//!
 //! \returns
 //!    True if successful, false otherwise.
 //!
@@ -279,7 +356,7 @@ bool rp_t::readBlock(ks10_t::addr_t vaddr, ks10_t::data_t daddr) {
 //
 
 bool rp_t::bootBlock(ks10_t::addr_t paddr, ks10_t::addr_t vaddr,
-                     ks10_t::data_t daddr, ks10_t::addr_t offset) {
+                     ks10_t::data_t daddr, ks10_t::addr_t offset, bool cache) {
 
     //
     // Read the Home Block
@@ -292,6 +369,8 @@ bool rp_t::bootBlock(ks10_t::addr_t paddr, ks10_t::addr_t vaddr,
 #ifdef RP_VERBOSE
             printf("KS10: Successfully read HOM block.\n");
 #endif
+            ks10_t::data_t homsum = cache ? homChecksum(paddr) : 0;
+
             //
             // Get the disk address of the FE File Page from the Home Block
             //
@@ -332,6 +411,9 @@ bool rp_t::bootBlock(ks10_t::addr_t paddr, ks10_t::addr_t vaddr,
 #ifdef RP_VERBOSE
                                 printf("KS10: Monitor Pre-Boot read successfully.\n");
 #endif
+                                if (cache) {
+                                    updateCache(paddr, offset, homsum);
+                                }
                                 printf("KS10: Booting from address %07llo.\n", paddr);
                                 ks10_t::writeRegCIR((ks10_t::opJRST << 18) | paddr);
                                 ks10_t::startRUN();
@@ -802,8 +884,6 @@ void rp_t::testInit(uint16_t unit) {
 void rp_t::testRead(uint16_t unit) {
     bool pass = true;
     const unsigned int words     = 128;
-    const ks10_t::addr_t vaddr   = 004000;
-    const ks10_t::addr_t paddr   = 070000;
     const ks10_t::data_t pattern = 0525252525252;
 
     //
@@ -837,23 +917,36 @@ void rp_t::testRead(uint16_t unit) {
 
     //
     // Set Unibus mapping
-    //  This will page the destination to 070000
+    //  This will page the destination to a staging buffer
     //
 
-    uba.writePAG(1, uba_t::PAG_FTM | uba_t::PAG_VLD | uba_t::addr2page(paddr));
+    ks10_t::addr_t paddr;
+    const ks10_t::addr_t vaddr = uba.allocPAG(1, &paddr);
+    if (vaddr == 0) {
+        return;
+    }
+    uba.mapPAG(vaddr, paddr, 1, uba_t::PAG_FTM | uba_t::PAG_VLD);
+
+    //
+    // The buffer starts one word into the page so that the word before it
+    // is also in the staging buffer.
+    //
+
+    const ks10_t::addr_t vbuf = vaddr + 4;
+    const ks10_t::addr_t pbuf = paddr + 1;
 
     //
     // Set destination address
     //
 
-    ks10_t::writeIO(addrBA, vaddr);
+    ks10_t::writeIO(addrBA, vbuf);
 
     //
     // Fill destination with data
     //
 
     for (unsigned int i = 0; i < words+2; i++) {
-        ks10_t::writeMem(paddr - 1 + i, pattern);
+        ks10_t::writeMem(pbuf - 1 + i, pattern);
     }
 
     //
@@ -914,31 +1007,31 @@ void rp_t::testRead(uint16_t unit) {
     // Check RH11 Bus Address (RHBA) register
     //
 
-    if (ks10_t::readIO16(addrBA) != vaddr + 4 * words) {
+    if (ks10_t::readIO16(addrBA) != vbuf + 4 * words) {
         pass = false;
         printf("KS10: RHBA should be %06llo.\n"
                "      RHBA was %06o\n",
-               vaddr + 4 * words, ks10_t::readIO16(addrBA));
+               vbuf + 4 * words, ks10_t::readIO16(addrBA));
     }
 
     //
     // Check memory
     //
 
-    if (pattern != ks10_t::readMem(paddr - 1)) {
+    if (pattern != ks10_t::readMem(pbuf - 1)) {
         pass = false;
         printf("KS10: Memory immediately before buffer was modified.\n");
     }
 
     for (unsigned int i = 0; i < words; i++) {
-        printf("KS10: Memory Offset[%d] = %012llo\n", i, ks10_t::readMem(paddr + i));
-        if (pattern == ks10_t::readMem(paddr + i)) {
+        printf("KS10: Memory Offset[%d] = %012llo\n", i, ks10_t::readMem(pbuf + i));
+        if (pattern == ks10_t::readMem(pbuf + i)) {
             pass = false;
             printf("KS10: Memory buffer was not modified by disk read.\n");
         }
     }
 
-    if (pattern != ks10_t::readMem(paddr + words)) {
+    if (pattern != ks10_t::readMem(pbuf + words)) {
         pass = false;
         printf("KS10: Memory immediately after buffer was modified.\n");
     }
@@ -949,6 +1042,7 @@ void rp_t::testRead(uint16_t unit) {
 
     printf("KS10: RP disk read test %s.\n", pass ? "passed" : "failed");
 
+    uba.freePAG(vaddr, 1, paddr);
 }
 
 //!
@@ -962,8 +1056,6 @@ void rp_t::testRead(uint16_t unit) {
 void rp_t::testWrite(uint16_t unit) {
     bool pass = true;
     const unsigned int words     = 128;
-    const ks10_t::addr_t vaddr   = 004000;
-    const ks10_t::addr_t paddr   = 070000;
     const ks10_t::data_t pattern = 0123456654321;
 
     //
@@ -989,6 +1081,18 @@ void rp_t::testWrite(uint16_t unit) {
         return;
     }
 
+    //
+    // Set Unibus mapping
+    //  This will page the destination to a staging buffer
+    //
+
+    ks10_t::addr_t paddr;
+    const ks10_t::addr_t vaddr = uba.allocPAG(1, &paddr);
+    if (vaddr == 0) {
+        return;
+    }
+    uba.mapPAG(vaddr, paddr, 1, uba_t::PAG_FTM | uba_t::PAG_VLD);
+
     //
     // Create data pattern
     //
@@ -1003,13 +1107,6 @@ void rp_t::testWrite(uint16_t unit) {
 
     ks10_t::writeIO(addrWC, -words*2);
 
-    //
-    // Set Unibus mapping
-    //  This will page the destination to 070000
-    //
-
-    uba.writePAG(1, uba_t::PAG_FTM | uba_t::PAG_VLD | uba_t::addr2page(paddr));
-
     //
     // Set destination address
     //
@@ -1087,6 +1184,7 @@ void rp_t::testWrite(uint16_t unit) {
 
     printf("KS10: RH11 disk write test %s.\n", pass ? "passed" : "failed");
 
+    uba.freePAG(vaddr, 1, paddr);
 }
 
 //!
@@ -1100,8 +1198,6 @@ void rp_t::testWrite(uint16_t unit) {
 void rp_t::testWrchk(uint16_t unit) {
     bool pass = true;
     const unsigned int words     = 128;
-    const unsigned int vaddr     = 004000;
-    const unsigned int paddr     = 070000;
     const ks10_t::data_t pattern = 0123456654321;
 
     //
@@ -1142,6 +1238,18 @@ void rp_t::testWrchk(uint16_t unit) {
 
 #endif
 
+    //
+    // Set Unibus mapping
+    //  This will page the destination to a staging buffer
+    //
+
+    ks10_t::addr_t paddr;
+    const ks10_t::addr_t vaddr = uba.allocPAG(1, &paddr);
+    if (vaddr == 0) {
+        return;
+    }
+    uba.mapPAG(vaddr, paddr, 1, uba_t::PAG_FTM | uba_t::PAG_VLD);
+
     //
     // Create data pattern
     //
@@ -1156,13 +1264,6 @@ void rp_t::testWrchk(uint16_t unit) {
 
     ks10_t::writeIO(addrWC, -words*2);
 
-    //
-    // Set Unibus mapping
-    //  This will page the destination to 070000
-    //
-
-    uba.writePAG(1, uba_t::PAG_FTM | uba_t::PAG_VLD | uba_t::addr2page(paddr));
-
     //
     // Set destination address
     //
@@ -1280,6 +1381,228 @@ void rp_t::testWrchk(uint16_t unit) {
 
     printf("KS10: RH11 disk wrchk test %s.\n", pass ? "passed" : "failed");
 
+    uba.freePAG(vaddr, 1, paddr);
+}
+
+//!
+//! \brief
+//!    Boot cache directory and file.  The cache does not depend on the
+//!    working directory of the console.
+//!
+
+static const char *bootCacheDir  = "/var/cache/ks10";
+static const char *bootCacheFile = "/var/cache/ks10/rpboot.cache";
+
+//!
+//! \brief
+//!    Calculate the checksum of a HOM block
+//!
+//! \param [in] paddr -
+//!    Physical address (KS10 address) of the HOM block.
+//!
+//! \returns
+//!    36-bit rotate-and-add checksum of the 128 word HOM block.
+//!
+
+ks10_t::data_t rp_t::homChecksum(ks10_t::addr_t paddr) {
+    ks10_t::data_t buf[RP_WORDS];
+    ks10_t::readMemBlock(paddr, buf, RP_WORDS);
+
+    ks10_t::data_t sum = 0;
+    for (unsigned int i = 0; i < RP_WORDS; i++) {
+        sum = ((sum << 1) | (sum >> 35)) & 0777777777777;
+        sum = (sum + buf[i]) & 0777777777777;
+    }
+    return sum;
+}
+
+//!
+//! \brief
+//!    Read the boot cache file
+//!
+//! \param [out] entries -
+//!    Array of cache entries.  Unused entries are zeroed.
+//!
+
+void rp_t::readCache(bootcache_t *entries) {
+    memset(entries, 0, BOOTCACHE_SIZE * sizeof(bootcache_t));
+    FILE *fp = fopen(bootCacheFile, "rb");
+    if (fp) {
+        if (fread(entries, sizeof(bootcache_t), BOOTCACHE_SIZE, fp) == 0) {
+            memset(entries, 0, BOOTCACHE_SIZE * sizeof(bootcache_t));
+        }
+        fclose(fp);
+    }
+}
+
+//!
+//! \brief
+//!    Write the boot cache file
+//!
+//! \param [in] entries -
+//!    Array of cache entries
+//!
+
+void rp_t::writeCache(const bootcache_t *entries) {
+    mkdir(bootCacheDir, 0755);
+    FILE *fp = fopen(bootCacheFile, "wb");
+    if (!fp) {
+        printf("KS10: fopen(%s) failed.\n", bootCacheFile);
+        return;
+    }
+    fwrite(entries, sizeof(bootcache_t), BOOTCACHE_SIZE, fp);
+    fclose(fp);
+}
+
+//!
+//! \brief
+//!    Save the Pre-Boot page in the boot cache
+//!
+//! \details
+//!    The cache entry for the selected unit and Pre-Boot is replaced.
+//!
+//! \param [in] paddr -
+//!    Physical address (KS10 address) of the Pre-Boot page.
+//!
+//! \param [in] offset -
+//!    FE File Page offset of the Pre-Boot.
+//!
+//! \param [in] homsum -
+//!    Checksum of the primary HOM block
+//!
+
+void rp_t::updateCache(ks10_t::addr_t paddr, ks10_t::addr_t offset, ks10_t::data_t homsum) {
+    static bootcache_t entries[BOOTCACHE_SIZE];
+    readCache(entries);
+
+    uint16_t unit = ks10_t::readIO16(addrCS2) & RHCS2_UNIT;
+    uint16_t rpsn = ks10_t::readIO16(addrSN);
+
+    //
+    // Use the entry for this unit and pre-boot, or a free entry.
+    //
+
+    bootcache_t *entry = NULL;
+    for (unsigned int i = 0; i < BOOTCACHE_SIZE; i++) {
+        if ((entries[i].magic == BOOTCACHE_MAGIC) && (entries[i].unit == unit) && (entries[i].offset == offset)) {
+            entry = &entries[i];
+            break;
+        } else if ((entry == NULL) && (entries[i].magic != BOOTCACHE_MAGIC)) {
+            entry = &entries[i];
+        }
+    }
+
+    if (entry == NULL) {
+        entry = &entries[0];
+    }
+
+    entry->magic  = BOOTCACHE_MAGIC;
+    entry->unit   = unit;
+    entry->rpsn   = rpsn;
+    entry->offset = offset;
+    entry->homsum = homsum;
+    ks10_t::readMemBlock(paddr, entry->preboot, 512);
+
+    writeCache(entries);
+}
+
+//!
+//! \brief
+//!    Attempt to boot using the boot cache.
+//!
+//! \details
+//!    The HOM block is read from the disk.  If the drive serial number and the
+//!    HOM block checksum match the cache entry, the cached Pre-Boot page is
+//!    written to memory and started without reading the FE File Page or the
+//!    Pre-Boot page.  If the HOM block has changed, the cache entry is
+//!    invalidated.
+//!
+//!    A Pre-Boot or FE File that is rewritten without changing the HOM block
+//!    is not detected.  The cache must be flushed (rp boot --flush) after
+//!    the front-end files are rewritten.
+//!
+//! \param [in] paddr -
+//!    Physical address (KS10 address) of the disk buffer.
+//!
+//! \param [in] vaddr -
+//!    Virtual address (RH11 address) of the disk buffer.
+//!
+//! \param [in] daddr -
+//!    Disk address (in CHS format) of the HOM block.
+//!
+//! \param [in] offset -
+//!    FE File Page offset of the Pre-Boot.
+//!
+//! \returns
+//!    True if booted from the cache, false otherwise.
+//!
+
+bool rp_t::bootCached(ks10_t::addr_t paddr, ks10_t::addr_t vaddr,
+                      ks10_t::data_t daddr, ks10_t::addr_t offset) {
+
+    static bootcache_t entries[BOOTCACHE_SIZE];
+    readCache(entries);
+
+    uint16_t unit = ks10_t::readIO16(addrCS2) & RHCS2_UNIT;
+    uint16_t rpsn = ks10_t::readIO16(addrSN);
+
+    bootcache_t *entry = NULL;
+    for (unsigned int i = 0; i < BOOTCACHE_SIZE; i++) {
+        if ((entries[i].magic == BOOTCACHE_MAGIC) && (entries[i].unit == unit) &&
+            (entries[i].offset == offset) && (entries[i].rpsn == rpsn)) {
+            entry = &entries[i];
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        printf("KS10: Boot cache miss.\n");
+        return false;
+    }
+
+    //
+    // Read the Home Block and compare the checksum
+    //
+
+    printf("KS10: Reading Home Block.\n");
+    if (!readBlock(vaddr, daddr) || !isHomBlock(paddr)) {
+        return false;
+    }
+
+    if (homChecksum(paddr) != entry->homsum) {
+        printf("KS10: Home Block has changed. Invalidating boot cache.\n");
+        entry->magic = 0;
+        writeCache(entries);
+        return false;
+    }
+
+    if (entry->preboot[0] == 0) {
+        return false;
+    }
+
+    //
+    // Write the cached Pre-Boot to memory and start it
+    //
+
+    ks10_t::writeMemBlock(paddr, entry->preboot, 512);
+    printf("KS10: Booting from cached Pre-Boot at address %07llo.\n", paddr);
+    ks10_t::writeRegCIR((ks10_t::opJRST << 18) | paddr);
+    ks10_t::startRUN();
+    command_t::consoleOutput();
+    return true;
+}
+
+//!
+//! \brief
+//!    Flush the boot cache
+//!
+
+void rp_t::flushCache(void) {
+    if (remove(bootCacheFile) == 0) {
+        printf("KS10: Boot cache flushed.\n");
+    } else {
+        printf("KS10: Boot cache is empty.\n");
+    }
 }
 
 //!
@@ -1292,8 +1615,16 @@ void rp_t::testWrchk(uint16_t unit) {
 //! \param [in] diagmode
 //!    Boot to SMMON
 //!
+//! \param [in] cache
+//!    Use the boot cache.  If the primary HOM block matches the cache, the
+//!    cached Pre-Boot page is used instead of reading the FE File Page and
+//!    the Pre-Boot page from the disk.  Otherwise the disk is booted normally
+//!    and the cache is updated.  The cache is only updated from the primary
+//!    HOM block so that booting from the secondary HOM block does not
+//!    replace the entry.
+//!
 
-void rp_t::boot(uint16_t unit, bool diagmode) {
+void rp_t::boot(uint16_t unit, bool diagmode, bool cache) {
 
     const ks10_t::addr_t paddr = 01000;         // KS10 address of disk buffer
     const ks10_t::addr_t vaddr = 04000;         // UBA address of disk buffer
@@ -1360,12 +1691,860 @@ void rp_t::boot(uint16_t unit, bool diagmode) {
     // Attempt to read Monitor Pre-Boot code from one of the Home Blocks
     //
 
-    bool success = bootBlock(paddr, vaddr, priHomeBlock, offset);
+    if (cache && bootCached(paddr, vaddr, priHomeBlock, offset)) {
+        return;
+    }
+
+    bool success = bootBlock(paddr, vaddr, priHomeBlock, offset, cache);
     if (!success) {
         printf("KS10: Trying Secondary Home Block.\n");
-        success = bootBlock(paddr, vaddr, secHomeBlock, offset);
+        success = bootBlock(paddr, vaddr, secHomeBlock, offset, false);
         if (!success) {
             printf("KS10: Unable to boot from this disk.\n");
         }
     }
 }
+
+//!
+//! \brief
+//!    Prepare a disk unit for a disk image transfer
+//!
+//! \details
+//!    This clears the controller, selects the unit, checks that the media is
+//!    on-line, and issues a Read-in Preset so that Volume Valid is set.
+//!
+//!    Two UBA pages are mapped for the transfer buffers so that one buffer
+//!    can be moved to or from the file system while the other buffer is being
+//!    transferred by the RH11.  The caller must free the pages when the
+//!    transfer is complete.
+//!
+//! \param [in] unit -
+//!    Selected disk unit
+//!
+//! \param [out] vaddr -
+//!    UBA addresses of the two transfer buffers
+//!
+//! \param [out] paddr -
+//!    KS10 memory addresses of the two transfer buffers
+//!
+//! \returns
+//!    True if the disk is ready, false otherwise.
+//!
+
+bool rp_t::imageSetup(uint16_t unit, ks10_t::addr_t vaddr[2], ks10_t::addr_t paddr[2]) {
+
+    //
+    // Controller clear
+    //
+
+    ks10_t::writeIO(addrCS2, RHCS2_CLR);
+
+    //
+    // Select disk (unit)
+    //
+
+    ks10_t::writeIO(addrCS2, (ks10_t::readIO16(addrCS2) & ~RHCS2_UNIT) | (unit & 7));
+
+    //
+    // Check if disk in on-line
+    //
+
+    if (!(ks10_t::readIO16(addrDS) & RPDS_MOL)) {
+        printf("KS10: Disk is off-line.\n");
+        return false;
+    }
+
+    //
+    // Put unit in 18-bit (20 sector) mode
+    //
+
+    ks10_t::writeIO(addrOF, 0);
+
+    //
+    // Clear Attentions
+    //
+
+    ks10_t::writeIO(addrAS, 0x00ff);
+
+    //
+    // Execute Read in Preset Command
+    //
+
+    ks10_t::writeIO(addrCS1, RHCS1_CMDPRE | RHCS1_GO);
+
+    if (!(ks10_t::readIO16(addrDS) & RPDS_VV)) {
+        printf("KS10: Volume Valid should be set after preset command.\n");
+        return false;
+    }
+
+    //
+    // Set Unibus Paging
+    //  The first page maps to the first staging buffer
+    //  The second page maps to the second staging buffer
+    //
+
+    vaddr[0] = uba.allocPAG(2, &paddr[0]);
+    if (vaddr[0] == 0) {
+        return false;
+    }
+    vaddr[1] = vaddr[0] + 04000;
+    paddr[1] = paddr[0] + 01000;
+    uba.mapPAG(vaddr[0], paddr[0], 2, uba_t::PAG_FTM | uba_t::PAG_VLD);
+
+    return true;
+}
+
+//!
+//! \brief
+//!    Start a disk transfer
+//!
+//! \details
+//!    This function returns as soon as the command is issued. The transfer
+//!    must not cross a track boundary.
+//!
+//! \param [in] cmd -
+//!    RH11 function (read, write, or write check)
+//!
+//! \param [in] vaddr -
+//!    Adapter virtual address of the buffer
+//!
+//! \param [in] sect -
+//!    Linear sector number
+//!
+//! \param [in] words -
+//!    Number of 36-bit words to transfer
+//!
+//! \param [out] go -
+//!    If not NULL, the time that the GO bit was set.
+//!
+
+void rp_t::startXfer(uint16_t cmd, ks10_t::addr_t vaddr, unsigned int sect, unsigned int words, struct timespec *go) {
+
+    unsigned int cylinder = sect / (RP06_TRK * RP06_SEC);
+    unsigned int track    = (sect / RP06_SEC) % RP06_TRK;
+    unsigned int sector   = sect % RP06_SEC;
+
+    ks10_t::writeIO(addrWC, -words * 2);
+    ks10_t::writeIO(addrBA, vaddr);
+    ks10_t::writeIO(addrDA, ((track & 077) << 8) | ((sector & 077) << 0));
+    ks10_t::writeIO(addrDC, cylinder);
+    if (go) {
+        clock_gettime(CLOCK_MONOTONIC, go);
+    }
+    ks10_t::writeIO(addrCS1, cmd | RHCS1_GO);
+}
+
+//!
+//! \brief
+//!    Wait for a disk image transfer to complete
+//!
+//! \param [in] wrchk -
+//!    Check for write check errors if true.
+//!
+//! \returns
+//!    True if the transfer completed without errors, false otherwise.
+//!
+
+bool rp_t::imageWait(bool wrchk) {
+
+    wait();
+
+    uint16_t cs1 = ks10_t::readIO16(addrCS1);
+    if (!(cs1 & RHCS1_RDY)) {
+        printf("KS10: Disk timeout.\n");
+        return false;
+    }
+
+    if (wrchk && (ks10_t::readIO16(addrCS2) & RHCS2_WCE)) {
+        printf("KS10: Write check error.\n");
+        return false;
+    }
+
+    if (cs1 & RHCS1_SC) {
+        printf("KS10: Disk error. RPER = %06o.\n", ks10_t::readIO16(addrER));
+        return false;
+    }
+
+    return true;
+}
+
+//!
+//! \brief
+//!    Print disk image transfer progress
+//!
+//! \param [in] cyl -
+//!    Current cylinder
+//!
+//! \param [in] last -
+//!    Last cylinder
+//!
+//! \param [in] bytes -
+//!    Number of bytes transferred
+//!
+//! \param [in] begin -
+//!    Time the transfer started
+//!
+
+static void imageProgress(unsigned int cyl, unsigned int last, double bytes, const struct timespec &begin) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double secs = (now.tv_sec - begin.tv_sec) + (now.tv_nsec - begin.tv_nsec) / 1e9;
+    printf("\rKS10: Cylinder %3d of %3d (%6.3f MB/s)", cyl, last, secs > 0 ? bytes / secs / 1e6 : 0.0);
+    fflush(stdout);
+}
+
+//!
+//! \brief
+//!    Read a block from a SIMH format disk image
+//!
+//! \details
+//!    Each 36-bit word is stored as a 64-bit little-endian value.  A short
+//!    read (at the end of a truncated image) is zero filled.
+//!
+//! \param [in] fp -
+//!    File pointer of the disk image
+//!
+//! \param [out] data -
+//!    Buffer of 512 words
+//!
+
+static void imageRead(FILE *fp, ks10_t::data_t *data) {
+    static uint8_t buffer[512 * 8];
+    size_t len = fread(buffer, 1, sizeof(buffer), fp);
+    memset(&buffer[len], 0, sizeof(buffer) - len);
+    for (unsigned int i = 0; i < 512; i++) {
+        ks10_t::data_t word = 0;
+        for (int j = 7; j >= 0; j--) {
+            word = (word << 8) | buffer[i * 8 + j];
+        }
+        data[i] = word;
+    }
+}
+
+//!
+//! \brief
+//!    Write a block to a SIMH format disk image
+//!
+//! \param [in] fp -
+//!    File pointer of the disk image
+//!
+//! \param [in] data -
+//!    Buffer of 512 words
+//!
+//! \returns
+//!    True if successful, false otherwise.
+//!
+
+static bool imageWrite(FILE *fp, const ks10_t::data_t *data) {
+    static uint8_t buffer[512 * 8];
+    for (unsigned int i = 0; i < 512; i++) {
+        for (int j = 0; j < 8; j++) {
+            buffer[i * 8 + j] = data[i] >> (8 * j);
+        }
+    }
+    return fwrite(buffer, 1, sizeof(buffer), fp) == sizeof(buffer);
+}
+
+//!
+//! \brief
+//!    Write (or verify) a disk image from a file
+//!
+//! \details
+//!    The file is in SIMH format.  Each 36-bit word is stored as a 64-bit
+//!    little-endian value.
+//!
+//!    While the RH11 is transferring one buffer to the disk, the next block
+//!    is read from the file into the other buffer.
+//!
+//! \param [in] unit -
+//!    Selected disk unit
+//!
+//! \param [in] fp -
+//!    File pointer of the disk image
+//!
+//! \param [in] start -
+//!    First cylinder to transfer
+//!
+//! \param [in] write -
+//!    Write the disk if true.  Otherwise the disk is only compared to the file.
+//!
+//! \param [in] verify -
+//!    Write check each block after it is written.
+//!
+//! \returns
+//!    True if successful, false otherwise.
+//!
+
+bool rp_t::imageXfer(uint16_t unit, FILE *fp, unsigned int start, bool write, bool verify) {
+
+    ks10_t::addr_t paddr[2];
+    ks10_t::addr_t vaddr[2];
+    static ks10_t::data_t data[IMG_WORDS];
+
+    if (fseek(fp, (long)start * IMG_CBLKS * IMG_WORDS * 8, SEEK_SET) != 0) {
+        printf("KS10: Unable to seek to cylinder %d in disk image.\n", start);
+        return false;
+    }
+
+    if (!imageSetup(unit, vaddr, paddr)) {
+        return false;
+    }
+
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    //
+    // Load the first buffer
+    //
+
+    unsigned int first = start * IMG_CBLKS;
+    imageRead(fp, data);
+    ks10_t::writeMemBlock(paddr[0], data, IMG_WORDS);
+
+    for (unsigned int blk = first; blk < IMG_BLKS; blk++) {
+        unsigned int buf = (blk - first) & 1;
+
+        startXfer(write ? RHCS1_CMDWR : RHCS1_CMDWCH, vaddr[buf], blk * IMG_SECT, IMG_WORDS);
+
+        //
+        // Load the next block into the other buffer
+        //
+
+        if (blk + 1 < IMG_BLKS) {
+            imageRead(fp, data);
+            ks10_t::writeMemBlock(paddr[buf ^ 1], data, IMG_WORDS);
+        }
+
+        bool success = imageWait(!write);
+        if (success && write && verify) {
+            startXfer(RHCS1_CMDWCH, vaddr[buf], blk * IMG_SECT, IMG_WORDS);
+            success = imageWait(true);
+        }
+
+        if (!success) {
+            printf("\nKS10: Transfer failed at cylinder %d.  Use --start=%d to resume.\n",
+                   blk / IMG_CBLKS, blk / IMG_CBLKS);
+            uba.freePAG(vaddr[0], 2, paddr[0]);
+            return false;
+        }
+
+        if ((blk + 1) % IMG_CBLKS == 0) {
+            imageProgress(blk / IMG_CBLKS, RP06_CYL - 1, (blk + 1 - first) * IMG_WORDS * 8.0, begin);
+        }
+    }
+
+    printf("\n");
+    uba.freePAG(vaddr[0], 2, paddr[0]);
+    return true;
+}
+
+//!
+//! \brief
+//!    Dump a disk to a disk image file
+//!
+//! \details
+//!    The file is in SIMH format.  Each 36-bit word is stored as a 64-bit
+//!    little-endian value.
+//!
+//!    While the RH11 is reading the next block from the disk into one buffer,
+//!    the previous block is copied from the other buffer to the file.
+//!
+//! \param [in] unit -
+//!    Selected disk unit
+//!
+//! \param [in] filename -
+//!    Name of the disk image file
+//!
+//! \param [in] start -
+//!    First cylinder to dump.  When non-zero, the existing file is updated
+//!    starting at that cylinder so that an interrupted dump can be resumed.
+//!
+//! \returns
+//!    True if successful, false otherwise.
+//!
+
+bool rp_t::dumpImage(uint16_t unit, const char *filename, unsigned int start) {
+
+    ks10_t::addr_t paddr[2];
+    ks10_t::addr_t vaddr[2];
+    static ks10_t::data_t data[IMG_WORDS];
+
+    if (start >= RP06_CYL) {
+        printf("KS10: Starting cylinder must be less than %d.\n", RP06_CYL);
+        return false;
+    }
+
+    FILE *fp = fopen(filename, start == 0 ? "wb" : "r+b");
+    if (!fp) {
+        printf("KS10: fopen(%s) failed.\n", filename);
+        return false;
+    }
+
+    if (fseek(fp, (long)start * IMG_CBLKS * IMG_WORDS * 8, SEEK_SET) != 0) {
+        printf("KS10: Unable to seek to cylinder %d in disk image.\n", start);
+        fclose(fp);
+        return false;
+    }
+
+    if (!imageSetup(unit, vaddr, paddr)) {
+        fclose(fp);
+        return false;
+    }
+
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    unsigned int first = start * IMG_CBLKS;
+    startXfer(RHCS1_CMDRD, vaddr[0], first * IMG_SECT, IMG_WORDS);
+
+    for (unsigned int blk = first; blk < IMG_BLKS; blk++) {
+        unsigned int buf = (blk - first) & 1;
+
+        if (!imageWait(false)) {
+            printf("\nKS10: Dump failed at cylinder %d.  Use --start=%d to resume.\n",
+                   blk / IMG_CBLKS, blk / IMG_CBLKS);
+            uba.freePAG(vaddr[0], 2, paddr[0]);
+            fclose(fp);
+            return false;
+        }
+
+        //
+        // Start reading the next block into the other buffer
+        //
+
+        if (blk + 1 < IMG_BLKS) {
+            startXfer(RHCS1_CMDRD, vaddr[buf ^ 1], (blk + 1) * IMG_SECT, IMG_WORDS);
+        }
+
+        //
+        // Copy this block to the file
+        //
+
+        ks10_t::readMemBlock(paddr[buf], data, IMG_WORDS);
+        if (!imageWrite(fp, data)) {
+            printf("\nKS10: Unable to write disk image.  Use --start=%d to resume.\n",
+                   blk / IMG_CBLKS);
+            if (blk + 1 < IMG_BLKS) {
+                wait();
+            }
+            uba.freePAG(vaddr[0], 2, paddr[0]);
+            fclose(fp);
+            return false;
+        }
+
+        if ((blk + 1) % IMG_CBLKS == 0) {
+            imageProgress(blk / IMG_CBLKS, RP06_CYL - 1, (blk + 1 - first) * IMG_WORDS * 8.0, begin);
+        }
+    }
+
+    printf("\nKS10: Disk dumped to %s.\n", filename);
+    uba.freePAG(vaddr[0], 2, paddr[0]);
+    fclose(fp);
+    return true;
+}
+
+//!
+//! \brief
+//!    Restore a disk from a disk image file
+//!
+//! \param [in] unit -
+//!    Selected disk unit
+//!
+//! \param [in] filename -
+//!    Name of the disk image file
+//!
+//! \param [in] start -
+//!    First cylinder to restore
+//!
+//! \param [in] verify -
+//!    Write check each block after it is written.
+//!
+//! \returns
+//!    True if successful, false otherwise.
+//!
+
+bool rp_t::restoreImage(uint16_t unit, const char *filename, unsigned int start, bool verify) {
+
+    if (start >= RP06_CYL) {
+        printf("KS10: Starting cylinder must be less than %d.\n", RP06_CYL);
+        return false;
+    }
+
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        printf("KS10: fopen(%s) failed.\n", filename);
+        return false;
+    }
+
+    bool success = imageXfer(unit, fp, start, true, verify);
+    if (success) {
+        printf("KS10: Disk restored from %s%s.\n", filename, verify ? " and verified" : "");
+    }
+
+    fclose(fp);
+    return success;
+}
+
+//!
+//! \brief
+//!    Compare a disk to a disk image file
+//!
+//! \details
+//!    The comparison is performed by the RH11 using write check commands.
+//!
+//! \param [in] unit -
+//!    Selected disk unit
+//!
+//! \param [in] filename -
+//!    Name of the disk image file
+//!
+//! \param [in] start -
+//!    First cylinder to compare
+//!
+//! \returns
+//!    True if the disk matches the file, false otherwise.
+//!
+
+bool rp_t::verifyImage(uint16_t unit, const char *filename, unsigned int start) {
+
+    if (start >= RP06_CYL) {
+        printf("KS10: Starting cylinder must be less than %d.\n", RP06_CYL);
+        return false;
+    }
+
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        printf("KS10: fopen(%s) failed.\n", filename);
+        return false;
+    }
+
+    bool success = imageXfer(unit, fp, start, false, false);
+    if (success) {
+        printf("KS10: Disk matches %s.\n", filename);
+    }
+
+    fclose(fp);
+    return success;
+}
+
+//!
+//! \brief
+//!    Perform one timed single sector transfer
+//!
+//! \details
+//!    The latency is measured from setting RHCS1[GO] to RHCS1[RDY].  The
+//!    ready bit is polled without sleeping so that the measurement is not
+//!    quantized by the scheduler.
+//!
+//! \param [in] cmd -
+//!    RH11 function (read or write)
+//!
+//! \param [in] vaddr -
+//!    UBA address of the transfer buffer
+//!
+//! \param [in] sect -
+//!    Linear sector number
+//!
+//! \param [out] usec -
+//!    Latency in microseconds
+//!
+//! \returns
+//!    True if the transfer completed without errors, false otherwise.
+//!
+
+bool rp_t::benchXfer(uint16_t cmd, ks10_t::addr_t vaddr, unsigned int sect, double &usec) {
+
+    struct timespec go;
+    struct timespec now;
+
+    startXfer(cmd, vaddr, sect, RP_WORDS, &go);
+
+    for (;;) {
+        uint16_t cs1 = ks10_t::readIO16(addrCS1);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        usec = (now.tv_sec - go.tv_sec) * 1e6 + (now.tv_nsec - go.tv_nsec) / 1e3;
+        if (cs1 & RHCS1_RDY) {
+            return !(cs1 & RHCS1_SC);
+        }
+        if (usec > 1e6) {
+            printf("KS10: Disk timeout.\n");
+            return false;
+        }
+    }
+}
+
+//!
+//! \brief
+//!    Compare function for sorting latencies
+//!
+
+static int benchCompare(const void *a, const void *b) {
+    double x = *static_cast<const double *>(a);
+    double y = *static_cast<const double *>(b);
+    return (x > y) - (x < y);
+}
+
+//!
+//! \brief
+//!    Run one benchmark pattern
+//!
+//! \param [in, out] bench -
+//!    Benchmark results
+//!
+//! \param [in] cmd -
+//!    RH11 function (read or write)
+//!
+//! \param [in] vaddr -
+//!    UBA address of the transfer buffer
+//!
+//! \param [in] sects -
+//!    List of linear sector numbers to transfer
+//!
+//! \param [in] count -
+//!    Number of sectors in the list
+//!
+
+void rp_t::benchRun(rpbench_t &bench, uint16_t cmd, ks10_t::addr_t vaddr, const unsigned int *sects, unsigned int count) {
+
+    static double lat[10000];
+
+    uint64_t rpdebug = ks10_t::getRPDEBUG();
+    uint16_t rdcnt = (rpdebug >>  0) & 0xffff;
+    uint16_t wrcnt = (rpdebug >> 16) & 0xffff;
+
+    struct timespec begin;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    bench.ops    = 0;
+    bench.errors = 0;
+    double total = 0;
+
+    for (unsigned int i = 0; i < count; i++) {
+        double usec;
+        if (benchXfer(cmd, vaddr, sects[i], usec)) {
+            lat[bench.ops++] = usec;
+            total += usec;
+        } else {
+            bench.errors++;
+            printf("KS10: %s failed at sector %d. RPER = %06o.\n", bench.name, sects[i], ks10_t::readIO16(addrER));
+            break;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    bench.secs = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    rpdebug = ks10_t::getRPDEBUG();
+    bench.rdcnt = static_cast<uint16_t>(((rpdebug >>  0) & 0xffff) - rdcnt);
+    bench.wrcnt = static_cast<uint16_t>(((rpdebug >> 16) & 0xffff) - wrcnt);
+
+    if (bench.ops == 0) {
+        bench.min = bench.avg = bench.p50 = bench.p90 = bench.p99 = bench.max = 0;
+        return;
+    }
+
+    qsort(lat, bench.ops, sizeof(lat[0]), benchCompare);
+    bench.min = lat[0];
+    bench.avg = total / bench.ops;
+    bench.p50 = lat[(bench.ops - 1) * 50 / 100];
+    bench.p90 = lat[(bench.ops - 1) * 90 / 100];
+    bench.p99 = lat[(bench.ops - 1) * 99 / 100];
+    bench.max = lat[bench.ops - 1];
+}
+
+//!
+//! \brief
+//!    RP Performance Test
+//!
+//! \details
+//!    This measures the performance of the disk using single sector transfers
+//!    with the following patterns:
+//!
+//!    - Sequential reads starting at cylinder 0.
+//!    - Random reads over the whole disk.
+//!    - Sequential writes to the maintenance cylinders (809-814).
+//!    - Seek stress: reads alternating between cylinder 0 and the last
+//!      cylinder.
+//!
+//!    The SD read and write counters in the RP debug register are sampled
+//!    before and after each pattern to cross-check the number of operations
+//!    that the FPGA actually performed.
+//!
+//! \param [in] unit -
+//!    Selected disk unit
+//!
+//! \param [in] count -
+//!    Number of operations for each pattern
+//!
+//! \param [in] csvfile -
+//!    If not NULL, write the results to this file in CSV format
+//!
+//! \param [in] jsonfile -
+//!    If not NULL, write the results to this file in JSON format
+//!
+
+void rp_t::testBench(uint16_t unit, unsigned int count, const char *csvfile, const char *jsonfile) {
+
+    const unsigned int maxCount  = 10000;
+    static unsigned int sects[maxCount];
+    const unsigned int secPerCyl = RP06_TRK * RP06_SEC;
+    const unsigned int maintSect = 809 * secPerCyl;
+    const unsigned int maintSize = (RP06_CYL - 809) * secPerCyl;
+    const unsigned int diskSize  = RP06_CYL * secPerCyl;
+    const double bytesPerSect    = RP_WORDS * 36 / 8;
+
+    enum {
+        seqRead,
+        rndRead,
+        seqWrite,
+        seekStress,
+        numBench,
+    };
+
+    rpbench_t bench[numBench] = {
+        {"seqread",  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        {"rndread",  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        {"seqwrite", 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        {"seek",     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    };
+
+    if ((count == 0) || (count > maxCount)) {
+        printf("KS10: Benchmark count must be between 1 and %d.\n", maxCount);
+        return;
+    }
+
+    printf("KS10: Running RP benchmark on unit %d (%d operations per test).\n", unit, count);
+
+    //
+    // Write pattern.  It is written to the buffer with one block write.
+    //
+
+    ks10_t::data_t fill[RP_WORDS];
+    for (unsigned int j = 0; j < RP_WORDS; j++) {
+        fill[j] = 0123456654321;
+    }
+
+    //
+    // Run each pattern.  The controller is cleared and the drive is preset
+    //  before each pattern so that an error in one pattern does not affect
+    //  the next.
+    //
+
+    srand(1);
+    for (int i = 0; i < numBench; i++) {
+
+        ks10_t::addr_t vaddr[2];
+        ks10_t::addr_t paddr[2];
+        if (!imageSetup(unit, vaddr, paddr)) {
+            return;
+        }
+
+        switch (i) {
+            case seqRead:
+                for (unsigned int j = 0; j < count; j++) {
+                    sects[j] = j % diskSize;
+                }
+                break;
+            case rndRead:
+                for (unsigned int j = 0; j < count; j++) {
+                    sects[j] = rand() % diskSize;
+                }
+                break;
+            case seqWrite:
+                ks10_t::writeMemBlock(paddr[0], fill, RP_WORDS);
+                for (unsigned int j = 0; j < count; j++) {
+                    sects[j] = maintSect + (j % maintSize);
+                }
+                break;
+            case seekStress:
+                for (unsigned int j = 0; j < count; j++) {
+                    sects[j] = (j & 1) ? diskSize - 1 - (j % RP06_SEC) : (j % RP06_SEC);
+                }
+                break;
+        }
+
+        benchRun(bench[i], (i == seqWrite) ? RHCS1_CMDWR : RHCS1_CMDRD, vaddr[0], sects, count);
+        uba.freePAG(vaddr[0], 2, paddr[0]);
+    }
+
+    //
+    // Print results
+    //
+
+    printf("\n"
+           "  Test        Ops   Err     IOPS    MB/s      Min      Avg      P50      P90      P99      Max   SD Rd   SD Wr\n"
+           "  --------  -----  ----  -------  ------  -------  -------  -------  -------  -------  -------  ------  ------\n");
+    for (int i = 0; i < numBench; i++) {
+        double iops = bench[i].secs > 0 ? bench[i].ops / bench[i].secs : 0;
+        printf("  %-8s  %5d  %4d  %7.1f  %6.3f  %7.0f  %7.0f  %7.0f  %7.0f  %7.0f  %7.0f  %6d  %6d\n",
+               bench[i].name, bench[i].ops, bench[i].errors, iops, iops * bytesPerSect / 1e6,
+               bench[i].min, bench[i].avg, bench[i].p50, bench[i].p90, bench[i].p99, bench[i].max,
+               bench[i].rdcnt, bench[i].wrcnt);
+    }
+    printf("\n"
+           "  Latencies are in microseconds from RHCS1[GO] to RHCS1[RDY].\n"
+           "  MB/s is based on %d bytes (128 36-bit words) per sector.\n"
+           "\n", static_cast<int>(bytesPerSect));
+
+    //
+    // Cross-check the operation count against the RP debug register
+    //
+
+    for (int i = 0; i < numBench; i++) {
+        unsigned int sdcnt = (i == seqWrite) ? bench[i].wrcnt : bench[i].rdcnt;
+        if (bench[i].ops != 0 && sdcnt == 0) {
+            printf("KS10: %sRPDEBUG %s count did not change during the %s test.%s\n",
+                   vt100fg_red, (i == seqWrite) ? "write" : "read", bench[i].name, vt100at_rst);
+        }
+    }
+
+    //
+    // Export CSV
+    //
+
+    if (csvfile) {
+        FILE *fp = fopen(csvfile, "w");
+        if (!fp) {
+            printf("KS10: fopen(%s) failed.\n", csvfile);
+        } else {
+            fprintf(fp, "test,ops,errors,seconds,iops,mbps,min_us,avg_us,p50_us,p90_us,p99_us,max_us,sd_rdcnt,sd_wrcnt\n");
+            for (int i = 0; i < numBench; i++) {
+                double iops = bench[i].secs > 0 ? bench[i].ops / bench[i].secs : 0;
+                fprintf(fp, "%s,%d,%d,%.6f,%.1f,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%d,%d\n",
+                        bench[i].name, bench[i].ops, bench[i].errors, bench[i].secs, iops,
+                        iops * bytesPerSect / 1e6, bench[i].min, bench[i].avg, bench[i].p50,
+                        bench[i].p90, bench[i].p99, bench[i].max, bench[i].rdcnt, bench[i].wrcnt);
+            }
+            fclose(fp);
+            printf("KS10: Results written to %s.\n", csvfile);
+        }
+    }
+
+    //
+    // Export JSON
+    //
+
+    if (jsonfile) {
+        FILE *fp = fopen(jsonfile, "w");
+        if (!fp) {
+            printf("KS10: fopen(%s) failed.\n", jsonfile);
+        } else {
+            fprintf(fp, "{\n  \"unit\": %d,\n  \"count\": %d,\n  \"tests\": [\n", unit, count);
+            for (int i = 0; i < numBench; i++) {
+                double iops = bench[i].secs > 0 ? bench[i].ops / bench[i].secs : 0;
+                fprintf(fp, "    {\"test\": \"%s\", \"ops\": %d, \"errors\": %d, \"seconds\": %.6f, "
+                        "\"iops\": %.1f, \"mbps\": %.3f, \"min_us\": %.1f, \"avg_us\": %.1f, "
+                        "\"p50_us\": %.1f, \"p90_us\": %.1f, \"p99_us\": %.1f, \"max_us\": %.1f, "
+                        "\"sd_rdcnt\": %d, \"sd_wrcnt\": %d}%s\n",
+                        bench[i].name, bench[i].ops, bench[i].errors, bench[i].secs, iops,
+                        iops * bytesPerSect / 1e6, bench[i].min, bench[i].avg, bench[i].p50,
+                        bench[i].p90, bench[i].p99, bench[i].max, bench[i].rdcnt, bench[i].wrcnt,
+                        (i == numBench - 1) ? "" : ",");
+            }
+            fprintf(fp, "  ]\n}\n");
+            fclose(fp);
+            printf("KS10: Results written to %s.\n", jsonfile);
+        }
+    }
+}
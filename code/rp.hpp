@@ -39,6 +39,7 @@
 #ifndef __RP_HPP
 #define __RP_HPP
 
+#include <time.h>
 #include <stdio.h>
 #include <stdint.h>
 
@@ -46,6 +47,26 @@
 #include "ks10.hpp"
 #include "rh11.hpp"
 
+//!
+//! \brief
+//!    RP Benchmark Results
+//!
+
+struct rpbench_t {
+    const char *name;                           //!< Test name
+    unsigned int ops;                           //!< Operations completed
+    unsigned int errors;                        //!< Operations that failed
+    double secs;                                //!< Elapsed time (seconds)
+    double min;                                 //!< Minimum latency (us)
+    double avg;                                 //!< Average latency (us)
+    double p50;                                 //!< 50th percentile latency (us)
+    double p90;                                 //!< 90th percentile latency (us)
+    double p99;                                 //!< 99th percentile latency (us)
+    double max;                                 //!< Maximum latency (us)
+    unsigned int rdcnt;                         //!< SD reads from RPDEBUG
+    unsigned int wrcnt;                         //!< SD writes from RPDEBUG
+};
+
 //!
 //! \brief
 //!    RP Interface Object
@@ -77,6 +98,46 @@ class rp_t : public rh11_t {
         static const uint16_t RPDS_MOL     = 0010000;
         static const uint16_t RPDS_VV      = 0000100;
 
+        //
+        // RP06 Geometry
+        //
+
+        static const unsigned int RP06_CYL = 815;      //!< Cylinders per disk
+        static const unsigned int RP06_TRK = 19;       //!< Tracks per cylinder
+        static const unsigned int RP06_SEC = 20;       //!< Sectors per track (18-bit mode)
+        static const unsigned int RP_WORDS = 128;      //!< Words per sector
+
+        //
+        // Disk image transfers
+        //  Each transfer moves one UBA page (512 words or 4 sectors) so that
+        //  a transfer never crosses a track boundary.
+        //
+
+        static const unsigned int IMG_SECT  = 4;
+        static const unsigned int IMG_WORDS = IMG_SECT * RP_WORDS;
+        static const unsigned int IMG_CBLKS = RP06_TRK * RP06_SEC / IMG_SECT;
+        static const unsigned int IMG_BLKS  = RP06_CYL * IMG_CBLKS;
+
+        //
+        // Boot cache
+        //  A copy of the pre-boot page is kept for each unit and is keyed by
+        //  the drive serial number (RPSN), the primary HOM block checksum,
+        //  and the FE File Page offset of the pre-boot (monitor or
+        //  diagnostic).
+        //
+
+        struct bootcache_t {
+            uint32_t magic;                             //!< Entry is valid
+            uint16_t unit;                              //!< Disk unit
+            uint16_t rpsn;                              //!< Drive serial number
+            uint32_t offset;                            //!< FE File Page offset
+            ks10_t::data_t homsum;                      //!< HOM block checksum
+            ks10_t::data_t preboot[512];                //!< Pre-boot page
+        };
+
+        static const uint32_t BOOTCACHE_MAGIC = 0x52504245;
+        static const unsigned int BOOTCACHE_SIZE = 16;
+
         //
         // Private functions
         //
@@ -85,7 +146,18 @@ class rp_t : public rh11_t {
         void testRPLA22(uint16_t unit);
         bool isHomBlock(ks10_t::addr_t addr);
         bool readBlock(ks10_t::addr_t vaddr, ks10_t::data_t daddr);
-        bool bootBlock(ks10_t::addr_t paddr, ks10_t::addr_t vaddr, ks10_t::data_t daddr, ks10_t::addr_t offset);
+        bool bootBlock(ks10_t::addr_t paddr, ks10_t::addr_t vaddr, ks10_t::data_t daddr, ks10_t::addr_t offset, bool cache);
+        ks10_t::data_t homChecksum(ks10_t::addr_t paddr);
+        bool bootCached(ks10_t::addr_t paddr, ks10_t::addr_t vaddr, ks10_t::data_t daddr, ks10_t::addr_t offset);
+        void updateCache(ks10_t::addr_t paddr, ks10_t::addr_t offset, ks10_t::data_t homsum);
+        static void readCache(bootcache_t *entries);
+        static void writeCache(const bootcache_t *entries);
+        bool imageSetup(uint16_t unit, ks10_t::addr_t vaddr[2], ks10_t::addr_t paddr[2]);
+        void startXfer(uint16_t cmd, ks10_t::addr_t vaddr, unsigned int sect, unsigned int words, struct timespec *go = NULL);
+        bool benchXfer(uint16_t cmd, ks10_t::addr_t vaddr, unsigned int sect, double &usec);
+        void benchRun(rpbench_t &bench, uint16_t cmd, ks10_t::addr_t vaddr, const unsigned int *sects, unsigned int count);
+        bool imageWait(bool wrchk);
+        bool imageXfer(uint16_t unit, FILE *fp, unsigned int start, bool write, bool verify);
 
     public:
 
@@ -95,13 +167,18 @@ class rp_t : public rh11_t {
         // Public Functions
         //
 
-        void dumpRegs(void);
+        void dumpRegs(bool script = false);
         void testInit(uint16_t unit);
         void testRPLA(uint16_t unit);
         void testRead(uint16_t unit);
         void testWrite(uint16_t unit);
         void testWrchk(uint16_t unit);
-        void boot(uint16_t unit, bool diagmode = false);
+        void testBench(uint16_t unit, unsigned int count = 1000, const char *csvfile = NULL, const char *jsonfile = NULL);
+        void boot(uint16_t unit, bool diagmode = false, bool cache = false);
+        static void flushCache(void);
+        bool dumpImage(uint16_t unit, const char *filename, unsigned int start = 0);
+        bool restoreImage(uint16_t unit, const char *filename, unsigned int start = 0, bool verify = false);
+        bool verifyImage(uint16_t unit, const char *filename, unsigned int start = 0);
 
         //!
         //! \brief
@@ -0,0 +1,611 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Symbol Table Object
+//!
+//! \details
+//!    Symbols are appended in any order and sorted by value when a file has
+//!    been loaded.  Lookups are a binary search for the symbol with the
+//!    largest value that is not greater than the address.
+//!
+//!    Binary files are read five bytes per word.  The ANSI packing is the
+//!    same as the .SAV files that the "go" command loads.  The Core Dump
+//!    packing is the usual packing for files that were copied from tape.
+//!
+//! \file
+//!    symtab.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "pack.hpp"
+#include "symtab.hpp"
+
+//
+// Location of the DDT symbol table pointer (.JBSYM) in a program
+//
+
+static const unsigned int jbSYM = 0116;
+
+//
+// Program sizes
+//
+
+static const unsigned int memSIZE  = 01000000;         // Words in section 0
+static const unsigned int pageSIZE = 01000;            // Words per page
+
+//!
+//! \brief
+//!    Compare symbols by value.  At the same value locals sort before
+//!    globals so that lookup() finds the global.
+//!
+
+static int compare(const void *a, const void *b) {
+    const symtab_t::sym_t *sa = (const symtab_t::sym_t *)a;
+    const symtab_t::sym_t *sb = (const symtab_t::sym_t *)b;
+    if (sa->value != sb->value) {
+        return sa->value < sb->value ? -1 : 1;
+    }
+    if (sa->global != sb->global) {
+        return sa->global ? 1 : -1;
+    }
+    return strcmp(sa->name, sb->name);
+}
+
+//!
+//! \brief
+//!    Sort the symbols by value
+//!
+//! \details
+//!    Duplicate entries are removed.
+//!
+
+void symtab_t::sort(void) {
+    qsort(syms, num, sizeof(syms[0]), compare);
+    unsigned int j = 0;
+    for (unsigned int i = 0; i < num; i++) {
+        if ((j == 0) || (compare(&syms[j - 1], &syms[i]) != 0)) {
+            syms[j++] = syms[i];
+        }
+    }
+    num = j;
+}
+
+//!
+//! \brief
+//!    Add a symbol
+//!
+//! \details
+//!    The table is not sorted until the caller is done adding symbols.
+//!
+//! \param [in] name -
+//!    Symbol name.  Long names are truncated.
+//!
+//! \param [in] value -
+//!    Symbol value
+//!
+//! \param [in] global -
+//!    Global symbol
+//!
+//! \returns
+//!    True if the symbol was added
+//!
+
+bool symtab_t::add(const char *name, uint32_t value, bool global) {
+    if (num == alloc) {
+        unsigned int size = alloc ? 2 * alloc : 1024;
+        sym_t *temp = new sym_t[size];
+        if (num) {
+            memcpy(temp, syms, num * sizeof(syms[0]));
+        }
+        delete[] syms;
+        syms  = temp;
+        alloc = size;
+    }
+    strncpy(syms[num].name, name, maxName - 1);
+    syms[num].name[maxName - 1] = 0;
+    syms[num].value  = value;
+    syms[num].global = global;
+    num++;
+    return true;
+}
+
+//!
+//! \brief
+//!    Remove all of the symbols
+//!
+
+void symtab_t::clear(void) {
+    num = 0;
+}
+
+//!
+//! \brief
+//!    Read a word from a binary file
+//!
+//! \param [in] fp -
+//!    File pointer
+//!
+//! \param [in] cordmp -
+//!    Core Dump packing instead of ANSI packing
+//!
+//! \param [out] data -
+//!    36-bit word
+//!
+//! \returns
+//!    True if a word was read
+//!
+
+bool symtab_t::readWord(FILE *fp, bool cordmp, uint64_t &data) {
+    uint8_t buffer[5];
+    if (fread(buffer, sizeof(buffer), 1, fp) != 1) {
+        return false;
+    }
+    data = cordmp ? pack_t::packCORDMP(buffer) : pack_t::packANSI(buffer);
+    return true;
+}
+
+//!
+//! \brief
+//!    Add a symbol from a RADIX50 symbol table entry
+//!
+//! \details
+//!    The first word of the entry is the symbol code in bits 0-3 and the
+//!    RADIX50 name in bits 4-35.  The second word is the value.
+//!
+//!    Program names (00), block names (14), and symbols that are
+//!    half-killed (40) or deleted (20) are skipped, as are values that are
+//!    not section 0 addresses.
+//!
+//! \param [in] sym -
+//!    RADIX50 symbol
+//!
+//! \param [in] value -
+//!    Symbol value
+//!
+//! \param [in] reloc -
+//!    Relocation added to the value
+//!
+//! \returns
+//!    True if the symbol was added
+//!
+
+bool symtab_t::addRAD50(uint64_t sym, uint64_t value, uint32_t reloc) {
+
+    static const char rad50[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.$%";
+
+    unsigned int code = (sym >> 30) & 074;
+    if (((code & 014) == 000) || ((code & 014) == 014) || (code & 060)) {
+        return false;
+    }
+
+    value += reloc;
+    if (value > 0777777) {
+        return false;
+    }
+
+    char temp[7];
+    char *name = &temp[6];
+    *name = 0;
+    for (uint32_t r = sym & 037777777777; r != 0; r /= 050) {
+        if (r % 050 < sizeof(rad50) - 1) {
+            *--name = rad50[r % 050];
+        }
+        if (name == temp) {
+            break;
+        }
+    }
+    while (*name == ' ') {
+        name++;
+    }
+    if (*name == 0) {
+        return false;
+    }
+
+    return add(name, value, (code & 014) == 004);
+}
+
+//!
+//! \brief
+//!    Add the symbols from the DDT symbol table of a program image
+//!
+//! \details
+//!    .JBSYM is -n,,addr when the program was loaded with its symbols.
+//!
+//! \param [in] mem -
+//!    Program image
+//!
+//! \returns
+//!    True if the program has a symbol table
+//!
+
+bool symtab_t::addDDT(const uint64_t *mem) {
+
+    uint64_t ptr = mem[jbSYM];
+    if ((ptr & 0400000000000ULL) == 0) {
+        printf("KS10: Program has no symbol table (.JBSYM is %012llo).\n", ptr);
+        return false;
+    }
+
+    unsigned int len  = 01000000 - ((ptr >> 18) & 0777777);
+    unsigned int addr = ptr & 0777777;
+    for (unsigned int i = 0; i + 1 < len; i += 2) {
+        addRAD50(mem[(addr + i) & 0777777], mem[(addr + i + 1) & 0777777], 0);
+    }
+    return true;
+}
+
+//!
+//! \brief
+//!    Load the symbols from a .SAV file
+//!
+//! \details
+//!    A .SAV file is a list of IOWD (-n,,addr-1) blocks that is terminated
+//!    by a JRST to the starting address.
+//!
+
+bool symtab_t::loadSAV(FILE *fp, bool cordmp) {
+
+    uint64_t *mem = new uint64_t[memSIZE]();
+    uint64_t iowd;
+    while (readWord(fp, cordmp, iowd) && (iowd & 0400000000000ULL)) {
+        unsigned int words = 01000000 - ((iowd >> 18) & 0777777);
+        unsigned int addr  = iowd & 0777777;
+        for (unsigned int i = 0; i < words; i++) {
+            addr = (addr + 1) & 0777777;
+            if (!readWord(fp, cordmp, mem[addr])) {
+                break;
+            }
+        }
+    }
+
+    bool ret = addDDT(mem);
+    delete[] mem;
+    return ret;
+}
+
+//!
+//! \brief
+//!    Load the symbols from a .EXE file
+//!
+//! \details
+//!    The directory section (1776,,len) maps file pages to process pages.
+//!    Each entry is two words: flags and file page, then repeat count and
+//!    process page.  A file page of zero is an allocated but zero page.
+//!    Only section 0 is loaded.
+//!
+
+bool symtab_t::loadEXE(FILE *fp, bool cordmp) {
+
+    uint64_t header;
+    if (!readWord(fp, cordmp, header) || (((header >> 18) & 0777777) != 01776)) {
+        printf("KS10: File is not an .EXE file.\n");
+        return false;
+    }
+
+    unsigned int entries = ((header & 0777777) - 1) / 2;
+    uint64_t *dir = new uint64_t[2 * entries];
+    for (unsigned int i = 0; i < 2 * entries; i++) {
+        if (!readWord(fp, cordmp, dir[i])) {
+            printf("KS10: .EXE directory is truncated.\n");
+            delete[] dir;
+            return false;
+        }
+    }
+
+    uint64_t *mem = new uint64_t[memSIZE]();
+    for (unsigned int i = 0; i < entries; i++) {
+        unsigned int filePage = dir[2 * i + 0] & 0777777777;
+        unsigned int procPage = dir[2 * i + 1] & 0777777777;
+        unsigned int count    = ((dir[2 * i + 1] >> 27) & 0777) + 1;
+        if (filePage == 0) {
+            continue;
+        }
+        for (unsigned int j = 0; (j < count) && (procPage + j < memSIZE / pageSIZE); j++) {
+            if (fseek(fp, (filePage + j) * pageSIZE * 5L, SEEK_SET) != 0) {
+                break;
+            }
+            for (unsigned int k = 0; k < pageSIZE; k++) {
+                if (!readWord(fp, cordmp, mem[(procPage + j) * pageSIZE + k])) {
+                    break;
+                }
+            }
+        }
+    }
+
+    bool ret = addDDT(mem);
+    delete[] mem;
+    delete[] dir;
+    return ret;
+}
+
+//!
+//! \brief
+//!    Load the symbols from a .REL file
+//!
+//! \details
+//!    Each LINK block starts with a type,,count header.  In the short
+//!    format blocks (types 0-37) a relocation word precedes each group of
+//!    18 data words and is not included in the count.  The long format
+//!    blocks (types 1000 and up) are skipped using the count.
+//!
+//!    Symbol blocks (type 2) are pairs of RADIX50 symbol and value words.
+//!    Relocatable values are relative to the start of each module, so the
+//!    caller supplies the relocation.  This is only exact for a file with a
+//!    single module.
+//!
+
+bool symtab_t::loadREL(FILE *fp, bool cordmp, uint32_t reloc) {
+
+    uint64_t header;
+    while (readWord(fp, cordmp, header)) {
+
+        unsigned int type  = (header >> 18) & 0777777;
+        unsigned int count = header & 0777777;
+
+        if (type >= 01000) {
+            if (fseek(fp, count * 5L, SEEK_CUR) != 0) {
+                break;
+            }
+            continue;
+        }
+
+        uint64_t relwd = 0;
+        uint64_t data[2];
+        for (unsigned int i = 0; i < count; i++) {
+            if ((i % 18) == 0) {
+                if (!readWord(fp, cordmp, relwd)) {
+                    return true;
+                }
+            }
+            if (!readWord(fp, cordmp, data[i & 1])) {
+                return true;
+            }
+            if ((type == 2) && (i & 1)) {
+                bool relocatable = (relwd >> (34 - 2 * (i % 18))) & 1;
+                addRAD50(data[0], data[1] & 0777777, relocatable ? reloc : 0);
+            }
+        }
+    }
+    return true;
+}
+
+//!
+//! \brief
+//!    Parse a symbol name
+//!
+
+static bool isName(const char *s) {
+    if (!isalpha(*s) && (*s != '.') && (*s != '$') && (*s != '%')) {
+        return false;
+    }
+    for (; *s; s++) {
+        if (!isalnum(*s) && (*s != '.') && (*s != '$') && (*s != '%')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//!
+//! \brief
+//!    Parse an octal value.  A trailing quote marks a relocatable value.
+//!
+
+static bool isValue(const char *s, uint32_t reloc, uint32_t &value) {
+    if ((*s < '0') || (*s > '7')) {
+        return false;
+    }
+    char *end;
+    unsigned long v = strtoul(s, &end, 8);
+    if (*end == '\'') {
+        v += reloc;
+        end++;
+    }
+    if ((*end != 0) || (v > 0777777)) {
+        return false;
+    }
+    value = v;
+    return true;
+}
+
+//!
+//! \brief
+//!    Load symbols from a text file
+//!
+//! \details
+//!    A line that starts with a symbol name and an octal value in either
+//!    order, for example "START 1000", "1000 START" or "START=1000", adds a
+//!    symbol.  More name and value pairs may follow on the same line.  The
+//!    first word that is not part of a pair (for example "Global" in a LINK
+//!    map) ends the line.  This reads LINK maps and MACRO listing symbol
+//!    tables without picking up the code in the listing.
+//!
+
+bool symtab_t::loadMAP(FILE *fp, uint32_t reloc) {
+
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+
+        const char *tok[16];
+        unsigned int ntok = 0;
+        for (char *t = strtok(line, " \t\r\n=:"); t && (ntok < 16); t = strtok(NULL, " \t\r\n=:")) {
+            tok[ntok++] = t;
+        }
+
+        for (unsigned int i = 0; i + 1 < ntok; i += 2) {
+            uint32_t value;
+            if (isName(tok[i]) && isValue(tok[i + 1], reloc, value)) {
+                add(tok[i], value);
+            } else if (isValue(tok[i], reloc, value) && isName(tok[i + 1])) {
+                add(tok[i + 1], value);
+            } else {
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+//!
+//! \brief
+//!    Load symbols from a file
+//!
+//! \details
+//!    The format is selected by the file extension: .SAV, .EXE, .REL, or
+//!    anything else for a text file.
+//!
+//! \param [in] filename -
+//!    Name of the symbol file
+//!
+//! \param [in] reloc -
+//!    Relocation for relocatable symbols in .REL files and listings
+//!
+//! \param [in] cordmp -
+//!    Binary files use the Core Dump packing instead of ANSI packing
+//!
+//! \returns
+//!    True if the file was read
+//!
+
+bool symtab_t::load(const char *filename, uint32_t reloc, bool cordmp) {
+
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        printf("KS10: Unable to open symbol file \"%s\". %s\n", filename, strerror(errno));
+        return false;
+    }
+
+    const char *ext = strrchr(filename, '.');
+    if (ext == NULL) {
+        ext = "";
+    }
+
+    unsigned int start = num;
+    bool ret;
+    if (strcasecmp(ext, ".sav") == 0) {
+        ret = loadSAV(fp, cordmp);
+    } else if (strcasecmp(ext, ".exe") == 0) {
+        ret = loadEXE(fp, cordmp);
+    } else if (strcasecmp(ext, ".rel") == 0) {
+        ret = loadREL(fp, cordmp, reloc);
+    } else {
+        ret = loadMAP(fp, reloc);
+    }
+    fclose(fp);
+
+    unsigned int added = num - start;
+    sort();
+    if (ret) {
+        printf("KS10: Loaded %u symbols from \"%s\".\n", added, filename);
+    }
+    return ret;
+}
+
+//!
+//! \brief
+//!    Find the symbol for an address
+//!
+//! \param [in] addr -
+//!    Address
+//!
+//! \returns
+//!    Index of the symbol with the largest value that is not greater than
+//!    the address, or -1 if there is no such symbol within maxOffset.
+//!
+
+int symtab_t::lookup(uint32_t addr) const {
+    unsigned int lo = 0;
+    unsigned int hi = num;
+    while (lo < hi) {
+        unsigned int mid = (lo + hi) / 2;
+        if (syms[mid].value <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if ((lo == 0) || (addr - syms[lo - 1].value > maxOffset)) {
+        return -1;
+    }
+    return lo - 1;
+}
+
+//!
+//! \brief
+//!    Find a symbol by name
+//!
+//! \param [in] name -
+//!    Symbol name.  Case is ignored.
+//!
+//! \returns
+//!    Index of the symbol or -1 if it is not found
+//!
+
+int symtab_t::find(const char *name) const {
+    for (unsigned int i = 0; i < num; i++) {
+        if (strcasecmp(syms[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//!
+//! \brief
+//!    Format an address as symbol+offset
+//!
+//! \param [in] addr -
+//!    Address
+//!
+//! \param [out] buf -
+//!    Output buffer
+//!
+//! \param [in] size -
+//!    Size of the output buffer
+//!
+//! \returns
+//!    buf.  The address is printed in octal when there is no symbol.
+//!
+
+const char *symtab_t::format(uint32_t addr, char *buf, size_t size) const {
+    int i = lookup(addr);
+    if (i < 0) {
+        snprintf(buf, size, "%06o", addr);
+    } else if (addr == syms[i].value) {
+        snprintf(buf, size, "%s", syms[i].name);
+    } else {
+        snprintf(buf, size, "%s+%o", syms[i].name, addr - syms[i].value);
+    }
+    return buf;
+}
@@ -0,0 +1,143 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Symbol Table Object
+//!
+//! \details
+//!    This object maps KS10 addresses to symbols.  The symbols are kept in
+//!    an array that is sorted by value so that an address is resolved to
+//!    "symbol+offset" with a binary search.
+//!
+//!    Symbols can be loaded from the DDT symbol table of a .SAV or .EXE
+//!    file, from the symbol blocks of a .REL file, or from the symbol table
+//!    of a LINK map or MACRO listing.
+//!
+//! \file
+//!    symtab.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+
+#ifndef __SYMTAB_HPP
+#define __SYMTAB_HPP
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+//!
+//! \brief
+//!    Symbol Table Object
+//!
+
+class symtab_t {
+
+    public:
+
+        static const unsigned int maxName = 16;         //!< Longest symbol name
+
+        //!
+        //! \brief
+        //!    Symbol
+        //!
+
+        struct sym_t {
+            uint32_t value;                             //!< Symbol value (address)
+            bool global;                                //!< Global symbol
+            char name[maxName];                         //!< Symbol name
+        };
+
+        //
+        // Largest offset that is printed as symbol+offset
+        //
+
+        static const uint32_t maxOffset = 010000;
+
+    private:
+
+        sym_t *syms;                                    //!< Symbols sorted by value
+        unsigned int num;                               //!< Number of symbols
+        unsigned int alloc;                             //!< Size of syms[]
+
+        void sort(void);
+        static bool readWord(FILE *fp, bool cordmp, uint64_t &data);
+        bool addRAD50(uint64_t sym, uint64_t value, uint32_t reloc);
+        bool addDDT(const uint64_t *mem);
+        bool loadSAV(FILE *fp, bool cordmp);
+        bool loadEXE(FILE *fp, bool cordmp);
+        bool loadREL(FILE *fp, bool cordmp, uint32_t reloc);
+        bool loadMAP(FILE *fp, uint32_t reloc);
+
+    public:
+
+        bool add(const char *name, uint32_t value, bool global = true);
+        bool load(const char *filename, uint32_t reloc = 0, bool cordmp = false);
+        void clear(void);
+        int find(const char *name) const;
+        int lookup(uint32_t addr) const;
+        const char *format(uint32_t addr, char *buf, size_t size) const;
+
+        //!
+        //! \brief
+        //!    Returns the number of symbols
+        //!
+
+        unsigned int size(void) const {
+            return num;
+        }
+
+        //!
+        //! \brief
+        //!    Returns a symbol
+        //!
+
+        const sym_t &operator[](unsigned int i) const {
+            return syms[i];
+        }
+
+        //!
+        //! \brief
+        //!    Constructor
+        //!
+
+        symtab_t(void) :
+            syms(NULL),
+            num(0),
+            alloc(0) {
+            ;
+        }
+
+        //!
+        //! \brief
+        //!    Destructor
+        //!
+
+        ~symtab_t(void) {
+            delete[] syms;
+        }
+};
+
+#endif
@@ -44,6 +44,7 @@
 #include "tape.hpp"
 #include "dasm.hpp"
 #include "ks10.hpp"
+#include "pack.hpp"
 #include "vt100.hpp"
 #include "commands.hpp"
 
@@ -218,11 +219,7 @@ inline int tape_t::readDataCORDMP(ks10_t::data_t &data) {
         return -1;
     }
 
-    data = ((((ks10_t::data_t)buf[0] & 0xff) << 28) |
-            (((ks10_t::data_t)buf[1] & 0xff) << 20) |
-            (((ks10_t::data_t)buf[2] & 0xff) << 12) |
-            (((ks10_t::data_t)buf[3] & 0xff) <<  4) |
-            (((ks10_t::data_t)buf[4] & 0x0f) <<  0));
+    data = pack_t::packCORDMP(buf);
 
     return 0;
 }
@@ -257,10 +254,7 @@ inline int tape_t::readDataCOMPAT(ks10_t::data_t &data) {
         return -1;
     }
 
-    data = ((((ks10_t::data_t)buf[0] & 0xff) << 28) |
-            (((ks10_t::data_t)buf[1] & 0xff) << 20) |
-            (((ks10_t::data_t)buf[2] & 0xff) << 12) |
-            (((ks10_t::data_t)buf[3] & 0xff) <<  4));
+    data = pack_t::packCOMPAT(buf);
 
     return 0;
 }
@@ -292,6 +286,52 @@ int tape_t::readData(uint8_t format, ks10_t::data_t &data) {
     return -1;
 }
 
+//!
+//! \brief
+//!    Read the data of one record from file.
+//!
+//! \details
+//!    The record is read with one fread() and the whole record is packed
+//!    into recWords[] with the bulk packing routines.
+//!
+//! \param format
+//!    Format of the data
+//!
+//! \param length
+//!    Length of the record in bytes
+//!
+//! \param [out] words
+//!    Number of whole words that were read
+//!
+//! \returns
+//!    0 if the whole record was read, -1 otherwise.
+//!
+
+int tape_t::readRecord(uint8_t format, unsigned int length, unsigned int &words) {
+
+    size_t nread = fread(recBytes, sizeof(recBytes[0]), length, fp);
+
+    words = nread / bytes_per_word(format);
+    switch (format) {
+        case f_CORDMP:
+            pack_t::packCORDMP(recWords, recBytes, words);
+            break;
+        case f_COMPAT:
+            pack_t::packCOMPAT(recWords, recBytes, words);
+            break;
+        default:
+            words = 0;
+            return -1;
+    }
+
+    if (nread != length) {
+        printf("TAPE: Unit %d: Error: readRecord() - fread() returned %d.\n", unit, nread);
+        return -1;
+    }
+
+    return 0;
+}
+
 //!
 //! \brief
 //!    Write one word of PDP-10 CORDMP Data to tape
@@ -311,14 +351,10 @@ int tape_t::readData(uint8_t format, ks10_t::data_t &data) {
 
 int tape_t::writeDataCORDMP(ks10_t::data_t data) {
 
-    char buf[5];
+    uint8_t buf[5];
     const unsigned int bufsiz = sizeof(buf)/sizeof(buf[0]);
 
-    buf[0] = ((data & 0xff0000000) >> 28);
-    buf[1] = ((data & 0x00ff00000) >> 20);
-    buf[2] = ((data & 0x0000ff000) >> 12);
-    buf[3] = ((data & 0x000000ff0) >>  4);
-    buf[4] = ((data & 0x00000000f) >>  0);
+    pack_t::unpackCORDMP(data, buf);
 
     size_t nwrite = fwrite(buf, sizeof(buf[0]), bufsiz, fp);
     if (nwrite != bufsiz) {
@@ -346,13 +382,10 @@ int tape_t::writeDataCORDMP(ks10_t::data_t data) {
 
 int tape_t::writeDataCOMPAT(ks10_t::data_t data) {
 
-    char buf[4];
+    uint8_t buf[4];
     const unsigned int bufsiz = sizeof(buf)/sizeof(buf[0]);
 
-    buf[0] = ((data & 0xff0000000) >> 28);
-    buf[1] = ((data & 0x00ff00000) >> 20);
-    buf[2] = ((data & 0x0000ff000) >> 12);
-    buf[3] = ((data & 0x000000ff0) >>  4);
+    pack_t::unpackCOMPAT(data, buf);
 
     size_t nwrite = fwrite(buf, sizeof(buf[0]), bufsiz, fp);
     if (nwrite != bufsiz) {
@@ -1003,20 +1036,20 @@ void tape_t::readForward(uint64_t mtDIR) {
             objcnt += 1;
             reccnt += 1;
 
-            for (unsigned int i = 0; i < length; i += bpw) {
+            //
+            // Read the record from file.
+            // This should not fail at EOF. We've already validated the tape file.
+            //
 
-                //
-                // Read data from file.
-                // This should not fail at EOF. We've already validated the tape file.
-                //
+            unsigned int words;
+            if (readRecord(format, length, words) < 0) {
+                DEBUG_RDFWD("TAPE: Unit %d: Read Forward. Found EOF reading data.\n", unit);
+                done = true;
+            }
 
-                ks10_t::data_t data;
-                int status = readData(format, data);
-                if (status < 0) {
-                    DEBUG_RDFWD("TAPE: Unit %d: Read Forward. Found EOF reading data.\n", unit);
-                    done = true;
-                    break;
-                }
+            for (unsigned int i = 0; i < words; i++) {
+
+                ks10_t::data_t data = recWords[i];
 
                 //
                 // Write data to Tape Controller
@@ -69,6 +69,8 @@ class tape_t {
         bool lastTM;                    //!< TM state
         FILE *fp;                       //!< File pointer
         std::thread thread;             //!< Thread object
+        uint8_t recBytes[0x10000];      //!< Record data from the file
+        ks10_t::data_t recWords[0x10000 / 4]; //!< Record data packed into words
 
         //!
         //! \brief
@@ -253,6 +255,7 @@ class tape_t {
         int  readDataCORDMP(ks10_t::data_t &data);
         int  readDataCOMPAT(ks10_t::data_t &data);
         int  readData(uint8_t format, ks10_t::data_t &data);
+        int  readRecord(uint8_t format, unsigned int length, unsigned int &words);
         int  writeDataCORDMP(ks10_t::data_t);
         int  writeDataCOMPAT(ks10_t::data_t);
         int  writeData(ks10_t::data_t, uint8_t format);
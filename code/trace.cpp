@@ -0,0 +1,406 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Instruction Trace Interface Object
+//!
+//! \details
+//!    The FPGA trace buffer is a LIFO.  The CPU pushes the PC and IR of each
+//!    instruction and every read of the ITR pops the newest entry.  When the
+//!    buffer is full the CPU keeps pushing and the oldest entries are lost.
+//!
+//!    The buffer is drained newest first, so each pass is written to the
+//!    file in reverse.  While the KS10 is running, instructions that are
+//!    pushed during a pass are read ahead of older entries, and a pass that
+//!    stops after one buffer length leaves the oldest entries for the next
+//!    pass.  The order is therefore only exact when the KS10 is halted.  A
+//!    streamed trace is not in execution order and the gap markers only
+//!    show roughly where entries were lost.  It is good for histograms of
+//!    the PCs and opcodes but not for following the program flow.
+//!
+//!    The FPGA does not count lost entries.  A pass that finds the buffer
+//!    full is counted as a gap, and the number of entries that were lost is
+//!    estimated from the fill rate measured in the passes that did not
+//!    overflow.
+//!
+//!    The LIFO also loses entries that are not counted at all.  When the
+//!    CPU pushes an entry in the same cycle that the console pops one, the
+//!    stack pointers are left unchanged and the pushed entry is dropped.
+//!    While the KS10 is running the lost count and the drop fraction are
+//!    therefore lower bounds.  A trace that is drained while the KS10 is
+//!    halted is complete.
+//!
+//! \file
+//!    trace.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "trace.hpp"
+#include "util.hpp"
+
+//!
+//! \brief
+//!    Drain the trace buffer
+//!
+//! \details
+//!    The first read provides the size of the trace buffer and the full and
+//!    empty status.  The rest of the buffer is read in one locked pass.
+//!
+//! \returns
+//!    Number of entries in buf[], newest first.  The status bits of the
+//!    first read are left in buf[0].
+//!
+
+unsigned int trace_t::drain(void) {
+
+    uint64_t itr = ks10_t::readITR();
+    if (itr & ks10_t::itrEMPTY) {
+        return 0;
+    }
+
+    unsigned int need = 1u << ((itr & ks10_t::itrSIZE) >> 56);
+    if (need != size) {
+        delete[] buf;
+        buf  = new uint64_t[need];
+        size = need;
+    }
+
+    buf[0] = itr;
+    return 1 + ks10_t::readITRBlock(&buf[1], size - 1);
+}
+
+//!
+//! \brief
+//!    Write one trace entry
+//!
+//! \param [in] fp -
+//!    File pointer
+//!
+//! \param [in] entry -
+//!    Trace entry
+//!
+//! \returns
+//!    True if the entry was written
+//!
+
+bool trace_t::writeEntry(FILE *fp, uint64_t entry) {
+    uint8_t b[8];
+    for (unsigned int j = 0; j < 8; j++) {
+        b[j] = (entry >> (8 * j)) & 0xff;
+    }
+    return fwrite(b, sizeof(b), 1, fp) == 1;
+}
+
+//!
+//! \brief
+//!    Save the trace buffer to a file
+//!
+//! \details
+//!    The KS10 should be halted so that the buffer is not changing.
+//!
+//! \param [in] filename -
+//!    Name of the file to create
+//!
+
+void trace_t::save(const char *filename) {
+
+    struct timespec start;
+    struct timespec finish;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned int num = drain();
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    if (num == 0) {
+        printf("tr: trace buffer is empty\n");
+        return;
+    }
+
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        printf("tr: unable to open file \"%s\": %s\n", filename, strerror(errno));
+        return;
+    }
+
+    bool ok = true;
+    for (unsigned int i = num; ok && (i > 0); i--) {
+        ok = writeEntry(fp, buf[i - 1] & ks10_t::itrPCIR);
+    }
+
+    if (fclose(fp) != 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        printf("tr: error writing file \"%s\": %s\n", filename, strerror(errno));
+    } else {
+        printf("tr: saved %u entries to \"%s\" (drained in %.3f ms)\n", num, filename, nsecs(start, finish) / 1.0e6);
+    }
+}
+
+//!
+//! \brief
+//!    Open the current file in the ring
+//!
+//! \returns
+//!    True if the file was opened
+//!
+
+bool trace_t::openFile(void) {
+    char filename[maxName + 16];
+    sprintf(filename, "%s/trace%02u.bin", streamDir, local.file);
+    streamFp = fopen(filename, "wb");
+    streamCount = 0;
+    return streamFp != NULL;
+}
+
+//!
+//! \brief
+//!    Stream thread
+//!
+//! \details
+//!    The thread drains the trace buffer as fast as it fills.  When a pass
+//!    finds little to do the thread sleeps for a millisecond.  The KS10 is
+//!    not stopped for a pass, so the entries are not in execution order.
+//!
+
+void trace_t::streamLoop(void) {
+
+    struct timespec last;
+    clock_gettime(CLOCK_MONOTONIC, &last);
+
+    while (streamRun) {
+
+        unsigned int num = drain();
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t interval = nsecs(last, now);
+        last = now;
+
+        local.passes++;
+
+        //
+        // A full buffer means that entries were overwritten since the last
+        // pass.  Mark the gap in the file with the estimated loss.
+        //
+
+        bool ok = true;
+        if ((num != 0) && (buf[0] & ks10_t::itrFULL)) {
+            uint64_t lost = 0;
+            if (local.fillNsecs != 0) {
+                double pushed = (double)local.fillEntries * interval / local.fillNsecs;
+                if (pushed > num) {
+                    lost = pushed - num;
+                }
+            }
+            local.gaps++;
+            local.lost += lost;
+            ok = writeEntry(streamFp, itrGAP | (lost & ks10_t::itrPCIR));
+        } else {
+            local.fillEntries += num;
+            local.fillNsecs   += interval;
+        }
+
+        for (unsigned int i = num; ok && (i > 0); i--) {
+            ok = writeEntry(streamFp, buf[i - 1] & ks10_t::itrPCIR);
+            if (ok && (++streamCount >= streamEntries)) {
+                fclose(streamFp);
+                local.file = (local.file + 1) % streamFiles;
+                if (local.file == 0) {
+                    local.wraps++;
+                }
+                ok = openFile();
+            }
+        }
+        local.entries += num;
+
+        if (!ok) {
+            local.error = true;
+            streamRun = false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            stats = local;
+        }
+
+        if ((num == 0) || (num < size / 4)) {
+            usleep(1000);
+        }
+    }
+}
+
+//!
+//! \brief
+//!    Start streaming the trace buffer to a ring of files
+//!
+//! \details
+//!    The trace buffer is cleared and then streamed to the files
+//!    dir/trace00.bin through dir/traceNN.bin.  Each file holds the given
+//!    number of entries.  When the last file is full the first file is
+//!    overwritten.
+//!
+//! \param [in] dir -
+//!    Directory for the trace files
+//!
+//! \param [in] files -
+//!    Number of files in the ring
+//!
+//! \param [in] entries -
+//!    Number of entries in each file
+//!
+//! \returns
+//!    True if the stream was started
+//!
+
+bool trace_t::streamStart(const char *dir, unsigned int files, uint64_t entries) {
+
+    if (streamRun) {
+        printf("KS10: Trace stream is already running.\n");
+        return false;
+    }
+
+    struct stat st;
+    if ((stat(dir, &st) != 0) || !S_ISDIR(st.st_mode)) {
+        printf("KS10: %s is not a directory.\n", dir);
+        return false;
+    }
+
+    if (strlen(dir) >= maxName) {
+        printf("KS10: Directory name is too long.\n");
+        return false;
+    }
+
+    if ((files == 0) || (files > 100) || (entries == 0)) {
+        printf("KS10: Invalid trace file ring.\n");
+        return false;
+    }
+
+    streamStop();
+
+    strcpy(streamDir, dir);
+    streamFiles   = files;
+    streamEntries = entries;
+    memset(&local, 0, sizeof(local));
+    memset(&stats, 0, sizeof(stats));
+
+    if (!openFile()) {
+        printf("KS10: Unable to create trace file in %s. %s\n", dir, strerror(errno));
+        return false;
+    }
+
+    ks10_t::writeITR(ks10_t::itrCLR);
+    clock_gettime(CLOCK_MONOTONIC, &streamTime);
+    streamRun = true;
+    streamThread = std::thread(&trace_t::streamLoop, this);
+
+    printf("KS10: Streaming trace to %s (%u files of %llu entries).\n", dir, files, entries);
+    return true;
+}
+
+//!
+//! \brief
+//!    Stop streaming the trace buffer
+//!
+
+void trace_t::streamStop(void) {
+
+    bool wasRunning = streamThread.joinable();
+
+    streamRun = false;
+    if (streamThread.joinable()) {
+        streamThread.join();
+    }
+
+    if (streamFp) {
+        fclose(streamFp);
+        streamFp = NULL;
+    }
+
+    if (wasRunning) {
+        clock_gettime(CLOCK_MONOTONIC, &streamEnd);
+    }
+}
+
+//!
+//! \brief
+//!    Print the trace stream statistics
+//!
+//! \details
+//!    The drop fraction is the estimated number of lost entries divided by
+//!    the number of instructions that were executed (entries + lost).  It
+//!    does not include the entries that were dropped by a push during a
+//!    pop, so it is a lower bound.
+//!
+
+void trace_t::streamStat(void) {
+
+    if (streamDir[0] == 0) {
+        printf("KS10: Trace stream has not been started.\n");
+        return;
+    }
+
+    stats_t copy;
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        copy = stats;
+    }
+
+    bool running = streamThread.joinable();
+    struct timespec now;
+    if (running) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } else {
+        now = streamEnd;
+    }
+    double secs = nsecs(streamTime, now) / 1.0e9;
+    uint64_t total = copy.entries + copy.lost;
+
+    printf("KS10: Trace stream to %s is %s%s.\n"
+           "      Files     : %u files of %llu entries. Current is trace%02u.bin (wrapped %u times)\n"
+           "      Time      : %.1f seconds\n"
+           "      Passes    : %llu\n"
+           "      Entries   : %llu (%.0f entries/sec)\n"
+           "      Overflows : %llu\n"
+           "      Lost      : at least %llu estimated (%.2f%% of the instructions were not captured)\n",
+           streamDir, streamRun ? "running" : "stopped", copy.error ? " (file error)" : "",
+           streamFiles, streamEntries, copy.file, copy.wraps,
+           secs,
+           copy.passes,
+           copy.entries, secs > 0 ? copy.entries / secs : 0.0,
+           copy.gaps,
+           copy.lost, total ? 100.0 * copy.lost / total : 0.0);
+
+    if ((copy.gaps != 0) && (copy.fillNsecs == 0)) {
+        printf("      Every pass overflowed so the loss could not be estimated.\n");
+    }
+}
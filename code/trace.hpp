@@ -0,0 +1,160 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Instruction Trace Interface Object
+//!
+//! \details
+//!    This object drains the FPGA instruction trace buffer (ITR) to files.
+//!    The buffer can be saved once after the KS10 halts or it can be
+//!    streamed continuously by a background thread while the KS10 runs.
+//!
+//!    Trace files contain eight byte, little-endian entries with the PC in
+//!    bits 53:36 and the IR in bits 35:0.  A file that is saved while the
+//!    KS10 is halted is in execution order.  A streamed file is not: the
+//!    buffer is a LIFO that the KS10 keeps pushing while it is drained, so
+//!    the entries of one pass are interleaved with newer ones and a pass
+//!    can leave older entries behind for the next.  Streamed files are only
+//!    good for histograms.  An entry with bit 63 set is a gap marker.  Its
+//!    low bits are the estimated number of instructions that were lost when
+//!    the trace buffer overflowed.
+//!
+//! \file
+//!    trace.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+
+#ifndef __TRACE_HPP
+#define __TRACE_HPP
+
+#include <mutex>
+#include <thread>
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ks10.hpp"
+
+//!
+//! \brief
+//!    Instruction Trace Interface Object
+//!
+
+class trace_t {
+
+    private:
+
+        static const unsigned int maxName = 256;        //!< Longest directory name
+
+        //!
+        //! \brief
+        //!    Stream statistics
+        //!
+
+        struct stats_t {
+            uint64_t passes;                    //!< Drain passes
+            uint64_t entries;                   //!< Entries written
+            uint64_t gaps;                      //!< Passes that found the buffer overflowed
+            uint64_t lost;                      //!< Estimated entries lost in the gaps
+            uint64_t fillEntries;               //!< Entries read in passes without overflow
+            uint64_t fillNsecs;                 //!< Time covered by those passes
+            unsigned int file;                  //!< Current file
+            unsigned int wraps;                 //!< Times the file ring has wrapped
+            bool error;                         //!< A file could not be written
+        };
+
+        unsigned int size;                      //!< Trace buffer size
+        uint64_t *buf;                          //!< Drain buffer
+
+        char streamDir[maxName];                //!< Capture directory
+        unsigned int streamFiles;               //!< Number of files in the ring
+        uint64_t streamEntries;                 //!< Entries per file
+        FILE *streamFp;                         //!< Current file
+        uint64_t streamCount;                   //!< Entries in the current file
+        volatile bool streamRun;                //!< Stream thread is running
+        std::thread streamThread;               //!< Stream thread
+        std::mutex streamMutex;                 //!< Protects stats
+        stats_t stats;                          //!< Statistics
+        stats_t local;                          //!< Stream thread statistics
+        struct timespec streamTime;             //!< Start time
+        struct timespec streamEnd;              //!< Stop time
+
+        unsigned int drain(void);
+        static bool writeEntry(FILE *fp, uint64_t entry);
+        bool openFile(void);
+        void streamLoop(void);
+
+    public:
+
+        //
+        // Gap marker in a trace file
+        //
+
+        static const uint64_t itrGAP = 0x8000000000000000ULL;
+
+        void save(const char *filename);
+        bool streamStart(const char *dir, unsigned int files, uint64_t entries);
+        void streamStop(void);
+        void streamStat(void);
+
+        //!
+        //! \brief
+        //!    Returns true if the trace is being streamed
+        //!
+
+        bool streaming(void) {
+            return streamRun;
+        }
+
+        //!
+        //! \brief
+        //!    Constructor
+        //!
+
+        trace_t(void) :
+            size(0),
+            buf(NULL),
+            streamFiles(0),
+            streamEntries(0),
+            streamFp(NULL),
+            streamCount(0),
+            streamRun(false) {
+            streamDir[0] = 0;
+        }
+
+        //!
+        //! \brief
+        //!    Destructor
+        //!
+
+        ~trace_t(void) {
+            streamStop();
+            delete[] buf;
+        }
+};
+
+#endif
@@ -0,0 +1,210 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    IO Bridge Interface Object
+//!
+//! \details
+//!    This file implements the UBA Paging RAM allocator.
+//!
+//! \file
+//!    uba.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#include <stdio.h>
+
+#include "uba.hpp"
+
+//
+// Static members
+//
+
+std::mutex uba_t::mutex;
+uint64_t uba_t::allocMap[8];
+uint64_t uba_t::validMap[8];
+ks10_t::data_t uba_t::shadow[8][uba_t::numPAG];
+unsigned int uba_t::epoch[8];
+uint32_t uba_t::stageMap;
+
+//!
+//! \brief
+//!    Write to Paging Memory through the shadow
+//!
+//! \details
+//!    The write is skipped if the shadow shows that the Paging RAM already
+//!    contains the data.  The KS10 may modify the Paging RAM whenever it
+//!    runs, so the shadow is discarded if the KS10 is running or if it has
+//!    been started, continued, or reset since the shadow was loaded.
+//!
+//! \param page -
+//!    Paging RAM entry
+//!
+//! \param data -
+//!    data to write to Paging Memory
+//!
+//! \note
+//!    The page map mutex must be held.
+//!
+
+void uba_t::__writePAG(unsigned int page, ks10_t::data_t data) {
+
+    unsigned int cpuEpoch = ks10_t::cpuEpoch();
+    if ((epoch[ubaNUM] != cpuEpoch) || !ks10_t::halt()) {
+        epoch[ubaNUM]    = cpuEpoch;
+        validMap[ubaNUM] = 0;
+    }
+
+    page &= numPAG - 1;
+    uint64_t bit = 1ULL << page;
+
+    if ((validMap[ubaNUM] & bit) && (shadow[ubaNUM][page] == data)) {
+        return;
+    }
+
+    ks10_t::writeIO(addrPAG + page, data);
+    shadow[ubaNUM][page] = data;
+    validMap[ubaNUM] |= bit;
+}
+
+//!
+//! \brief
+//!    Allocate a contiguous window of Unibus address space
+//!
+//! \details
+//!    If paddr is provided, the same number of contiguous pages of the
+//!    console staging area in KS10 memory is allocated with the window.
+//!    Each caller then has its own DMA buffer.  The window is not mapped.
+//!
+//! \param pages -
+//!    Number of pages (512 words each) to allocate
+//!
+//! \param [out] paddr -
+//!    KS10 memory address of the staging pages, or NULL if the caller does
+//!    not need staging pages.
+//!
+//! \returns
+//!    Unibus address of the window, or zero if no window or no staging
+//!    pages are available.
+//!
+
+ks10_t::addr_t uba_t::allocPAG(unsigned int pages, ks10_t::addr_t *paddr) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if ((pages == 0) || (pages >= numPAG)) {
+        printf("KS10: UBA%d: Unable to allocate %d pages of Unibus address space.\n", ubaNUM, pages);
+        return 0;
+    }
+
+    uint64_t mask = (1ULL << pages) - 1;
+    unsigned int page = bootPAG + 1;
+    while ((page + pages <= numPAG) && (allocMap[ubaNUM] & (mask << page))) {
+        page++;
+    }
+    if (page + pages > numPAG) {
+        printf("KS10: UBA%d: Unable to allocate %d pages of Unibus address space.\n", ubaNUM, pages);
+        return 0;
+    }
+
+    if (paddr != NULL) {
+        unsigned int stage = 0;
+        while ((stage + pages <= numSTAGE) && (stageMap & (mask << stage))) {
+            stage++;
+        }
+        if (stage + pages > numSTAGE) {
+            printf("KS10: UBA%d: Unable to allocate %d pages of staging memory.\n", ubaNUM, pages);
+            return 0;
+        }
+        stageMap |= mask << stage;
+        *paddr = stageADDR + (stage << 9);
+    }
+
+    allocMap[ubaNUM] |= mask << page;
+    return page2vaddr(page);
+}
+
+//!
+//! \brief
+//!    Map a window of Unibus address space to KS10 memory
+//!
+//! \param vaddr -
+//!    Unibus address of the window returned by allocPAG()
+//!
+//! \param paddr -
+//!    KS10 memory address.  This should be page aligned.
+//!
+//! \param pages -
+//!    Number of pages to map
+//!
+//! \param flags -
+//!    Paging RAM flags (PAG_VLD, PAG_FTM, etc)
+//!
+
+void uba_t::mapPAG(ks10_t::addr_t vaddr, ks10_t::addr_t paddr, unsigned int pages, ks10_t::data_t flags) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    unsigned int page = vaddr2page(vaddr);
+    for (unsigned int i = 0; i < pages; i++) {
+        __writePAG(page + i, flags | (addr2page(paddr) + i));
+    }
+}
+
+//!
+//! \brief
+//!    Free a window of Unibus address space
+//!
+//! \details
+//!    The Paging RAM is not modified.  The pages are simply made available
+//!    to the next allocPAG().
+//!
+//! \param vaddr -
+//!    Unibus address of the window returned by allocPAG()
+//!
+//! \param pages -
+//!    Number of pages to free
+//!
+//! \param paddr -
+//!    KS10 memory address of the staging pages returned by allocPAG(), or
+//!    zero if no staging pages were allocated.
+//!
+
+void uba_t::freePAG(ks10_t::addr_t vaddr, unsigned int pages, ks10_t::addr_t paddr) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (vaddr == 0) {
+        return;
+    }
+
+    uint64_t mask = (1ULL << pages) - 1;
+    allocMap[ubaNUM] &= ~(mask << vaddr2page(vaddr));
+    if (paddr != 0) {
+        stageMap &= ~(mask << ((paddr - stageADDR) >> 9));
+    }
+}
@@ -9,6 +9,12 @@
 //!    This object allows the console to interact with the IO Bridge Adapter.
 //!    This is mostly for testing the various devices from the console.
 //!
+//!    The object also manages the UBA Paging RAM on behalf of the console.
+//!    Console DMA operations allocate a contiguous window of pages with
+//!    allocPAG(), map it with mapPAG(), and release it with freePAG().  The
+//!    Paging RAM is shadowed in host memory so that entries that have not
+//!    changed are not rewritten.
+//!
 //! \file
 //!    uba.hpp
 //!
@@ -39,6 +45,10 @@
 #ifndef __UBA_HPP
 #define __UBA_HPP
 
+#include <mutex>
+
+#include <stdint.h>
+
 #include "ks10.hpp"
 
 //!
@@ -67,6 +77,42 @@ class uba_t {
         const ks10_t::addr_t addrCSR;
         const ks10_t::addr_t addrMR;
 
+        //
+        // UBA number (1-4)
+        //
+
+        const unsigned int ubaNUM;
+
+        //
+        // Number of entries in the Paging RAM.  Page 0 is never allocated.
+        // Page 1 is reserved for the RP and MT boot loaders which map it to
+        // KS10 address 01000.
+        //
+
+        static const unsigned int numPAG = 64;
+        static const unsigned int bootPAG = 1;
+
+        //
+        // Staging area in KS10 memory for console DMA buffers.  The pages
+        // are shared by all UBAs.
+        //
+
+        static const ks10_t::addr_t stageADDR = 060000;
+        static const unsigned int numSTAGE = 16;
+
+        //
+        // Page map state shared by all objects on the same UBA
+        //
+
+        static std::mutex mutex;                        //!< Protects page map state
+        static uint64_t allocMap[8];                    //!< Allocated pages
+        static uint64_t validMap[8];                    //!< Shadow entries that are valid
+        static ks10_t::data_t shadow[8][numPAG];        //!< Paging RAM shadow
+        static unsigned int epoch[8];                   //!< CPU epoch of the shadow
+        static uint32_t stageMap;                       //!< Allocated staging pages
+
+        void __writePAG(unsigned int page, ks10_t::data_t data);
+
     public:
 
         //
@@ -109,7 +155,8 @@ class uba_t {
         uba_t (ks10_t::addr_t baseADDR) :
             addrPAG((baseADDR & 07000000) + offsetUBA + offsetPAG),
             addrCSR((baseADDR & 07000000) + offsetUBA + offsetCSR),
-            addrMR ((baseADDR & 07000000) + offsetUBA + offsetMR ) {
+            addrMR ((baseADDR & 07000000) + offsetUBA + offsetMR ),
+            ubaNUM ((baseADDR >> 18) & 7) {
             ;
         }
 
@@ -149,7 +196,8 @@ class uba_t {
         //!
 
         void writePAG(ks10_t::addr_t offset, ks10_t::data_t data) {
-            ks10_t::writeIO(addrPAG + offset, data);
+            std::lock_guard<std::mutex> lock(mutex);
+            __writePAG(offset, data);
         }
 
         //!
@@ -181,6 +229,40 @@ class uba_t {
         static ks10_t::data_t addr2page(ks10_t::addr_t addr) {
             return (addr >> 9) & 03777;
         }
+
+        //!
+        //! \brief
+        //!    Function to convert a page number to a Unibus address
+        //!
+        //! \param page -
+        //!    Paging RAM entry
+        //!
+        //! \returns
+        //!    Unibus address of the first byte of the page
+        //!
+
+        static ks10_t::addr_t page2vaddr(unsigned int page) {
+            return page << 11;
+        }
+
+        //!
+        //! \brief
+        //!    Function to convert a Unibus address to a page number
+        //!
+        //! \param vaddr -
+        //!    Unibus address
+        //!
+        //! \returns
+        //!    Paging RAM entry associated with the Unibus address
+        //!
+
+        static unsigned int vaddr2page(ks10_t::addr_t vaddr) {
+            return (vaddr >> 11) & 077;
+        }
+
+        ks10_t::addr_t allocPAG(unsigned int pages, ks10_t::addr_t *paddr = NULL);
+        void mapPAG(ks10_t::addr_t vaddr, ks10_t::addr_t paddr, unsigned int pages, ks10_t::data_t flags);
+        void freePAG(ks10_t::addr_t vaddr, unsigned int pages, ks10_t::addr_t paddr = 0);
 };
 
 #endif
@@ -0,0 +1,523 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Unibus Exerciser (UBE) Interface Object
+//!
+//! \details
+//!    This object allows the console to drive the Unibus Exercisers.
+//!
+//!    The exercisers can perform NPR (DMA) reads and writes of KS10 memory
+//!    and can request interrupts on any BR level.  An NPR transfer moves
+//!    one KS10 word (BA increments by four, CC increments by two).  A block
+//!    transfer runs until CC overflows so a transfer of N words is started
+//!    with CC set to -2N.
+//!
+//!    The console cannot acknowledge interrupts (only the KS10 reads the
+//!    interrupt vector) so the interrupt test measures the time from GO to
+//!    the UBA reporting the interrupt request and then clears the request
+//!    through the exerciser CLR register.
+//!
+//! \file
+//!    ube.cpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#include <time.h>
+#include <stdio.h>
+
+#include "uba.hpp"
+#include "ube.hpp"
+
+//!
+//! \brief
+//!    Return the time in microseconds
+//!
+
+static double usecNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+//!
+//! \brief
+//!    Check and clear the UBA error bits
+//!
+//! \details
+//!    The PIA fields are preserved when the TMO and NXD bits are cleared.
+//!
+//! \param [in,out] tmo -
+//!    Incremented if the UBA reported a timeout (non-existent memory)
+//!
+//! \param [in,out] nxd -
+//!    Incremented if the UBA reported a non-existent device
+//!
+//! \returns
+//!    Number of errors
+//!
+
+unsigned int ube_t::checkUBA(unsigned int &tmo, unsigned int &nxd) {
+
+    ks10_t::data_t csr = uba.readCSR();
+    unsigned int errors = 0;
+
+    if (csr & uba_t::UBACSR_TMO) {
+        tmo++;
+        errors++;
+    }
+    if (csr & uba_t::UBACSR_NXD) {
+        nxd++;
+        errors++;
+    }
+    if (errors) {
+        uba.writeCSR((csr & 077) | uba_t::UBACSR_TMO | uba_t::UBACSR_NXD);
+    }
+    return errors;
+}
+
+//!
+//! \brief
+//!    Wait for the exercisers to complete a block transfer
+//!
+//! \details
+//!    An exerciser does not respond to register reads while it is making an
+//!    NPR In request, so a poll can fail with NXD.  That just means that
+//!    the exerciser is busy.
+//!
+//! \param mask -
+//!    Bit mask of exercisers
+//!
+//! \param timeout -
+//!    Timeout in milliseconds
+//!
+//! \returns
+//!    True if every exerciser completed, false if the wait timed out.
+//!
+
+bool ube_t::waitDMA(unsigned int mask, unsigned int timeout) {
+
+    double limit = usecNow() + timeout * 1e3;
+
+    for (unsigned int unit = 0; unit < maxUBE; unit++) {
+        if (mask & (1 << unit)) {
+            for (;;) {
+                uint16_t cc = ks10_t::readIO16(addrREG(unit, offsetCC));
+                if (ks10_t::nxmnxd()) {
+                    uba.writeCSR((uba.readCSR() & 077) | uba_t::UBACSR_NXD);
+                } else if ((cc & 0xfffe) == 0) {
+                    break;
+                }
+                if (usecNow() > limit) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+//!
+//! \brief
+//!    Find the exercisers that are present
+//!
+//! \returns
+//!    Bit mask of exercisers that respond
+//!
+
+unsigned int ube_t::probe(void) {
+
+    uba.readCSR();
+    if (ks10_t::nxmnxd()) {
+        printf("KS10: UBA%d is not present.\n", ubaNUM());
+        return 0;
+    }
+
+    unsigned int mask = 0;
+    for (unsigned int unit = 0; unit < maxUBE; unit++) {
+        ks10_t::readIO16(addrREG(unit, offsetCSR1));
+        if (!ks10_t::nxmnxd()) {
+            mask |= 1 << unit;
+        }
+    }
+
+    unsigned int tmo = 0;
+    unsigned int nxd = 0;
+    checkUBA(tmo, nxd);
+
+    return mask;
+}
+
+//!
+//! \brief
+//!    Dump exerciser registers
+//!
+//! \param mask -
+//!    Bit mask of exercisers to dump
+//!
+
+void ube_t::dumpRegs(unsigned int mask) {
+
+    printf("KS10: UBA%d Status: %012llo\n"
+           "      Unit  Addr      DB      CC      BA      CSR1    CSR2\n",
+           ubaNUM(), uba.readCSR());
+
+    for (unsigned int unit = 0; unit < maxUBE; unit++) {
+        if (mask & (1 << unit)) {
+            printf("      %2d    %08o  %06o  %06o  %06o  %06o  %06o\n",
+                   unit + 1, addrREG(unit, 0),
+                   ks10_t::readIO16(addrREG(unit, offsetDB)),
+                   ks10_t::readIO16(addrREG(unit, offsetCC)),
+                   ks10_t::readIO16(addrREG(unit, offsetBA)),
+                   ks10_t::readIO16(addrREG(unit, offsetCSR1)),
+                   ks10_t::readIO16(addrREG(unit, offsetCSR2)));
+        }
+    }
+}
+
+//!
+//! \brief
+//!    DMA bandwidth test
+//!
+//! \details
+//!    Each exerciser is given its own slice of KS10 memory and its own
+//!    window of Unibus address space.  All of the exercisers are started
+//!    together with the Simultaneous GO register so that they compete for
+//!    the UBA.  Only the time that the exercisers are busy is measured.
+//!
+//!    Write data is verified by reading KS10 memory.  Read data is
+//!    verified by checking the last word that was read into the DB
+//!    register.
+//!
+//! \param mask -
+//!    Bit mask of exercisers to use
+//!
+//! \param write -
+//!    True for NPR Out (write KS10 memory), false for NPR In (read KS10
+//!    memory)
+//!
+//! \param words -
+//!    Number of KS10 words per exerciser per transfer
+//!
+//! \param count -
+//!    Number of transfers
+//!
+//! \param paddr -
+//!    KS10 memory used for the test.  It is overwritten.  If zero, the
+//!    buffer is allocated from the console staging area.
+//!
+//! \returns
+//!    True if the test ran without errors.
+//!
+
+bool ube_t::testDMA(unsigned int mask, bool write, unsigned int words, unsigned int count, ks10_t::addr_t paddr) {
+
+    unsigned int units = 0;
+    for (unsigned int unit = 0; unit < maxUBE; unit++) {
+        if (mask & (1 << unit)) {
+            units++;
+        }
+    }
+
+    if ((units == 0) || (words == 0) || (words * units > maxWords)) {
+        printf("KS10: Transfer size must be between 1 and %d words for all exercisers.\n", maxWords);
+        return false;
+    }
+
+    //
+    // Map one window of Unibus address space per exerciser.  BA is only 16
+    // bits so the windows must be in the first 64 KB of Unibus space.
+    //
+
+    const unsigned int slicePAG = (words + 511) / 512;
+    const unsigned int pages    = slicePAG * units;
+
+    ks10_t::addr_t stage = 0;
+    ks10_t::addr_t vaddr = uba.allocPAG(pages, paddr == 0 ? &stage : NULL);
+    if (vaddr == 0) {
+        return false;
+    }
+    if (vaddr + pages * 04000 > 0200000) {
+        printf("KS10: Unibus address space above 64 KB is not reachable by the exercisers.\n");
+        uba.freePAG(vaddr, pages, stage);
+        return false;
+    }
+    if (paddr == 0) {
+        paddr = stage;
+    }
+    uba.mapPAG(vaddr, paddr, pages, uba_t::PAG_VLD);
+
+    static ks10_t::data_t buffer[maxWords];
+
+    //
+    // Initialize the exercisers.  Fill memory with a pattern for reads.
+    //
+
+    ks10_t::addr_t sliceVADDR[maxUBE];
+    ks10_t::addr_t slicePADDR[maxUBE];
+    unsigned int slice = 0;
+
+    for (unsigned int unit = 0; unit < maxUBE; unit++) {
+        if (mask & (1 << unit)) {
+            sliceVADDR[unit] = vaddr + slice * slicePAG * 04000;
+            slicePADDR[unit] = paddr + slice * slicePAG * 01000;
+            slice++;
+            ks10_t::writeIO16(addrREG(unit, offsetCLR), 1);
+            ks10_t::writeIO16(addrREG(unit, offsetCSR2), 0);
+            if (!write) {
+                for (unsigned int i = 0; i < words; i++) {
+                    buffer[i] = ((ks10_t::data_t)((i + unit) & 0xffff) << 18) | (~i & 0xffff);
+                }
+                ks10_t::writeMemBlock(slicePADDR[unit], buffer, words);
+            }
+        }
+    }
+
+    const uint16_t mode = UBECSR1_NPRS | UBECSR1_XTCCO | (write ? UBECSR1_NPRO : 0);
+
+    unsigned int tmo      = 0;
+    unsigned int nxd      = 0;
+    unsigned int timeouts = 0;
+    unsigned int ubeErrs  = 0;
+    unsigned int dataErrs = 0;
+    double busy = 0;
+    double minTime = 1e30;
+    double maxTime = 0;
+
+    for (unsigned int n = 0; n < count; n++) {
+
+        //
+        // Set up each exerciser
+        //
+
+        for (unsigned int unit = 0; unit < maxUBE; unit++) {
+            if (mask & (1 << unit)) {
+                ks10_t::writeIO16(addrREG(unit, offsetDB),   0125252 ^ (n * 0x1111) ^ unit);
+                ks10_t::writeIO16(addrREG(unit, offsetBA),   sliceVADDR[unit]);
+                ks10_t::writeIO16(addrREG(unit, offsetCC),   -2 * words);
+                ks10_t::writeIO16(addrREG(unit, offsetCSR1), mode);
+            }
+        }
+
+        //
+        // Start them together.  Simultaneous GO also starts any exerciser
+        // that is not in the mask, but those are left with CSR1 cleared
+        // (no operation) by previous tests.
+        //
+
+        double start = usecNow();
+        if (units == 1) {
+            for (unsigned int unit = 0; unit < maxUBE; unit++) {
+                if (mask & (1 << unit)) {
+                    ks10_t::writeIO16(addrREG(unit, offsetCSR1), mode | UBECSR1_GO);
+                }
+            }
+        } else {
+            ks10_t::writeIO16(addrREG(0, offsetSIM), 1);
+        }
+        bool done = waitDMA(mask, 1000);
+        double usec = usecNow() - start;
+
+        if (!done) {
+            timeouts++;
+            for (unsigned int unit = 0; unit < maxUBE; unit++) {
+                if (mask & (1 << unit)) {
+                    ks10_t::writeIO16(addrREG(unit, offsetCLR), 1);
+                }
+            }
+        } else {
+            busy += usec;
+            if (usec < minTime) {
+                minTime = usec;
+            }
+            if (usec > maxTime) {
+                maxTime = usec;
+            }
+        }
+
+        checkUBA(tmo, nxd);
+
+        //
+        // Check results
+        //
+
+        for (unsigned int unit = 0; unit < maxUBE; unit++) {
+            if (mask & (1 << unit)) {
+                if (ks10_t::readIO16(addrREG(unit, offsetCSR2)) & UBECSR2_ERR) {
+                    ubeErrs++;
+                    ks10_t::writeIO16(addrREG(unit, offsetCLR), 1);
+                }
+                uint16_t db = ks10_t::readIO16(addrREG(unit, offsetDB));
+                if (write) {
+                    ks10_t::data_t expect = ((ks10_t::data_t)db << 18) | db;
+                    ks10_t::readMemBlock(slicePADDR[unit], buffer, words);
+                    for (unsigned int i = 0; i < words; i++) {
+                        if (buffer[i] != expect) {
+                            dataErrs++;
+                        }
+                    }
+                } else if (done && (db != ((words - 1 + unit) & 0xffff))) {
+                    dataErrs++;
+                }
+            }
+        }
+    }
+
+    for (unsigned int unit = 0; unit < maxUBE; unit++) {
+        if (mask & (1 << unit)) {
+            ks10_t::writeIO16(addrREG(unit, offsetCSR1), 0);
+        }
+    }
+    uba.freePAG(vaddr, pages, stage);
+
+    unsigned int completed = count - timeouts;
+    double xfers = (double)completed * words * units;
+
+    printf("KS10: UBA%d DMA %s test: %d exerciser%s, %d words each, %d transfers.\n",
+           ubaNUM(), write ? "write" : "read", units, units == 1 ? "" : "s", words, count);
+    if (completed != 0) {
+        printf("      Bandwidth        : %.0f words/sec (%.2f MB/sec)\n"
+               "      Transfer time    : %.1f min, %.1f avg, %.1f max usec\n",
+               xfers * 1e6 / busy, xfers * 4 / busy,
+               minTime, busy / completed, maxTime);
+    }
+    printf("      Timeouts         : %d\n"
+           "      UBA TMO (NXM)    : %d\n"
+           "      UBA NXD          : %d\n"
+           "      UBE errors       : %d\n"
+           "      Data errors      : %d\n",
+           timeouts, tmo, nxd, ubeErrs, dataErrs);
+
+    return (timeouts | tmo | nxd | ubeErrs | dataErrs) == 0;
+}
+
+//!
+//! \brief
+//!    Interrupt request test
+//!
+//! \details
+//!    Each exerciser in turn requests an interrupt.  The time from GO to
+//!    the UBA reporting the request (UBACSR HI or LO) is measured.  The
+//!    request is then cleared and the next exerciser is tested.
+//!
+//! \param mask -
+//!    Bit mask of exercisers to use
+//!
+//! \param level -
+//!    BR level (4 to 7)
+//!
+//! \param count -
+//!    Number of interrupts per exerciser
+//!
+//! \returns
+//!    True if the test ran without errors.
+//!
+
+bool ube_t::testINTR(unsigned int mask, unsigned int level, unsigned int count) {
+
+    if ((level < 4) || (level > 7)) {
+        printf("KS10: BR level must be 4, 5, 6, or 7.\n");
+        return false;
+    }
+
+    const uint16_t br = UBECSR1_BR4 << (level - 4);
+    const ks10_t::data_t pend = (level >= 6) ? uba_t::UBACSR_HI : uba_t::UBACSR_LO;
+
+    unsigned int tmo      = 0;
+    unsigned int nxd      = 0;
+    unsigned int total    = 0;
+    unsigned int lost     = 0;
+    unsigned int stuck    = 0;
+    double sum     = 0;
+    double minTime = 1e30;
+    double maxTime = 0;
+
+    double begin = usecNow();
+
+    for (unsigned int n = 0; n < count; n++) {
+        for (unsigned int unit = 0; unit < maxUBE; unit++) {
+            if ((mask & (1 << unit)) == 0) {
+                continue;
+            }
+
+            total++;
+            double start = usecNow();
+            ks10_t::writeIO16(addrREG(unit, offsetCSR1), br | UBECSR1_GO);
+
+            bool seen = false;
+            double usec = 0;
+            while (usec < 10000) {
+                if (uba.readCSR() & pend) {
+                    seen = true;
+                    break;
+                }
+                usec = usecNow() - start;
+            }
+            usec = usecNow() - start;
+
+            if (seen) {
+                sum += usec;
+                if (usec < minTime) {
+                    minTime = usec;
+                }
+                if (usec > maxTime) {
+                    maxTime = usec;
+                }
+            } else {
+                lost++;
+            }
+
+            //
+            // Clear the request
+            //
+
+            ks10_t::writeIO16(addrREG(unit, offsetCLR), 1);
+            ks10_t::writeIO16(addrREG(unit, offsetCSR1), 0);
+            if (uba.readCSR() & pend) {
+                stuck++;
+            }
+            checkUBA(tmo, nxd);
+        }
+    }
+
+    double secs = (usecNow() - begin) / 1e6;
+    unsigned int seen = total - lost;
+
+    printf("KS10: UBA%d BR%d interrupt test: %d requests in %.3f seconds (%.0f/sec).\n",
+           ubaNUM(), level, total, secs, secs > 0 ? total / secs : 0.0);
+    if (seen != 0) {
+        printf("      Request latency  : %.1f min, %.1f avg, %.1f max usec\n",
+               minTime, sum / seen, maxTime);
+    }
+    printf("      Lost requests    : %d\n"
+           "      Stuck requests   : %d\n"
+           "      UBA TMO (NXM)    : %d\n"
+           "      UBA NXD          : %d\n",
+           lost, stuck, tmo, nxd);
+
+    return (lost | stuck | tmo | nxd) == 0;
+}
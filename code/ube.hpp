@@ -0,0 +1,178 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Unibus Exerciser (UBE) Interface Object
+//!
+//! \details
+//!    This object allows the console to drive the Unibus Exercisers that are
+//!    attached to an IO Bridge (UBA).  The exercisers are used to measure
+//!    DMA bandwidth, interrupt request latency, and the rate of Unibus
+//!    errors (TMO and NXD) reported by the UBA.
+//!
+//!    The FPGA attaches up to twelve exercisers to UBA4.  Each exerciser
+//!    occupies 16 bytes of IO space starting at 770000.
+//!
+//! \file
+//!    ube.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+
+#ifndef __UBE_HPP
+#define __UBE_HPP
+
+#include <stdint.h>
+
+#include "uba.hpp"
+#include "ks10.hpp"
+
+//!
+//! \brief
+//!    Unibus Exerciser Interface Object
+//!
+
+class ube_t {
+    private:
+
+        //
+        // Register offsets
+        //
+
+        const ks10_t::addr_t offsetDB   = 000;
+        const ks10_t::addr_t offsetCC   = 002;
+        const ks10_t::addr_t offsetBA   = 004;
+        const ks10_t::addr_t offsetCSR1 = 006;
+        const ks10_t::addr_t offsetCLR  = 010;
+        const ks10_t::addr_t offsetSIM  = 014;
+        const ks10_t::addr_t offsetCSR2 = 016;
+
+        //
+        // Each exerciser uses 16 bytes of IO space
+        //
+
+        const ks10_t::addr_t spacing    = 020;
+
+        //
+        // Base address of the first exerciser
+        //
+
+        const ks10_t::addr_t addrBASE;
+
+        //
+        // UBA object
+        //
+
+        uba_t uba;
+
+        //!
+        //! \brief
+        //!    Returns the address of an exerciser register
+        //!
+
+        ks10_t::addr_t addrREG(unsigned int unit, ks10_t::addr_t offset) {
+            return addrBASE + unit * spacing + offset;
+        }
+
+        unsigned int checkUBA(unsigned int &tmo, unsigned int &nxd);
+        bool waitDMA(unsigned int mask, unsigned int timeout);
+
+    public:
+
+        //
+        // UBE Base Address
+        //
+
+        static const uint32_t baseADDR1 = 04770000;     //!< base address #1
+
+        //
+        // Number of exercisers
+        //
+
+        static const unsigned int maxUBE = 12;
+
+        //
+        // Largest DMA (KS10 words) for all exercisers combined
+        //
+
+        static const unsigned int maxWords = 8192;
+
+        //
+        //! UBECSR1 definitions
+        //
+
+        static const uint16_t UBECSR1_ERR   = 0x8000;   //!< Error
+        static const uint16_t UBECSR1_FTM   = 0x0800;   //!< Fast Transfer Mode
+        static const uint16_t UBECSR1_XTCCO = 0x0400;   //!< Transfer until CC overflow
+        static const uint16_t UBECSR1_NPRO  = 0x0200;   //!< NPR Out (DATO)
+        static const uint16_t UBECSR1_BYTE  = 0x0100;   //!< NPR Byte
+        static const uint16_t UBECSR1_NPRS  = 0x0020;   //!< Simulate NPR cycles
+        static const uint16_t UBECSR1_BR7   = 0x0010;   //!< Interrupt on BR7
+        static const uint16_t UBECSR1_BR6   = 0x0008;   //!< Interrupt on BR6
+        static const uint16_t UBECSR1_BR5   = 0x0004;   //!< Interrupt on BR5
+        static const uint16_t UBECSR1_BR4   = 0x0002;   //!< Interrupt on BR4
+        static const uint16_t UBECSR1_GO    = 0x0001;   //!< Go
+
+        //
+        //! UBECSR2 definitions
+        //
+
+        static const uint16_t UBECSR2_TMO   = 0x8000;   //!< Timeout
+        static const uint16_t UBECSR2_BMD   = 0x4000;   //!< Bad Memory Data
+        static const uint16_t UBECSR2_BPE   = 0x2000;   //!< Bus Parity Error
+        static const uint16_t UBECSR2_NXD   = 0x1000;   //!< Non-existent Device
+        static const uint16_t UBECSR2_ERR   = 0xffe0;   //!< All error bits
+
+        //
+        // Public Functions
+        //
+
+        unsigned int probe(void);
+        void dumpRegs(unsigned int mask);
+        bool testDMA(unsigned int mask, bool write, unsigned int words, unsigned int count, ks10_t::addr_t paddr);
+        bool testINTR(unsigned int mask, unsigned int level, unsigned int count);
+
+        //!
+        //! \brief
+        //!    Returns the UBA number of the exercisers
+        //!
+
+        unsigned int ubaNUM(void) {
+            return (addrBASE >> 18) & 7;
+        }
+
+        //!
+        //! \brief
+        //!    Constructor. Setup register addresses.
+        //!
+
+        ube_t(uint32_t baseADDR = baseADDR1) :
+            addrBASE(baseADDR & 07777760),
+            uba(baseADDR) {
+            ;
+        }
+};
+
+#endif
@@ -0,0 +1,86 @@
+//******************************************************************************
+//
+//  KS10 Console Microcontroller
+//
+//! \brief
+//!    Shared Helper Functions
+//!
+//! \details
+//!    Small timing and sorting helpers that are used by the console objects
+//!    and by the host tools in the tools directory.
+//!
+//! \file
+//!    util.hpp
+//!
+//! \author
+//!    Rob Doyle - doyle (at) cox (dot) net
+//
+//******************************************************************************
+//
+// Copyright (C) 2013-2022 Rob Doyle
+//
+// This file is part of the KS10 FPGA Project
+//
+// The KS10 FPGA project is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version.
+//
+// The KS10 FPGA project is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this software.  If not, see <http://www.gnu.org/licenses/>.
+//
+//******************************************************************************
+//
+
+#ifndef __UTIL_HPP
+#define __UTIL_HPP
+
+#include <time.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+//!
+//! \brief
+//!    Return the time between two timespecs in nanoseconds
+//!
+
+inline uint64_t nsecs(const struct timespec &start, const struct timespec &finish) {
+    return (finish.tv_sec - start.tv_sec) * 1000000000ULL + finish.tv_nsec - start.tv_nsec;
+}
+
+//!
+//! \brief
+//!    Sort indices by decreasing count.  Equal counts are sorted by
+//!    increasing index.
+//!
+//! \param [in] count -
+//!    Array of counts
+//!
+//! \param [in] size -
+//!    Number of entries in the count array
+//!
+//! \returns
+//!    Array of indices into count[].  The caller must delete[] the array.
+//!
+
+inline unsigned int *sortIndex(const uint32_t *count, unsigned int size) {
+    unsigned int *index = new unsigned int[size];
+    for (unsigned int i = 0; i < size; i++) {
+        index[i] = i;
+    }
+    std::sort(index, index + size, [count](unsigned int a, unsigned int b) {
+        if (count[a] != count[b]) {
+            return count[a] > count[b];
+        }
+        return a < b;
+    });
+    return index;
+}
+
+#endif
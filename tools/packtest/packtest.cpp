@@ -0,0 +1,350 @@
+//
+// packtest.cpp
+//
+// Copyright 2022 Rob Doyle
+// SPDX-License-Identifier: GPL-2.0
+//
+// Round-trip tests and benchmarks for the PDP-10 byte packing routines in
+// code/pack.cpp.
+//
+// The bulk routines are checked against the single word routines, which are
+// the scalar reference.  The Unibus and Compatible formats carry 32 bits per
+// word so every possible word can be tested (--full).  The Core Dump and ANSI-ASCII
+// formats carry 36 bits per word, which is too many to test exhaustively.
+// Every value of every byte is tested with random values in the other bytes,
+// followed by random words.
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "pack.hpp"
+#include "util.hpp"
+
+//
+// Command line options
+//
+
+static bool     optFull  = false;       // Run the 32-bit exhaustive tests
+static bool     optBench = false;       // Run the benchmarks
+static unsigned optSize  = 65536;       // Benchmark buffer size (words)
+
+//
+// Test state
+//
+
+static const unsigned int blkWORDS = 4096;
+static unsigned long long checked;
+static unsigned long long failed;
+
+void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "\n"
+            "Options:\n"
+            "  -f, --full           Test every 32-bit word (about two minutes)\n"
+            "  -b, --bench          Run the benchmarks after the tests\n"
+            "  -s, --size=N         Benchmark buffer size in words (default 65536)\n"
+            "  -h, --help           Print this help\n", prog);
+}
+
+//
+// Small, fast, repeatable random numbers
+//
+
+static uint64_t rnd(void) {
+    static uint64_t x = 0x2545f4914f6cdd1dULL;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+//
+// Report the first few failures
+//
+
+static void fail(const char *test, unsigned long long n, ks10_t::data_t expect, ks10_t::data_t got) {
+    if (failed++ < 10) {
+        printf("  %s: failed at %llu: expected %012llo, got %012llo\n", test, n,
+               (unsigned long long)expect, (unsigned long long)got);
+    }
+}
+
+//
+// Formats.  The mask is the bits of each byte that the format stores.
+//
+
+enum fmt_t {
+    fmtUNIBUS,
+    fmtCORDMP,
+    fmtCOMPAT,
+    fmtANSI,
+};
+
+static const struct {
+    const char *name;
+    unsigned int bpw;
+    uint8_t mask[5];
+} fmts[] = {
+    {"UNIBUS", 4, {0xff, 0xff, 0xff, 0xff, 0x00}},
+    {"CORDMP", 5, {0xff, 0xff, 0xff, 0xff, 0x0f}},
+    {"COMPAT", 4, {0xff, 0xff, 0xff, 0xff, 0x00}},
+    {"ANSI",   5, {0x7f, 0x7f, 0x7f, 0x7f, 0xff}},
+};
+
+static ks10_t::data_t scalarPack(fmt_t fmt, const uint8_t *b) {
+    switch (fmt) {
+        case fmtUNIBUS: return pack_t::packUNIBUS(b);
+        case fmtCORDMP: return pack_t::packCORDMP(b);
+        case fmtCOMPAT: return pack_t::packCOMPAT(b);
+        default:        return pack_t::packANSI(b);
+    }
+}
+
+static void bulkPack(fmt_t fmt, ks10_t::data_t *dst, const uint8_t *src, unsigned int words) {
+    switch (fmt) {
+        case fmtUNIBUS: pack_t::packUNIBUS(dst, src, words * 4); break;
+        case fmtCORDMP: pack_t::packCORDMP(dst, src, words);     break;
+        case fmtCOMPAT: pack_t::packCOMPAT(dst, src, words);     break;
+        default:        pack_t::packANSI(dst, src, words);       break;
+    }
+}
+
+static void bulkUnpack(fmt_t fmt, uint8_t *dst, const ks10_t::data_t *src, unsigned int words) {
+    switch (fmt) {
+        case fmtUNIBUS: pack_t::unpackUNIBUS(dst, src, words); break;
+        case fmtCORDMP: pack_t::unpackCORDMP(dst, src, words); break;
+        case fmtCOMPAT: pack_t::unpackCOMPAT(dst, src, words); break;
+        default:        pack_t::unpackANSI(dst, src, words);   break;
+    }
+}
+
+//
+// Pack the bytes with the bulk routine and check every word against the
+// single word routine.  Then unpack the words with the bulk routine and
+// check that the stored bits of the bytes come back.
+//
+
+static void checkBlock(fmt_t fmt, const uint8_t *src, unsigned int words, unsigned long long base) {
+
+    static ks10_t::data_t dst[blkWORDS];
+    static uint8_t out[5 * blkWORDS];
+
+    const char *name = fmts[fmt].name;
+    const unsigned int bpw = fmts[fmt].bpw;
+    const uint8_t *mask = fmts[fmt].mask;
+
+    bulkPack(fmt, dst, src, words);
+    bulkUnpack(fmt, out, dst, words);
+
+    for (unsigned int i = 0; i < words; i++) {
+        const uint8_t *b = &src[i * bpw];
+        ks10_t::data_t ref = scalarPack(fmt, b);
+        if (dst[i] != ref) {
+            fail(name, base + i, ref, dst[i]);
+        }
+        for (unsigned int j = 0; j < bpw; j++) {
+            if (out[i * bpw + j] != (b[j] & mask[j])) {
+                fail(name, base + i, b[j] & mask[j], out[i * bpw + j]);
+                break;
+            }
+        }
+    }
+
+    checked += words;
+}
+
+//
+// Every 32-bit value as four bytes
+//
+
+static void testFull32(fmt_t fmt) {
+    static uint8_t src[4 * blkWORDS];
+    unsigned long long before = failed;
+    for (unsigned long long v = 0; v < 0x100000000ULL; v += blkWORDS) {
+        for (unsigned int i = 0; i < blkWORDS; i++) {
+            uint32_t x = v + i;
+            memcpy(&src[i * 4], &x, 4);
+        }
+        checkBlock(fmt, src, blkWORDS, v);
+    }
+    printf("  %-8s every 32-bit word:          %s\n", fmts[fmt].name, failed == before ? "pass" : "FAIL");
+}
+
+//
+// Every value of every byte with random values in the other bytes, then
+// random words.  The block length steps through every remainder so the
+// scalar tails of the bulk routines are used.
+//
+
+static void testLanes(fmt_t fmt) {
+    static uint8_t src[5 * blkWORDS];
+    const unsigned int bpw = fmts[fmt].bpw;
+    unsigned long long before = failed;
+    unsigned long long n = 0;
+
+    for (unsigned int lane = 0; lane < bpw; lane++) {
+        for (unsigned int pass = 0; pass < 64; pass++) {
+            for (unsigned int i = 0; i < 256; i++) {
+                for (unsigned int j = 0; j < bpw; j++) {
+                    src[i * bpw + j] = (j == lane) ? i : rnd();
+                }
+            }
+            checkBlock(fmt, src, 256 - (pass & 7), n);
+            n += 256;
+        }
+    }
+
+    for (unsigned int pass = 0; pass < 4096; pass++) {
+        for (unsigned int i = 0; i < blkWORDS * bpw; i++) {
+            src[i] = rnd();
+        }
+        checkBlock(fmt, src, blkWORDS - (pass & 7), n);
+        n += blkWORDS;
+    }
+
+    printf("  %-8s every byte value, random:   %s\n", fmts[fmt].name, failed == before ? "pass" : "FAIL");
+}
+
+//
+// Partial last word of packUNIBUS().  The missing bytes are zero and the
+// routine must not write past the last word.
+//
+
+static void testTail(void) {
+    unsigned long long before = failed;
+    uint8_t src[64];
+    ks10_t::data_t dst[17];
+    for (unsigned int bytes = 0; bytes <= 64; bytes++) {
+        for (unsigned int i = 0; i < sizeof(src); i++) {
+            src[i] = rnd();
+        }
+        for (unsigned int i = 0; i < 17; i++) {
+            dst[i] = 0777777777777;
+        }
+        unsigned int words = pack_t::packUNIBUS(dst, src, bytes);
+        if (words != (bytes + 3) / 4) {
+            fail("UNIBUS", bytes, (bytes + 3) / 4, words);
+        }
+        for (unsigned int i = 0; i < words; i++) {
+            uint8_t b[4] = {0, 0, 0, 0};
+            for (unsigned int j = 0; (j < 4) && (i * 4 + j < bytes); j++) {
+                b[j] = src[i * 4 + j];
+            }
+            if (dst[i] != pack_t::packUNIBUS(b)) {
+                fail("UNIBUS", bytes, pack_t::packUNIBUS(b), dst[i]);
+            }
+        }
+        if (dst[words] != 0777777777777) {
+            fail("UNIBUS", bytes, 0777777777777, dst[words]);
+        }
+        checked += words;
+    }
+    printf("  %-8s partial last word:          %s\n", "UNIBUS", failed == before ? "pass" : "FAIL");
+}
+
+static void bench(void) {
+
+    uint8_t *bytes = new uint8_t[5 * optSize];
+    ks10_t::data_t *words = new ks10_t::data_t[optSize];
+    for (unsigned int i = 0; i < 5 * optSize; i++) {
+        bytes[i] = rnd();
+    }
+
+    printf("\nBenchmark (%u words, GB/s of packed bytes)\n\n"
+           "  Format     Scalar     Pack   Unpack\n"
+           "  ------   -------- -------- --------\n", optSize);
+
+    for (unsigned int f = fmtUNIBUS; f <= fmtANSI; f++) {
+        const fmt_t fmt = (fmt_t)f;
+        double rate[3];
+        for (unsigned int t = 0; t < 3; t++) {
+            unsigned long long total = 0;
+            struct timespec start, now;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            do {
+                for (unsigned int rep = 0; rep < 16; rep++) {
+                    if (t == 0) {
+                        for (unsigned int i = 0; i < optSize; i++) {
+                            words[i] = scalarPack(fmt, &bytes[i * fmts[f].bpw]);
+                        }
+                    } else if (t == 1) {
+                        bulkPack(fmt, words, bytes, optSize);
+                    } else {
+                        bulkUnpack(fmt, bytes, words, optSize);
+                    }
+                    total += (unsigned long long)optSize * fmts[f].bpw;
+                }
+                clock_gettime(CLOCK_MONOTONIC, &now);
+            } while (nsecs(start, now) < 250000000ULL);
+            rate[t] = (double)total / nsecs(start, now);
+        }
+        printf("  %-6s   %8.2f %8.2f %8.2f\n", fmts[f].name, rate[0], rate[1], rate[2]);
+    }
+
+    delete[] bytes;
+    delete[] words;
+}
+
+int main(int argc, char *argv[]) {
+
+    static const struct option options[] = {
+        {"full",  no_argument,       0, 'f'},
+        {"bench", no_argument,       0, 'b'},
+        {"size",  required_argument, 0, 's'},
+        {"help",  no_argument,       0, 'h'},
+        {0,       0,                 0,  0 },
+    };
+
+    for (;;) {
+        int ret = getopt_long(argc, argv, "fbs:h", options, NULL);
+        if (ret == -1) {
+            break;
+        }
+        switch (ret) {
+            case 'f':
+                optFull = true;
+                break;
+            case 'b':
+                optBench = true;
+                break;
+            case 's':
+                optSize = strtoul(optarg, NULL, 0);
+                if (optSize == 0) {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'h':
+                usage(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    printf("Round-trip tests\n\n");
+
+    if (optFull) {
+        testFull32(fmtUNIBUS);
+        testFull32(fmtCOMPAT);
+    }
+    testLanes(fmtUNIBUS);
+    testLanes(fmtCORDMP);
+    testLanes(fmtCOMPAT);
+    testLanes(fmtANSI);
+    testTail();
+
+    printf("\n%llu words checked, %llu failures\n", checked, failed);
+
+    if (optBench) {
+        bench();
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
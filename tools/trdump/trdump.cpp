@@ -0,0 +1,225 @@
+//
+// trdump.cpp
+//
+// Copyright 2022 Rob Doyle
+// SPDX-License-Identifier: GPL-2.0
+//
+// Decode an instruction trace file that was saved by the console "tr --save"
+// command or streamed by the "tr --stream" command.
+//
+// Each trace entry is eight bytes, little-endian, with the PC in bits 53:36
+// and the IR in bits 35:0.  A saved trace is in execution order if the KS10
+// was halted.  A streamed trace is not, and is only good for histograms.  An
+// entry with bit 63 set marks a trace buffer overflow.  Its low bits are the
+// estimated number of instructions that were lost.
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "dasm.hpp"
+#include "util.hpp"
+
+//
+// Command line options
+//
+
+static bool     optList  = false;       // Disassemble each entry
+static bool     optMix   = false;       // Opcode mix
+static unsigned optTop   = 0;           // Number of PCs in the histogram
+static unsigned optLoPC  = 0;           // PC filter
+static unsigned optHiPC  = 0777777;     // PC filter
+static int      optOP    = -1;          // Opcode filter
+
+//
+// Histograms
+//
+
+static uint32_t pcCount[01000000];
+static uint64_t pcIR[01000000];         // Last instruction seen at each PC
+static uint32_t opCount[01000];
+
+void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] file...\n"
+            "\n"
+            "Options:\n"
+            "  -l, --list           Disassemble each entry (default)\n"
+            "  -t, --top=N          Print the N most frequently executed PCs\n"
+            "  -m, --mix            Print the opcode mix\n"
+            "  -p, --pc=lo[:hi]     Only use entries with lo <= PC <= hi (octal)\n"
+            "  -o, --opcode=op      Only use entries with the opcode op (octal)\n"
+            "  -h, --help           Print this help\n", prog);
+}
+
+//
+// Return the mnemonic of an opcode.  The disassembly is the instruction in
+// octal, the instruction fields, and the mnemonic separated by tabs.
+//
+
+static const char *mnemonic(unsigned int op) {
+    static char buf[16];
+    const char *s = dasm((unsigned long long)op << 27);
+    for (int i = 0; (i < 2) && s; i++) {
+        s = strchr(s, '\t');
+        s = s ? s + 1 : NULL;
+    }
+    if ((s == NULL) || (sscanf(s, "%15s", buf) != 1)) {
+        strcpy(buf, "?");
+    }
+    return buf;
+}
+
+//
+// Read and process one trace file
+//
+
+static unsigned long long gaps;         // Overflow gaps
+static unsigned long long lost;         // Estimated instructions lost in the gaps
+
+static bool readFile(const char *filename, unsigned long long &total, unsigned long long &used) {
+
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        perror(filename);
+        return false;
+    }
+
+    uint8_t b[8];
+    while (fread(b, sizeof(b), 1, fp) == 1) {
+        uint64_t entry = 0;
+        for (int j = 7; j >= 0; j--) {
+            entry = (entry << 8) | b[j];
+        }
+
+        if (entry & 0x8000000000000000ULL) {
+            gaps++;
+            lost += entry & 0x003fffffffffffffULL;
+            if (optList) {
+                printf("--------- gap: about %llu instructions were not captured\n", entry & 0x003fffffffffffffULL);
+            }
+            continue;
+        }
+
+        unsigned int pc = (entry >> 36) & 0777777;
+        unsigned long long ir = entry & 0777777777777ULL;
+        unsigned int op = (ir >> 27) & 0777;
+
+        total++;
+        if ((pc < optLoPC) || (pc > optHiPC) || ((optOP >= 0) && (op != (unsigned int)optOP))) {
+            continue;
+        }
+        used++;
+
+        pcCount[pc]++;
+        pcIR[pc] = ir;
+        opCount[op]++;
+
+        if (optList) {
+            printf("%9llu  %06o  %s\n", total - 1, pc, dasm(ir));
+        }
+    }
+
+    fclose(fp);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+
+    static const struct option options[] = {
+        {"list",   no_argument,       0, 'l'},
+        {"top",    required_argument, 0, 't'},
+        {"mix",    no_argument,       0, 'm'},
+        {"pc",     required_argument, 0, 'p'},
+        {"opcode", required_argument, 0, 'o'},
+        {"help",   no_argument,       0, 'h'},
+        {0,        0,                 0,  0 },
+    };
+
+    for (;;) {
+        int ret = getopt_long(argc, argv, "lt:mp:o:h", options, NULL);
+        if (ret == -1) {
+            break;
+        }
+        switch (ret) {
+            case 'l':
+                optList = true;
+                break;
+            case 't':
+                optTop = strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                optMix = true;
+                break;
+            case 'p': {
+                char *end;
+                optLoPC = strtoul(optarg, &end, 8) & 0777777;
+                optHiPC = (*end == ':') ? strtoul(end + 1, NULL, 8) & 0777777 : optLoPC;
+                break;
+            }
+            case 'o':
+                optOP = strtoul(optarg, NULL, 8) & 0777;
+                break;
+            case 'h':
+                usage(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!optMix && (optTop == 0)) {
+        optList = true;
+    }
+
+    unsigned long long total = 0;
+    unsigned long long used  = 0;
+
+    for (int i = optind; i < argc; i++) {
+        if (!readFile(argv[i], total, used)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("%llu entries, %llu selected\n", total, used);
+    if (gaps) {
+        printf("%llu overflow gaps, about %llu instructions (%.2f%%) were not captured\n",
+               gaps, lost, 100.0 * lost / (total + lost));
+    }
+    if (used == 0) {
+        return EXIT_SUCCESS;
+    }
+
+    if (optTop) {
+        unsigned int *index = sortIndex(pcCount, 01000000);
+        printf("\n"
+               "  Count     Pct     PC    Instruction\n"
+               "---------  ------  ------  -----------\n");
+        for (unsigned int i = 0; (i < optTop) && (pcCount[index[i]] != 0); i++) {
+            printf("%9u  %5.2f%%  %06o  %s\n", pcCount[index[i]], 100.0 * pcCount[index[i]] / used, index[i], dasm(pcIR[index[i]]));
+        }
+        delete[] index;
+    }
+
+    if (optMix) {
+        unsigned int *index = sortIndex(opCount, 01000);
+        printf("\n"
+               "  Count     Pct    OPC  Mnemonic\n"
+               "---------  ------  ---  --------\n");
+        for (unsigned int i = 0; (i < 01000) && (opCount[index[i]] != 0); i++) {
+            printf("%9u  %5.2f%%  %03o  %s\n", opCount[index[i]], 100.0 * opCount[index[i]] / used, index[i], mnemonic(index[i]));
+        }
+        delete[] index;
+    }
+
+    return EXIT_SUCCESS;
+}